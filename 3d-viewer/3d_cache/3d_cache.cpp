@@ -24,11 +24,16 @@
 
 #define GLM_FORCE_RADIANS
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <mutex>
+#include <set>
 #include <sstream>
+#include <thread>
 #include <utility>
 
 #include <wx/datetime.h>
@@ -49,6 +54,7 @@
 
 #include "3d_cache.h"
 #include "3d_info.h"
+#include "3d_mesh_cache.h"
 #include "3d_plugin_manager.h"
 #include "sg/scenegraph.h"
 #include "plugins/3dapi/ifsg_api.h"
@@ -66,6 +72,12 @@
 static std::mutex mutex3D_cache;
 static std::mutex mutex3D_cacheManager;
 
+// The plugins are not reentrant (they switch the process locale while parsing and keep
+// static tables), so the calls into them are serialized when models are loaded in parallel.
+// Only the model parsing and the scene graph cache writes are serialized: hashing, reading
+// the cache files and building the render meshes run concurrently.
+static std::mutex mutex3D_plugins;
+
 
 static bool isSHA1Same( const unsigned char* shaA, const unsigned char* shaB ) noexcept
 {
@@ -84,6 +96,7 @@ static bool checkTag( const char* aTag, void* aPluginMgrPtr )
 
     S3D_PLUGIN_MANAGER *pp = (S3D_PLUGIN_MANAGER*) aPluginMgrPtr;
 
+    // only reads the plugin list and tags, which do not change once the plugins are loaded
     return pp->CheckTag( aTag );
 }
 
@@ -138,11 +151,18 @@ public:
     void SetSHA1( const unsigned char* aSHA1Sum );
     const wxString GetCacheBaseName();
 
+    // free the render data, whether it was built from the scene graph or mapped from a
+    // mesh cache file
+    void ReleaseRenderData();
+
     wxDateTime    modTime;      // file modification time
     unsigned char sha1sum[20];
     std::string   pluginInfo;   // PluginName:Version string
     SCENEGRAPH*   sceneData;
     S3DMODEL*     renderData;
+
+    // when set, renderData points into this memory mapped ".3dm" file
+    std::unique_ptr<S3D_MESH_CACHE> meshCache;
 };
 
 
@@ -158,8 +178,21 @@ S3D_CACHE_ENTRY::~S3D_CACHE_ENTRY()
 {
     delete sceneData;
 
-    if( NULL != renderData )
+    ReleaseRenderData();
+}
+
+
+void S3D_CACHE_ENTRY::ReleaseRenderData()
+{
+    if( meshCache )
+    {
+        meshCache.reset();
+        renderData = NULL;
+    }
+    else if( NULL != renderData )
+    {
         S3D::Destroy3DModel( &renderData );
+    }
 }
 
 
@@ -174,6 +207,7 @@ void S3D_CACHE_ENTRY::SetSHA1( const unsigned char* aSHA1Sum )
     }
 
     memcpy( sha1sum, aSHA1Sum, 20 );
+    m_CacheBaseName.clear();
 }
 
 
@@ -200,7 +234,7 @@ S3D_CACHE::~S3D_CACHE()
 
     FlushCache();
 
-    // We'll delete ".3dc" cache files older than this many days
+    // We'll delete ".3dc" and ".3dm" cache files older than this many days
     int clearCacheInterval = commonSettings->m_System.clear_3d_cache_interval;
 
     // An interval of zero means the user doesn't want to ever clear the cache
@@ -213,7 +247,8 @@ S3D_CACHE::~S3D_CACHE()
 }
 
 
-SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr,
+                             bool aNeedSceneData )
 {
     if( aCachePtr )
         *aCachePtr = NULL;
@@ -264,13 +299,17 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCach
                     mi->second->sceneData = NULL;
                 }
 
-                if( NULL != mi->second->renderData )
-                    S3D::Destroy3DModel( &mi->second->renderData );
+                mi->second->ReleaseRenderData();
 
+                std::lock_guard<std::mutex> pluginLock( mutex3D_plugins );
                 mi->second->sceneData = m_Plugins->Load3DModel( full3Dpath, mi->second->pluginInfo );
             }
         }
 
+        // the entry may have been created from a mesh cache file, without any scene graph
+        if( aNeedSceneData && NULL == mi->second->sceneData && mi->second->meshCache )
+            loadSceneData( full3Dpath, mi->second );
+
         if( NULL != aCachePtr )
             *aCachePtr = mi->second;
 
@@ -278,7 +317,7 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCach
     }
 
     // a cache item does not exist; search the Filename->Cachename map
-    return checkCache( full3Dpath, aCachePtr );
+    return checkCache( full3Dpath, aCachePtr, aNeedSceneData );
 }
 
 
@@ -288,7 +327,8 @@ SCENEGRAPH* S3D_CACHE::Load( const wxString& aModelFile )
 }
 
 
-SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr,
+                                   bool aNeedSceneData )
 {
     if( aCachePtr )
         *aCachePtr = NULL;
@@ -345,18 +385,138 @@ SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY**
 
     ep->SetSHA1( sha1sum );
 
-    wxString bname = ep->GetCacheBaseName();
+    // the renderers only need the final meshes, which can be mapped without building
+    // the scene graph at all
+    if( !aNeedSceneData && loadMeshCacheData( ep ) )
+        return NULL;
+
+    loadSceneData( aFileName, ep );
+
+    return ep->sceneData;
+}
+
+
+void S3D_CACHE::loadSceneData( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem )
+{
+    wxString bname = aCacheItem->GetCacheBaseName();
     wxString cachename = m_CacheDir + bname + wxT( ".3dc" );
 
-    if( wxFileName::FileExists( cachename ) && loadCacheData( ep ) )
-        return ep->sceneData;
+    if( wxFileName::FileExists( cachename ) && loadCacheData( aCacheItem ) )
+        return;
+
+    {
+        std::lock_guard<std::mutex> pluginLock( mutex3D_plugins );
+        aCacheItem->sceneData = m_Plugins->Load3DModel( aFileName, aCacheItem->pluginInfo );
+    }
+
+    if( NULL != aCacheItem->sceneData )
+        saveCacheData( aCacheItem );
+}
 
-    ep->sceneData = m_Plugins->Load3DModel( aFileName, ep->pluginInfo );
+
+S3D_CACHE_ENTRY* S3D_CACHE::createEntry( const wxString& aFileName )
+{
+    S3D_CACHE_ENTRY* ep = new S3D_CACHE_ENTRY;
+    wxFileName fname( aFileName );
+    ep->modTime = fname.GetModificationTime();
+
+    unsigned char sha1sum[20];
+
+    // as in checkCache(), an entry without data prevents further attempts at loading
+    // a file which cannot be hashed or cached
+    if( !getSHA1( aFileName, sha1sum ) || m_CacheDir.empty() )
+        return ep;
+
+    ep->SetSHA1( sha1sum );
+
+    if( loadMeshCacheData( ep ) )
+        return ep;
+
+    loadSceneData( aFileName, ep );
 
     if( NULL != ep->sceneData )
-        saveCacheData( ep );
+    {
+        ep->renderData = S3D::GetModel( ep->sceneData );
 
-    return ep->sceneData;
+        if( NULL != ep->renderData )
+            saveMeshCacheData( ep );
+    }
+
+    return ep;
+}
+
+
+void S3D_CACHE::PreloadModels( const std::vector<wxString>& aModelFiles )
+{
+    // Resolve the names and keep each model once; boards tend to use the same few
+    // models for hundreds of footprints
+    std::vector<wxString> paths;
+    std::set<wxString>    resolved;
+
+    for( const wxString& modelFile : aModelFiles )
+    {
+        wxString full3Dpath = m_FNResolver->ResolvePath( modelFile );
+
+        if( !full3Dpath.empty() && resolved.insert( full3Dpath ).second )
+            paths.push_back( full3Dpath );
+    }
+
+    {
+        // models already in the cache are left to load(), which checks for modifications
+        std::lock_guard<std::mutex> lock( mutex3D_cache );
+
+        paths.erase( std::remove_if( paths.begin(), paths.end(),
+                                     [&]( const wxString& aPath )
+                                     {
+                                         return m_CacheMap.count( aPath ) > 0;
+                                     } ),
+                     paths.end() );
+    }
+
+    if( paths.empty() )
+        return;
+
+    std::vector<S3D_CACHE_ENTRY*> entries( paths.size(), nullptr );
+    std::atomic<size_t>           nextModel( 0 );
+    std::atomic<size_t>           threadsFinished( 0 );
+
+    size_t parallelThreadCount = std::min<size_t>(
+            std::max<size_t>( std::thread::hardware_concurrency(), 2 ), paths.size() );
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+    {
+        std::thread t = std::thread( [&]()
+        {
+            for( size_t i = nextModel.fetch_add( 1 ); i < paths.size();
+                 i = nextModel.fetch_add( 1 ) )
+            {
+                entries[i] = createEntry( paths[i] );
+            }
+
+            threadsFinished++;
+        } );
+
+        t.detach();
+    }
+
+    while( threadsFinished < parallelThreadCount )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+
+    std::lock_guard<std::mutex> lock( mutex3D_cache );
+
+    for( size_t i = 0; i < paths.size(); ++i )
+    {
+        // the model may have been loaded by another caller in the meantime
+        if( m_CacheMap.insert( std::pair< wxString, S3D_CACHE_ENTRY* >
+                                   ( paths[i], entries[i] ) ).second )
+        {
+            m_CacheList.push_back( entries[i] );
+        }
+        else
+        {
+            delete entries[i];
+        }
+    }
 }
 
 
@@ -506,11 +666,56 @@ bool S3D_CACHE::saveCacheData( S3D_CACHE_ENTRY* aCacheItem )
         }
     }
 
+    // Writing renumbers the nodes through the global node name counters, which the plugins
+    // also use while building scene graphs
+    std::lock_guard<std::mutex> pluginLock( mutex3D_plugins );
+
     return S3D::WriteCache( fname.ToUTF8(), true, (SGNODE*)aCacheItem->sceneData,
         aCacheItem->pluginInfo.c_str() );
 }
 
 
+bool S3D_CACHE::loadMeshCacheData( S3D_CACHE_ENTRY* aCacheItem )
+{
+    wxString bname = aCacheItem->GetCacheBaseName();
+
+    if( bname.empty() || m_CacheDir.empty() )
+        return false;
+
+    wxString fname = m_CacheDir + bname + wxT( ".3dm" );
+
+    if( !wxFileName::FileExists( fname ) )
+        return false;
+
+    std::unique_ptr<S3D_MESH_CACHE> meshCache = S3D_MESH_CACHE::Read( fname );
+
+    if( !meshCache )
+        return false;
+
+    aCacheItem->ReleaseRenderData();
+    aCacheItem->renderData = meshCache->GetModel();
+    aCacheItem->meshCache = std::move( meshCache );
+
+    return true;
+}
+
+
+bool S3D_CACHE::saveMeshCacheData( S3D_CACHE_ENTRY* aCacheItem )
+{
+    if( NULL == aCacheItem->renderData || aCacheItem->meshCache )
+        return false;
+
+    wxString bname = aCacheItem->GetCacheBaseName();
+
+    if( bname.empty() || m_CacheDir.empty() )
+        return false;
+
+    wxString fname = m_CacheDir + bname + wxT( ".3dm" );
+
+    return S3D_MESH_CACHE::Write( fname, *aCacheItem->renderData );
+}
+
+
 bool S3D_CACHE::Set3DConfigDir( const wxString& aConfigDir )
 {
     if( !m_ConfigDir.empty() )
@@ -665,7 +870,11 @@ void S3D_CACHE::ClosePlugins()
 S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName )
 {
     S3D_CACHE_ENTRY* cp = NULL;
-    SCENEGRAPH* sp = load( aModelFileName, &cp );
+    SCENEGRAPH* sp = load( aModelFileName, &cp, false );
+
+    // a model mapped from the mesh cache comes without a scene graph
+    if( cp && cp->renderData )
+        return cp->renderData;
 
     if( !sp )
         return NULL;
@@ -679,20 +888,19 @@ S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName )
         return NULL;
     }
 
-    if( cp->renderData )
-        return cp->renderData;
-
     S3DMODEL* mp = S3D::GetModel( sp );
     cp->renderData = mp;
 
+    if( mp )
+        saveMeshCacheData( cp );
+
     return mp;
 }
 
 void S3D_CACHE::CleanCacheDir( int aNumDaysOld )
 {
     wxDir         dir;
-    wxString      fileSpec = wxT( "*.3dc" );
-    wxArrayString fileList; // Holds list of ".3dc" files found in cache directory
+    wxArrayString fileList; // Holds list of ".3dc" and ".3dm" files found in cache directory
     size_t        numFilesFound = 0;
 
     wxFileName thisFile;
@@ -708,8 +916,10 @@ void S3D_CACHE::CleanCacheDir( int aNumDaysOld )
     {
         thisFile.SetPath( m_CacheDir ); // Set the base path to the cache folder
 
-        // Get a list of all the ".3dc" files in the cache directory
-        numFilesFound = dir.GetAllFiles( m_CacheDir, &fileList, fileSpec );
+        // Get a list of all the ".3dc" and ".3dm" files in the cache directory
+        dir.GetAllFiles( m_CacheDir, &fileList, wxT( "*.3dc" ) );
+        dir.GetAllFiles( m_CacheDir, &fileList, wxT( "*.3dm" ) );
+        numFilesFound = fileList.GetCount();
 
         for( unsigned int i = 0; i < numFilesFound; i++ )
         {
@@ -34,6 +34,7 @@
 #include "kicad_string.h"
 #include <list>
 #include <map>
+#include <vector>
 #include "plugins/3dapi/c3dmodel.h"
 #include <project.h>
 #include <wx/string.h>
@@ -79,7 +80,8 @@ private:
      * @return      SCENEGRAPH object associated with file name
      * @retval      NULL    on error
      */
-    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = NULL );
+    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = NULL,
+                            bool aNeedSceneData = true );
 
     /**
      * Function getSHA1
@@ -98,8 +100,27 @@ private:
     // save scene data to a cache file
     bool saveCacheData( S3D_CACHE_ENTRY* aCacheItem );
 
-    // the real load function (can supply a cache entry pointer to member functions)
-    SCENEGRAPH* load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr = NULL );
+    // load scene data from the ".3dc" cache file, or from the model file itself
+    void loadSceneData( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem );
+
+    // create a cache entry holding both the scene and the render data of a model;
+    // this may run in a worker thread, the entry is not added to the cache
+    S3D_CACHE_ENTRY* createEntry( const wxString& aFileName );
+
+    // map render data from a ".3dm" mesh cache file
+    bool loadMeshCacheData( S3D_CACHE_ENTRY* aCacheItem );
+
+    // save render data to a ".3dm" mesh cache file
+    bool saveMeshCacheData( S3D_CACHE_ENTRY* aCacheItem );
+
+    /**
+     * The real load function (can supply a cache entry pointer to member functions).
+     *
+     * When \a aNeedSceneData is false, the render data may be mapped from the mesh cache
+     * instead; the entry then holds no scene graph and NULL is returned.
+     */
+    SCENEGRAPH* load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr = NULL,
+                      bool aNeedSceneData = true );
 
 public:
     S3D_CACHE();
@@ -177,20 +198,36 @@ public:
     /**
      * Function GetModel
      * attempts to load the scene data for a model and to translate it
-     * into an S3D_MODEL structure for display by a renderer
+     * into an S3D_MODEL structure for display by a renderer.  The result is
+     * stored in a ".3dm" mesh cache file, which is memory mapped on the next
+     * requests for the same model, skipping the scene graph entirely.
      *
      * @param aModelFileName is the full path to the model to be loaded
      * @return is a pointer to the render data or NULL if not available
      */
     S3DMODEL* GetModel( const wxString& aModelFileName );
 
+    /**
+     * Function PreloadModels
+     * loads a set of models in parallel, so the subsequent calls to GetModel()
+     * for them are served from the cache.  The file names are resolved and
+     * deduplicated first: each distinct model is loaded exactly once.
+     *
+     * The models are hashed and read from the cache files concurrently; the
+     * plugins are not reentrant, so the models which are not cached yet are
+     * still parsed one at a time.
+     *
+     * @param aModelFiles are the partial or full paths of the models to load
+     */
+    void PreloadModels( const std::vector<wxString>& aModelFiles );
+
     /**
      * Function Delete up old cache files in cache directory
      *
-     * Deletes ".3dc" files in the cache directory that are older than
+     * Deletes ".3dc" and ".3dm" files in the cache directory that are older than
      * "aNumDaysOld".
      *
-     * @param aNumDaysOld is age threshold to delete ".3dc" cache files
+     * @param aNumDaysOld is age threshold to delete cache files
      */
     void CleanCacheDir( int aNumDaysOld );
 };
@@ -0,0 +1,345 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include <wx/ffile.h>
+#include <wx/log.h>
+
+#include <cache_file.h>
+
+#include "3d_mesh_cache.h"
+
+
+#define MASK_3D_CACHE "3D_CACHE"
+
+/*
+ * File layout; every block starts on a BLOCK_ALIGN boundary and all the values are stored
+ * in the native byte order (the file is a local cache, it is never shared between machines):
+ *
+ *   MESH_CACHE_HEADER
+ *   SMATERIAL[ m_MaterialsCount ]
+ *   MESH_CACHE_RECORD[ m_MeshesCount ]
+ *   for each mesh: positions, normals, texcoords, colors (SFVEC3F / SFVEC2F arrays)
+ *                  and face indices (uint32_t array)
+ */
+
+static const char     MESH_CACHE_MAGIC[8] = "KI3DMSH";
+static const uint32_t MESH_CACHE_VERSION = 1;
+static const uint32_t MESH_CACHE_BYTE_ORDER = 0x01020304;
+static const size_t   BLOCK_ALIGN = 16;
+
+
+struct MESH_CACHE_HEADER
+{
+    char     m_Magic[8];
+    uint32_t m_Version;
+    uint32_t m_ByteOrder;
+    uint32_t m_MaterialSize;        ///< sizeof( SMATERIAL ) of the writer
+    uint32_t m_VectorSize;          ///< sizeof( SFVEC3F ) of the writer
+    uint32_t m_MaterialsCount;
+    uint32_t m_MeshesCount;
+    uint64_t m_FileSize;
+};
+
+
+struct MESH_CACHE_RECORD
+{
+    uint32_t m_VertexCount;
+    uint32_t m_FaceIdxCount;
+    uint32_t m_MaterialIdx;
+    uint32_t m_Reserved;
+
+    // offsets from the start of the file, 0 for a missing array
+    uint64_t m_Positions;
+    uint64_t m_Normals;
+    uint64_t m_Texcoords;
+    uint64_t m_Colors;
+    uint64_t m_FaceIdx;
+};
+
+
+static uint64_t alignBlock( uint64_t aOffset )
+{
+    return ( aOffset + BLOCK_ALIGN - 1 ) & ~uint64_t( BLOCK_ALIGN - 1 );
+}
+
+
+/**
+ * Reserve a block of \a aCount elements of \a aElemSize bytes at \a aOffset.
+ * @return the block offset, or 0 if there is nothing to store.
+ */
+static uint64_t reserveBlock( uint64_t& aOffset, const void* aData, uint64_t aCount,
+                              size_t aElemSize )
+{
+    if( !aData || aCount == 0 )
+        return 0;
+
+    uint64_t block = alignBlock( aOffset );
+    aOffset = block + aCount * aElemSize;
+
+    return block;
+}
+
+
+static bool writeBlock( wxFFile& aFile, uint64_t aOffset, const void* aData, size_t aLength )
+{
+    if( aOffset == 0 )
+        return true;
+
+    static const char padding[BLOCK_ALIGN] = {};
+    uint64_t          pos = static_cast<uint64_t>( aFile.Tell() );
+
+    if( aOffset < pos || aOffset - pos >= BLOCK_ALIGN )
+        return false;
+
+    if( aOffset > pos && aFile.Write( padding, aOffset - pos ) != aOffset - pos )
+        return false;
+
+    return aFile.Write( aData, aLength ) == aLength;
+}
+
+
+S3D_MESH_CACHE::S3D_MESH_CACHE()
+{
+    m_model.m_MeshesSize = 0;
+    m_model.m_Meshes = nullptr;
+    m_model.m_MaterialsSize = 0;
+    m_model.m_Materials = nullptr;
+}
+
+
+std::unique_ptr<S3D_MESH_CACHE> S3D_MESH_CACHE::Read( const wxString& aFileName )
+{
+    std::unique_ptr<S3D_MESH_CACHE> cache( new S3D_MESH_CACHE );
+
+    if( !cache->m_file.Open( aFileName ) )
+    {
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] cannot map mesh cache file '%s'", aFileName );
+        return nullptr;
+    }
+
+    if( !cache->build() )
+    {
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] invalid mesh cache file '%s'", aFileName );
+        return nullptr;
+    }
+
+    return cache;
+}
+
+
+bool S3D_MESH_CACHE::build()
+{
+    const char*    data = m_file.Data();
+    const uint64_t size = m_file.Size();
+
+    if( size < sizeof( MESH_CACHE_HEADER ) )
+        return false;
+
+    const MESH_CACHE_HEADER* header = reinterpret_cast<const MESH_CACHE_HEADER*>( data );
+
+    if( memcmp( header->m_Magic, MESH_CACHE_MAGIC, sizeof( MESH_CACHE_MAGIC ) ) != 0
+            || header->m_Version != MESH_CACHE_VERSION
+            || header->m_ByteOrder != MESH_CACHE_BYTE_ORDER
+            || header->m_MaterialSize != sizeof( SMATERIAL )
+            || header->m_VectorSize != sizeof( SFVEC3F )
+            || header->m_FileSize != size
+            || header->m_MeshesCount == 0 )
+    {
+        return false;
+    }
+
+    // Check that a block lies in the file; a null offset stands for a missing array
+    auto inFile = [&]( uint64_t aOffset, uint64_t aCount, size_t aElemSize ) -> bool
+    {
+        if( aOffset == 0 )
+            return true;
+
+        return aOffset % BLOCK_ALIGN == 0 && aOffset >= sizeof( MESH_CACHE_HEADER )
+               && aOffset <= size && aCount * aElemSize <= size - aOffset;
+    };
+
+    uint64_t materials = alignBlock( sizeof( MESH_CACHE_HEADER ) );
+    uint64_t records = alignBlock( materials + header->m_MaterialsCount * sizeof( SMATERIAL ) );
+
+    if( !inFile( records, header->m_MeshesCount, sizeof( MESH_CACHE_RECORD ) ) )
+        return false;
+
+    const MESH_CACHE_RECORD* record = reinterpret_cast<const MESH_CACHE_RECORD*>( data + records );
+
+    m_meshes.resize( header->m_MeshesCount );
+
+    for( uint32_t i = 0; i < header->m_MeshesCount; ++i, ++record )
+    {
+        const uint64_t vertices = record->m_VertexCount;
+
+        if( !record->m_Positions || !record->m_FaceIdx
+                || record->m_MaterialIdx >= header->m_MaterialsCount
+                || !inFile( record->m_Positions, vertices, sizeof( SFVEC3F ) )
+                || !inFile( record->m_Normals, vertices, sizeof( SFVEC3F ) )
+                || !inFile( record->m_Texcoords, vertices, sizeof( SFVEC2F ) )
+                || !inFile( record->m_Colors, vertices, sizeof( SFVEC3F ) )
+                || !inFile( record->m_FaceIdx, record->m_FaceIdxCount, sizeof( uint32_t ) ) )
+        {
+            return false;
+        }
+
+        auto at = [&]( uint64_t aOffset ) -> char*
+        {
+            return aOffset ? m_file.Data() + aOffset : nullptr;
+        };
+
+        SMESH& mesh = m_meshes[i];
+
+        mesh.m_VertexSize = record->m_VertexCount;
+        mesh.m_Positions = reinterpret_cast<SFVEC3F*>( at( record->m_Positions ) );
+        mesh.m_Normals = reinterpret_cast<SFVEC3F*>( at( record->m_Normals ) );
+        mesh.m_Texcoords = reinterpret_cast<SFVEC2F*>( at( record->m_Texcoords ) );
+        mesh.m_Color = reinterpret_cast<SFVEC3F*>( at( record->m_Colors ) );
+        mesh.m_FaceIdxSize = record->m_FaceIdxCount;
+        mesh.m_FaceIdx = reinterpret_cast<unsigned int*>( at( record->m_FaceIdx ) );
+        mesh.m_MaterialIdx = record->m_MaterialIdx;
+
+        // The renderers index the vertex arrays without checking, so a damaged file must not
+        // get through
+        for( unsigned int j = 0; j < mesh.m_FaceIdxSize; ++j )
+        {
+            if( mesh.m_FaceIdx[j] >= mesh.m_VertexSize )
+                return false;
+        }
+    }
+
+    m_model.m_MeshesSize = header->m_MeshesCount;
+    m_model.m_Meshes = m_meshes.data();
+    m_model.m_MaterialsSize = header->m_MaterialsCount;
+    m_model.m_Materials = header->m_MaterialsCount
+                                  ? reinterpret_cast<SMATERIAL*>( m_file.Data() + materials )
+                                  : nullptr;
+
+    return true;
+}
+
+
+bool S3D_MESH_CACHE::Write( const wxString& aFileName, const S3DMODEL& aModel )
+{
+    static_assert( sizeof( unsigned int ) == sizeof( uint32_t ), "unexpected index size" );
+
+    if( aModel.m_MeshesSize == 0 || !aModel.m_Meshes
+            || ( aModel.m_MaterialsSize && !aModel.m_Materials ) )
+    {
+        return false;
+    }
+
+    MESH_CACHE_HEADER header;
+
+    memcpy( header.m_Magic, MESH_CACHE_MAGIC, sizeof( MESH_CACHE_MAGIC ) );
+    header.m_Version = MESH_CACHE_VERSION;
+    header.m_ByteOrder = MESH_CACHE_BYTE_ORDER;
+    header.m_MaterialSize = sizeof( SMATERIAL );
+    header.m_VectorSize = sizeof( SFVEC3F );
+    header.m_MaterialsCount = aModel.m_MaterialsSize;
+    header.m_MeshesCount = aModel.m_MeshesSize;
+
+    // Lay out the file first, so the records can be written before the arrays
+    uint64_t materials = alignBlock( sizeof( MESH_CACHE_HEADER ) );
+    uint64_t records = alignBlock( materials + aModel.m_MaterialsSize * sizeof( SMATERIAL ) );
+    uint64_t offset = records + aModel.m_MeshesSize * sizeof( MESH_CACHE_RECORD );
+
+    std::vector<MESH_CACHE_RECORD> meshRecords( aModel.m_MeshesSize );
+
+    for( unsigned int i = 0; i < aModel.m_MeshesSize; ++i )
+    {
+        const SMESH&       mesh = aModel.m_Meshes[i];
+        MESH_CACHE_RECORD& record = meshRecords[i];
+
+        if( !mesh.m_Positions || mesh.m_VertexSize == 0 || !mesh.m_FaceIdx
+                || mesh.m_FaceIdxSize == 0 )
+        {
+            return false;
+        }
+
+        record.m_VertexCount = mesh.m_VertexSize;
+        record.m_FaceIdxCount = mesh.m_FaceIdxSize;
+        record.m_MaterialIdx = mesh.m_MaterialIdx;
+        record.m_Reserved = 0;
+        record.m_Positions = reserveBlock( offset, mesh.m_Positions, mesh.m_VertexSize,
+                                           sizeof( SFVEC3F ) );
+        record.m_Normals = reserveBlock( offset, mesh.m_Normals, mesh.m_VertexSize,
+                                         sizeof( SFVEC3F ) );
+        record.m_Texcoords = reserveBlock( offset, mesh.m_Texcoords, mesh.m_VertexSize,
+                                           sizeof( SFVEC2F ) );
+        record.m_Colors = reserveBlock( offset, mesh.m_Color, mesh.m_VertexSize,
+                                        sizeof( SFVEC3F ) );
+        record.m_FaceIdx = reserveBlock( offset, mesh.m_FaceIdx, mesh.m_FaceIdxSize,
+                                         sizeof( uint32_t ) );
+    }
+
+    header.m_FileSize = offset;
+
+    auto writer =
+            [&]( wxFFile& aFile )
+            {
+                bool ok = aFile.Write( &header, sizeof( header ) ) == sizeof( header );
+
+                if( ok && aModel.m_MaterialsSize )
+                {
+                    ok = writeBlock( aFile, materials, aModel.m_Materials,
+                                     aModel.m_MaterialsSize * sizeof( SMATERIAL ) );
+                }
+
+                if( ok )
+                {
+                    ok = writeBlock( aFile, records, meshRecords.data(),
+                                     meshRecords.size() * sizeof( MESH_CACHE_RECORD ) );
+                }
+
+                for( unsigned int i = 0; ok && i < aModel.m_MeshesSize; ++i )
+                {
+                    const SMESH&             mesh = aModel.m_Meshes[i];
+                    const MESH_CACHE_RECORD& record = meshRecords[i];
+
+                    ok = writeBlock( aFile, record.m_Positions, mesh.m_Positions,
+                                     mesh.m_VertexSize * sizeof( SFVEC3F ) )
+                         && writeBlock( aFile, record.m_Normals, mesh.m_Normals,
+                                        mesh.m_VertexSize * sizeof( SFVEC3F ) )
+                         && writeBlock( aFile, record.m_Texcoords, mesh.m_Texcoords,
+                                        mesh.m_VertexSize * sizeof( SFVEC2F ) )
+                         && writeBlock( aFile, record.m_Colors, mesh.m_Color,
+                                        mesh.m_VertexSize * sizeof( SFVEC3F ) )
+                         && writeBlock( aFile, record.m_FaceIdx, mesh.m_FaceIdx,
+                                        mesh.m_FaceIdxSize * sizeof( uint32_t ) );
+                }
+
+                return ok;
+            };
+
+    if( !WriteFileAtomically( aFileName, writer ) )
+    {
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] cannot write mesh cache file '%s'", aFileName );
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,84 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_cache.h
+ * Flattened, memory-mappable storage of the render data (S3DMODEL) of a 3D model.
+ */
+
+#ifndef MESH_CACHE_3D_H
+#define MESH_CACHE_3D_H
+
+#include <memory>
+#include <vector>
+
+#include <mapped_file.h>
+#include "plugins/3dapi/c3dmodel.h"
+
+
+/**
+ * S3D_MESH_CACHE
+ *
+ * Holds an S3DMODEL read from a ".3dm" cache file. The file contains the final vertex,
+ * normal, texture coordinate, color, index and material arrays, laid out so they can be
+ * used in place: the file is memory mapped and the model arrays point into the mapping,
+ * so no scene graph has to be parsed and no mesh has to be rebuilt to display the model.
+ *
+ * The model is valid as long as the S3D_MESH_CACHE object exists.
+ */
+class S3D_MESH_CACHE
+{
+public:
+    S3D_MESH_CACHE();
+
+    S3D_MESH_CACHE( const S3D_MESH_CACHE& ) = delete;
+    S3D_MESH_CACHE& operator=( const S3D_MESH_CACHE& ) = delete;
+
+    /**
+     * Function Read
+     * maps a ".3dm" file and validates its content.
+     *
+     * @return the cached model or nullptr if the file is missing, was written by an
+     * incompatible version or is damaged.
+     */
+    static std::unique_ptr<S3D_MESH_CACHE> Read( const wxString& aFileName );
+
+    /**
+     * Function Write
+     * stores a model in a ".3dm" file, see WriteFileAtomically().
+     *
+     * @return true on success.
+     */
+    static bool Write( const wxString& aFileName, const S3DMODEL& aModel );
+
+    S3DMODEL* GetModel() { return &m_model; }
+
+private:
+    bool build();
+
+    MAPPED_FILE        m_file;
+    std::vector<SMESH> m_meshes;
+    S3DMODEL           m_model;
+};
+
+#endif  // MESH_CACHE_3D_H
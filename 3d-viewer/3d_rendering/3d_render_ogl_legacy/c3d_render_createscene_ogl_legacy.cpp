@@ -884,6 +884,23 @@ void C3D_RENDER_OGL_LEGACY::load_3D_models( REPORTER* aStatusReporter )
        (!m_boardAdapter.GetFlag( FL_MODULE_ATTRIBUTES_VIRTUAL )) )
         return;
 
+    // Load all the models at once: each distinct model is loaded only once
+    std::vector<wxString> modelFiles;
+
+    for( MODULE* module : m_boardAdapter.GetBoard()->Modules() )
+    {
+        for( const MODULE_3D_SETTINGS& model : module->Models() )
+        {
+            if( model.m_Show && !model.m_Filename.empty() )
+                modelFiles.push_back( model.m_Filename );
+        }
+    }
+
+    if( aStatusReporter )
+        aStatusReporter->Report( _( "Loading 3D models" ) );
+
+    m_boardAdapter.Get3DCacheManager()->PreloadModels( modelFiles );
+
     // Go for all modules
     for( MODULE* module : m_boardAdapter.GetBoard()->Modules() )
     {
@@ -891,20 +908,20 @@ void C3D_RENDER_OGL_LEGACY::load_3D_models( REPORTER* aStatusReporter )
         {
             if( model.m_Show && !model.m_Filename.empty() )
             {
-                if( aStatusReporter )
-                {
-                    // Display the short filename of the 3D model loaded:
-                    // (the full name is usually too long to be displayed)
-                    wxFileName fn( model.m_Filename );
-                    wxString msg;
-                    msg.Printf( _( "Loading %s" ), fn.GetFullName() );
-                    aStatusReporter->Report( msg );
-                }
-
                 // Check if the model is not present in our cache map
                 // (Not already loaded in memory)
                 if( m_3dmodel_map.find( model.m_Filename ) == m_3dmodel_map.end() )
                 {
+                    if( aStatusReporter )
+                    {
+                        // Display the short filename of the 3D model loaded:
+                        // (the full name is usually too long to be displayed)
+                        wxFileName fn( model.m_Filename );
+                        wxString msg;
+                        msg.Printf( _( "Loading %s" ), fn.GetFullName() );
+                        aStatusReporter->Report( msg );
+                    }
+
                     // It is not present, try get it from cache
                     const S3DMODEL* modelPtr =
                             m_boardAdapter.Get3DCacheManager()->GetModel( model.m_Filename );
@@ -28,8 +28,14 @@
  */
 
 #include "cbvh_pbrt.h"
+#include <algorithm>
 #include <wx/debug.h>
 
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+#include <xmmintrin.h>
+#define BVH_SSE_BOX_TEST
+#endif
+
 
 #define BVH_RANGED_TRAVERSAL
 //#define BVH_PARTITION_TRAVERSAL
@@ -45,45 +51,185 @@ struct StackNode
 };
 
 
+#ifdef BVH_RANGED_TRAVERSAL
+
+static_assert( ( RAYPACKET_RAYS_PER_PACKET % 4 ) == 0, "packets are tested 4 rays at a time" );
+
+
+/**
+ * The origins and inverse directions of the rays of a packet, laid out to test four rays
+ * at once against a box.
+ */
+struct PACKET_SOA
+{
+    alignas( 16 ) float m_ox[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_oy[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_oz[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_ix[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_iy[RAYPACKET_RAYS_PER_PACKET];
+    alignas( 16 ) float m_iz[RAYPACKET_RAYS_PER_PACKET];
+
+    explicit PACKET_SOA( const RAYPACKET &aRayPacket )
+    {
+        for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+        {
+            const RAY &ray = aRayPacket.m_ray[i];
+
+            m_ox[i] = ray.m_Origin.x;
+            m_oy[i] = ray.m_Origin.y;
+            m_oz[i] = ray.m_Origin.z;
+            m_ix[i] = ray.m_InvDir.x;
+            m_iy[i] = ray.m_InvDir.y;
+            m_iz[i] = ray.m_InvDir.z;
+        }
+    }
+};
+
+
+/**
+ * Slab test of the four rays starting at \a i (a multiple of 4) against a box.
+ * @return a mask with bit n set if ray i + n enters the box before its current hit.
+ */
+static inline unsigned int hitMask4( const PACKET_SOA &aRays,
+                                     const CBBOX &aBBox,
+                                     unsigned int i,
+                                     const HITINFO_PACKET *aHitInfoPacket )
+{
+#ifdef BVH_SSE_BOX_TEST
+    const __m128 ox = _mm_load_ps( &aRays.m_ox[i] );
+    const __m128 oy = _mm_load_ps( &aRays.m_oy[i] );
+    const __m128 oz = _mm_load_ps( &aRays.m_oz[i] );
+    const __m128 ix = _mm_load_ps( &aRays.m_ix[i] );
+    const __m128 iy = _mm_load_ps( &aRays.m_iy[i] );
+    const __m128 iz = _mm_load_ps( &aRays.m_iz[i] );
+
+    const __m128 t0x = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aBBox.Min().x ), ox ), ix );
+    const __m128 t1x = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aBBox.Max().x ), ox ), ix );
+    const __m128 t0y = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aBBox.Min().y ), oy ), iy );
+    const __m128 t1y = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aBBox.Max().y ), oy ), iy );
+    const __m128 t0z = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aBBox.Min().z ), oz ), iz );
+    const __m128 t1z = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aBBox.Max().z ), oz ), iz );
+
+    const __m128 tNear = _mm_max_ps( _mm_min_ps( t0x, t1x ),
+                                     _mm_max_ps( _mm_min_ps( t0y, t1y ),
+                                                 _mm_min_ps( t0z, t1z ) ) );
+
+    const __m128 tFar = _mm_min_ps( _mm_max_ps( t0x, t1x ),
+                                    _mm_min_ps( _mm_max_ps( t0y, t1y ),
+                                                _mm_max_ps( t0z, t1z ) ) );
+
+    const __m128 tHit = _mm_set_ps( aHitInfoPacket[i + 3].m_HitInfo.m_tHit,
+                                    aHitInfoPacket[i + 2].m_HitInfo.m_tHit,
+                                    aHitInfoPacket[i + 1].m_HitInfo.m_tHit,
+                                    aHitInfoPacket[i + 0].m_HitInfo.m_tHit );
+
+    const __m128 hit = _mm_and_ps( _mm_and_ps( _mm_cmple_ps( tNear, tFar ),
+                                               _mm_cmpge_ps( tFar, _mm_setzero_ps() ) ),
+                                   _mm_cmplt_ps( tNear, tHit ) );
+
+    return (unsigned int) _mm_movemask_ps( hit );
+#else
+    unsigned int mask = 0;
+
+    for( unsigned int n = 0; n < 4; ++n )
+    {
+        const unsigned int r = i + n;
+
+        const float t0x = ( aBBox.Min().x - aRays.m_ox[r] ) * aRays.m_ix[r];
+        const float t1x = ( aBBox.Max().x - aRays.m_ox[r] ) * aRays.m_ix[r];
+        const float t0y = ( aBBox.Min().y - aRays.m_oy[r] ) * aRays.m_iy[r];
+        const float t1y = ( aBBox.Max().y - aRays.m_oy[r] ) * aRays.m_iy[r];
+        const float t0z = ( aBBox.Min().z - aRays.m_oz[r] ) * aRays.m_iz[r];
+        const float t1z = ( aBBox.Max().z - aRays.m_oz[r] ) * aRays.m_iz[r];
+
+        const float tNear = std::max( std::min( t0x, t1x ),
+                                      std::max( std::min( t0y, t1y ), std::min( t0z, t1z ) ) );
+        const float tFar = std::min( std::max( t0x, t1x ),
+                                     std::min( std::max( t0y, t1y ), std::max( t0z, t1z ) ) );
+
+        if( ( tNear <= tFar ) && ( tFar >= 0.0f )
+          && ( tNear < aHitInfoPacket[r].m_HitInfo.m_tHit ) )
+            mask |= 1 << n;
+    }
+
+    return mask;
+#endif
+}
+
+
+static inline unsigned int lowestBit( unsigned int aMask )
+{
+    unsigned int n = 0;
+
+    while( !( aMask & ( 1 << n ) ) )
+        ++n;
+
+    return n;
+}
+
+
+static inline unsigned int highestBit( unsigned int aMask )
+{
+    unsigned int n = 3;
+
+    while( !( aMask & ( 1 << n ) ) )
+        --n;
+
+    return n;
+}
+
+
 static inline unsigned int getFirstHit( const RAYPACKET &aRayPacket,
+                                        const PACKET_SOA &aRays,
                                         const CBBOX &aBBox,
                                         unsigned int ia,
                                         HITINFO_PACKET *aHitInfoPacket )
 {
-    float hitT;
+    unsigned int group = ia & ~3u;
 
-    if( aBBox.Intersect( aRayPacket.m_ray[ia], &hitT ) )
-        if( hitT < aHitInfoPacket[ia].m_HitInfo.m_tHit )
-            return ia;
+    // Only the rays from ia on are still alive
+    unsigned int mask = hitMask4( aRays, aBBox, group, aHitInfoPacket ) >> ( ia - group );
+
+    if( mask & 1 )
+        return ia;
 
     if( !aRayPacket.m_Frustum.Intersect( aBBox ) )
         return RAYPACKET_RAYS_PER_PACKET;
 
-    for( unsigned int i = ia + 1; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    if( mask )
+        return ia + lowestBit( mask );
+
+    for( group += 4; group < RAYPACKET_RAYS_PER_PACKET; group += 4 )
     {
-        if( aBBox.Intersect( aRayPacket.m_ray[i], &hitT ) )
-            if( hitT < aHitInfoPacket[i].m_HitInfo.m_tHit )
-                return i;
+        mask = hitMask4( aRays, aBBox, group, aHitInfoPacket );
+
+        if( mask )
+            return group + lowestBit( mask );
     }
 
     return RAYPACKET_RAYS_PER_PACKET;
 }
 
 
-#ifdef BVH_RANGED_TRAVERSAL
-
-static inline unsigned int getLastHit( const RAYPACKET &aRayPacket,
+static inline unsigned int getLastHit( const PACKET_SOA &aRays,
                                        const CBBOX &aBBox,
                                        unsigned int ia,
                                        HITINFO_PACKET *aHitInfoPacket )
 {
-    for( unsigned int ie = (RAYPACKET_RAYS_PER_PACKET - 1); ie > ia; --ie )
+    const unsigned int firstGroup = ia & ~3u;
+
+    for( unsigned int group = RAYPACKET_RAYS_PER_PACKET; group > firstGroup; )
     {
-        float hitT;
+        group -= 4;
 
-        if( aBBox.Intersect( aRayPacket.m_ray[ie], &hitT ) )
-            if( hitT < aHitInfoPacket[ie].m_HitInfo.m_tHit )
-                return ie + 1;
+        unsigned int mask = hitMask4( aRays, aBBox, group, aHitInfoPacket );
+
+        // Only look at the rays after ia
+        if( group == firstGroup )
+            mask &= ~( ( 2u << ( ia - group ) ) - 1 );
+
+        if( mask )
+            return group + highestBit( mask ) + 1;
     }
 
     return ia + 1;
@@ -107,13 +253,15 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
     int todoOffset = 0, nodeNum = 0;
     StackNode todo[MAX_TODOS];
 
+    const PACKET_SOA rays( aRayPacket );
+
     unsigned int ia = 0;
 
     while( true )
     {
         const LinearBVHNode *curCell = &m_nodes[nodeNum];
 
-        ia = getFirstHit( aRayPacket, curCell->bounds, ia, aHitInfoPacket );
+        ia = getFirstHit( aRayPacket, rays, curCell->bounds, ia, aHitInfoPacket );
 
         if( ia < RAYPACKET_RAYS_PER_PACKET )
         {
@@ -127,7 +275,7 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
             }
             else
             {
-                const unsigned int ie = getLastHit( aRayPacket,
+                const unsigned int ie = getLastHit( rays,
                                                     curCell->bounds,
                                                     ia,
                                                     aHitInfoPacket );
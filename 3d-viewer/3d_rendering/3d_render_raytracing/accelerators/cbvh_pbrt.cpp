@@ -73,6 +73,8 @@
 #include <boost/range/algorithm/nth_element.hpp>
 #include <boost/range/algorithm/partition.hpp>
 #include <cstdlib>
+#include <future>
+#include <thread>
 #include <vector>
 
 #include <stack>
@@ -232,9 +234,14 @@ static void RadixSort( std::vector<MortonPrimitive> *v )
 }
 
 
+/// Below this number of primitives, a subtree is not worth a task of its own
+#define PARALLEL_BUILD_MIN_PRIMITIVES 4096
+
+
 CBVH_PBRT::CBVH_PBRT( const CGENERICCONTAINER &aObjectContainer,
                       int aMaxPrimsInNode,
-                      SPLITMETHOD aSplitMethod ) :
+                      SPLITMETHOD aSplitMethod,
+                      bool aParallelBuild ) :
     m_maxPrimsInNode( std::min( 255, aMaxPrimsInNode ) ),
     m_splitMethod( aSplitMethod )
 {
@@ -278,10 +285,33 @@ CBVH_PBRT::CBVH_PBRT( const CGENERICCONTAINER &aObjectContainer,
     BVHBuildNode *root;
 
     if( m_splitMethod == SPLITMETHOD::HLBVH )
+    {
         root = HLBVHBuild( primitiveInfo, &totalNodes, orderedPrims);
+    }
     else
-        root = recursiveBuild( primitiveInfo, 0, m_primitives.size(),
-                               &totalNodes, orderedPrims);
+    {
+        // Split the work until there are a few more tasks than threads, for load balancing
+        int parallelDepth = 0;
+
+        if( aParallelBuild )
+        {
+            for( unsigned int n = std::thread::hardware_concurrency(); n > 1; n >>= 1 )
+                parallelDepth++;
+
+            parallelDepth++;
+        }
+
+        std::atomic<int> nodeCount( 0 );
+
+        root = recursiveBuild( primitiveInfo, 0, m_primitives.size(), &nodeCount,
+                               parallelDepth );
+
+        totalNodes = nodeCount;
+
+        // The leaves refer to ranges of the reordered _primitiveInfo_
+        for( const BVHPrimitiveInfo& info : primitiveInfo )
+            orderedPrims.push_back( m_primitives[ info.primitiveNumber ] );
+    }
 
     wxASSERT( m_primitives.size() == orderedPrims.size() );
 
@@ -423,11 +453,23 @@ struct BucketInfo
 };
 
 
+BVHBuildNode *CBVH_PBRT::allocateBuildNode()
+{
+    // !TODO: implement an memory Arena
+    BVHBuildNode *node = static_cast<BVHBuildNode *>( malloc( sizeof( BVHBuildNode ) ) );
+
+    std::lock_guard<std::mutex> lock( m_addresses_lock );
+    m_addresses_pointer_to_mm_free.push_back( node );
+
+    return node;
+}
+
+
 BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primitiveInfo,
                                           int start,
                                           int end,
-                                          int *totalNodes,
-                                          CONST_VECTOR_OBJECT &orderedPrims )
+                                          std::atomic<int> *totalNodes,
+                                          int aParallelDepth )
 {
     wxASSERT( totalNodes != NULL );
     wxASSERT( start >= 0 );
@@ -439,9 +481,7 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
 
     (*totalNodes)++;
 
-    // !TODO: implement an memory Arena
-    BVHBuildNode *node = static_cast<BVHBuildNode *>( malloc( sizeof( BVHBuildNode ) ) );
-    m_addresses_pointer_to_mm_free.push_back( node );
+    BVHBuildNode *node = allocateBuildNode();
 
     node->bounds.Reset();
     node->firstPrimOffset = 0;
@@ -462,16 +502,7 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
     if( nPrimitives == 1 )
     {
         // Create leaf _BVHBuildNode_
-        int firstPrimOffset = orderedPrims.size();
-
-        for( int i = start; i < end; ++i )
-        {
-            int primitiveNr = primitiveInfo[i].primitiveNumber;
-            wxASSERT( primitiveNr < (int)m_primitives.size() );
-            orderedPrims.push_back( m_primitives[ primitiveNr ] );
-        }
-
-        node->InitLeaf( firstPrimOffset, nPrimitives, bounds );
+        node->InitLeaf( start, nPrimitives, bounds );
     }
     else
     {
@@ -491,23 +522,7 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
                   centroidBounds.Min()[dim] ) < (FLT_EPSILON + FLT_EPSILON) )
         {
             // Create leaf _BVHBuildNode_
-            const int firstPrimOffset = orderedPrims.size();
-
-            for( int i = start; i < end; ++i )
-            {
-                int primitiveNr = primitiveInfo[i].primitiveNumber;
-
-                wxASSERT( (primitiveNr >= 0) &&
-                          (primitiveNr < (int)m_primitives.size()) );
-
-                const COBJECT *obj = static_cast<const COBJECT *>( m_primitives[ primitiveNr ] );
-
-                wxASSERT( obj != NULL );
-
-                orderedPrims.push_back( obj );
-            }
-
-            node->InitLeaf( firstPrimOffset, nPrimitives, bounds );
+            node->InitLeaf( start, nPrimitives, bounds );
         }
         else
         {
@@ -590,41 +605,40 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
                         buckets[b].bounds.Union( primitiveInfo[i].bounds );
                     }
 
-                    // Compute costs for splitting after each bucket
+                    // Compute costs for splitting after each bucket, sweeping the
+                    // buckets once from each side
                     float cost[nBuckets - 1];
 
+                    CBBOX b0;
+                    b0.Reset();
+                    int count0 = 0;
+
                     for( int i = 0; i < (nBuckets - 1); ++i )
                     {
-                        CBBOX b0, b1;
-
-                        b0.Reset();
-                        b1.Reset();
-
-                        int count0 = 0;
-                        int count1 = 0;
-
-                        for( int j = 0; j <= i; ++j )
+                        if( buckets[i].count )
                         {
-                            if( buckets[j].count )
-                            {
-                                count0 += buckets[j].count;
-                                b0.Union( buckets[j].bounds );
-                            }
+                            count0 += buckets[i].count;
+                            b0.Union( buckets[i].bounds );
                         }
 
-                        for( int j = i + 1; j < nBuckets; ++j )
+                        cost[i] = count0 * b0.SurfaceArea();
+                    }
+
+                    CBBOX b1;
+                    b1.Reset();
+                    int count1 = 0;
+
+                    for( int i = nBuckets - 1; i > 0; --i )
+                    {
+                        if( buckets[i].count )
                         {
-                            if( buckets[j].count )
-                            {
-                                count1 += buckets[j].count;
-                                b1.Union( buckets[j].bounds );
-                            }
+                            count1 += buckets[i].count;
+                            b1.Union( buckets[i].bounds );
                         }
 
-                        cost[i] = 1.0f +
-                                  ( count0 * b0.SurfaceArea() +
-                                    count1 * b1.SurfaceArea() ) /
-                                  bounds.SurfaceArea();
+                        cost[i - 1] = 1.0f +
+                                      ( cost[i - 1] + count1 * b1.SurfaceArea() ) /
+                                      bounds.SurfaceArea();
                     }
 
                     // Find bucket to split at that minimizes SAH metric
@@ -660,18 +674,7 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
                     else
                     {
                         // Create leaf _BVHBuildNode_
-                        const int firstPrimOffset = orderedPrims.size();
-
-                        for( int i = start; i < end; ++i )
-                        {
-                            const int primitiveNr = primitiveInfo[i].primitiveNumber;
-
-                            wxASSERT( primitiveNr < (int)m_primitives.size() );
-
-                            orderedPrims.push_back( m_primitives[ primitiveNr ] );
-                        }
-
-                        node->InitLeaf( firstPrimOffset, nPrimitives, bounds );
+                        node->InitLeaf( start, nPrimitives, bounds );
 
                         return node;
                     }
@@ -680,17 +683,31 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
             }
             }
 
-            node->InitInterior( dim,
-                                recursiveBuild( primitiveInfo,
-                                                start,
-                                                mid,
-                                                totalNodes,
-                                                orderedPrims ),
-                                recursiveBuild( primitiveInfo,
-                                                mid,
-                                                end,
-                                                totalNodes,
-                                                orderedPrims) );
+            BVHBuildNode *child0;
+            BVHBuildNode *child1;
+
+            // Both halves work on separate ranges of _primitiveInfo_, so they can be built
+            // concurrently
+            if( ( aParallelDepth > 0 ) && ( nPrimitives >= PARALLEL_BUILD_MIN_PRIMITIVES ) )
+            {
+                std::future<BVHBuildNode *> first = std::async( std::launch::async,
+                        [&]()
+                        {
+                            return recursiveBuild( primitiveInfo, start, mid, totalNodes,
+                                                   aParallelDepth - 1 );
+                        } );
+
+                child1 = recursiveBuild( primitiveInfo, mid, end, totalNodes,
+                                         aParallelDepth - 1 );
+                child0 = first.get();
+            }
+            else
+            {
+                child0 = recursiveBuild( primitiveInfo, start, mid, totalNodes, 0 );
+                child1 = recursiveBuild( primitiveInfo, mid, end, totalNodes, 0 );
+            }
+
+            node->InitInterior( dim, child0, child1 );
         }
     }
 
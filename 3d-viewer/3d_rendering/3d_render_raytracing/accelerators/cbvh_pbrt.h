@@ -33,6 +33,7 @@
  *  - Code style to match KiCad
  *  - Asserts converted
  *  - Use compare functions/structures for std::partition and std::nth_element
+ *  - The recursive build of the subtrees is run in parallel
  *
  * The original source code have the following licence:
  *
@@ -71,8 +72,10 @@
 #define _CBVH_PBRT_H_
 
 #include "caccelerator.h"
+#include <atomic>
 #include <cstdint>
 #include <list>
+#include <mutex>
 
 // Forward Declarations
 struct BVHBuildNode;
@@ -97,6 +100,8 @@ struct LinearBVHNode
     uint8_t  pad[1];       ///< ensure 32 byte total size
 };
 
+static_assert( sizeof( LinearBVHNode ) == 32, "LinearBVHNode must fit in 32 bytes" );
+
 
 enum class SPLITMETHOD
 {
@@ -110,8 +115,12 @@ enum class SPLITMETHOD
 class  CBVH_PBRT : public CGENERICACCELERATOR
 {
 public:
+    /**
+     * @param aParallelBuild builds the subtrees of the upper levels of the tree in parallel
+     * (not used with SPLITMETHOD::HLBVH).  The resulting tree is the same either way.
+     */
     CBVH_PBRT( const CGENERICCONTAINER& aObjectContainer, int aMaxPrimsInNode = 4,
-            SPLITMETHOD aSplitMethod = SPLITMETHOD::SAH );
+            SPLITMETHOD aSplitMethod = SPLITMETHOD::SAH, bool aParallelBuild = true );
 
     ~CBVH_PBRT();
 
@@ -123,11 +132,20 @@ public:
 
 private:
 
+    /**
+     * Build the subtree of primitiveInfo[start, end). The primitives are reordered in place,
+     * so the leaves refer to contiguous ranges of primitiveInfo.
+     *
+     * @param aParallelDepth is the number of levels for which the subtrees are built
+     * concurrently.
+     */
     BVHBuildNode *recursiveBuild( std::vector<BVHPrimitiveInfo> &primitiveInfo,
                                   int start,
                                   int end,
-                                  int *totalNodes,
-                                  CONST_VECTOR_OBJECT &orderedPrims );
+                                  std::atomic<int> *totalNodes,
+                                  int aParallelDepth );
+
+    BVHBuildNode *allocateBuildNode();
 
     BVHBuildNode *HLBVHBuild( const std::vector<BVHPrimitiveInfo> &primitiveInfo,
                               int *totalNodes,
@@ -158,6 +176,7 @@ private:
     LinearBVHNode       *m_nodes;
 
     std::list<void *> m_addresses_pointer_to_mm_free;
+    std::mutex        m_addresses_lock;     ///< guards m_addresses_pointer_to_mm_free
 
     // Partition traversal
     unsigned int m_I[RAYPACKET_RAYS_PER_PACKET];
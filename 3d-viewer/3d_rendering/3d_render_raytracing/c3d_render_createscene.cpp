@@ -1250,6 +1250,26 @@ void C3D_RENDER_RAYTRACING::add_3D_vias_and_pads_to_container()
 
 void C3D_RENDER_RAYTRACING::load_3D_models()
 {
+    // Load all the models at once: each distinct model is loaded only once
+    std::vector<wxString> modelFiles;
+
+    for( MODULE* module : m_boardAdapter.GetBoard()->Modules() )
+    {
+        if( !m_boardAdapter.ShouldModuleBeDisplayed( (MODULE_ATTR_T) module->GetAttributes() ) )
+            continue;
+
+        for( const MODULE_3D_SETTINGS& model : module->Models() )
+        {
+            if( ( static_cast<float>( model.m_Opacity ) > FLT_EPSILON ) && model.m_Show
+                    && !model.m_Filename.empty() )
+            {
+                modelFiles.push_back( model.m_Filename );
+            }
+        }
+    }
+
+    m_boardAdapter.Get3DCacheManager()->PreloadModels( modelFiles );
+
     // Go for all modules
     for( auto module : m_boardAdapter.GetBoard()->Modules() )
     {
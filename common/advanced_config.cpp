@@ -140,6 +140,18 @@ static const wxChar MinPlotPenWidth[] = wxT( "MinPlotPenWidth" );
 
 static const wxChar DebugZoneFiller[] = wxT( "DebugZoneFiller" );
 
+/**
+ * When true, a binary snapshot of each board is written next to its file when it is loaded,
+ * and used instead of the file while the file is unchanged.
+ */
+static const wxChar BoardSnapshots[] = wxT( "BoardSnapshots" );
+
+/**
+ * When set, the instrumented code of each module is traced, and the trace is written in this
+ * directory in the Chrome trace event format when the module ends.
+ */
+static const wxChar TraceProfilerPath[] = wxT( "TraceProfilerPath" );
+
 } // namespace KEYS
 
 
@@ -236,6 +248,8 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_MinPlotPenWidth           = 0.0212;   // 1 pixel at 1200dpi.
 
     m_DebugZoneFiller           = false;
+    m_BoardSnapshots            = false;
+    m_TraceProfilerPath         = wxEmptyString;
 
     loadFromConfigFile();
 }
@@ -314,6 +328,12 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::DebugZoneFiller,
                                                 &m_DebugZoneFiller, false ) );
 
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::BoardSnapshots,
+                                                &m_BoardSnapshots, false ) );
+
+    configParams.push_back( new PARAM_CFG_WXSTRING( true, AC_KEYS::TraceProfilerPath,
+                                                    &m_TraceProfilerPath, wxEmptyString ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     for( PARAM_CFG* param : configParams )
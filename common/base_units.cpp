@@ -557,31 +557,85 @@ wxString GetAbbreviatedUnitsLabel( EDA_UNITS aUnit, bool aUseMils, EDA_DATA_TYPE
 }
 
 
-std::string FormatInternalUnits( int aValue )
+/**
+ * The number of decimals of a millimetre in an internal unit, which is a power of ten in all
+ * the applications.
+ */
+static constexpr int iuDecimals()
 {
-    char    buf[50];
-    double  engUnits = aValue;
-    int     len;
+    int    decimals = 0;
+    double scale = 1.0;
+
+    while( scale < IU_PER_MM )
+    {
+        scale *= 10.0;
+        decimals++;
+    }
+
+    return decimals;
+}
+
+
+static constexpr double iuScale( int aDecimals )
+{
+    return aDecimals == 0 ? 1.0 : 10.0 * iuScale( aDecimals - 1 );
+}
+
 
-    engUnits /= IU_PER_MM;
+static constexpr int IU_DECIMALS = iuDecimals();
 
-    if( engUnits != 0.0 && fabs( engUnits ) <= 0.0001 )
+static_assert( iuScale( IU_DECIMALS ) == IU_PER_MM, "IU_PER_MM must be a power of ten" );
+
+
+int FormatInternalUnits( int aValue, char* aBuf )
+{
+    // This is the same text as printing aValue / IU_PER_MM with the "%.10g" format (or the
+    // "%.10f" format and trimmed trailing zeros for the values too small for "%g" to avoid
+    // an exponent).  An int has at most 10 digits, so this text is always the exact decimal
+    // value and it can be written with integer arithmetic only.
+    char     digits[16];
+    char*    p = aBuf;
+    unsigned magnitude = aValue < 0 ? 0u - (unsigned) aValue : (unsigned) aValue;
+    int      count = 0;
+
+    if( aValue < 0 )
+        *p++ = '-';
+
+    do
     {
-        len = snprintf( buf, sizeof(buf), "%.10f", engUnits );
+        digits[count++] = (char) ( '0' + magnitude % 10 );
+        magnitude /= 10;
+    } while( magnitude );
 
-        while( --len > 0 && buf[len] == '0' )
-            buf[len] = '\0';
+    // Leading zeros of the fractional part, and the "0" of the integer part
+    while( count <= IU_DECIMALS )
+        digits[count++] = '0';
 
-        if( buf[len] == '.' )
-            buf[len] = '\0';
-        else
-            ++len;
-    }
-    else
+    // Trailing zeros of the fractional part are not printed
+    int last = 0;
+
+    while( last < IU_DECIMALS && digits[last] == '0' )
+        last++;
+
+    for( int ii = count - 1; ii >= last; ii-- )
     {
-        len = snprintf( buf, sizeof(buf), "%.10g", engUnits );
+        if( ii == IU_DECIMALS - 1 )
+            *p++ = '.';
+
+        *p++ = digits[ii];
     }
 
+    *p = '\0';
+
+    return (int) ( p - aBuf );
+}
+
+
+std::string FormatInternalUnits( int aValue )
+{
+    char buf[32];
+    int  len = FormatInternalUnits( aValue, buf );
+
     return std::string( buf, len );
 }
 
@@ -597,20 +651,39 @@ std::string FormatAngle( double aAngle )
 }
 
 
+int FormatInternalUnits( int aX, int aY, char* aBuf )
+{
+    int len = FormatInternalUnits( aX, aBuf );
+
+    aBuf[len++] = ' ';
+
+    return len + FormatInternalUnits( aY, aBuf + len );
+}
+
+
 std::string FormatInternalUnits( const wxPoint& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    char buf[64];
+    int  len = FormatInternalUnits( aPoint.x, aPoint.y, buf );
+
+    return std::string( buf, len );
 }
 
 
 std::string FormatInternalUnits( const VECTOR2I& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    char buf[64];
+    int  len = FormatInternalUnits( aPoint.x, aPoint.y, buf );
+
+    return std::string( buf, len );
 }
 
 
 std::string FormatInternalUnits( const wxSize& aSize )
 {
-    return FormatInternalUnits( aSize.GetWidth() ) + " " + FormatInternalUnits( aSize.GetHeight() );
+    char buf[64];
+    int  len = FormatInternalUnits( aSize.GetWidth(), aSize.GetHeight(), buf );
+
+    return std::string( buf, len );
 }
 
@@ -0,0 +1,132 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <string>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <cache_file.h>
+#include <macros.h>
+#include <mapped_file.h>
+#include <settings/settings_manager.h>
+
+
+bool WriteFileAtomically( const wxString& aFileName,
+                          const std::function<bool( wxFFile& aFile )>& aWriter )
+{
+    wxFileName fn( aFileName );
+
+    if( !fn.DirExists() && !fn.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+        return false;
+
+    // In the same folder, so the rename doesn't move the data
+    wxFFile  file;
+    wxString tmpFileName = wxFileName::CreateTempFileName( fn.GetPathWithSep() + "tmp", &file );
+
+    if( tmpFileName.IsEmpty() )
+        return false;
+
+    bool written = file.IsOpened() && aWriter( file );
+
+    written = file.Close() && written;
+
+    if( !written || !wxRenameFile( tmpFileName, aFileName, true ) )
+    {
+        wxRemoveFile( tmpFileName );
+        return false;
+    }
+
+    return true;
+}
+
+
+///> Replaces the user settings as the root of the library index folders, when not empty
+static wxString s_libraryIndexRoot;
+
+
+void SetLibraryIndexRoot( const wxString& aRoot )
+{
+    s_libraryIndexRoot = aRoot;
+}
+
+
+wxString GetLibraryIndexFileName( const wxString& aIndexDir, const wxString& aLibraryPath,
+                                  const wxString& aExtension )
+{
+    size_t     hash = std::hash<std::string>()( TO_UTF8( aLibraryPath ) );
+    wxFileName libFn( aLibraryPath );
+    wxString   libName = libFn.GetName();
+
+    // Folder libraries can be given with a trailing separator
+    if( libName.IsEmpty() && libFn.GetDirCount() )
+        libName = wxFileName( libFn.GetDirs().Last() ).GetName();
+
+    wxFileName fn( s_libraryIndexRoot.IsEmpty() ? SETTINGS_MANAGER::GetUserSettingsPath()
+                                                : s_libraryIndexRoot,
+                   wxEmptyString );
+
+    fn.AppendDir( aIndexDir );
+    fn.SetName( libName + wxString::Format( "-%016llx", (unsigned long long) hash ) );
+    fn.SetExt( aExtension );
+
+    return fn.GetFullPath();
+}
+
+
+unsigned long long HashContent( const char* aData, size_t aSize )
+{
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+
+    for( size_t ii = 0; ii < aSize; ++ii )
+    {
+        hash ^= (unsigned char) aData[ii];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+
+bool HashFileContent( const wxString& aFileName, unsigned long long& aHash )
+{
+    wxFileName fn( aFileName );
+
+    if( !fn.FileExists() )
+        return false;
+
+    // Empty files cannot be mapped
+    if( fn.GetSize() == 0 )
+    {
+        aHash = HashContent( nullptr, 0 );
+        return true;
+    }
+
+    MAPPED_FILE file;
+
+    if( !file.Open( aFileName ) )
+        return false;
+
+    aHash = HashContent( file.Data(), file.Size() );
+    return true;
+}
@@ -45,6 +45,17 @@ using KIGFX::COLOR4D;
 // Create only once, as seeding is *very* expensive
 static boost::uuids::random_generator randomGenerator;
 
+// The generator isn't thread-safe, and items are now also created by loader threads
+static std::mutex randomGeneratorMutex;
+
+
+static boost::uuids::uuid newRandomUuid()
+{
+    std::lock_guard<std::mutex> lock( randomGeneratorMutex );
+
+    return randomGenerator();
+}
+
 // These don't have the same performance penalty, but might as well be consistent
 static boost::uuids::string_generator stringGenerator;
 static boost::uuids::nil_generator nilGenerator;
@@ -62,7 +73,7 @@ KIID& NilUuid()
 
 
 KIID::KIID() :
-        m_uuid( randomGenerator() ),
+        m_uuid( newRandomUuid() ),
         m_cached_timestamp( 0 )
 {
 }
@@ -106,7 +117,7 @@ KIID::KIID( const wxString& aString ) :
         {
             // Failed to parse string representation; best we can do is assign a new
             // random one.
-            m_uuid = randomGenerator();
+            m_uuid = newRandomUuid();
         }
     }
 }
@@ -180,7 +191,7 @@ void KIID::ConvertTimestampToUuid()
         return;
 
     m_cached_timestamp = 0;
-    m_uuid = randomGenerator();
+    m_uuid = newRandomUuid();
 }
 
 
@@ -223,10 +234,18 @@ void KiAssertFilter( const wxString &file, int line,
 #endif
 #endif
 
-std::atomic<unsigned int> LOCALE_IO::m_c_count( 0 );
-LOCALE_IO::LOCALE_IO() : m_wxLocale( nullptr )
+// Held while switching the locale, so other LOCALE_IO constructors wait for the switch
+static std::mutex s_localeMutex;
+
+unsigned int LOCALE_IO::m_c_count = 0;
+std::string  LOCALE_IO::m_user_locale;
+wxLocale*    LOCALE_IO::m_wxLocale = nullptr;
+
+
+LOCALE_IO::LOCALE_IO()
 {
-    // use thread safe, atomic operation
+    std::lock_guard<std::mutex> lock( s_localeMutex );
+
     if( m_c_count++ == 0 )
     {
 #if USE_WXLOCALE
@@ -247,7 +266,8 @@ LOCALE_IO::LOCALE_IO() : m_wxLocale( nullptr )
 
 LOCALE_IO::~LOCALE_IO()
 {
-    // use thread safe, atomic operation
+    std::lock_guard<std::mutex> lock( s_localeMutex );
+
     if( --m_c_count == 0 )
     {
         // revert to the user locale
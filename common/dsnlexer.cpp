@@ -27,7 +27,11 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>         // bsearch()
+#include <cstring>
 #include <cctype>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include <macros.h>
 #include <fctsys.h>
@@ -41,6 +45,39 @@
 
 //-----<DSNLEXER>-------------------------------------------------------------
 
+/**
+ * @return the hashtable of the keywords of \a aKeywords, built by the first lexer using
+ * them.  The hashtables are never changed afterwards, so the lexers of several threads can
+ * share them.
+ */
+static const KEYWORD_MAP* keywordHash( const KEYWORD* aKeywords, unsigned aKeywordCount )
+{
+    static std::mutex mutex;
+    static std::map<std::pair<const KEYWORD*, unsigned>, std::unique_ptr<KEYWORD_MAP>> hashes;
+
+    std::lock_guard<std::mutex> lock( mutex );
+
+    std::unique_ptr<KEYWORD_MAP>& hash = hashes[ std::make_pair( aKeywords, aKeywordCount ) ];
+
+    if( !hash )
+    {
+        hash.reset( new KEYWORD_MAP );
+
+        if( aKeywordCount > 11 )
+        {
+            // resize the hashtable bucket count
+            hash->reserve( aKeywordCount );
+        }
+
+        // fill the specialized "C string" hashtable from keywords[]
+        for( const KEYWORD* it = aKeywords; it < aKeywords + aKeywordCount; ++it )
+            (*hash)[it->name] = it->token;
+    }
+
+    return hash.get();
+}
+
+
 void DSNLEXER::init()
 {
     curTok  = DSN_NONE;
@@ -54,22 +91,7 @@ void DSNLEXER::init()
 
     curOffset = 0;
 
-#if 1
-    if( keywordCount > 11 )
-    {
-        // resize the hashtable bucket count
-        keyword_hash.reserve( keywordCount );
-    }
-
-    // fill the specialized "C string" hashtable from keywords[]
-    const KEYWORD*  it  = keywords;
-    const KEYWORD*  end = it + keywordCount;
-
-    for( ; it < end; ++it )
-    {
-        keyword_hash[it->name] = it->token;
-    }
-#endif
+    keyword_hash = keywordHash( keywords, keywordCount );
 }
 
 
@@ -232,9 +254,9 @@ LINE_READER* DSNLEXER::PopReader()
 
 int DSNLEXER::findToken( const std::string& tok )
 {
-    KEYWORD_MAP::const_iterator it = keyword_hash.find( tok.c_str() );
+    KEYWORD_MAP::const_iterator it = keyword_hash->find( tok.c_str() );
 
-    if( it != keyword_hash.end() )
+    if( it != keyword_hash->end() )
         return it->second;
 
     return DSN_SYMBOL;      // not a keyword, some arbitrary symbol.
@@ -670,7 +692,15 @@ L_read:
                 }
 
                 else
-                    curText += *head++;
+                {
+                    // copy the plain characters up to the next escape or delimiter at once
+                    const char* run = head;
+
+                    while( head<limit && *head != '\\' && *head != '"' )
+                        ++head;
+
+                    curText.append( run, head );
+                }
 
             }   // while
 
@@ -754,7 +784,9 @@ L_read:
 
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.append( cur, head );
 
     if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
     {
@@ -780,6 +812,211 @@ exit:   // single point of exit, no returns elsewhere please.
 }
 
 
+/**
+ * Function splitDecimal
+ * splits the plain decimal number in [aText, aEnd) in its digits, as an integer, and its
+ * number of decimals.
+ *
+ * @return bool - false if the text is not a plain decimal number or has more digits than a
+ *  long long can hold.
+ */
+static bool splitDecimal( const char* aText, const char* aEnd, bool& aNegative,
+                          unsigned long long& aDigits, int& aDecimals )
+{
+    const char* p = aText;
+    int         digitCount = 0;
+    bool        dot = false;
+
+    aNegative = ( p < aEnd && *p == '-' );
+
+    if( p < aEnd && ( *p == '-' || *p == '+' ) )
+        ++p;
+
+    aDigits = 0;
+    aDecimals = 0;
+
+    for( ; p < aEnd; ++p )
+    {
+        if( isDigit( *p ) )
+        {
+            if( ++digitCount > 18 )
+                return false;
+
+            aDigits = aDigits * 10 + ( *p - '0' );
+
+            if( dot )
+                aDecimals++;
+        }
+        else if( *p == '.' && !dot )
+        {
+            dot = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return p == aEnd && digitCount > 0;
+}
+
+
+static bool toFixedPoint( const char* aText, const char* aEnd, int aDecimals, long long aLimit,
+                          long long& aResult )
+{
+    static const long long powersOf10[] = {
+        1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+        1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+        100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+        1000000000000000000LL
+    };
+
+    bool               negative;
+    unsigned long long digits;
+    int                decimals;
+
+    if( aDecimals < 0 || aDecimals >= (int) arrayDim( powersOf10 ) || aLimit < 0 )
+        return false;
+
+    if( !splitDecimal( aText, aEnd, negative, digits, decimals ) || decimals > aDecimals )
+        return false;
+
+    long long scale = powersOf10[aDecimals - decimals];
+
+    // digits * scale <= aLimit, without overflowing
+    if( digits > (unsigned long long) ( aLimit / scale ) )
+        return false;
+
+    aResult = (long long) digits * scale;
+
+    if( negative )
+        aResult = -aResult;
+
+    return true;
+}
+
+
+bool DSNLEXER::ParseDecimal( const char* aText, double& aResult )
+{
+    // Powers of ten which are exact as doubles
+    static const double exactPowersOf10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    bool               negative;
+    unsigned long long digits;
+    int                decimals;
+
+    if( !splitDecimal( aText, aText + strlen( aText ), negative, digits, decimals ) )
+        return false;
+
+    // Both operands are exact doubles, so the division is correctly rounded, as strtod() is
+    if( digits >= ( 1ULL << 53 ) || decimals >= (int) arrayDim( exactPowersOf10 ) )
+        return false;
+
+    aResult = (double) digits / exactPowersOf10[decimals];
+
+    if( negative )
+        aResult = -aResult;
+
+    return true;
+}
+
+
+bool DSNLEXER::ParseFixedPoint( const char* aText, int aDecimals, long long aLimit,
+                                long long& aResult )
+{
+    return toFixedPoint( aText, aText + strlen( aText ), aDecimals, aLimit, aResult );
+}
+
+
+bool DSNLEXER::NextFixedPointPair( const char* aKeyword, int aDecimals, long long aLimit,
+                                   long long& aX, long long& aY )
+{
+    // Comment lines are tokens then, leave them to NextTok()
+    if( curTok == DSN_EOF || commentsAreTokens )
+        return false;
+
+    const char* cur = next;
+
+    // skip the whitespace, and the blank and comment lines as NextTok() does
+    for( ;; )
+    {
+        while( cur<limit && isSpace( *cur ) )
+            ++cur;
+
+        if( cur < limit )
+            break;
+
+        if( readLine() == 0 )
+            return false;   // NextTok() gets the end of file again
+
+        cur = start;
+
+        while( cur<limit && isSpace( *cur ) )
+            ++cur;
+
+        if( cur<limit && *cur=='#' )
+            cur = limit;
+    }
+
+    next = cur;
+
+    if( *cur != '(' )
+        return false;
+
+    const char* p = cur + 1;
+
+    while( p<limit && isSpace( *p ) )
+        ++p;
+
+    for( const char* kw = aKeyword; *kw; ++kw, ++p )
+    {
+        if( p >= limit || *p != *kw )
+            return false;
+    }
+
+    const char* numbers[2][2];
+
+    for( auto& number : numbers )
+    {
+        if( p >= limit || !isSpace( *p ) )
+            return false;
+
+        while( p<limit && isSpace( *p ) )
+            ++p;
+
+        number[0] = p;
+
+        while( p<limit && !isSep( *p ) )
+            ++p;
+
+        number[1] = p;
+    }
+
+    while( p<limit && isSpace( *p ) )
+        ++p;
+
+    if( p >= limit || *p != ')' )
+        return false;
+
+    if( !toFixedPoint( numbers[0][0], numbers[0][1], aDecimals, aLimit, aX )
+            || !toFixedPoint( numbers[1][0], numbers[1][1], aDecimals, aLimit, aY ) )
+    {
+        return false;
+    }
+
+    prevTok   = DSN_NUMBER;
+    curTok    = DSN_RIGHT;
+    curText   = ')';
+    curOffset = p - start;
+    next      = p + 1;
+
+    return true;
+}
+
+
 wxArrayString* DSNLEXER::ReadCommentLines()
 {
     wxArrayString*  ret = 0;
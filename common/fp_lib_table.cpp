@@ -272,6 +272,16 @@ void FP_LIB_TABLE::FootprintEnumerate( wxArrayString& aFootprintNames, const wxS
 }
 
 
+void FP_LIB_TABLE::FootprintEnumerateInfo( std::vector<FOOTPRINT_INDEX_ENTRY>& aFootprints,
+                                           const wxString& aNickname, bool aBestEfforts )
+{
+    const FP_LIB_TABLE_ROW* row = FindRow( aNickname );
+    wxASSERT( (PLUGIN*) row->plugin );
+    row->plugin->FootprintEnumerateInfo( aFootprints, row->GetFullURI( true ), aBestEfforts,
+                                         row->GetProperties() );
+}
+
+
 void FP_LIB_TABLE::PrefetchLib( const wxString& aNickname )
 {
     const FP_LIB_TABLE_ROW* row = FindRow( aNickname );
@@ -1115,6 +1115,40 @@ void CAIRO_GAL_BASE::blitCursor( wxMemoryDC& clientDC )
 }
 
 
+void CAIRO_GAL_BASE::DrawPolylines( const std::vector<std::vector<VECTOR2D>>& aPointLists )
+{
+    bool pathStarted = false;
+
+    // All the polylines go to the same path, which is stroked once
+    for( const std::vector<VECTOR2D>& pointList : aPointLists )
+    {
+        if( pointList.size() < 2 )
+            continue;
+
+        if( !pathStarted )
+        {
+            syncLineWidth();
+            pathStarted = true;
+        }
+
+        const auto p = roundp( xform( pointList[0].x, pointList[0].y ) );
+        cairo_move_to( currentContext, p.x, p.y );
+
+        for( size_t i = 1; i < pointList.size(); ++i )
+        {
+            const auto p2 = roundp( xform( pointList[i].x, pointList[i].y ) );
+            cairo_line_to( currentContext, p2.x, p2.y );
+        }
+    }
+
+    if( pathStarted )
+    {
+        flushPath();
+        isElementAdded = true;
+    }
+}
+
+
 void CAIRO_GAL_BASE::drawPoly( const std::deque<VECTOR2D>& aPointList )
 {
     wxCHECK( aPointList.size() > 1, /* void */ );
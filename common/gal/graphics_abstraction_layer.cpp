@@ -143,6 +143,14 @@ bool GAL::updatedGalDisplayOptions( const GAL_DISPLAY_OPTIONS& aOptions )
 }
 
 
+void GAL::DrawPolylines( const std::vector<std::vector<VECTOR2D>>& aPointLists )
+{
+    // Generic fallback: backends able to batch the polylines should override it
+    for( const std::vector<VECTOR2D>& pointList : aPointLists )
+        DrawPolyline( std::deque<VECTOR2D>( pointList.begin(), pointList.end() ) );
+}
+
+
 void GAL::SetTextAttributes( const EDA_TEXT* aText )
 {
     SetGlyphSize( VECTOR2D( aText->GetTextSize() ) );
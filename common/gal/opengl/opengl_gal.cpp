@@ -982,6 +982,33 @@ void OPENGL_GAL::DrawPolyline( const SHAPE_LINE_CHAIN& aLineChain )
 }
 
 
+void OPENGL_GAL::DrawPolylines( const std::vector<std::vector<VECTOR2D>>& aPointLists )
+{
+    unsigned int segCount = 0;
+
+    for( const std::vector<VECTOR2D>& pointList : aPointLists )
+    {
+        if( pointList.size() > 1 )
+            segCount += pointList.size() - 1;
+    }
+
+    if( segCount == 0 )
+        return;
+
+    currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
+
+    // Allocate the vertices for all the segments at once, instead of one chunk per segment
+    if( !currentManager->Reserve( 6 * segCount ) )
+        return;
+
+    for( const std::vector<VECTOR2D>& pointList : aPointLists )
+    {
+        for( size_t i = 1; i < pointList.size(); ++i )
+            drawLineQuad( pointList[i - 1], pointList[i], false );
+    }
+}
+
+
 void OPENGL_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
 {
     wxCHECK( aPointList.size() >= 2, /* void */ );
@@ -1696,7 +1723,8 @@ void OPENGL_GAL::DrawCursor( const VECTOR2D& aCursorPosition )
 }
 
 
-void OPENGL_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+void OPENGL_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
+                               bool aReserve )
 {
     /* Helper drawing:                   ____--- v3       ^
      *                           ____---- ...   \          \
@@ -1718,7 +1746,8 @@ void OPENGL_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEnd
 
     VECTOR2D vs( v2.x - v1.x, v2.y - v1.y );
 
-    currentManager->Reserve( 6 );
+    if( aReserve )
+        currentManager->Reserve( 6 );
 
     // Line width is maintained by the vertex shader
     currentManager->Shader( SHADER_LINE_A, lineWidth, vs.x, vs.y );
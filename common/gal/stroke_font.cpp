@@ -31,6 +31,11 @@
 #include <math/util.h>      // for KiROUND
 #include <wx/string.h>
 #include <gr_text.h>
+#include <hash_eda.h>
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 
 using namespace KIGFX;
@@ -46,6 +51,119 @@ GLYPH_LIST*         g_newStrokeFontGlyphs = nullptr;     ///< Glyph list
 std::vector<BOX2D>* g_newStrokeFontGlyphBoundingBoxes;   ///< Bounding boxes of the glyphs
 
 
+namespace
+{
+
+/**
+ * Everything the geometry of a stroke text depends on.  The text position and rotation are
+ * not part of the key: they are applied by the GAL transform, so a single entry serves every
+ * instance of the same text (e.g. all the "R1" references or all the "GND" labels).
+ */
+struct TEXT_CACHE_KEY
+{
+    std::string         m_text;
+    VECTOR2D            m_glyphSize;
+    double              m_lineWidth;
+    EDA_TEXT_HJUSTIFY_T m_hJustify;
+    EDA_TEXT_VJUSTIFY_T m_vJustify;
+    bool                m_italic;
+    bool                m_mirrored;
+
+    bool operator==( const TEXT_CACHE_KEY& aOther ) const
+    {
+        return m_text == aOther.m_text
+                && m_glyphSize == aOther.m_glyphSize
+                && m_lineWidth == aOther.m_lineWidth
+                && m_hJustify == aOther.m_hJustify
+                && m_vJustify == aOther.m_vJustify
+                && m_italic == aOther.m_italic
+                && m_mirrored == aOther.m_mirrored;
+    }
+};
+
+
+struct TEXT_CACHE_KEY_HASH
+{
+    std::size_t operator()( const TEXT_CACHE_KEY& aKey ) const
+    {
+        return hash_val( aKey.m_text, aKey.m_glyphSize.x, aKey.m_glyphSize.y, aKey.m_lineWidth,
+                         static_cast<int>( aKey.m_hJustify ), static_cast<int>( aKey.m_vJustify ),
+                         aKey.m_italic, aKey.m_mirrored );
+    }
+};
+
+
+/**
+ * Least recently used cache of stroke text geometries, shared by all the STROKE_FONT
+ * instances (so PCB_PAINTER, SCH_PAINTER and GERBVIEW_PAINTER all benefit from it).
+ */
+class STROKE_TEXT_CACHE
+{
+public:
+    std::shared_ptr<const STROKE_TEXT_GEOMETRY> Get( const TEXT_CACHE_KEY& aKey )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        auto it = m_index.find( aKey );
+
+        if( it == m_index.end() )
+            return nullptr;
+
+        // Move the entry to the front of the LRU list
+        m_entries.splice( m_entries.begin(), m_entries, it->second );
+
+        return it->second->second;
+    }
+
+    void Put( const TEXT_CACHE_KEY& aKey, std::shared_ptr<const STROKE_TEXT_GEOMETRY> aGeometry )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        auto it = m_index.find( aKey );
+
+        if( it != m_index.end() )
+        {
+            it->second->second = std::move( aGeometry );
+            m_entries.splice( m_entries.begin(), m_entries, it->second );
+            return;
+        }
+
+        m_entries.emplace_front( aKey, std::move( aGeometry ) );
+        m_index[ aKey ] = m_entries.begin();
+
+        while( m_entries.size() > MAX_ENTRIES )
+        {
+            m_index.erase( m_entries.back().first );
+            m_entries.pop_back();
+        }
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        m_index.clear();
+        m_entries.clear();
+    }
+
+private:
+    typedef std::pair<TEXT_CACHE_KEY, std::shared_ptr<const STROKE_TEXT_GEOMETRY>> ENTRY;
+
+    ///> Maximum number of texts kept in the cache
+    static constexpr size_t MAX_ENTRIES = 16384;
+
+    std::mutex                                                     m_mutex;
+    std::list<ENTRY>                                               m_entries;  ///< MRU first
+    std::unordered_map<TEXT_CACHE_KEY, std::list<ENTRY>::iterator,
+                       TEXT_CACHE_KEY_HASH>                        m_index;
+};
+
+
+STROKE_TEXT_CACHE g_strokeTextCache;
+
+} // namespace
+
+
 STROKE_FONT::STROKE_FONT( GAL* aGal ) :
     m_gal( aGal ), m_glyphs( nullptr ), m_glyphBoundingBoxes( nullptr )
 {
@@ -185,31 +303,87 @@ BOX2D STROKE_FONT::computeBoundingBox( const GLYPH* aGLYPH, double aGlyphWidth )
 }
 
 
+void STROKE_FONT::ClearTextCache()
+{
+    g_strokeTextCache.Clear();
+}
+
+
 void STROKE_FONT::Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRotationAngle )
 {
     if( aText.empty() )
         return;
 
+    m_gal->SetIsStroke( true );
+    //m_gal->SetIsFill( false );
+
+    if( m_gal->IsFontBold() )
+        m_gal->SetLineWidth( m_gal->GetLineWidth() * BOLD_FACTOR );
+
+    // The geometry depends on the line width, so it has to be looked up after the bold
+    // correction above
+    std::shared_ptr<const STROKE_TEXT_GEOMETRY> geometry = getTextGeometry( aText );
+
     // Context needs to be saved before any transformations
     m_gal->Save();
 
     m_gal->Translate( aPosition );
     m_gal->Rotate( -aRotationAngle );
 
+    for( const std::pair<VECTOR2D, VECTOR2D>& overbar : geometry->m_overbars )
+        m_gal->DrawLine( overbar.first, overbar.second );
+
+    // All glyph strokes are sent to the GAL at once
+    m_gal->DrawPolylines( geometry->m_strokes );
+
+    m_gal->Restore();
+}
+
+
+std::shared_ptr<const STROKE_TEXT_GEOMETRY> STROKE_FONT::getTextGeometry( const UTF8& aText ) const
+{
+    TEXT_CACHE_KEY key;
+
+    key.m_text.assign( aText.c_str(), aText.size() );
+    key.m_glyphSize = m_gal->GetGlyphSize();
+    key.m_lineWidth = m_gal->GetLineWidth();
+    key.m_hJustify  = m_gal->GetHorizontalJustify();
+    key.m_vJustify  = m_gal->GetVerticalJustify();
+    key.m_italic    = m_gal->IsFontItalic();
+    key.m_mirrored  = m_gal->IsTextMirrored();
+
+    std::shared_ptr<const STROKE_TEXT_GEOMETRY> geometry = g_strokeTextCache.Get( key );
+
+    if( !geometry )
+    {
+        auto newGeometry = std::make_shared<STROKE_TEXT_GEOMETRY>();
+        buildTextGeometry( aText, *newGeometry );
+
+        geometry = newGeometry;
+        g_strokeTextCache.Put( key, geometry );
+    }
+
+    return geometry;
+}
+
+
+void STROKE_FONT::buildTextGeometry( const UTF8& aText, STROKE_TEXT_GEOMETRY& aGeometry ) const
+{
     // Single line height
     int lineHeight = KiROUND( GetInterline( m_gal->GetGlyphSize().y ) );
     int lineCount = linesCount( aText );
     const VECTOR2D& glyphSize = m_gal->GetGlyphSize();
+    VECTOR2D offset( 0.0, 0.0 );
 
     // align the 1st line of text
     switch( m_gal->GetVerticalJustify() )
     {
     case GR_TEXT_VJUSTIFY_TOP:
-        m_gal->Translate( VECTOR2D( 0, glyphSize.y ) );
+        offset.y += glyphSize.y;
         break;
 
     case GR_TEXT_VJUSTIFY_CENTER:
-        m_gal->Translate( VECTOR2D( 0, glyphSize.y / 2.0 ) );
+        offset.y += glyphSize.y / 2.0;
         break;
 
     case GR_TEXT_VJUSTIFY_BOTTOM:
@@ -227,22 +401,16 @@ void STROKE_FONT::Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRo
             break;
 
         case GR_TEXT_VJUSTIFY_CENTER:
-            m_gal->Translate( VECTOR2D(0, -( lineCount - 1 ) * lineHeight / 2) );
+            offset.y += -( lineCount - 1 ) * lineHeight / 2;
             break;
 
         case GR_TEXT_VJUSTIFY_BOTTOM:
-            m_gal->Translate( VECTOR2D(0, -( lineCount - 1 ) * lineHeight ) );
+            offset.y += -( lineCount - 1 ) * lineHeight;
             break;
         }
     }
 
-    m_gal->SetIsStroke( true );
-    //m_gal->SetIsFill( false );
-
-    if( m_gal->IsFontBold() )
-        m_gal->SetLineWidth( m_gal->GetLineWidth() * BOLD_FACTOR );
-
-    // Split multiline strings into separate ones and draw them line by line
+    // Split multiline strings into separate ones and compute them line by line
     size_t  begin = 0;
     size_t  newlinePos = aText.find( '\n' );
 
@@ -250,22 +418,21 @@ void STROKE_FONT::Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRo
     {
         size_t length = newlinePos - begin;
 
-        drawSingleLineText( aText.substr( begin, length ) );
-        m_gal->Translate( VECTOR2D( 0.0, lineHeight ) );
+        buildSingleLineText( aText.substr( begin, length ), offset, aGeometry );
+        offset.y += lineHeight;
 
         begin = newlinePos + 1;
         newlinePos = aText.find( '\n', begin );
     }
 
-    // Draw the last (or the only one) line
+    // Compute the last (or the only one) line
     if( !aText.empty() )
-        drawSingleLineText( aText.substr( begin ) );
-
-    m_gal->Restore();
+        buildSingleLineText( aText.substr( begin ), offset, aGeometry );
 }
 
 
-void STROKE_FONT::drawSingleLineText( const UTF8& aText )
+void STROKE_FONT::buildSingleLineText( const UTF8& aText, const VECTOR2D& aOffset,
+                                       STROKE_TEXT_GEOMETRY& aGeometry ) const
 {
     double      xOffset;
     double      yOffset;
@@ -279,31 +446,28 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
     VECTOR2D textSize = computeTextLineSize( aText );
     double half_thickness = m_gal->GetLineWidth()/2;
 
-    // Context needs to be saved before any transformations
-    m_gal->Save();
-
     // First adjust: the text X position is corrected by half_thickness
     // because when the text with thickness is draw, its full size is textSize,
     // but the position of lines is half_thickness to textSize - half_thickness
     // so we must translate the coordinates by half_thickness on the X axis
     // to place the text inside the 0 to textSize X area.
-    m_gal->Translate( VECTOR2D( half_thickness, 0 ) );
+    VECTOR2D lineOrigin = aOffset + VECTOR2D( half_thickness, 0 );
 
     // Adjust the text position to the given horizontal justification
     switch( m_gal->GetHorizontalJustify() )
     {
     case GR_TEXT_HJUSTIFY_CENTER:
-        m_gal->Translate( VECTOR2D( -textSize.x / 2.0, 0 ) );
+        lineOrigin.x += -textSize.x / 2.0;
         break;
 
     case GR_TEXT_HJUSTIFY_RIGHT:
         if( !m_gal->IsTextMirrored() )
-            m_gal->Translate( VECTOR2D( -textSize.x, 0 ) );
+            lineOrigin.x += -textSize.x;
         break;
 
     case GR_TEXT_HJUSTIFY_LEFT:
         if( m_gal->IsTextMirrored() )
-            m_gal->Translate( VECTOR2D( -textSize.x, 0 ) );
+            lineOrigin.x += -textSize.x;
         break;
 
     default:
@@ -437,7 +601,8 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
             VECTOR2D startOverbar( overbar_start_x, overbar_start_y );
             VECTOR2D endOverbar( overbar_end_x, overbar_end_y );
 
-            m_gal->DrawLine( startOverbar, endOverbar );
+            aGeometry.m_overbars.emplace_back( lineOrigin + startOverbar,
+                                               lineOrigin + endOverbar );
         }
         else
         {
@@ -446,7 +611,10 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
 
         for( const std::vector<VECTOR2D>* ptList : *glyph )
         {
-            std::deque<VECTOR2D> ptListScaled;
+            aGeometry.m_strokes.emplace_back();
+            std::vector<VECTOR2D>& ptListScaled = aGeometry.m_strokes.back();
+
+            ptListScaled.reserve( ptList->size() );
 
             for( const VECTOR2D& pt : *ptList )
             {
@@ -462,16 +630,12 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
                         scaledPt.x -= scaledPt.y * STROKE_FONT::ITALIC_TILT;
                 }
 
-                ptListScaled.push_back( scaledPt );
+                ptListScaled.push_back( lineOrigin + scaledPt );
             }
-
-            m_gal->DrawPolyline( ptListScaled );
         }
 
         xOffset += glyphSize.x * bbox.GetEnd().x;
     }
-
-    m_gal->Restore();
 }
 
 
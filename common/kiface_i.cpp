@@ -24,11 +24,16 @@
  */
 
 #include <macros.h>             // FROM_UTF8()
+#include <wx/filename.h>
 #include <wx/stdpaths.h>
+#include <wx/utils.h>
 
+#include <advanced_config.h>
 #include <kiface_i.h>
 #include <pgm_base.h>
 #include <systemdirsappend.h>
+#include <trace_helpers.h>
+#include <trace_profiler.h>
 
 #include <common.h>
 
@@ -92,6 +97,9 @@ bool KIFACE_I::start_common( int aCtlBits )
     m_bm.Init();
     setSearchPaths( &m_bm.m_search, m_id );
 
+    if( !ADVANCED_CFG::GetCfg().m_TraceProfilerPath.IsEmpty() )
+        TRACE_PROFILER::Instance().Enable( true );
+
     return true;
 }
 
@@ -99,5 +107,21 @@ bool KIFACE_I::start_common( int aCtlBits )
 void KIFACE_I::end_common()
 {
     m_bm.End();
+
+    if( TRACE_PROFILER::IsEnabled() )
+    {
+        TRACE_PROFILER::Instance().Enable( false );
+
+        // One file per module and process, as each module has its own profiler
+        wxFileName fn( ADVANCED_CFG::GetCfg().m_TraceProfilerPath,
+                       wxString::Format( "%s-%lu", Name(), wxGetProcessId() ), "json" );
+
+        if( !TRACE_PROFILER::Instance().ExportChromeTrace( fn.GetFullPath(),
+                                                          Name().ToStdString() ) )
+        {
+            wxLogTrace( traceTraceProfiler, "Cannot write the trace file %s",
+                        fn.GetFullPath() );
+        }
+    }
 }
 
@@ -434,9 +434,10 @@ bool KIWAY::PlayersClose( bool doForce )
 }
 
 
-void KIWAY::ExpressMail( FRAME_T aDestination, MAIL_T aCommand, std::string& aPayload, wxWindow* aSource )
+void KIWAY::ExpressMail( FRAME_T aDestination, MAIL_T aCommand, std::string& aPayload,
+                         wxWindow* aSource, KIWAY_MAIL_OBJECT* aMailObject )
 {
-    KIWAY_EXPRESS   mail( aDestination, aCommand, aPayload, aSource );
+    KIWAY_EXPRESS   mail( aDestination, aCommand, aPayload, aSource, aMailObject );
 
     ProcessEvent( mail );
 }
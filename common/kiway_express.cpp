@@ -44,16 +44,18 @@ const wxEventType KIWAY_EXPRESS::wxEVENT_ID = 30000;    // commmon accross all l
 KIWAY_EXPRESS::KIWAY_EXPRESS( const KIWAY_EXPRESS& anOther ) :
     wxEvent( anOther ),
     m_destination( anOther.m_destination ),
-    m_payload( anOther.m_payload )
+    m_payload( anOther.m_payload ),
+    m_mailObject( anOther.m_mailObject )
 {
 }
 
 
 KIWAY_EXPRESS::KIWAY_EXPRESS( FRAME_T aDestination, MAIL_T aCommand, std::string& aPayload,
-                              wxWindow* aSource ) :
+                              wxWindow* aSource, KIWAY_MAIL_OBJECT* aMailObject ) :
     wxEvent( aCommand, wxEVENT_ID ),
     m_destination( aDestination ),
-    m_payload( aPayload )
+    m_payload( aPayload ),
+    m_mailObject( aMailObject )
 {
     SetEventObject( aSource );
 }
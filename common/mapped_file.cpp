@@ -0,0 +1,153 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <mapped_file.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN 1
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+MAPPED_FILE::MAPPED_FILE() :
+        m_data( nullptr ),
+        m_size( 0 )
+#ifdef _WIN32
+        , m_mapping( nullptr )
+#endif
+{
+}
+
+
+MAPPED_FILE::~MAPPED_FILE()
+{
+    Close();
+}
+
+
+#if defined(_WIN32)
+
+bool MAPPED_FILE::Open( const wxString& aFileName )
+{
+    Close();
+
+    HANDLE file = CreateFileW( aFileName.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+    if( file == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER size;
+
+    if( !GetFileSizeEx( file, &size ) || size.QuadPart == 0 )
+    {
+        CloseHandle( file );
+        return false;
+    }
+
+    // Copy-on-write: the pages may be written to, the file is never modified.
+    // The mapping object keeps its own reference on the file
+    HANDLE mapping = CreateFileMappingW( file, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+    CloseHandle( file );
+
+    if( mapping == NULL )
+        return false;
+
+    void* data = MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+
+    if( data == NULL )
+    {
+        CloseHandle( mapping );
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_data = static_cast<char*>( data );
+    m_size = static_cast<size_t>( size.QuadPart );
+
+    return true;
+}
+
+
+void MAPPED_FILE::Close()
+{
+    if( m_data )
+        UnmapViewOfFile( m_data );
+
+    if( m_mapping )
+        CloseHandle( m_mapping );
+
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_size = 0;
+}
+
+#else
+
+bool MAPPED_FILE::Open( const wxString& aFileName )
+{
+    Close();
+
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd < 0 )
+        return false;
+
+    struct stat st;
+
+    if( fstat( fd, &st ) != 0 || st.st_size <= 0 )
+    {
+        close( fd );
+        return false;
+    }
+
+    // MAP_PRIVATE makes the writes copy-on-write: they never reach the file.
+    // The mapping stays valid once the descriptor is closed
+    void* data = mmap( nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+    close( fd );
+
+    if( data == MAP_FAILED )
+        return false;
+
+    m_data = static_cast<char*>( data );
+    m_size = static_cast<size_t>( st.st_size );
+
+    return true;
+}
+
+
+void MAPPED_FILE::Close()
+{
+    if( m_data )
+        munmap( m_data, m_size );
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
@@ -24,9 +24,11 @@
 
 
 #include <cstdarg>
+#include <cstring>
 #include <config.h> // HAVE_FGETC_NOLOCK
 
 #include <richio.h>
+#include <wx/filename.h>
 
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
@@ -225,6 +227,65 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
+MMAP_LINE_READER::MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber, unsigned aMaxLineLength ) :
+    LINE_READER( aMaxLineLength ), m_ndx( 0 ), m_buffer( m_line )
+{
+    // Empty files cannot be mapped, but they are readable
+    if( !m_file.Open( aFileName )
+            && ( !wxFileName::IsFileReadable( aFileName ) || wxFileName::GetSize( aFileName ) != 0 ) )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_source  = aFileName;
+    m_lineNum = aStartingLineNumber;
+}
+
+
+MMAP_LINE_READER::~MMAP_LINE_READER()
+{
+    // LINE_READER deletes its own buffer, not the mapping
+    m_line = m_buffer;
+}
+
+
+char* MMAP_LINE_READER::ReadLine()
+{
+    const size_t size = m_file.Size();
+
+    m_length = 0;
+
+    if( m_ndx < size )
+    {
+        char*       line = m_file.Data() + m_ndx;
+        const void* eol  = memchr( line, '\n', size - m_ndx );
+        size_t      length = eol ? (const char*) eol - line + 1 : size - m_ndx;
+
+        if( length > m_maxLineLength )
+            THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+        m_line   = line;
+        m_length = (unsigned) length;
+        m_ndx   += length;
+    }
+    else
+    {
+        m_line = m_buffer;
+
+        if( m_line )
+            m_line[0] = 0;
+    }
+
+    // m_lineNum is incremented even if there was no line read, as FILE_LINE_READER does.
+    ++m_lineNum;
+
+    return m_length ? m_line : NULL;
+}
+
+
 STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
@@ -415,13 +476,24 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
     for( int i=0; i<nestLevel;  ++i )
     {
         // no error checking needed, an exception indicates an error.
-        result = sprint( "%*c", NESTWIDTH, ' ' );
+        write( "  ", NESTWIDTH );
 
-        total += result;
+        total += NESTWIDTH;
     }
 
-    // no error checking needed, an exception indicates an error.
-    result = vprint( fmt, args );
+    // Plain texts, like ")\n", don't need to go through vsnprintf
+    if( !strchr( fmt, '%' ) )
+    {
+        result = (int) strlen( fmt );
+
+        if( result > 0 )
+            write( fmt, result );
+    }
+    else
+    {
+        // no error checking needed, an exception indicates an error.
+        result = vprint( fmt, args );
+    }
 
     va_end( args );
 
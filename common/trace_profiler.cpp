@@ -0,0 +1,268 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <trace_profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <locale>
+
+#include <wx/string.h>
+#include <wx/utils.h>
+
+
+constexpr size_t TRACE_PROFILER::RING_SIZE;
+
+std::atomic<bool> TRACE_PROFILER::s_enabled( false );
+
+
+static int64_t steadyClockNs()
+{
+    using namespace std::chrono;
+
+    return duration_cast<nanoseconds>( steady_clock::now().time_since_epoch() ).count();
+}
+
+
+/**
+ * Writes a string as a JSON string value.
+ */
+static void writeJsonString( std::ostream& aStream, const char* aString )
+{
+    aStream << '"';
+
+    for( const char* c = aString ? aString : ""; *c; ++c )
+    {
+        if( *c == '"' || *c == '\\' )
+            aStream << '\\' << *c;
+        else if( (unsigned char) *c < 0x20 )
+            aStream << "\\u" << std::hex << std::setw( 4 ) << std::setfill( '0' ) << (int) *c
+                    << std::dec << std::setfill( ' ' );
+        else
+            aStream << *c;
+    }
+
+    aStream << '"';
+}
+
+
+TRACE_PROFILER::TRACE_PROFILER() :
+        m_epoch( steadyClockNs() ),
+        m_nextThread( 1 )
+{
+}
+
+
+TRACE_PROFILER& TRACE_PROFILER::Instance()
+{
+    static TRACE_PROFILER instance;
+    return instance;
+}
+
+
+void TRACE_PROFILER::Enable( bool aEnable )
+{
+    if( aEnable )
+    {
+        Clear();
+        m_epoch = steadyClockNs();
+    }
+
+    s_enabled = aEnable;
+}
+
+
+int64_t TRACE_PROFILER::Timestamp() const
+{
+    return steadyClockNs() - m_epoch.load( std::memory_order_relaxed );
+}
+
+
+TRACE_PROFILER::THREAD_BUFFER& TRACE_PROFILER::threadBuffer()
+{
+    // Hands the buffer over to a new thread when the thread finishes, so short-lived worker
+    // threads don't allocate a ring buffer each
+    struct SLOT
+    {
+        ~SLOT()
+        {
+            if( m_buffer )
+                m_buffer->m_retired = true;
+        }
+
+        std::shared_ptr<THREAD_BUFFER> m_buffer;
+    };
+
+    thread_local SLOT slot;
+
+    if( !slot.m_buffer )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        for( const std::shared_ptr<THREAD_BUFFER>& buffer : m_buffers )
+        {
+            if( buffer->m_retired )
+            {
+                buffer->m_retired = false;
+                slot.m_buffer = buffer;
+                break;
+            }
+        }
+
+        if( !slot.m_buffer )
+        {
+            m_buffers.push_back( std::make_shared<THREAD_BUFFER>() );
+            slot.m_buffer = m_buffers.back();
+        }
+
+        slot.m_buffer->m_thread = m_nextThread++;
+    }
+
+    return *slot.m_buffer;
+}
+
+
+void TRACE_PROFILER::Record( const char* aName, const char* aCategory, int64_t aStart,
+                             int64_t aDuration )
+{
+    // The zone started before the profiler was disabled
+    if( !IsEnabled() )
+        return;
+
+    THREAD_BUFFER&              buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock( buffer.m_mutex );
+
+    if( buffer.m_events.empty() )
+        buffer.m_events.resize( RING_SIZE );
+
+    TRACE_EVENT& event = buffer.m_events[buffer.m_count % RING_SIZE];
+
+    event.m_name = aName;
+    event.m_category = aCategory;
+    event.m_start = aStart;
+    event.m_duration = aDuration;
+    event.m_thread = buffer.m_thread;
+
+    buffer.m_count++;
+}
+
+
+const char* TRACE_PROFILER::Intern( const std::string& aName )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    // Set elements are never moved, nor removed
+    return m_names.insert( aName ).first->c_str();
+}
+
+
+void TRACE_PROFILER::Clear()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    for( const std::shared_ptr<THREAD_BUFFER>& buffer : m_buffers )
+    {
+        std::lock_guard<std::mutex> bufferLock( buffer->m_mutex );
+        buffer->m_count = 0;
+    }
+}
+
+
+std::vector<TRACE_EVENT> TRACE_PROFILER::GetEvents() const
+{
+    std::vector<TRACE_EVENT> events;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        for( const std::shared_ptr<THREAD_BUFFER>& buffer : m_buffers )
+        {
+            std::lock_guard<std::mutex> bufferLock( buffer->m_mutex );
+
+            size_t count = (size_t) std::min<uint64_t>( buffer->m_count, RING_SIZE );
+
+            events.insert( events.end(), buffer->m_events.begin(),
+                           buffer->m_events.begin() + count );
+        }
+    }
+
+    // Enclosing zones first, as they are recorded after the zones they enclose
+    std::sort( events.begin(), events.end(),
+               []( const TRACE_EVENT& aLeft, const TRACE_EVENT& aRight )
+               {
+                   if( aLeft.m_start != aRight.m_start )
+                       return aLeft.m_start < aRight.m_start;
+
+                   return aLeft.m_duration > aRight.m_duration;
+               } );
+
+    return events;
+}
+
+
+void TRACE_PROFILER::ExportChromeTrace( std::ostream& aStream,
+                                        const std::string& aProcessName ) const
+{
+    std::vector<TRACE_EVENT> events = GetEvents();
+    unsigned long            pid = wxGetProcessId();
+    std::locale              previousLocale = aStream.imbue( std::locale::classic() );
+
+    // Times are in microseconds
+    aStream << std::fixed << std::setprecision( 3 );
+    aStream << "{\"traceEvents\":[\n";
+
+    aStream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":0,\"args\":{\"name\":";
+    writeJsonString( aStream, aProcessName.c_str() );
+    aStream << "}}";
+
+    for( const TRACE_EVENT& event : events )
+    {
+        aStream << ",\n{\"name\":";
+        writeJsonString( aStream, event.m_name );
+        aStream << ",\"cat\":";
+        writeJsonString( aStream, event.m_category );
+        aStream << ",\"ph\":\"X\",\"ts\":" << event.m_start / 1e3
+                << ",\"dur\":" << event.m_duration / 1e3
+                << ",\"pid\":" << pid << ",\"tid\":" << event.m_thread << "}";
+    }
+
+    aStream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    aStream.imbue( previousLocale );
+}
+
+
+bool TRACE_PROFILER::ExportChromeTrace( const wxString& aFileName,
+                                        const std::string& aProcessName ) const
+{
+    std::ofstream stream( aFileName.fn_str() );
+
+    if( !stream )
+        return false;
+
+    ExportChromeTrace( stream, aProcessName );
+
+    return stream.good();
+}
@@ -42,6 +42,7 @@
 #include <cmath>
 #include <cstdio>   // used only for debug
 #include <ctime>    // used for representation of x axes involving date
+#include <limits>
 #include <set>
 
 // Memory leak debugging
@@ -3198,6 +3199,7 @@ mpFXYVector::mpFXYVector( const wxString& name, int flags ) : mpFXY( name, flags
     m_minY  = -1;
     m_maxY  = 1;
     m_type  = mpLAYER_PLOT;
+    m_decimated = false;
 }
 
 
@@ -3266,15 +3268,20 @@ size_t mpFXYVector::GetCount()
 
 bool mpFXYVector::GetNextXY( double& x, double& y )
 {
-    if( m_index >= m_xs.size() )
+    size_t count = m_decimated ? m_plotIndices.size() : m_xs.size();
+
+    if( m_index >= count )
     {
         return false;
     }
     else
     {
-        x = m_xs[m_index];
-        y = m_ys[m_index++];
-        return m_index <= m_xs.size();
+        size_t ii = m_decimated ? m_plotIndices[m_index] : m_index;
+
+        x = m_xs[ii];
+        y = m_ys[ii];
+        m_index++;
+        return true;
     }
 }
 
@@ -3283,6 +3290,7 @@ void mpFXYVector::Clear()
 {
     m_xs.clear();
     m_ys.clear();
+    updateData( 0 );
 }
 
 
@@ -3296,41 +3304,259 @@ void mpFXYVector::SetData( const std::vector<double>& xs, const std::vector<doub
     m_xs    = xs;
     m_ys    = ys;
 
-    // Update internal variables for the bounding box.
-    if( xs.size()>0 )
+    updateData( 0 );
+}
+
+
+void mpFXYVector::AppendData( const std::vector<double>& xs, const std::vector<double>& ys )
+{
+    if( xs.size() != ys.size() )
+        return;
+
+    size_t first = m_xs.size();
+
+    m_xs.insert( m_xs.end(), xs.begin(), xs.end() );
+    m_ys.insert( m_ys.end(), ys.begin(), ys.end() );
+
+    updateData( first );
+}
+
+
+void mpFXYVector::updateData( size_t aFirst )
+{
+    size_t count = m_xs.size();
+
+    if( count == 0 )
+    {
+        m_minX  = -1;
+        m_maxX  = 1;
+        m_minY  = -1;
+        m_maxY  = 1;
+    }
+    else
+    {
+        // Update internal variables for the bounding box.
+        if( aFirst == 0 )
+        {
+            m_minX  = m_xs[0];
+            m_maxX  = m_xs[0];
+            m_minY  = m_ys[0];
+            m_maxY  = m_ys[0];
+        }
+
+        for( size_t ii = aFirst; ii < count; ii++ )
+        {
+            m_minX = std::min( m_minX, m_xs[ii] );
+            m_maxX = std::max( m_maxX, m_xs[ii] );
+            m_minY = std::min( m_minY, m_ys[ii] );
+            m_maxY = std::max( m_maxY, m_ys[ii] );
+        }
+    }
+
+    m_minMaxIndex.Update( m_xs, m_ys, aFirst );
+}
+
+
+void mpMinMaxIndex::Update( const std::vector<double>& aXs, const std::vector<double>& aYs,
+                            size_t aFirst )
+{
+    size_t count = aXs.size();
+
+    if( aFirst == 0 )
+        m_sortedX = true;
+
+    for( size_t ii = std::max<size_t>( aFirst, 1 ); ii < count && m_sortedX; ii++ )
+    {
+        if( aXs[ii] < aXs[ii - 1] )
+            m_sortedX = false;
+    }
+
+    if( count == 0 || !m_sortedX || count > std::numeric_limits<unsigned int>::max() )
     {
-        m_minX  = xs[0];
-        m_maxX  = xs[0];
-        m_minY  = ys[0];
-        m_maxY  = ys[0];
+        m_pyramid.clear();
+        return;
+    }
+
+    // Update the blocks holding the new points, at every level of the pyramid
+    size_t blockCount = ( count + 3 ) / 4;
+    size_t first = aFirst / 4;
+
+    for( size_t level = 0; ; level++ )
+    {
+        if( m_pyramid.size() <= level )
+            m_pyramid.emplace_back();
+
+        std::vector<MINMAX>& blocks = m_pyramid[level];
+        blocks.resize( blockCount );
+
+        for( size_t ii = first; ii < blockCount; ii++ )
+        {
+            MINMAX& minmax = blocks[ii];
+
+            if( level == 0 )
+            {
+                size_t last = std::min( 4 * ii + 4, count );
+
+                minmax.min = minmax.max = 4 * ii;
+
+                for( size_t jj = 4 * ii + 1; jj < last; jj++ )
+                {
+                    if( aYs[jj] < aYs[minmax.min] )
+                        minmax.min = jj;
+
+                    if( aYs[jj] > aYs[minmax.max] )
+                        minmax.max = jj;
+                }
+            }
+            else
+            {
+                const std::vector<MINMAX>& children = m_pyramid[level - 1];
+
+                minmax = children[2 * ii];
+
+                if( 2 * ii + 1 < children.size() )
+                {
+                    const MINMAX& next = children[2 * ii + 1];
 
-        std::vector<double>::const_iterator it;
+                    if( aYs[next.min] < aYs[minmax.min] )
+                        minmax.min = next.min;
+
+                    if( aYs[next.max] > aYs[minmax.max] )
+                        minmax.max = next.max;
+                }
+            }
+        }
 
-        for( it = xs.begin(); it!=xs.end(); it++ )
+        if( blockCount == 1 )
         {
-            if( *it<m_minX )
-                m_minX = *it;
+            m_pyramid.resize( level + 1 );
+            break;
+        }
 
-            if( *it>m_maxX )
-                m_maxX = *it;
+        blockCount = ( blockCount + 1 ) / 2;
+        first /= 2;
+    }
+}
+
+
+mpMinMaxIndex::MINMAX mpMinMaxIndex::RangeMinMax( const std::vector<double>& aYs,
+                                                  size_t aFirst, size_t aLast ) const
+{
+    MINMAX minmax = { (unsigned int) aFirst, (unsigned int) aFirst };
+    size_t ii = aFirst;
+
+    while( ii < aLast )
+    {
+        // Take the largest block of the pyramid starting at ii and ending before aLast
+        size_t level = 0;
+
+        while( level + 1 < m_pyramid.size() && ii % ( (size_t) 8 << level ) == 0
+                && ii + ( (size_t) 8 << level ) <= aLast )
+        {
+            level++;
+        }
+
+        MINMAX next;
+
+        if( ii % 4 == 0 && ii + 4 <= aLast )
+        {
+            next = m_pyramid[level][ii >> ( level + 2 )];
+            ii += (size_t) 4 << level;
+        }
+        else
+        {
+            next.min = next.max = ii;
+            ii++;
         }
 
-        for( it = ys.begin(); it!=ys.end(); it++ )
+        if( aYs[next.min] < aYs[minmax.min] )
+            minmax.min = next.min;
+
+        if( aYs[next.max] > aYs[minmax.max] )
+            minmax.max = next.max;
+    }
+
+    return minmax;
+}
+
+
+bool mpMinMaxIndex::Decimate( const std::vector<double>& aXs, const std::vector<double>& aYs,
+                              wxCoord aStartPx, wxCoord aEndPx,
+                              const std::function<double( double )>& aColumn,
+                              std::vector<size_t>& aIndices ) const
+{
+    aIndices.clear();
+
+    if( !m_sortedX || m_pyramid.empty()
+            || aXs.size() <= 2 * (size_t) std::max( 1, aEndPx - aStartPx ) )
+    {
+        return false;
+    }
+
+    size_t first = std::partition_point( aXs.begin(), aXs.end(),
+                                         [&]( double x )
+                                         {
+                                             return aColumn( x ) < aStartPx;
+                                         } )
+                   - aXs.begin();
+
+    // Keep a point on each side of the view, for the lines leaving it
+    if( first > 0 )
+        aIndices.push_back( first - 1 );
+
+    for( wxCoord px = aStartPx; px <= aEndPx && first < aXs.size(); px++ )
+    {
+        size_t last = std::partition_point( aXs.begin() + first, aXs.end(),
+                                            [&]( double x )
+                                            {
+                                                return aColumn( x ) <= px;
+                                            } )
+                      - aXs.begin();
+
+        if( last > first )
         {
-            if( *it<m_minY )
-                m_minY = *it;
+            MINMAX minmax = RangeMinMax( aYs, first, last );
 
-            if( *it>m_maxY )
-                m_maxY = *it;
+            aIndices.push_back( std::min( minmax.min, minmax.max ) );
+
+            if( minmax.min != minmax.max )
+                aIndices.push_back( std::max( minmax.min, minmax.max ) );
         }
+
+        first = last;
     }
-    else
+
+    if( first < aXs.size() )
+        aIndices.push_back( first );
+
+    return true;
+}
+
+
+void mpFXYVector::Plot( wxDC& dc, mpWindow& w )
+{
+    wxCoord startPx = m_drawOutsideMargins ? 0 : w.GetMarginLeft();
+    wxCoord endPx   = m_drawOutsideMargins ? w.GetScrX() : w.GetScrX() - w.GetMarginRight();
+
+    // Redrawing millions of points on every pan or zoom is too slow, and most of them fall
+    // on the same pixel columns anyway: only the extremes of every column are plotted.
+    // Points of a scatter plot are all drawn, only lines pass through the column extremes.
+    if( m_visible && m_continuous && m_scaleX )
     {
-        m_minX  = -1;
-        m_maxX  = 1;
-        m_minY  = -1;
-        m_maxY  = 1;
+        // Pixel column of a point, as mpWindow::x2p() computes it but without overflowing
+        // for the points far out of the view
+        m_decimated = m_minMaxIndex.Decimate( m_xs, m_ys, startPx, endPx,
+                                              [&]( double x )
+                                              {
+                                                  return std::trunc(
+                                                          ( m_scaleX->TransformToPlot( x )
+                                                            - w.GetPosX() ) * w.GetScaleX() );
+                                              },
+                                              m_plotIndices );
     }
+
+    mpFXY::Plot( dc, w );
+    m_decimated = false;
 }
 
 
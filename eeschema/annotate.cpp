@@ -194,6 +194,10 @@ void SCH_EDIT_FRAME::AnnotateComponents( bool              aAnnotateSchematic,
         SCH_COMPONENT*  comp = ref.GetComp();
         SCH_SHEET_PATH* sheet = &ref.GetSheetPath();
 
+        // Only the new and renumbered components are modified, and saved for undo
+        if( !ref.IsAnnotationChanged() )
+            continue;
+
         SaveCopyInUndoList( sheet->LastScreen(), comp, UNDO_REDO::CHANGED, appendUndo );
         appendUndo = true;
         ref.Annotate();
@@ -69,23 +69,13 @@ std::vector<wxPoint> SCH_EDIT_FRAME::GetSchematicConnections()
 
 bool SCH_EDIT_FRAME::TestDanglingEnds()
 {
-    std::vector<DANGLING_END_ITEM> endPoints;
-    bool hasStateChanged = false;
-
-    for( auto item : GetScreen()->Items() )
-        item->GetEndPoints( endPoints );
-
-    for( auto item : GetScreen()->Items() )
-    {
-        if( item->UpdateDanglingState( endPoints ) )
-        {
-            GetCanvas()->GetView()->Update( item, KIGFX::REPAINT );
-            hasStateChanged = true;
-        }
-        item->GetEndPoints( endPoints );
-    }
+    std::function<void( SCH_ITEM* )> changedHandler =
+            [&]( SCH_ITEM* aChangedItem )
+            {
+                GetCanvas()->GetView()->Update( aChangedItem, KIGFX::REPAINT );
+            };
 
-    return hasStateChanged;
+    return GetScreen()->TestDanglingEnds( nullptr, &changedHandler );
 }
 
 
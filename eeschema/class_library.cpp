@@ -417,7 +417,7 @@ void PART_LIBS::FindLibraryNearEntries( std::vector<LIB_PART*>& aCandidates,
 }
 
 
-int PART_LIBS::s_modify_generation = 1;     // starts at 1 and goes up
+std::atomic<int> PART_LIBS::s_modify_generation( 1 );     // starts at 1 and goes up
 
 
 int PART_LIBS::GetModifyHash()
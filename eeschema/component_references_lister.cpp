@@ -32,6 +32,9 @@
 
 #include <wx/regex.h>
 #include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
 #include <vector>
 #include <unordered_set>
 
@@ -281,6 +284,47 @@ wxString buildFullReference( const SCH_REFERENCE& aItem, int aUnitNumber = -1 )
 }
 
 
+/**
+ * Reference numbers in use, per reference prefix, so free numbers can be found without
+ * scanning the whole reference list.
+ */
+class REFERENCE_NUMBERS
+{
+public:
+    void Add( const std::string& aPrefix, int aNumber )
+    {
+        if( aNumber >= 0 )
+            m_used[ aPrefix ].insert( aNumber );
+    }
+
+    /**
+     * Same as SCH_REFERENCE_LIST::CreateFirstFreeRefId(): return the first number not in
+     * use for \a aPrefix starting at \a aFirstValue, which is then in use.
+     */
+    int CreateFirstFree( const std::string& aPrefix, int aFirstValue )
+    {
+        std::set<int>& used = m_used[ aPrefix ];
+
+        // Numbers are only ever added, so all the numbers from aFirstValue to the last one
+        // returned for it are still in use: start after that one.
+        auto cursor = m_cursors.find( std::make_pair( aPrefix, aFirstValue ) );
+        int  expectedId = ( cursor != m_cursors.end() ) ? cursor->second : aFirstValue;
+
+        for( auto it = used.lower_bound( expectedId ); it != used.end() && *it == expectedId; ++it )
+            expectedId++;
+
+        used.insert( expectedId );
+        m_cursors[ std::make_pair( aPrefix, aFirstValue ) ] = expectedId + 1;
+
+        return expectedId;
+    }
+
+private:
+    std::map<std::string, std::set<int>>        m_used;
+    std::map<std::pair<std::string, int>, int>  m_cursors;
+};
+
+
 void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int aStartNumber,
                                    SCH_MULTI_UNIT_REFERENCE_MAP aLockedUnitMap )
 {
@@ -290,6 +334,68 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
     int LastReferenceNumber = 0;
     int NumberOfUnits, Unit;
 
+    // A component instance: the component and its sheet path (see SCH_REFERENCE::IsSameInstance)
+    typedef std::pair<SCH_COMPONENT*, wxString> INSTANCE;
+
+    // Units which can be grouped in a package: prefix, value, library symbol and, when
+    // annotating by sheet, sheet path
+    typedef std::tuple<std::string, wxString, std::string, wxString> UNIT_GROUP;
+
+    // A reference prefix and number, shared by the units of a package
+    typedef std::pair<std::string, int> PACKAGE;
+
+    auto instance =
+            []( const SCH_REFERENCE& aRef )
+            {
+                return INSTANCE( aRef.GetComp(), aRef.GetSheetPath().PathAsString() );
+            };
+
+    auto unitGroup =
+            [&]( const SCH_REFERENCE& aRef )
+            {
+                return UNIT_GROUP( aRef.m_Ref, aRef.m_Value,
+                                   aRef.m_RootCmp->GetLibId().GetLibItemName(),
+                                   aUseSheetNum ? aRef.GetSheetPath().PathAsString()
+                                                : wxString() );
+            };
+
+    // Indexes of the list, so annotating a component only looks at the components it
+    // can be related to instead of the whole list:
+    // - the numbers in use for each prefix;
+    // - the components using each prefix and number, to find the annotated units of a package;
+    // - the components not annotated yet, by group of units that can share a package;
+    // - the components by instance, and the locked units of each instance.
+    REFERENCE_NUMBERS                                         numbers;
+    std::map<PACKAGE, std::vector<size_t>>                     packages;
+    std::map<UNIT_GROUP, std::set<size_t>>                     newUnits;
+    std::map<INSTANCE, std::vector<size_t>>                    instances;
+    std::map<INSTANCE, SCH_REFERENCE_LIST*>                    lockedLists;
+
+    auto setNumber =
+            [&]( size_t aIndex, int aNumber )
+            {
+                flatList[aIndex].m_NumRef = aNumber;
+                packages[ PACKAGE( flatList[aIndex].m_Ref, aNumber ) ].push_back( aIndex );
+            };
+
+    for( size_t ii = 0; ii < flatList.size(); ii++ )
+    {
+        SCH_REFERENCE& ref = flatList[ii];
+
+        numbers.Add( ref.m_Ref, ref.m_NumRef );
+        packages[ PACKAGE( ref.m_Ref, ref.m_NumRef ) ].push_back( ii );
+        instances[ instance( ref ) ].push_back( ii );
+
+        if( ref.m_IsNew && !ref.m_Flag )
+            newUnits[ unitGroup( ref ) ].insert( ii );
+    }
+
+    for( SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair : aLockedUnitMap )
+    {
+        for( unsigned thisRefI = 0; thisRefI < pair.second.GetCount(); ++thisRefI )
+            lockedLists.emplace( instance( pair.second[thisRefI] ), &pair.second );
+    }
+
     /* calculate index of the first component with the same reference prefix
      * than the current component.  All components having the same reference
      * prefix will receive a reference number with consecutive values:
@@ -318,11 +424,6 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
     // inUseRefs keep trace of previously allocated references
     std::unordered_set<wxString> inUseRefs;
 
-    // This is the list of all Id already in use for a given reference prefix.
-    // Will be refilled for each new reference prefix.
-    std::vector<int>idList;
-    GetRefsInUse( first, idList, minRefId );
-
     for( unsigned ii = 0; ii < flatList.size(); ii++ )
     {
         auto& ref_unit = flatList[ii];
@@ -332,22 +433,10 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
 
         // Check whether this component is in aLockedUnitMap.
         SCH_REFERENCE_LIST* lockedList = NULL;
-        for( SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair : aLockedUnitMap )
-        {
-            unsigned n_refs = pair.second.GetCount();
-
-            for( unsigned thisRefI = 0; thisRefI < n_refs; ++thisRefI )
-            {
-                SCH_REFERENCE &thisRef = pair.second[thisRefI];
+        auto                locked = lockedLists.find( instance( ref_unit ) );
 
-                if( thisRef.IsSameInstance( ref_unit ) )
-                {
-                    lockedList = &pair.second;
-                    break;
-                }
-            }
-            if( lockedList != NULL ) break;
-        }
+        if( locked != lockedLists.end() )
+            lockedList = locked->second;
 
         if(  ( flatList[first].CompareRef( ref_unit ) != 0 )
           || ( aUseSheetNum && ( flatList[first].m_SheetNum != ref_unit.m_SheetNum ) )  )
@@ -360,8 +449,6 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                 minRefId = ref_unit.m_SheetNum * aSheetIntervalId + 1;
             else
                 minRefId = aStartNumber + 1;
-
-            GetRefsInUse( first, idList, minRefId );
         }
 
         // Annotation of one part per package components (trivial case).
@@ -369,8 +456,8 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
         {
             if( ref_unit.m_IsNew )
             {
-                LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId );
-                ref_unit.m_NumRef = LastReferenceNumber;
+                LastReferenceNumber = numbers.CreateFirstFree( ref_unit.m_Ref, minRefId );
+                setNumber( ii, LastReferenceNumber );
             }
 
             ref_unit.m_Unit  = 1;
@@ -384,8 +471,8 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
 
         if( ref_unit.m_IsNew )
         {
-            LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId );
-            ref_unit.m_NumRef = LastReferenceNumber;
+            LastReferenceNumber = numbers.CreateFirstFree( ref_unit.m_Ref, minRefId );
+            setNumber( ii, LastReferenceNumber );
 
             if( !ref_unit.IsUnitsLocked() )
                 ref_unit.m_Unit = 1;
@@ -418,9 +505,9 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                     continue;
 
                 // Find the matching component
-                for( unsigned jj = ii + 1; jj < flatList.size(); jj++ )
+                for( size_t jj : instances[ instance( thisRef ) ] )
                 {
-                    if( ! thisRef.IsSameInstance( flatList[jj] ) )
+                    if( jj <= ii )
                         continue;
 
                     wxString ref_candidate = buildFullReference( ref_unit, thisRef.m_Unit );
@@ -430,7 +517,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                     // multiunits components have duplicate references)
                     if( inUseRefs.find( ref_candidate ) == inUseRefs.end() )
                     {
-                        flatList[jj].m_NumRef = ref_unit.m_NumRef;
+                        setNumber( jj, ref_unit.m_NumRef );
                         flatList[jj].m_Unit = thisRef.m_Unit;
                         flatList[jj].m_IsNew = false;
                         flatList[jj].m_Flag = 1;
@@ -447,50 +534,63 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
             * we search for others parts that have the same value and the same
             * reference prefix (ref without ref number)
             */
+            auto group = newUnits.find( unitGroup( ref_unit ) );
+
+            // Nothing to add to this package: an annotated package is only looked at when
+            // new units can complete it
+            if( group == newUnits.end() || group->second.empty() )
+                continue;
+
+            std::set<size_t>& candidates = group->second;
+
             for( Unit = 1; Unit <= NumberOfUnits; Unit++ )
             {
                 if( ref_unit.m_Unit == Unit )
                     continue;
 
-                int found = FindUnit( ii, Unit );
+                bool found = false;
 
-                if( found >= 0 )
-                    continue; // this unit exists for this reference (unit already annotated)
-
-                // Search a component to annotate ( same prefix, same value, not annotated)
-                for( unsigned jj = ii + 1; jj < flatList.size(); jj++ )
+                // Same as FindUnit( ii, Unit ), among the components using this number
+                for( size_t jj : packages[ PACKAGE( ref_unit.m_Ref, ref_unit.m_NumRef ) ] )
                 {
-                    auto& cmp_unit = flatList[jj];
-
-                    if( cmp_unit.m_Flag )    // already tested
-                        continue;
-
-                    if( cmp_unit.CompareRef( ref_unit ) != 0 )
-                        continue;
+                    const SCH_REFERENCE& unit = flatList[jj];
 
-                    if( cmp_unit.CompareValue( ref_unit ) != 0 )
-                        continue;
+                    if( jj != ii && !unit.m_IsNew && unit.m_NumRef == ref_unit.m_NumRef
+                            && unit.m_Unit == Unit )
+                    {
+                        found = true;
+                        break;
+                    }
+                }
 
-                    if( cmp_unit.CompareLibName( ref_unit ) != 0 )
-                        continue;
+                if( found )
+                    continue; // this unit exists for this reference (unit already annotated)
 
-                    if( aUseSheetNum &&
-                            cmp_unit.GetSheetPath().Cmp( ref_unit.GetSheetPath() ) != 0 )
-                        continue;
+                // Search a component to annotate ( same prefix, same value, not annotated)
+                for( auto it = candidates.upper_bound( ii ); it != candidates.end(); )
+                {
+                    auto& cmp_unit = flatList[*it];
 
-                    if( !cmp_unit.m_IsNew )
+                    // Annotated since the index was built
+                    if( cmp_unit.m_Flag || !cmp_unit.m_IsNew )
+                    {
+                        it = candidates.erase( it );
                         continue;
+                    }
 
                     // Component without reference number found, annotate it if possible
                     if( !cmp_unit.IsUnitsLocked()
                         || ( cmp_unit.m_Unit == Unit ) )
                     {
-                        cmp_unit.m_NumRef = ref_unit.m_NumRef;
+                        setNumber( *it, ref_unit.m_NumRef );
                         cmp_unit.m_Unit   = Unit;
                         cmp_unit.m_Flag   = 1;
                         cmp_unit.m_IsNew  = false;
+                        candidates.erase( it );
                         break;
                     }
+
+                    ++it;
                 }
             }
         }
@@ -706,6 +806,16 @@ void SCH_REFERENCE::Annotate()
 }
 
 
+bool SCH_REFERENCE::IsAnnotationChanged() const
+{
+    // Same reference as the one Annotate() sets
+    wxString ref = GetRef() + GetRefNumber();
+
+    return m_RootCmp->GetRef( &m_SheetPath ) != ref
+            || m_RootCmp->GetUnitSelection( &m_SheetPath ) != m_Unit;
+}
+
+
 void SCH_REFERENCE::Split()
 {
     std::string refText = GetRefStr();
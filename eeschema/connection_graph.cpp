@@ -18,6 +18,7 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <list>
 #include <thread>
 #include <algorithm>
@@ -25,6 +26,7 @@
 #include <vector>
 #include <unordered_map>
 #include <profile.h>
+#include <trace_profiler.h>
 #include <common.h>
 #include <erc.h>
 #include <sch_bus_entry.h>
@@ -357,9 +359,6 @@ CONNECTION_SUBGRAPH::PRIORITY CONNECTION_SUBGRAPH::GetDriverPriority( SCH_ITEM*
 }
 
 
-bool CONNECTION_GRAPH::m_allowRealTime = true;
-
-
 void CONNECTION_GRAPH::Reset()
 {
     for( auto& subgraph : m_subgraphs )
@@ -375,7 +374,9 @@ void CONNECTION_GRAPH::Reset()
     m_bus_name_to_code_map.clear();
     m_net_code_to_subgraphs_map.clear();
     m_net_name_to_subgraphs_map.clear();
-    m_item_to_subgraph_map.clear();
+    m_item_to_subgraphs_map.clear();
+    m_link_name_to_subgraphs_map.clear();
+    m_item_records.clear();
     m_local_label_cache.clear();
     m_global_label_cache.clear();
     m_last_net_code = 1;
@@ -386,33 +387,137 @@ void CONNECTION_GRAPH::Reset()
 
 void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnconditional )
 {
+    TRACE_ZONE( "CONNECTION_GRAPH::Recalculate", "schematic" );
     PROF_COUNTER recalc_time( "CONNECTION_GRAPH::Recalculate" );
 
-    if( aUnconditional )
-        Reset();
+    if( !aUnconditional )
+    {
+        PROF_COUNTER update_time( "updateIncrementally" );
+
+        bool updated = updateIncrementally( aSheetList );
+
+        if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
+            update_time.Show();
+
+        if( updated )
+        {
+            recalc_time.Stop();
+
+            if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
+                recalc_time.Show();
+
+            return;
+        }
+    }
+
+    Reset();
 
     PROF_COUNTER update_items( "updateItemConnectivity" );
 
     m_sheetList = aSheetList;
+    m_sheetNames.clear();
 
-    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    // Instances of a sheet share their screen and their items, so they are handled together.
+    // Items of different screens are independent and can be updated in parallel.
+    std::vector<std::vector<size_t>>        screen_sheets;
+    std::unordered_map<SCH_SCREEN*, size_t> screen_index;
+
+    for( size_t i = 0; i < aSheetList.size(); i++ )
     {
-        std::vector<SCH_ITEM*> items;
+        SCH_SCREEN* screen = aSheetList[i].LastScreen();
+        auto        it = screen_index.find( screen );
 
-        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        if( it == screen_index.end() )
+        {
+            screen_index[screen] = screen_sheets.size();
+            screen_sheets.push_back( { i } );
+        }
+        else
         {
-            if( item->IsConnectable() && ( aUnconditional || item->IsConnectivityDirty() ) )
-                items.push_back( item );
+            screen_sheets[it->second].push_back( i );
         }
 
-        m_items.reserve( m_items.size() + items.size() );
+        m_sheetNames.push_back( aSheetList[i].PathHumanReadable() );
+    }
+
+    std::vector<ITEM_BUFFER> buffers( aSheetList.size() );
+    std::atomic<size_t>      nextScreen( 0 );
+
+    auto update_lambda = [&]() -> size_t
+    {
+        TRACE_ZONE( "CONNECTION_GRAPH::updateItemConnectivity worker", "schematic" );
+
+        for( size_t ii = nextScreen++; ii < screen_sheets.size(); ii = nextScreen++ )
+        {
+            const std::vector<size_t>& sheets = screen_sheets[ii];
+            const SCH_SHEET_PATH&      first = aSheetList[sheets[0]];
+            std::vector<SCH_ITEM*>     items;
+
+            for( SCH_ITEM* item : first.LastScreen()->Items() )
+            {
+                if( item->IsConnectable() )
+                    items.push_back( item );
+            }
+
+            for( size_t sheet : sheets )
+                updateItemConnectivity( aSheetList[sheet], items, buffers[sheet] );
+
+            // UpdateDanglingState() also adds connected items for SCH_TEXT.  The dangling state
+            // is the same for all the instances, so only test the first one and copy the
+            // connections to the others.  Pins are skipped: they can change with the instance.
+            first.LastScreen()->TestDanglingEnds( &first );
+
+            for( size_t jj = 1; jj < sheets.size(); jj++ )
+            {
+                const SCH_SHEET_PATH& sheet = aSheetList[sheets[jj]];
+
+                for( SCH_ITEM* item : items )
+                {
+                    if( item->Type() != SCH_LABEL_T && item->Type() != SCH_GLOBAL_LABEL_T
+                            && item->Type() != SCH_HIER_LABEL_T )
+                    {
+                        continue;
+                    }
+
+                    for( SCH_ITEM* connected : item->ConnectedItems( first ) )
+                    {
+                        if( connected->Type() == SCH_PIN_T )
+                            continue;
+
+                        item->AddConnectionTo( sheet, connected );
+
+                        if( connected->Type() == SCH_LINE_T )
+                            connected->AddConnectionTo( sheet, item );
+                    }
+                }
+            }
+        }
+
+        return 1;
+    };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   screen_sheets.size() );
+
+    if( parallelThreadCount <= 1 )
+    {
+        update_lambda();
+    }
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
 
-        updateItemConnectivity( sheet, items );
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, update_lambda );
 
-        // UpdateDanglingState() also adds connected items for SCH_TEXT
-        sheet.LastScreen()->TestDanglingEnds( &sheet );
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
     }
 
+    // Keep the sheet order, so the subgraph and net codes don't depend on the threads
+    for( ITEM_BUFFER& buffer : buffers )
+        appendItemBuffer( buffer );
+
     if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
         update_items.Show();
 
@@ -427,42 +532,710 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 
     if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
         recalc_time.Show();
+}
 
-#ifndef DEBUG
-    // Pressure relief valve for release builds
-    const double max_recalc_time_msecs = 250.;
 
-    if( m_allowRealTime && ADVANCED_CFG::GetCfg().m_realTimeConnectivity &&
-        recalc_time.msecs() > max_recalc_time_msecs )
+bool CONNECTION_GRAPH::updateIncrementally( const SCH_SHEET_LIST& aSheetList )
+{
+    TRACE_ZONE( "CONNECTION_GRAPH::updateIncrementally", "schematic" );
+
+    using LINK = CONNECTION_SUBGRAPH::LINK;
+    using PRIORITY = CONNECTION_SUBGRAPH::PRIORITY;
+
+    // Subgraphs are linked across sheets by path, so any change to the hierarchy (including
+    // a renamed sheet, which renames its nets) needs a full update
+    if( m_sheetList.empty() || m_sheetList.size() != aSheetList.size() )
+        return false;
+
+    for( size_t i = 0; i < aSheetList.size(); i++ )
     {
-        m_allowRealTime = false;
+        if( aSheetList[i] != m_sheetList[i]
+                || aSheetList[i].PathHumanReadable() != m_sheetNames[i] )
+        {
+            return false;
+        }
     }
-#endif
+
+    auto graph_items =
+            []( SCH_ITEM* aItem, const SCH_SHEET_PATH& aSheet ) -> std::vector<SCH_ITEM*>
+            {
+                std::vector<SCH_ITEM*> items;
+
+                if( aItem->Type() == SCH_SHEET_T )
+                {
+                    for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( aItem )->GetPins() )
+                        items.push_back( pin );
+                }
+                else if( aItem->Type() == SCH_COMPONENT_T )
+                {
+                    for( SCH_PIN* pin : static_cast<SCH_COMPONENT*>( aItem )->GetPins( &aSheet ) )
+                        items.push_back( pin );
+                }
+                else
+                {
+                    items.push_back( aItem );
+                }
+
+                return items;
+            };
+
+    // Bus members are resolved through aliases and bus entries that are not tracked here
+    auto is_bus =
+            []( SCH_ITEM* aItem ) -> bool
+            {
+                switch( aItem->Type() )
+                {
+                case SCH_BUS_BUS_ENTRY_T:
+                case SCH_BUS_WIRE_ENTRY_T:
+                    return true;
+
+                case SCH_LINE_T:
+                    return aItem->GetLayer() == LAYER_BUS;
+
+                case SCH_LABEL_T:
+                case SCH_GLOBAL_LABEL_T:
+                case SCH_HIER_LABEL_T:
+                case SCH_SHEET_PIN_T:
+                    return SCH_CONNECTION::IsBusLabel(
+                            static_cast<SCH_TEXT*>( aItem )->GetShownText() );
+
+                case SCH_SHEET_T:
+                    for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( aItem )->GetPins() )
+                    {
+                        if( SCH_CONNECTION::IsBusLabel( pin->GetShownText() ) )
+                            return true;
+                    }
+
+                    return false;
+
+                default:
+                    return false;
+                }
+            };
+
+    // The sheets showing each screen, in the order of the sheet list
+    std::vector<SCH_SCREEN*>                                          screens;
+    std::unordered_map<SCH_SCREEN*, std::vector<const SCH_SHEET_PATH*>> screen_sheets;
+
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    {
+        std::vector<const SCH_SHEET_PATH*>& sheets = screen_sheets[sheet.LastScreen()];
+
+        if( sheets.empty() )
+            screens.push_back( sheet.LastScreen() );
+
+        sheets.push_back( &sheet );
+    }
+
+    // Compares the graph items of an item with its record, on every sheet showing it
+    auto same_graph_items =
+            [&]( SCH_ITEM* aItem, const ITEM_RECORD& aRecord ) -> bool
+            {
+                for( const SCH_SHEET_PATH* sheet : screen_sheets[aRecord.m_screen] )
+                {
+                    auto it = aRecord.m_graph_items.find( *sheet );
+
+                    if( it == aRecord.m_graph_items.end()
+                            || graph_items( aItem, *sheet ) != it->second )
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            };
+
+    // Find the changed and new items, on the first sheet showing them
+    std::vector<std::pair<SCH_ITEM*, const SCH_SHEET_PATH*>> changed;
+    std::unordered_set<SCH_ITEM*>                             present;
+    std::unordered_set<SCH_SCREEN*>                           changed_screens;
+
+    for( SCH_SCREEN* screen : screens )
+    {
+        const SCH_SHEET_PATH& sheet = *screen_sheets[screen].front();
+
+        for( SCH_ITEM* item : screen->Items() )
+        {
+            if( !item->IsConnectable() )
+                continue;
+
+            present.insert( item );
+
+            auto record = m_item_records.find( item );
+            bool dirty  = item->IsConnectivityDirty() || record == m_item_records.end()
+                          || record->second.m_screen != screen
+                          || !same_graph_items( item, record->second );
+
+            if( !dirty && item->Type() == SCH_SHEET_T )
+            {
+                for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
+                    dirty |= pin->IsConnectivityDirty();
+            }
+
+            if( !dirty )
+                continue;
+
+            if( is_bus( item ) )
+                return false;
+
+            changed.emplace_back( item, &sheet );
+            changed_screens.insert( screen );
+        }
+    }
+
+    std::vector<SCH_ITEM*> deleted;
+
+    for( const auto& record : m_item_records )
+    {
+        if( present.count( record.first ) )
+            continue;
+
+        if( record.second.m_bus )
+            return false;
+
+        deleted.push_back( record.first );
+        changed_screens.insert( record.second.m_screen );
+    }
+
+    if( changed.empty() && deleted.empty() )
+        return true;
+
+    // Past some point, rebuilding everything is cheaper than working out what to rebuild
+    if( ( changed.size() + deleted.size() ) * 2 > present.size() )
+        return false;
+
+    // Collect the subgraphs to rebuild: those of the changed and deleted items, of the items
+    // the changed ones may now touch, and of the names the changed items now carry
+    std::unordered_set<SCH_ITEM*>            replaced;
+    std::unordered_set<CONNECTION_SUBGRAPH*> affected;
+    std::vector<CONNECTION_SUBGRAPH*>        to_visit;
+
+    auto add_subgraph =
+            [&]( CONNECTION_SUBGRAPH* aSubgraph )
+            {
+                if( affected.insert( aSubgraph ).second )
+                    to_visit.push_back( aSubgraph );
+            };
+
+    auto add_subgraphs_of =
+            [&]( SCH_ITEM* aGraphItem )
+            {
+                auto it = m_item_to_subgraphs_map.find( aGraphItem );
+
+                if( it != m_item_to_subgraphs_map.end() )
+                {
+                    for( CONNECTION_SUBGRAPH* subgraph : it->second )
+                        add_subgraph( subgraph );
+                }
+            };
+
+    auto add_subgraphs_named =
+            [&]( const wxString& aName )
+            {
+                auto it = m_link_name_to_subgraphs_map.find( aName );
+
+                if( it != m_link_name_to_subgraphs_map.end() )
+                {
+                    for( CONNECTION_SUBGRAPH* subgraph : it->second )
+                        add_subgraph( subgraph );
+                }
+            };
+
+    auto replace =
+            [&]( SCH_ITEM* aItem )
+            {
+                auto record = m_item_records.find( aItem );
+
+                if( record == m_item_records.end() )
+                    return;
+
+                for( const auto& sheet_items : record->second.m_graph_items )
+                {
+                    for( SCH_ITEM* graph_item : sheet_items.second )
+                    {
+                        replaced.insert( graph_item );
+                        add_subgraphs_of( graph_item );
+                    }
+                }
+            };
+
+    for( const auto& entry : changed )
+        replace( entry.first );
+
+    for( SCH_ITEM* item : deleted )
+        replace( item );
+
+    for( const auto& entry : changed )
+    {
+        SCH_ITEM*             item  = entry.first;
+        const SCH_SHEET_PATH& sheet = *entry.second;
+
+        // Labels connect anywhere along a wire, so look at the whole item area
+        for( SCH_ITEM* other : sheet.LastScreen()->Items().Overlapping( item->GetBoundingBox() ) )
+        {
+            if( other == item || !other->IsConnectable() )
+                continue;
+
+            auto record = m_item_records.find( other );
+
+            if( record != m_item_records.end() )
+            {
+                for( const auto& sheet_items : record->second.m_graph_items )
+                {
+                    for( SCH_ITEM* graph_item : sheet_items.second )
+                        add_subgraphs_of( graph_item );
+                }
+            }
+        }
+
+        for( const SCH_SHEET_PATH* instance : screen_sheets[sheet.LastScreen()] )
+        {
+            for( SCH_ITEM* graph_item : graph_items( item, *instance ) )
+            {
+                switch( graph_item->Type() )
+                {
+                case SCH_LABEL_T:
+                case SCH_GLOBAL_LABEL_T:
+                case SCH_HIER_LABEL_T:
+                case SCH_SHEET_PIN_T:
+                    add_subgraphs_named( EscapeString(
+                            static_cast<SCH_TEXT*>( graph_item )->GetShownText(), CTX_NETNAME ) );
+                    break;
+
+                case SCH_PIN_T:
+                {
+                    SCH_PIN* pin = static_cast<SCH_PIN*>( graph_item );
+
+                    if( pin->IsPowerConnection() )
+                        add_subgraphs_named( pin->GetDefaultNetName( *instance ) );
+
+                    break;
+                }
+
+                default:
+                    break;
+                }
+            }
+        }
+    }
+
+    auto pin_to_port =
+            []( const CONNECTION_SUBGRAPH* aPinSubgraph, const LINK& aPin,
+                const CONNECTION_SUBGRAPH* aPortSubgraph, const LINK& aPort ) -> bool
+            {
+                if( aPin.m_priority != PRIORITY::SHEET_PIN || aPort.m_priority != PRIORITY::HIER_LABEL )
+                    return false;
+
+                SCH_SHEET_PATH path = aPinSubgraph->m_sheet;
+                path.push_back( aPin.m_sheet );
+
+                return path == aPortSubgraph->m_sheet;
+            };
+
+    auto linked =
+            [&]( const CONNECTION_SUBGRAPH* aSubgraph, const LINK& aLink,
+                 const CONNECTION_SUBGRAPH* aOther, const LINK& aOtherLink ) -> bool
+            {
+                if( aLink.m_name != aOtherLink.m_name )
+                    return false;
+
+                // Global labels and power pins reach the whole schematic
+                if( aLink.m_priority >= PRIORITY::POWER_PIN
+                        && aOtherLink.m_priority >= PRIORITY::POWER_PIN )
+                {
+                    return true;
+                }
+
+                if( aSubgraph->m_sheet == aOther->m_sheet )
+                    return true;
+
+                return pin_to_port( aSubgraph, aLink, aOther, aOtherLink )
+                        || pin_to_port( aOther, aOtherLink, aSubgraph, aLink );
+            };
+
+    // Anything linked to a rebuilt subgraph may get a new name or be merged with it, so it
+    // has to be rebuilt as well
+    while( !to_visit.empty() )
+    {
+        CONNECTION_SUBGRAPH* subgraph = to_visit.back();
+        to_visit.pop_back();
+
+        if( subgraph->m_link_bus || affected.size() * 2 > m_subgraphs.size() )
+            return false;
+
+        for( const LINK& link : subgraph->m_links )
+        {
+            auto it = m_link_name_to_subgraphs_map.find( link.m_name );
+
+            if( it == m_link_name_to_subgraphs_map.end() )
+                continue;
+
+            for( CONNECTION_SUBGRAPH* candidate : it->second )
+            {
+                if( affected.count( candidate ) )
+                    continue;
+
+                for( const LINK& candidate_link : candidate->m_links )
+                {
+                    if( linked( subgraph, link, candidate, candidate_link ) )
+                    {
+                        add_subgraph( candidate );
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Gather the items to rebuild, sheet by sheet.  Pins of unchanged symbols and sheets are
+    // rebuilt on their own.
+    std::map<SCH_SHEET_PATH, std::vector<SCH_ITEM*>> rebuild;
+
+    for( CONNECTION_SUBGRAPH* subgraph : affected )
+    {
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            if( !replaced.count( item ) )
+                rebuild[subgraph->m_sheet].push_back( item );
+        }
+    }
+
+    for( const auto& entry : changed )
+    {
+        for( const SCH_SHEET_PATH& sheet : aSheetList )
+        {
+            if( sheet.LastScreen() == entry.second->LastScreen() )
+                rebuild[sheet].push_back( entry.first );
+        }
+    }
+
+    CONNECTION_GRAPH update( m_schematic );
+
+    update.m_last_net_code = m_last_net_code;
+    update.m_last_bus_code = m_last_bus_code;
+    update.m_last_subgraph_code = m_last_subgraph_code;
+
+    // Keep the codes of the existing nets
+    std::swap( update.m_net_name_to_code_map, m_net_name_to_code_map );
+    std::swap( update.m_bus_name_to_code_map, m_bus_name_to_code_map );
+
+    for( auto& it : rebuild )
+        update.updateItemConnectivity( it.first, it.second );
+
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    {
+        // TestDanglingEnds() also adds connected items for SCH_TEXT
+        if( rebuild.count( sheet ) || changed_screens.count( sheet.LastScreen() ) )
+            sheet.LastScreen()->TestDanglingEnds( &sheet );
+    }
+
+    update.buildConnectionGraph();
+
+    std::swap( update.m_net_name_to_code_map, m_net_name_to_code_map );
+    std::swap( update.m_bus_name_to_code_map, m_bus_name_to_code_map );
+
+    // The rebuilt subgraphs must not reach the ones left in place, and net names are only
+    // made unique within the rebuilt part: let a full update sort out anything else
+    for( CONNECTION_SUBGRAPH* subgraph : update.m_subgraphs )
+    {
+        if( subgraph->m_link_bus )
+            return false;
+
+        for( const LINK& link : subgraph->m_links )
+        {
+            auto it = m_link_name_to_subgraphs_map.find( link.m_name );
+
+            if( it == m_link_name_to_subgraphs_map.end() )
+                continue;
+
+            for( CONNECTION_SUBGRAPH* candidate : it->second )
+            {
+                if( affected.count( candidate ) )
+                    continue;
+
+                for( const LINK& candidate_link : candidate->m_links )
+                {
+                    if( linked( subgraph, link, candidate, candidate_link ) )
+                        return false;
+                }
+            }
+        }
+    }
+
+    for( CONNECTION_SUBGRAPH* subgraph : update.m_driver_subgraphs )
+    {
+        auto it = m_net_name_to_subgraphs_map.find( subgraph->m_driver_connection->Name() );
+
+        if( it == m_net_name_to_subgraphs_map.end() )
+            continue;
+
+        for( CONNECTION_SUBGRAPH* candidate : it->second )
+        {
+            if( !affected.count( candidate ) )
+                return false;
+        }
+    }
+
+    m_invisible_power_pins.erase(
+            std::remove_if( m_invisible_power_pins.begin(), m_invisible_power_pins.end(),
+                    [&]( const std::pair<SCH_SHEET_PATH, SCH_PIN*>& aEntry ) -> bool
+                    {
+                        if( replaced.count( aEntry.second ) )
+                            return true;
+
+                        auto it = rebuild.find( aEntry.first );
+
+                        return it != rebuild.end()
+                                && std::find( it->second.begin(), it->second.end(),
+                                              aEntry.second ) != it->second.end();
+                    } ),
+            m_invisible_power_pins.end() );
+
+    for( SCH_ITEM* item : deleted )
+        m_item_records.erase( item );
+
+    removeSubgraphs( affected );
+    merge( update );
+
+    wxLogTrace( "CONN", "Incremental update: %lu changed, %lu deleted, %lu subgraphs rebuilt",
+                changed.size(), deleted.size(), affected.size() );
+
+    return true;
+}
+
+
+void CONNECTION_GRAPH::removeSubgraphs( const std::unordered_set<CONNECTION_SUBGRAPH*>& aSubgraphs )
+{
+    auto removed =
+            [&]( const CONNECTION_SUBGRAPH* aSubgraph ) -> bool
+            {
+                return aSubgraphs.count( const_cast<CONNECTION_SUBGRAPH*>( aSubgraph ) ) > 0;
+            };
+
+    auto remove_from =
+            [&]( auto& aVec )
+            {
+                aVec.erase( std::remove_if( aVec.begin(), aVec.end(), removed ), aVec.end() );
+            };
+
+    auto remove_from_map =
+            [&]( auto& aMap )
+            {
+                for( auto it = aMap.begin(); it != aMap.end(); )
+                {
+                    remove_from( it->second );
+
+                    if( it->second.empty() )
+                        it = aMap.erase( it );
+                    else
+                        ++it;
+                }
+            };
+
+    auto remove_from_key =
+            [&]( auto& aMap, const auto& aKey )
+            {
+                auto it = aMap.find( aKey );
+
+                if( it == aMap.end() )
+                    return;
+
+                remove_from( it->second );
+
+                if( it->second.empty() )
+                    aMap.erase( it );
+            };
+
+    remove_from( m_subgraphs );
+    remove_from( m_driver_subgraphs );
+    remove_from_map( m_sheet_to_subgraphs_map );
+    remove_from_map( m_net_code_to_subgraphs_map );
+    remove_from_map( m_local_label_cache );
+    remove_from_map( m_global_label_cache );
+
+    for( CONNECTION_SUBGRAPH* subgraph : aSubgraphs )
+    {
+        // Items may be gone already, they are only used as keys
+        for( SCH_ITEM* item : subgraph->m_items )
+            remove_from_key( m_item_to_subgraphs_map, item );
+
+        for( const CONNECTION_SUBGRAPH::LINK& link : subgraph->m_links )
+            remove_from_key( m_link_name_to_subgraphs_map, link.m_name );
+
+        // The driver may be gone as well, so use the name cached with the links
+        if( !subgraph->m_link_net_name.IsEmpty() )
+            remove_from_key( m_net_name_to_subgraphs_map, subgraph->m_link_net_name );
+    }
+
+    for( CONNECTION_SUBGRAPH* subgraph : aSubgraphs )
+        delete subgraph;
+}
+
+
+void CONNECTION_GRAPH::merge( CONNECTION_GRAPH& aGraph )
+{
+    auto append =
+            []( auto& aTo, const auto& aFrom )
+            {
+                aTo.insert( aTo.end(), aFrom.begin(), aFrom.end() );
+            };
+
+    auto append_map =
+            [&]( auto& aTo, const auto& aFrom )
+            {
+                for( const auto& it : aFrom )
+                    append( aTo[it.first], it.second );
+            };
+
+    for( CONNECTION_SUBGRAPH* subgraph : aGraph.m_subgraphs )
+    {
+        subgraph->m_graph = this;
+
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            if( SCH_CONNECTION* connection = item->Connection( subgraph->m_sheet ) )
+                connection->SetGraph( this );
+        }
+    }
+
+    append( m_subgraphs, aGraph.m_subgraphs );
+    append( m_driver_subgraphs, aGraph.m_driver_subgraphs );
+    append( m_invisible_power_pins, aGraph.m_invisible_power_pins );
+    append_map( m_sheet_to_subgraphs_map, aGraph.m_sheet_to_subgraphs_map );
+    append_map( m_net_name_to_subgraphs_map, aGraph.m_net_name_to_subgraphs_map );
+    append_map( m_net_code_to_subgraphs_map, aGraph.m_net_code_to_subgraphs_map );
+    append_map( m_local_label_cache, aGraph.m_local_label_cache );
+    append_map( m_global_label_cache, aGraph.m_global_label_cache );
+    append_map( m_item_to_subgraphs_map, aGraph.m_item_to_subgraphs_map );
+    append_map( m_link_name_to_subgraphs_map, aGraph.m_link_name_to_subgraphs_map );
+
+    for( auto& it : aGraph.m_item_records )
+        mergeItemRecord( it.first, it.second );
+
+    std::swap( m_bus_alias_cache, aGraph.m_bus_alias_cache );
+
+    m_last_net_code = aGraph.m_last_net_code;
+    m_last_bus_code = aGraph.m_last_bus_code;
+    m_last_subgraph_code = aGraph.m_last_subgraph_code;
+
+    // The subgraphs belong to this graph now
+    aGraph.m_subgraphs.clear();
+    aGraph.m_driver_subgraphs.clear();
+}
+
+
+void CONNECTION_GRAPH::appendItemBuffer( ITEM_BUFFER& aBuffer )
+{
+    m_items.insert( m_items.end(), aBuffer.m_items.begin(), aBuffer.m_items.end() );
+
+    m_invisible_power_pins.insert( m_invisible_power_pins.end(),
+                                   aBuffer.m_invisible_power_pins.begin(),
+                                   aBuffer.m_invisible_power_pins.end() );
+
+    for( auto& it : aBuffer.m_item_records )
+        mergeItemRecord( it.first, it.second );
+}
+
+
+void CONNECTION_GRAPH::mergeItemRecord( SCH_ITEM* aItem, ITEM_RECORD& aRecord )
+{
+    ITEM_RECORD& record = m_item_records[aItem];
+
+    // An item moved to another screen is not on the sheets of the previous one anymore
+    if( record.m_screen != aRecord.m_screen )
+        record.m_graph_items.clear();
+
+    record.m_screen = aRecord.m_screen;
+    record.m_bus = aRecord.m_bus;
+
+    // A partial update only rebuilds some of the sheets of an item
+    for( auto& it : aRecord.m_graph_items )
+        record.m_graph_items[it.first] = std::move( it.second );
 }
 
 
 void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                                                const std::vector<SCH_ITEM*>& aItemList )
+{
+    ITEM_BUFFER buffer;
+
+    updateItemConnectivity( aSheet, aItemList, buffer );
+    appendItemBuffer( buffer );
+}
+
+
+void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
+                                               const std::vector<SCH_ITEM*>& aItemList,
+                                               ITEM_BUFFER& aBuffer )
 {
     std::map< wxPoint, std::vector<SCH_ITEM*> > connection_map;
 
+    auto add_sheet_pin =
+            [&]( SCH_SHEET_PIN* aPin )
+            {
+                aPin->InitializeConnection( aSheet, this );
+                aPin->ConnectedItems( aSheet ).clear();
+                aPin->SetConnectivityDirty( false );
+
+                connection_map[ aPin->GetTextPos() ].push_back( aPin );
+                aBuffer.m_items.emplace_back( aPin );
+            };
+
+    auto add_symbol_pin =
+            [&]( SCH_PIN* aPin )
+            {
+                aPin->InitializeConnection( aSheet, this );
+
+                wxPoint pos = aPin->GetPosition();
+
+                // because calling the first time is not thread-safe
+                aPin->GetDefaultNetName( aSheet );
+                aPin->ConnectedItems( aSheet ).clear();
+
+                // Invisible power pins need to be post-processed later
+
+                if( aPin->IsPowerConnection() && !aPin->IsVisible() )
+                    aBuffer.m_invisible_power_pins.emplace_back( std::make_pair( aSheet, aPin ) );
+
+                connection_map[ pos ].push_back( aPin );
+                aBuffer.m_items.emplace_back( aPin );
+            };
+
     for( SCH_ITEM* item : aItemList )
     {
         std::vector< wxPoint > points = item->GetConnectionPoints();
         item->ConnectedItems( aSheet ).clear();
 
+        // Pins are only given directly when a part of the graph is rebuilt, otherwise they
+        // come with their symbol or sheet
+        if( item->Type() == SCH_SHEET_PIN_T )
+        {
+            add_sheet_pin( static_cast<SCH_SHEET_PIN*>( item ) );
+            continue;
+        }
+        else if( item->Type() == SCH_PIN_T )
+        {
+            add_symbol_pin( static_cast<SCH_PIN*>( item ) );
+            item->SetConnectivityDirty( false );
+            continue;
+        }
+
+        // Shared screens give the same items on several sheets, each one has its graph items
+        ITEM_RECORD&            record = aBuffer.m_item_records[item];
+        std::vector<SCH_ITEM*>& graph_items = record.m_graph_items[aSheet];
+
+        graph_items.clear();
+        record.m_screen = aSheet.LastScreen();
+        record.m_bus = ( item->Type() == SCH_BUS_BUS_ENTRY_T
+                         || item->Type() == SCH_BUS_WIRE_ENTRY_T
+                         || ( item->Type() == SCH_LINE_T && item->GetLayer() == LAYER_BUS ) );
+
         if( item->Type() == SCH_SHEET_T )
         {
             for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
             {
-                if( !pin->Connection( aSheet ) )
-                    pin->InitializeConnection( aSheet, this );
-
-                pin->ConnectedItems( aSheet ).clear();
-                pin->Connection( aSheet )->Reset();
-
-                connection_map[ pin->GetTextPos() ].push_back( pin );
-                m_items.emplace_back( pin );
+                add_sheet_pin( pin );
+                graph_items.push_back( pin );
             }
         }
         else if( item->Type() == SCH_COMPONENT_T )
@@ -478,28 +1251,17 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
 
             for( SCH_PIN* pin : component->GetPins( &aSheet ) )
             {
-                pin->InitializeConnection( aSheet, this );
-
-                wxPoint pos = pin->GetPosition();
-
-                // because calling the first time is not thread-safe
-                pin->GetDefaultNetName( aSheet );
-                pin->ConnectedItems( aSheet ).clear();
-
-                // Invisible power pins need to be post-processed later
-
-                if( pin->IsPowerConnection() && !pin->IsVisible() )
-                    m_invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
-
-                connection_map[ pos ].push_back( pin );
-                m_items.emplace_back( pin );
+                add_symbol_pin( pin );
+                graph_items.push_back( pin );
             }
         }
         else
         {
-            m_items.emplace_back( item );
+            aBuffer.m_items.emplace_back( item );
             auto conn = item->InitializeConnection( aSheet, this );
 
+            graph_items.push_back( item );
+
             // Set bus/net property here so that the propagation code uses it
             switch( item->Type() )
             {
@@ -515,10 +1277,6 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                 static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[1] = nullptr;
                 break;
 
-            case SCH_PIN_T:
-                conn->SetType( CONNECTION_TYPE::NET );
-                break;
-
             case SCH_BUS_WIRE_ENTRY_T:
                 conn->SetType( CONNECTION_TYPE::NET );
                 // clean previous (old) link:
@@ -659,6 +1417,8 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
 
 void CONNECTION_GRAPH::buildConnectionGraph()
 {
+    TRACE_ZONE( "CONNECTION_GRAPH::buildConnectionGraph", "schematic" );
+
     // Recache all bus aliases for later use
     wxCHECK_RET( m_schematic, "Connection graph cannot be built without schematic pointer" );
 
@@ -689,7 +1449,7 @@ void CONNECTION_GRAPH::buildConnectionGraph()
                 subgraph->AddItem( item );
 
                 connection->SetSubgraphCode( subgraph->m_code );
-                m_item_to_subgraph_map[item] = subgraph;
+                m_item_to_subgraphs_map[item].push_back( subgraph );
 
                 std::list<SCH_ITEM*> members;
 
@@ -720,7 +1480,7 @@ void CONNECTION_GRAPH::buildConnectionGraph()
                     if( connected_conn->SubgraphCode() == 0 )
                     {
                         connected_conn->SetSubgraphCode( subgraph->m_code );
-                        m_item_to_subgraph_map[connected_item] = subgraph;
+                        m_item_to_subgraphs_map[connected_item].push_back( subgraph );
                         subgraph->AddItem( connected_item );
 
                         std::copy_if( connected_item->ConnectedItems( sheet ).begin(),
@@ -773,6 +1533,8 @@ void CONNECTION_GRAPH::buildConnectionGraph()
 
     auto update_lambda = [&nextSubgraph, &dirty_graphs]() -> size_t
     {
+        TRACE_ZONE( "CONNECTION_GRAPH::buildConnectionGraph worker", "schematic" );
+
         for( size_t subgraphId = nextSubgraph++; subgraphId < dirty_graphs.size(); subgraphId = nextSubgraph++ )
         {
             auto subgraph = dirty_graphs[subgraphId];
@@ -1483,7 +2245,104 @@ void CONNECTION_GRAPH::buildConnectionGraph()
         m_net_name_to_subgraphs_map[subgraph->m_driver_connection->Name()].push_back( subgraph );
     }
 
-    // Clean up and deallocate stale subgraphs
+    cacheSubgraphLinks();
+
+    // The item list is only needed while building
+    m_items.clear();
+}
+
+
+void CONNECTION_GRAPH::cacheSubgraphLinks()
+{
+    auto remap =
+            []( auto& aVec )
+            {
+                typename std::remove_reference<decltype( aVec )>::type remapped;
+
+                for( auto subgraph : aVec )
+                {
+                    while( subgraph->m_absorbed )
+                        subgraph = subgraph->m_absorbed_by;
+
+                    if( std::find( remapped.begin(), remapped.end(), subgraph ) == remapped.end() )
+                        remapped.push_back( subgraph );
+                }
+
+                aVec = std::move( remapped );
+            };
+
+    // Absorbed subgraphs are about to be deleted: point the caches to the subgraphs that
+    // absorbed them instead
+    for( auto& it : m_item_to_subgraphs_map )
+        remap( it.second );
+
+    for( auto& it : m_local_label_cache )
+        remap( it.second );
+
+    for( auto& it : m_global_label_cache )
+        remap( it.second );
+
+    for( auto it = m_net_name_to_subgraphs_map.begin(); it != m_net_name_to_subgraphs_map.end(); )
+    {
+        auto& vec = it->second;
+
+        vec.erase( std::remove_if( vec.begin(), vec.end(),
+                                   []( const CONNECTION_SUBGRAPH* aSubgraph )
+                                   {
+                                       return aSubgraph->m_absorbed;
+                                   } ),
+                   vec.end() );
+
+        if( vec.empty() )
+            it = m_net_name_to_subgraphs_map.erase( it );
+        else
+            ++it;
+    }
+
+    for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        if( subgraph->m_absorbed )
+            continue;
+
+        subgraph->m_links.clear();
+        subgraph->m_link_bus = subgraph->m_bus_entry || !subgraph->m_bus_neighbors.empty()
+                               || !subgraph->m_bus_parents.empty();
+
+        if( subgraph->m_driver_connection )
+            subgraph->m_link_net_name = subgraph->m_driver_connection->Name();
+        else
+            subgraph->m_link_net_name.clear();
+
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            SCH_CONNECTION* conn = item->Connection( subgraph->m_sheet );
+
+            if( conn && conn->IsBus() )
+                subgraph->m_link_bus = true;
+
+            CONNECTION_SUBGRAPH::PRIORITY priority = CONNECTION_SUBGRAPH::GetDriverPriority( item );
+
+            if( priority < CONNECTION_SUBGRAPH::PRIORITY::SHEET_PIN )
+                continue;
+
+            CONNECTION_SUBGRAPH::LINK link;
+
+            link.m_name = subgraph->GetNameForDriver( item );
+            link.m_priority = priority;
+            link.m_sheet = nullptr;
+
+            if( item->Type() == SCH_SHEET_PIN_T )
+                link.m_sheet = static_cast<SCH_SHEET_PIN*>( item )->GetParent();
+
+            subgraph->m_links.push_back( link );
+
+            auto& vec = m_link_name_to_subgraphs_map[link.m_name];
+
+            if( vec.empty() || vec.back() != subgraph )
+                vec.push_back( subgraph );
+        }
+    }
+
     m_subgraphs.erase( std::remove_if( m_subgraphs.begin(), m_subgraphs.end(),
             [&]( const CONNECTION_SUBGRAPH* sg )
             {
@@ -2010,71 +2869,88 @@ CONNECTION_SUBGRAPH* CONNECTION_GRAPH::FindFirstSubgraphByName( const wxString&
 
 CONNECTION_SUBGRAPH* CONNECTION_GRAPH::GetSubgraphForItem( SCH_ITEM* aItem )
 {
-    if( !m_item_to_subgraph_map.count( aItem ) )
-        return nullptr;
-
-    CONNECTION_SUBGRAPH* ret = m_item_to_subgraph_map.at( aItem );
+    auto it = m_item_to_subgraphs_map.find( aItem );
 
-    while( ret->m_absorbed )
-        ret = ret->m_absorbed_by;
+    if( it == m_item_to_subgraphs_map.end() || it->second.empty() )
+        return nullptr;
 
-    return ret;
+    return it->second.front();
 }
 
 
 int CONNECTION_GRAPH::RunERC()
 {
-    int error_count = 0;
+    std::atomic<int> error_count( 0 );
 
     wxCHECK_MSG( m_schematic, true, "Null m_schematic in CONNECTION_GRAPH::ercCheckLabels" );
 
     ERC_SETTINGS& settings = m_schematic->ErcSettings();
 
-    for( auto&& subgraph : m_subgraphs )
+    // Graph is supposed to be up-to-date before calling RunERC()
+    wxASSERT( std::none_of( m_subgraphs.begin(), m_subgraphs.end(),
+                            []( const CONNECTION_SUBGRAPH* aSubgraph )
+                            {
+                                return aSubgraph->m_dirty;
+                            } ) );
+
+    // Resolving the drivers rewrites them, and the checks below read the drivers of other
+    // subgraphs (e.g. the hierarchical parent), so this is done before the parallel pass
+    if( settings.IsTestEnabled( ERCE_DRIVER_CONFLICT ) )
     {
-        // Graph is supposed to be up-to-date before calling RunERC()
-        wxASSERT( !subgraph->m_dirty );
+        for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+        {
+            if( !subgraph->ResolveDrivers() )
+                error_count++;
+        }
+    }
 
-        /**
-         * NOTE:
-         *
-         * We could check that labels attached to bus subgraphs follow the
-         * proper format (i.e. actually define a bus).
-         *
-         * This check doesn't need to be here right now because labels
-         * won't actually be connected to bus wires if they aren't in the right
-         * format due to their TestDanglingEnds() implementation.
-         */
+    // Subgraphs are checked independently and read-only, the markers are collected and added
+    // to the screens once all the checks are done
+    ErcParallelFor( m_subgraphs.size(),
+            [&]( size_t aIndex )
+            {
+                CONNECTION_SUBGRAPH* subgraph = m_subgraphs[aIndex];
 
-        if( settings.IsTestEnabled( ERCE_DRIVER_CONFLICT ) && !subgraph->ResolveDrivers() )
-            error_count++;
+                /**
+                 * NOTE:
+                 *
+                 * We could check that labels attached to bus subgraphs follow the
+                 * proper format (i.e. actually define a bus).
+                 *
+                 * This check doesn't need to be here right now because labels
+                 * won't actually be connected to bus wires if they aren't in the right
+                 * format due to their TestDanglingEnds() implementation.
+                 */
 
-        if( settings.IsTestEnabled( ERCE_BUS_TO_NET_CONFLICT )
-                && !ercCheckBusToNetConflicts( subgraph ) )
-            error_count++;
+                if( settings.IsTestEnabled( ERCE_BUS_TO_NET_CONFLICT )
+                        && !ercCheckBusToNetConflicts( subgraph ) )
+                    error_count++;
 
-        if( settings.IsTestEnabled( ERCE_BUS_ENTRY_CONFLICT )
-                && !ercCheckBusToBusEntryConflicts( subgraph ) )
-            error_count++;
+                if( settings.IsTestEnabled( ERCE_BUS_ENTRY_CONFLICT )
+                        && !ercCheckBusToBusEntryConflicts( subgraph ) )
+                    error_count++;
 
-        if( settings.IsTestEnabled( ERCE_BUS_TO_BUS_CONFLICT )
-                && !ercCheckBusToBusConflicts( subgraph ) )
-            error_count++;
+                if( settings.IsTestEnabled( ERCE_BUS_TO_BUS_CONFLICT )
+                        && !ercCheckBusToBusConflicts( subgraph ) )
+                    error_count++;
 
-        if( settings.IsTestEnabled( ERCE_WIRE_DANGLING )
-            && !ercCheckFloatingWires( subgraph ) )
-            error_count++;
+                if( settings.IsTestEnabled( ERCE_WIRE_DANGLING )
+                    && !ercCheckFloatingWires( subgraph ) )
+                    error_count++;
 
-        // The following checks are always performed since they don't currently
-        // have an option exposed to the user
+                // The following checks are always performed since they don't currently
+                // have an option exposed to the user
 
-        if( !ercCheckNoConnects( subgraph ) )
-            error_count++;
+                if( !ercCheckNoConnects( subgraph ) )
+                    error_count++;
 
-        if( ( settings.IsTestEnabled( ERCE_LABEL_NOT_CONNECTED )
-                || settings.IsTestEnabled( ERCE_GLOBLABEL ) ) && !ercCheckLabels( subgraph ) )
-            error_count++;
-    }
+                if( ( settings.IsTestEnabled( ERCE_LABEL_NOT_CONNECTED )
+                        || settings.IsTestEnabled( ERCE_GLOBLABEL ) )
+                        && !ercCheckLabels( subgraph ) )
+                    error_count++;
+            } );
+
+    m_ercMarkers.Flush();
 
     // Hierarchical sheet checking is done at the schematic level
     if( settings.IsTestEnabled( ERCE_HIERACHICAL_LABEL ) )
@@ -2130,8 +3006,7 @@ bool CONNECTION_GRAPH::ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSu
         std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_BUS_TO_NET_CONFLICT );
         ercItem->SetItems( net_item, bus_item );
 
-        SCH_MARKER* marker = new SCH_MARKER( ercItem, net_item->GetPosition() );
-        screen->Append( marker );
+        m_ercMarkers.Add( aSubgraph->m_code, screen, ercItem, net_item->GetPosition() );
 
         return false;
     }
@@ -2198,8 +3073,7 @@ bool CONNECTION_GRAPH::ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSu
             std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_BUS_TO_BUS_CONFLICT );
             ercItem->SetItems( label, port );
 
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, label->GetPosition() );
-            screen->Append( marker );
+            m_ercMarkers.Add( aSubgraph->m_code, screen, ercItem, label->GetPosition() );
 
             return false;
         }
@@ -2278,8 +3152,7 @@ bool CONNECTION_GRAPH::ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH
         std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_BUS_ENTRY_CONFLICT );
         ercItem->SetItems( bus_entry, bus_wire );
 
-        SCH_MARKER* marker = new SCH_MARKER( ercItem, bus_entry->GetPosition() );
-        screen->Append( marker );
+        m_ercMarkers.Add( aSubgraph->m_code, screen, ercItem, bus_entry->GetPosition() );
 
         return false;
     }
@@ -2332,8 +3205,8 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
             std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_NOCONNECT_CONNECTED );
             ercItem->SetItems( pin );
 
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, pin->GetTransformedPosition() );
-            screen->Append( marker );
+            m_ercMarkers.Add( aSubgraph->m_code, screen, ercItem,
+                              pin->GetTransformedPosition() );
 
             ok = false;
         }
@@ -2343,8 +3216,8 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
             std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_NOCONNECT_NOT_CONNECTED );
             ercItem->SetItems( aSubgraph->m_no_connect );
 
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, aSubgraph->m_no_connect->GetPosition() );
-            screen->Append( marker );
+            m_ercMarkers.Add( aSubgraph->m_code, screen, ercItem,
+                              aSubgraph->m_no_connect->GetPosition() );
 
             ok = false;
         }
@@ -2407,8 +3280,8 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
             std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_PIN_NOT_CONNECTED );
             ercItem->SetItems( pin );
 
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, pin->GetTransformedPosition() );
-            screen->Append( marker );
+            m_ercMarkers.Add( aSubgraph->m_code, screen, ercItem,
+                              pin->GetTransformedPosition() );
 
             ok = false;
         }
@@ -2429,9 +3302,8 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
                     std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_PIN_NOT_CONNECTED );
                     ercItem->SetItems( testPin );
 
-                    SCH_MARKER* marker = new SCH_MARKER( ercItem,
-                                                         testPin->GetTransformedPosition() );
-                    screen->Append( marker );
+                    m_ercMarkers.Add( aSubgraph->m_code, screen, ercItem,
+                                      testPin->GetTransformedPosition() );
 
                     ok = false;
                 }
@@ -2469,8 +3341,7 @@ bool CONNECTION_GRAPH::ercCheckFloatingWires( const CONNECTION_SUBGRAPH* aSubgra
                            wires.size() > 2 ? wires[2] : nullptr,
                            wires.size() > 3 ? wires[3] : nullptr );
 
-        SCH_MARKER* marker = new SCH_MARKER( ercItem, wires[0]->GetPosition() );
-        screen->Append( marker );
+        m_ercMarkers.Add( aSubgraph->m_code, screen, ercItem, wires[0]->GetPosition() );
 
         return false;
     }
@@ -2567,8 +3438,8 @@ bool CONNECTION_GRAPH::ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph )
                                                                        : ERCE_LABEL_NOT_CONNECTED );
         ercItem->SetItems( text );
 
-        SCH_MARKER* marker = new SCH_MARKER( ercItem, text->GetPosition() );
-        aSubgraph->m_sheet.LastScreen()->Append( marker );
+        m_ercMarkers.Add( aSubgraph->m_code, aSubgraph->m_sheet.LastScreen(), ercItem,
+                          text->GetPosition() );
 
         return false;
     }
@@ -22,9 +22,12 @@
 #define _CONNECTION_GRAPH_H
 
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <common.h>
+#include <erc.h>
 #include <erc_settings.h>
 #include <sch_connection.h>
 #include <sch_item.h>
@@ -41,6 +44,8 @@ class SCHEMATIC;
 class SCH_EDIT_FRAME;
 class SCH_HIERLABEL;
 class SCH_PIN;
+class SCH_SCREEN;
+class SCH_SHEET;
 class SCH_SHEET_PIN;
 
 
@@ -72,6 +77,17 @@ public:
         GLOBAL
     };
 
+    /**
+     * A name by which a subgraph can be connected to other subgraphs: a label, a power pin
+     * or a sheet pin.
+     */
+    struct LINK
+    {
+        wxString   m_name;
+        PRIORITY   m_priority;
+        SCH_SHEET* m_sheet;         ///< For sheet pins, the sheet the pin belongs to
+    };
+
     explicit CONNECTION_SUBGRAPH( CONNECTION_GRAPH* aGraph ) :
               m_graph( aGraph ),
               m_dirty( false ),
@@ -85,7 +101,8 @@ public:
               m_bus_entry( nullptr ),
               m_driver( nullptr ),
               m_driver_connection( nullptr ),
-              m_hier_parent( nullptr )
+              m_hier_parent( nullptr ),
+              m_link_bus( false )
     {}
 
     ~CONNECTION_SUBGRAPH() = default;
@@ -209,6 +226,18 @@ public:
 
     /// A cache of escaped netnames from schematic items
     std::unordered_map<SCH_ITEM*, wxString> m_driver_name_cache;
+
+    /**
+     * The links, final net name and bus status of the subgraph, cached when the graph is built.
+     * They are used by incremental updates to find the neighbors of a subgraph once its items
+     * have been changed or deleted, when the items cannot be accessed anymore.
+     */
+    std::vector<LINK> m_links;
+
+    /// The driver name the subgraph is cached under, once its driver may be gone
+    wxString m_link_net_name;
+
+    bool m_link_bus;
 };
 
 /// Associates a net code with the final name of a net
@@ -245,6 +274,11 @@ public:
     /**
      * Updates the connection graph for the given list of sheets.
      *
+     * Unless \a aUnconditional is set, only the subgraphs touching changed, new or deleted
+     * items are rebuilt, together with the subgraphs they are linked to by name or through
+     * the hierarchy.  The graph is fully rebuilt when the hierarchy changed or when the change
+     * involves buses.
+     *
      * @param aSheetList is the list of possibly modified sheets
      * @param aUnconditional is true if an unconditional full recalculation should be done
      */
@@ -297,13 +331,39 @@ public:
 
     CONNECTION_SUBGRAPH* GetSubgraphForItem( SCH_ITEM* aItem );
 
-    // TODO(JE) Remove this when pressure valve is removed
-    static bool m_allowRealTime;
-
 private:
-    // All the sheets in the schematic (as long as we don't have partial updates)
+    /**
+     * What the graph knows about a schematic item since its last update.  Deleted items are
+     * only known through this record and must not be accessed.
+     *
+     * Items of a shared screen are in the graph once per sheet instance, and the pins of a
+     * symbol depend on the instance, so the graph items are kept for each sheet.
+     */
+    struct ITEM_RECORD
+    {
+        SCH_SCREEN* m_screen;
+        bool        m_bus;           ///< Bus wire or bus entry
+
+        /// The item itself, or its pins, on each sheet showing it
+        std::unordered_map<SCH_SHEET_PATH, std::vector<SCH_ITEM*>> m_graph_items;
+    };
+
+    /**
+     * What updateItemConnectivity() produces for one sheet.  Sheets are processed in parallel,
+     * so their results are kept apart and appended to the graph afterwards.
+     */
+    struct ITEM_BUFFER
+    {
+        std::vector<SCH_ITEM*>                           m_items;
+        std::vector<std::pair<SCH_SHEET_PATH, SCH_PIN*>> m_invisible_power_pins;
+        std::unordered_map<SCH_ITEM*, ITEM_RECORD>       m_item_records;
+    };
+
+    // All the sheets in the schematic, and their names, as of the last full recalculation
     SCH_SHEET_LIST m_sheetList;
 
+    std::vector<wxString> m_sheetNames;
+
     // All connectable items in the schematic
     std::vector<SCH_ITEM*> m_items;
 
@@ -333,7 +393,16 @@ private:
     std::unordered_map<wxString,
                        std::vector<CONNECTION_SUBGRAPH*>> m_net_name_to_subgraphs_map;
 
-    std::map<SCH_ITEM*, CONNECTION_SUBGRAPH*> m_item_to_subgraph_map;
+    // The subgraphs of each item, one per sheet the item appears on
+    std::unordered_map<SCH_ITEM*, std::vector<CONNECTION_SUBGRAPH*>> m_item_to_subgraphs_map;
+
+    // Subgraphs by link name (see CONNECTION_SUBGRAPH::m_links)
+    std::unordered_map<wxString, std::vector<CONNECTION_SUBGRAPH*>> m_link_name_to_subgraphs_map;
+
+    std::unordered_map<SCH_ITEM*, ITEM_RECORD> m_item_records;
+
+    // Markers found by the checks of RunERC(), which run in parallel
+    ERC_MARKER_SINK m_ercMarkers;
 
     NET_MAP m_net_code_to_subgraphs_map;
 
@@ -367,11 +436,24 @@ private:
      * checks to ensure that the items should actually connect, the items are
      * linked together using ConnectedItems().
      *
-     * As a side effect, items are loaded into m_items for BuildConnectionGraph()
+     * As a side effect, items are loaded into aBuffer, to be moved to m_items for
+     * BuildConnectionGraph().  Only the items and aBuffer are modified, so different
+     * screens can be processed at the same time.
      *
      * @param aSheet is the path to the sheet of all items in the list
      * @param aItemList is a list of items to consider
+     * @param aBuffer receives the items to build the graph from
      */
+    void updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
+                                 const std::vector<SCH_ITEM*>& aItemList, ITEM_BUFFER& aBuffer );
+
+    /// Appends the results of updateItemConnectivity() to the graph
+    void appendItemBuffer( ITEM_BUFFER& aBuffer );
+
+    /// Adds the graph items of each sheet of aRecord to the record of aItem
+    void mergeItemRecord( SCH_ITEM* aItem, ITEM_RECORD& aRecord );
+
+    /// Updates the connectivity of the items of one sheet, adding them to the graph directly
     void updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                                  const std::vector<SCH_ITEM*>& aItemList );
 
@@ -390,6 +472,29 @@ private:
      */
     void buildConnectionGraph();
 
+    /**
+     * Caches the links of the subgraphs and maps the items of absorbed subgraphs to the
+     * subgraph that absorbed them, then deletes the absorbed subgraphs.
+     * Last step of buildConnectionGraph().
+     */
+    void cacheSubgraphLinks();
+
+    /**
+     * Rebuilds the part of the graph affected by the items changed since the last update.
+     *
+     * The affected subgraphs are found from the changed items and their neighbors, then
+     * rebuilt in a separate graph which is merged back into this one.
+     *
+     * @return false if a full recalculation is needed instead
+     */
+    bool updateIncrementally( const SCH_SHEET_LIST& aSheetList );
+
+    /// Deletes subgraphs and removes them from all the caches
+    void removeSubgraphs( const std::unordered_set<CONNECTION_SUBGRAPH*>& aSubgraphs );
+
+    /// Moves the subgraphs and caches of a partial graph into this one
+    void merge( CONNECTION_GRAPH& aGraph );
+
     /**
      * Helper to assign a new net code to a connection
      *
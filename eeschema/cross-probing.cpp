@@ -461,13 +461,22 @@ void SCH_EDIT_FRAME::KiwayMailIn( KIWAY_EXPRESS& mail )
         }
 
         NETLIST_EXPORTER_KICAD exporter( &Schematic() );
-        STRING_FORMATTER formatter;
 
         // TODO remove once real-time connectivity is a given
-        if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity || !CONNECTION_GRAPH::m_allowRealTime )
+        if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity )
             // Ensure the netlist data is up to date:
             RecalculateConnections( NO_CLEANUP );
 
+        // The caller can take the netlist as it is written, without formatting it
+        if( NETLIST_WRITER* writer = static_cast<NETLIST_WRITER*>( mail.GetMailObject() ) )
+        {
+            exporter.Format( writer, GNL_ALL | GNL_OPT_KICAD );
+            payload.clear();
+            break;
+        }
+
+        STRING_FORMATTER formatter;
+
         exporter.Format( &formatter, GNL_ALL | GNL_OPT_KICAD );
 
         payload = formatter.GetString();
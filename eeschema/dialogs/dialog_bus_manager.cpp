@@ -230,6 +230,8 @@ void DIALOG_BUS_MANAGER::OnOkClick( wxCommandEvent& aEvent )
 {
     if( TransferDataFromWindow() )
     {
+        // Bus aliases are not tracked by incremental connectivity updates
+        ( ( SCH_EDIT_FRAME* )GetParent() )->RecalculateConnections( NO_CLEANUP );
         ( ( SCH_EDIT_FRAME* )GetParent() )->OnModify();
         EndModal( wxID_OK );
     }
@@ -49,6 +49,7 @@
 #include <wx/ffile.h>
 #include <erc_item.h>
 #include <eeschema_settings.h>
+#include <profile.h>
 
 DIALOG_ERC::DIALOG_ERC( SCH_EDIT_FRAME* parent ) :
         DIALOG_ERC_BASE( parent, ID_DIALOG_ERC ),  // parent looks for this ID explicitly
@@ -249,55 +250,75 @@ void DIALOG_ERC::testErc( REPORTER& aReporter )
     SCH_SCREENS screens( sch->Root() );
     ERC_SETTINGS& settings = sch->ErcSettings();
     ERC_TESTER tester( sch );
+    PROF_COUNTER totalTimer;
+
+    // Runs a test and traces its wall time (enable with WXTRACE=ERC_PROFILE)
+    auto timed =
+            []( const char* aName, const std::function<void()>& aTest )
+            {
+                PROF_COUNTER timer;
+                aTest();
+                timer.Stop();
+                wxLogTrace( "ERC_PROFILE", "%s: %0.1f ms", aName, timer.msecs() );
+            };
 
     // Test duplicate sheet names inside a given sheet.  While one can have multiple references
     // to the same file, each must have a unique name.
     if( settings.IsTestEnabled( ERCE_DUPLICATE_SHEET_NAME ) )
     {
         aReporter.ReportTail( _( "Checking sheet names...\n" ), RPT_SEVERITY_INFO );
-        tester.TestDuplicateSheetNames( true );
+        timed( "TestDuplicateSheetNames", [&]() { tester.TestDuplicateSheetNames( true ); } );
     }
 
     if( settings.IsTestEnabled( ERCE_BUS_ALIAS_CONFLICT ) )
     {
         aReporter.ReportTail( _( "Checking bus conflicts...\n" ), RPT_SEVERITY_INFO );
-        tester.TestConflictingBusAliases();
+        timed( "TestConflictingBusAliases", [&]() { tester.TestConflictingBusAliases(); } );
     }
 
     // The connection graph has a whole set of ERC checks it can run
     aReporter.ReportTail( _( "Checking conflicts...\n" ) );
-    m_parent->RecalculateConnections( NO_CLEANUP );
-    sch->ConnectionGraph()->RunERC();
+    timed( "RecalculateConnections", [&]() { m_parent->RecalculateConnections( NO_CLEANUP ); } );
+    timed( "ConnectionGraph RunERC", [&]() { sch->ConnectionGraph()->RunERC(); } );
 
     // Test is all units of each multiunit component have the same footprint assigned.
     if( settings.IsTestEnabled( ERCE_DIFFERENT_UNIT_FP ) )
     {
         aReporter.ReportTail( _( "Checking footprints...\n" ), RPT_SEVERITY_INFO );
-        tester.TestMultiunitFootprints();
+        timed( "TestMultiunitFootprints", [&]() { tester.TestMultiunitFootprints(); } );
     }
 
     aReporter.ReportTail( _( "Checking pins...\n" ), RPT_SEVERITY_INFO );
 
     if( settings.IsTestEnabled( ERCE_DIFFERENT_UNIT_NET ) )
-        tester.TestMultUnitPinConflicts();
+        timed( "TestMultUnitPinConflicts", [&]() { tester.TestMultUnitPinConflicts(); } );
 
     // Test pins on each net against the pin connection table
     if( settings.IsTestEnabled( ERCE_PIN_TO_PIN_ERROR ) )
-        tester.TestPinToPin();
+        timed( "TestPinToPin", [&]() { tester.TestPinToPin(); } );
 
     // Test similar labels (i;e. labels which are identical when
     // using case insensitive comparisons)
     if( settings.IsTestEnabled( ERCE_SIMILAR_LABELS ) )
     {
         aReporter.ReportTail( _( "Checking labels...\n" ), RPT_SEVERITY_INFO );
-        tester.TestSimilarLabels();
+        timed( "TestSimilarLabels", [&]() { tester.TestSimilarLabels(); } );
     }
 
     if( settings.IsTestEnabled( ERCE_UNRESOLVED_VARIABLE ) )
-        tester.TestTextVars( m_parent->GetCanvas()->GetView()->GetWorksheet() );
+    {
+        timed( "TestTextVars",
+               [&]()
+               {
+                   tester.TestTextVars( m_parent->GetCanvas()->GetView()->GetWorksheet() );
+               } );
+    }
 
     if( settings.IsTestEnabled( ERCE_NOCONNECT_CONNECTED ) )
-        tester.TestNoConnectPins();
+        timed( "TestNoConnectPins", [&]() { tester.TestNoConnectPins(); } );
+
+    totalTimer.Stop();
+    wxLogTrace( "ERC_PROFILE", "ERC total: %0.1f ms", totalTimer.msecs() );
 
     // Display diags:
     m_markerTreeModel->SetProvider( m_markerProvider );
@@ -42,6 +42,11 @@
 #include <ws_proxy_view_item.h>
 #include <wx/ffile.h>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
 
 /* ERC tests :
  *  1 - conflicts between connected pins ( example: 2 connected outputs )
@@ -81,6 +86,65 @@ const wxString CommentERC_H[] =
     _( "No Connection" )
 };
 
+
+void ERC_MARKER_SINK::Add( size_t aIndex, SCH_SCREEN* aScreen, std::shared_ptr<ERC_ITEM> aItem,
+                           const wxPoint& aPosition )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    m_entries.push_back( { aIndex, aScreen, std::move( aItem ), aPosition } );
+}
+
+
+int ERC_MARKER_SINK::Flush()
+{
+    // Markers of the same index come from the same thread, in order: keep that order
+    std::stable_sort( m_entries.begin(), m_entries.end(),
+                      []( const ENTRY& a, const ENTRY& b )
+                      {
+                          return a.m_index < b.m_index;
+                      } );
+
+    // Markers get a new KIID, which can't be generated from several threads
+    for( const ENTRY& entry : m_entries )
+        entry.m_screen->Append( new SCH_MARKER( entry.m_item, entry.m_position ) );
+
+    int count = (int) m_entries.size();
+    m_entries.clear();
+
+    return count;
+}
+
+
+void ErcParallelFor( size_t aCount, const std::function<void( size_t )>& aFunc )
+{
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(), aCount );
+
+    std::atomic<size_t> next( 0 );
+
+    auto worker = [&]() -> size_t
+    {
+        for( size_t ii = next++; ii < aCount; ii = next++ )
+            aFunc( ii );
+
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+    {
+        worker();
+        return;
+    }
+
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        returns[ii] = std::async( std::launch::async, worker );
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        returns[ii].wait();
+}
+
 // Messages for matrix columns
 const wxString CommentERC_V[] =
 {
@@ -366,43 +430,46 @@ int ERC_TESTER::TestMultiunitFootprints()
 
 int ERC_TESTER::TestNoConnectPins()
 {
-    int err_count = 0;
+    SCH_SHEET_LIST  sheets = m_schematic->GetSheets();
+    ERC_MARKER_SINK markers;
 
-    for( const SCH_SHEET_PATH& sheet : m_schematic->GetSheets() )
-    {
-        std::map<wxPoint, std::vector<SCH_PIN*>> pinMap;
+    ErcParallelFor( sheets.size(),
+            [&]( size_t aSheet )
+            {
+                const SCH_SHEET_PATH& sheet = sheets[aSheet];
 
-        for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_COMPONENT_T ) )
-        {
-            SCH_COMPONENT* comp = static_cast<SCH_COMPONENT*>( item );
+                std::map<wxPoint, std::vector<SCH_PIN*>> pinMap;
 
-            for( SCH_PIN* pin : comp->GetPins( &sheet ) )
-            {
-                if( pin->GetLibPin()->GetType() == ELECTRICAL_PINTYPE::PT_NC )
-                    pinMap[pin->GetPosition()].emplace_back( pin );
-            }
-        }
+                for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_COMPONENT_T ) )
+                {
+                    SCH_COMPONENT* comp = static_cast<SCH_COMPONENT*>( item );
 
-        for( auto& pair : pinMap )
-        {
-            if( pair.second.size() > 1 )
-            {
-                err_count++;
+                    for( SCH_PIN* pin : comp->GetPins( &sheet ) )
+                    {
+                        if( pin->GetLibPin()->GetType() == ELECTRICAL_PINTYPE::PT_NC )
+                            pinMap[pin->GetPosition()].emplace_back( pin );
+                    }
+                }
 
-                std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_NOCONNECT_CONNECTED );
+                for( const auto& pair : pinMap )
+                {
+                    if( pair.second.size() > 1 )
+                    {
+                        std::shared_ptr<ERC_ITEM> ercItem =
+                                ERC_ITEM::Create( ERCE_NOCONNECT_CONNECTED );
 
-                ercItem->SetItems( pair.second[0], pair.second[1],
-                                   pair.second.size() > 2 ? pair.second[2] : nullptr,
-                                   pair.second.size() > 3 ? pair.second[3] : nullptr );
-                ercItem->SetErrorMessage( _( "Pins with \"no connection\" type are connected" ) );
+                        ercItem->SetItems( pair.second[0], pair.second[1],
+                                           pair.second.size() > 2 ? pair.second[2] : nullptr,
+                                           pair.second.size() > 3 ? pair.second[3] : nullptr );
+                        ercItem->SetErrorMessage(
+                                _( "Pins with \"no connection\" type are connected" ) );
 
-                SCH_MARKER* marker = new SCH_MARKER( ercItem, pair.first );
-                sheet.LastScreen()->Append( marker );
-            }
-        }
-    }
+                        markers.Add( aSheet, sheet.LastScreen(), ercItem, pair.first );
+                    }
+                }
+            } );
 
-    return err_count;
+    return markers.Flush();
 }
 
 
@@ -411,75 +478,84 @@ int ERC_TESTER::TestPinToPin()
     ERC_SETTINGS&  settings = m_schematic->ErcSettings();
     const NET_MAP& nets     = m_schematic->ConnectionGraph()->GetNetMap();
 
-    int errors = 0;
+    std::vector<const NET_MAP::value_type*> netList;
 
-    for( const std::pair<NET_NAME_CODE, std::vector<CONNECTION_SUBGRAPH*>> net : nets )
-    {
-        std::vector<SCH_PIN*> pins;
-        std::unordered_map<EDA_ITEM*, SCH_SCREEN*> pinToScreenMap;
+    for( const NET_MAP::value_type& net : nets )
+        netList.push_back( &net );
 
-        for( CONNECTION_SUBGRAPH* subgraph: net.second )
-        {
-            for( EDA_ITEM* item : subgraph->m_items )
+    ERC_MARKER_SINK markers;
+
+    ErcParallelFor( netList.size(),
+            [&]( size_t aNet )
             {
-                if( item->Type() == SCH_PIN_T )
+                std::vector<SCH_PIN*> pins;
+                std::unordered_map<EDA_ITEM*, SCH_SCREEN*> pinToScreenMap;
+
+                for( CONNECTION_SUBGRAPH* subgraph : netList[aNet]->second )
                 {
-                    pins.emplace_back( static_cast<SCH_PIN*>( item ) );
-                    pinToScreenMap[item] = subgraph->m_sheet.LastScreen();
+                    for( EDA_ITEM* item : subgraph->m_items )
+                    {
+                        if( item->Type() == SCH_PIN_T )
+                        {
+                            pins.emplace_back( static_cast<SCH_PIN*>( item ) );
+                            pinToScreenMap[item] = subgraph->m_sheet.LastScreen();
+                        }
+                    }
                 }
-            }
-        }
 
-        // Single-pin nets are handled elsewhere
-        if( pins.size() < 2 )
-            continue;
+                // Single-pin nets are handled elsewhere
+                if( pins.size() < 2 )
+                    return;
 
-        std::set<std::pair<SCH_PIN*, SCH_PIN*>> tested;
+                // Pins of sheets sharing a screen can be found more than once
+                std::set<std::pair<SCH_PIN*, SCH_PIN*>> tested;
 
-        for( SCH_PIN* refPin : pins )
-        {
-            ELECTRICAL_PINTYPE refType = refPin->GetType();
+                for( size_t ii = 0; ii < pins.size(); ++ii )
+                {
+                    SCH_PIN*           refPin = pins[ii];
+                    ELECTRICAL_PINTYPE refType = refPin->GetType();
 
-            for( SCH_PIN* testPin : pins )
-            {
-                if( testPin == refPin )
-                    continue;
+                    // Pairs with the pins before this one have been tested already
+                    for( size_t jj = ii + 1; jj < pins.size(); ++jj )
+                    {
+                        SCH_PIN* testPin = pins[jj];
 
-                std::pair<SCH_PIN*, SCH_PIN*> pair1 = std::make_pair( refPin, testPin );
-                std::pair<SCH_PIN*, SCH_PIN*> pair2 = std::make_pair( testPin, refPin );
+                        if( testPin == refPin )
+                            continue;
 
-                if( tested.count( pair1 ) || tested.count( pair2 ) )
-                    continue;
+                        std::pair<SCH_PIN*, SCH_PIN*> pair1 = std::make_pair( refPin, testPin );
+                        std::pair<SCH_PIN*, SCH_PIN*> pair2 = std::make_pair( testPin, refPin );
 
-                tested.insert( pair1 );
-                tested.insert( pair2 );
+                        if( tested.count( pair1 ) || tested.count( pair2 ) )
+                            continue;
 
-                ELECTRICAL_PINTYPE testType = testPin->GetType();
+                        tested.insert( pair1 );
 
-                PIN_ERROR erc = settings.GetPinMapValue( refType, testType );
+                        ELECTRICAL_PINTYPE testType = testPin->GetType();
 
-                if( erc != PIN_ERROR::OK )
-                {
-                    std::shared_ptr<ERC_ITEM> ercItem =
-                            ERC_ITEM::Create( erc == PIN_ERROR::WARNING ? ERCE_PIN_TO_PIN_WARNING :
-                                                                          ERCE_PIN_TO_PIN_ERROR );
-                    ercItem->SetItems( refPin, testPin );
-
-                    ercItem->SetErrorMessage(
-                            wxString::Format( _( "Pins of type %s and %s are connected" ),
-                                    ElectricalPinTypeGetText( refType ),
-                                    ElectricalPinTypeGetText( testType ) ) );
-
-                    SCH_MARKER* marker =
-                            new SCH_MARKER( ercItem, refPin->GetTransformedPosition() );
-                    pinToScreenMap[refPin]->Append( marker );
-                    errors++;
+                        PIN_ERROR erc = settings.GetPinMapValue( refType, testType );
+
+                        if( erc != PIN_ERROR::OK )
+                        {
+                            std::shared_ptr<ERC_ITEM> ercItem =
+                                    ERC_ITEM::Create( erc == PIN_ERROR::WARNING ?
+                                                              ERCE_PIN_TO_PIN_WARNING :
+                                                              ERCE_PIN_TO_PIN_ERROR );
+                            ercItem->SetItems( refPin, testPin );
+
+                            ercItem->SetErrorMessage(
+                                    wxString::Format( _( "Pins of type %s and %s are connected" ),
+                                            ElectricalPinTypeGetText( refType ),
+                                            ElectricalPinTypeGetText( testType ) ) );
+
+                            markers.Add( aNet, pinToScreenMap[refPin], ercItem,
+                                         refPin->GetTransformedPosition() );
+                        }
+                    }
                 }
-            }
-        }
-    }
+            } );
 
-    return errors;
+    return markers.Flush();
 }
 
 
@@ -491,7 +567,7 @@ int ERC_TESTER::TestMultUnitPinConflicts()
 
     std::unordered_map<wxString, std::pair<wxString, SCH_PIN*>> pinToNetMap;
 
-    for( const std::pair<NET_NAME_CODE, std::vector<CONNECTION_SUBGRAPH*>> net : nets )
+    for( const NET_MAP::value_type& net : nets )
     {
         const wxString& netName = net.first.first;
         std::vector<SCH_PIN*> pins;
@@ -542,50 +618,76 @@ int ERC_TESTER::TestSimilarLabels()
 {
     const NET_MAP& nets = m_schematic->ConnectionGraph()->GetNetMap();
 
-    int errors = 0;
+    struct LABEL
+    {
+        SCH_TEXT*   m_text;
+        SCH_SCREEN* m_screen;
+        wxString    m_shownText;
+        wxString    m_normalized;
+    };
 
-    std::unordered_map<wxString, SCH_TEXT*> labelMap;
+    std::vector<const NET_MAP::value_type*> netList;
 
-    for( const std::pair<NET_NAME_CODE, std::vector<CONNECTION_SUBGRAPH*>> net : nets )
-    {
-        std::vector<SCH_PIN*> pins;
+    for( const NET_MAP::value_type& net : nets )
+        netList.push_back( &net );
 
-        for( CONNECTION_SUBGRAPH* subgraph : net.second )
-        {
-            for( EDA_ITEM* item : subgraph->m_items )
+    // Resolving the label texts is the expensive part, it is done net by net in parallel
+    std::vector<std::vector<LABEL>> netLabels( netList.size() );
+
+    ErcParallelFor( netList.size(),
+            [&]( size_t aNet )
             {
-                switch( item->Type() )
+                for( CONNECTION_SUBGRAPH* subgraph : netList[aNet]->second )
                 {
-                case SCH_LABEL_T:
-                case SCH_HIER_LABEL_T:
-                case SCH_GLOBAL_LABEL_T:
-                {
-                    SCH_TEXT* text = static_cast<SCH_TEXT*>( item );
-
-                    wxString normalized = text->GetShownText().Lower();
-
-                    if( !labelMap.count( normalized ) )
+                    for( EDA_ITEM* item : subgraph->m_items )
                     {
-                        labelMap[normalized] = text;
+                        switch( item->Type() )
+                        {
+                        case SCH_LABEL_T:
+                        case SCH_HIER_LABEL_T:
+                        case SCH_GLOBAL_LABEL_T:
+                        {
+                            SCH_TEXT* text = static_cast<SCH_TEXT*>( item );
+                            wxString  shownText = text->GetShownText();
+
+                            netLabels[aNet].push_back( { text, subgraph->m_sheet.LastScreen(),
+                                                         shownText, shownText.Lower() } );
+                            break;
+                        }
+
+                        default:
+                            break;
+                        }
                     }
-                    else if( labelMap.at( normalized )->GetShownText() != text->GetShownText() )
-                    {
-                        std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_SIMILAR_LABELS );
-                        ercItem->SetItems( text, labelMap.at( normalized ) );
+                }
+            } );
 
-                        SCH_MARKER* marker = new SCH_MARKER( ercItem, text->GetPosition() );
-                        subgraph->m_sheet.LastScreen()->Append( marker );
-                    }
+    ERC_MARKER_SINK markers;
 
-                    break;
-                }
+    std::unordered_map<wxString, const LABEL*> labelMap;
 
-                default:
-                    break;
-                }
+    for( size_t ii = 0; ii < netLabels.size(); ++ii )
+    {
+        for( const LABEL& label : netLabels[ii] )
+        {
+            auto it = labelMap.find( label.m_normalized );
+
+            if( it == labelMap.end() )
+            {
+                labelMap[label.m_normalized] = &label;
+            }
+            else if( it->second->m_shownText != label.m_shownText )
+            {
+                std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_SIMILAR_LABELS );
+                ercItem->SetItems( label.m_text, it->second->m_text );
+
+                markers.Add( ii, label.m_screen, ercItem, label.m_text->GetPosition() );
             }
         }
     }
 
-    return errors;
+    markers.Flush();
+
+    // Similar labels are only reported by their markers, they are not counted as errors
+    return 0;
 }
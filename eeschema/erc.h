@@ -30,11 +30,18 @@
 #ifndef _ERC_H
 #define _ERC_H
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include <erc_settings.h>
 
 
+class ERC_ITEM;
 class NETLIST_OBJECT;
 class NETLIST_OBJECT_LIST;
+class SCH_SCREEN;
 class SCH_SHEET_LIST;
 class SCHEMATIC;
 
@@ -48,6 +55,51 @@ extern const wxString CommentERC_H[];
 extern const wxString CommentERC_V[];
 
 
+/**
+ * Collects the markers found by ERC tests running on several threads.
+ *
+ * Each marker is tagged with the index of the piece of work (net, subgraph, sheet...) it was
+ * found in.  Markers are only created and added to their screens by Flush(), sorted by this
+ * index, so the results don't depend on how the work was shared between the threads.
+ */
+class ERC_MARKER_SINK
+{
+public:
+    /**
+     * Stores a marker to create.  Can be called from any thread.
+     */
+    void Add( size_t aIndex, SCH_SCREEN* aScreen, std::shared_ptr<ERC_ITEM> aItem,
+              const wxPoint& aPosition );
+
+    /**
+     * Creates the stored markers and appends them to their screens.  Must be called from the
+     * main thread, once the test is done.
+     *
+     * @return the number of markers
+     */
+    int Flush();
+
+private:
+    struct ENTRY
+    {
+        size_t                    m_index;
+        SCH_SCREEN*               m_screen;
+        std::shared_ptr<ERC_ITEM> m_item;
+        wxPoint                   m_position;
+    };
+
+    std::mutex         m_mutex;
+    std::vector<ENTRY> m_entries;
+};
+
+
+/**
+ * Calls \a aFunc for each index from 0 to \a aCount - 1, sharing the calls between as many
+ * threads as there are cores.  The calls must be independent from each other.
+ */
+void ErcParallelFor( size_t aCount, const std::function<void( size_t )>& aFunc );
+
+
 class ERC_TESTER
 {
 public:
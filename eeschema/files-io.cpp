@@ -55,6 +55,7 @@
 #include <tool/tool_manager.h>
 #include <tools/sch_editor_control.h>
 #include <trace_helpers.h>
+#include <trace_profiler.h>
 #include <widgets/infobar.h>
 #include <wildcards_and_files_ext.h>
 #include <ws_data_model.h>
@@ -241,6 +242,7 @@ bool SCH_EDIT_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
     if( !AskToSaveChanges() )
         return false;
 
+    TRACE_ZONE( "SCH_EDIT_FRAME::OpenProjectFiles", "io" );
     PROF_COUNTER openFiles( "OpenProjectFile" );
 
     wxFileName pro = fullFileName;
@@ -36,6 +36,54 @@
 
 static bool sortPinsByNumber( LIB_PIN* aPin1, LIB_PIN* aPin2 );
 
+
+/**
+ * Builds the XNODE tree of the netlist, for the XML output.
+ */
+class XNODE_NETLIST_WRITER : public NETLIST_WRITER
+{
+public:
+    XNODE_NETLIST_WRITER() :
+            m_root( nullptr )
+    {
+    }
+
+    void Open( const char* aName ) override
+    {
+        XNODE* n = new XNODE( wxXML_ELEMENT_NODE, aName );
+
+        if( m_stack.empty() )
+            m_root = n;
+        else
+            m_stack.back()->AddChild( n );
+
+        m_stack.push_back( n );
+    }
+
+    void Attribute( const char* aName, const wxString& aValue ) override
+    {
+        m_stack.back()->AddAttribute( aName, aValue );
+    }
+
+    void Text( const wxString& aText ) override
+    {
+        if( !aText.IsEmpty() )
+            m_stack.back()->AddChild( new XNODE( wxXML_TEXT_NODE, wxEmptyString, aText ) );
+    }
+
+    void Close() override
+    {
+        m_stack.pop_back();
+    }
+
+    XNODE* GetRoot() const { return m_root; }
+
+private:
+    XNODE*              m_root;
+    std::vector<XNODE*> m_stack;
+};
+
+
 bool NETLIST_EXPORTER_GENERIC::WriteNetlist( const wxString& aOutFileName,
                                              unsigned aNetlistOptions )
 {
@@ -50,28 +98,37 @@ bool NETLIST_EXPORTER_GENERIC::WriteNetlist( const wxString& aOutFileName,
 
 XNODE* NETLIST_EXPORTER_GENERIC::makeRoot( int aCtl )
 {
-    XNODE*      xroot = node( "export" );
+    XNODE_NETLIST_WRITER writer;
 
-    xroot->AddAttribute( "version", "D" );
+    writeRoot( writer, aCtl );
+
+    return writer.GetRoot();
+}
+
+
+void NETLIST_EXPORTER_GENERIC::writeRoot( NETLIST_WRITER& aWriter, int aCtl )
+{
+    aWriter.Open( "export" );
+    aWriter.Attribute( "version", "D" );
 
     if( aCtl & GNL_HEADER )
         // add the "design" header
-        xroot->AddChild( makeDesignHeader() );
+        writeDesignHeader( aWriter );
 
     if( aCtl & GNL_COMPONENTS )
-        xroot->AddChild( makeComponents( aCtl ) );
+        writeComponents( aWriter, aCtl );
 
     if( aCtl & GNL_PARTS )
-        xroot->AddChild( makeLibParts() );
+        writeLibParts( aWriter );
 
     if( aCtl & GNL_LIBRARIES )
-        // must follow makeGenericLibParts()
-        xroot->AddChild( makeLibraries() );
+        // must follow writeLibParts()
+        writeLibraries( aWriter );
 
     if( aCtl & GNL_NETS )
-        xroot->AddChild( makeListOfNets() );
+        writeListOfNets( aWriter );
 
-    return xroot;
+    aWriter.Close();
 }
 
 
@@ -86,8 +143,8 @@ struct COMP_FIELDS
 };
 
 
-void NETLIST_EXPORTER_GENERIC::addComponentFields( XNODE* xcomp, SCH_COMPONENT* comp,
-                                                   SCH_SHEET_PATH* aSheet )
+void NETLIST_EXPORTER_GENERIC::writeComponentFields( NETLIST_WRITER& aWriter, SCH_COMPONENT* comp,
+                                                     SCH_SHEET_PATH* aSheet )
 {
     COMP_FIELDS fields;
 
@@ -100,70 +157,74 @@ void NETLIST_EXPORTER_GENERIC::addComponentFields( XNODE* xcomp, SCH_COMPONENT*
         // any non blank fields in all units and use the first non-blank field
         // for each unique field name.
 
-        wxString    ref = comp->GetRef( aSheet );
+        if( m_unitsByRef.empty() )
+        {
+            for( const SCH_SHEET_PATH& sheet : m_schematic->GetSheets() )
+            {
+                for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_COMPONENT_T ) )
+                {
+                    SCH_COMPONENT* unit = static_cast<SCH_COMPONENT*>( item );
+
+                    m_unitsByRef[ unit->GetRef( &sheet ).Lower() ].emplace_back( unit, sheet );
+                }
+            }
+        }
 
-        SCH_SHEET_LIST sheetList = m_schematic->GetSheets();
         int minUnit = comp->GetUnit();
 
-        for( unsigned i = 0;  i < sheetList.size();  i++ )
+        for( std::pair<SCH_COMPONENT*, SCH_SHEET_PATH>& unitAndSheet :
+                m_unitsByRef[ comp->GetRef( aSheet ).Lower() ] )
         {
-            for( auto item : sheetList[i].LastScreen()->Items().OfType( SCH_COMPONENT_T ) )
-            {
-                SCH_COMPONENT*  comp2 = (SCH_COMPONENT*) item;
+            SCH_COMPONENT*  comp2 = unitAndSheet.first;
+            SCH_SHEET_PATH* sheet2 = &unitAndSheet.second;
 
-                wxString ref2 = comp2->GetRef( &sheetList[i] );
+            int unit = comp2->GetUnit();
 
-                if( ref2.CmpNoCase( ref ) != 0 )
-                    continue;
+            // The lowest unit number wins.  User should only set fields in any one unit.
+            // remark: IsVoid() returns true for empty strings or the "~" string (empty
+            // field value)
+            if( !comp2->GetValue( sheet2 ).IsEmpty()
+                    && ( unit < minUnit || fields.value.IsEmpty() ) )
+            {
+                if( m_resolveTextVars )
+                    fields.value = comp2->GetValue( sheet2 );
+                else
+                    fields.value = comp2->GetField( VALUE )->GetText();
+            }
 
-                int unit = comp2->GetUnit();
+            if( !comp2->GetFootprint( sheet2 ).IsEmpty()
+                    && ( unit < minUnit || fields.footprint.IsEmpty() ) )
+            {
+                if( m_resolveTextVars )
+                    fields.footprint = comp2->GetFootprint( sheet2 );
+                else
+                    fields.footprint = comp2->GetField( FOOTPRINT )->GetText();
+            }
 
-                // The lowest unit number wins.  User should only set fields in any one unit.
-                // remark: IsVoid() returns true for empty strings or the "~" string (empty
-                // field value)
-                if( !comp2->GetValue( &sheetList[i] ).IsEmpty()
-                        && ( unit < minUnit || fields.value.IsEmpty() ) )
-                {
-                    if( m_resolveTextVars )
-                        fields.value = comp2->GetValue( &sheetList[i] );
-                    else
-                        fields.value = comp2->GetField( VALUE )->GetText();
-                }
+            if( !comp2->GetField( DATASHEET )->IsVoid()
+                    && ( unit < minUnit || fields.datasheet.IsEmpty() ) )
+            {
+                if( m_resolveTextVars )
+                    fields.datasheet = comp2->GetField( DATASHEET )->GetShownText();
+                else
+                    fields.datasheet = comp2->GetField( DATASHEET )->GetText();
+            }
 
-                if( !comp2->GetFootprint( &sheetList[i] ).IsEmpty()
-                        && ( unit < minUnit || fields.footprint.IsEmpty() ) )
-                {
-                    if( m_resolveTextVars )
-                        fields.footprint = comp2->GetFootprint( &sheetList[i] );
-                    else
-                        fields.footprint = comp2->GetField( FOOTPRINT )->GetText();
-                }
+            for( int fldNdx = MANDATORY_FIELDS;  fldNdx < comp2->GetFieldCount();  ++fldNdx )
+            {
+                SCH_FIELD* f = comp2->GetField( fldNdx );
 
-                if( !comp2->GetField( DATASHEET )->IsVoid()
-                        && ( unit < minUnit || fields.datasheet.IsEmpty() ) )
+                if( f->GetText().size()
+                    && ( unit < minUnit || fields.f.count( f->GetName() ) == 0 ) )
                 {
                     if( m_resolveTextVars )
-                        fields.datasheet = comp2->GetField( DATASHEET )->GetShownText();
+                        fields.f[ f->GetName() ] = f->GetShownText();
                     else
-                        fields.datasheet = comp2->GetField( DATASHEET )->GetText();
-                }
-
-                for( int fldNdx = MANDATORY_FIELDS;  fldNdx < comp2->GetFieldCount();  ++fldNdx )
-                {
-                    SCH_FIELD* f = comp2->GetField( fldNdx );
-
-                    if( f->GetText().size()
-                        && ( unit < minUnit || fields.f.count( f->GetName() ) == 0 ) )
-                    {
-                        if( m_resolveTextVars )
-                            fields.f[ f->GetName() ] = f->GetShownText();
-                        else
-                            fields.f[ f->GetName() ] = f->GetText();
-                    }
+                        fields.f[ f->GetName() ] = f->GetText();
                 }
-
-                minUnit = std::min( unit, minUnit );
             }
+
+            minUnit = std::min( unit, minUnit );
         }
     }
     else
@@ -199,39 +260,42 @@ void NETLIST_EXPORTER_GENERIC::addComponentFields( XNODE* xcomp, SCH_COMPONENT*
 
     // Do not output field values blank in netlist:
     if( fields.value.size() )
-        xcomp->AddChild( node( "value", fields.value ) );
+        aWriter.Leaf( "value", fields.value );
     else    // value field always written in netlist
-        xcomp->AddChild( node( "value", "~" ) );
+        aWriter.Leaf( "value", "~" );
 
     if( fields.footprint.size() )
-        xcomp->AddChild( node( "footprint", fields.footprint ) );
+        aWriter.Leaf( "footprint", fields.footprint );
 
     if( fields.datasheet.size() )
-        xcomp->AddChild( node( "datasheet", fields.datasheet ) );
+        aWriter.Leaf( "datasheet", fields.datasheet );
 
     if( fields.f.size() )
     {
-        XNODE* xfields;
-        xcomp->AddChild( xfields = node( "fields" ) );
+        aWriter.Open( "fields" );
 
         // non MANDATORY fields are output alphabetically
         for( std::map< wxString, wxString >::const_iterator it = fields.f.begin();
              it != fields.f.end();  ++it )
         {
-            XNODE*  xfield;
-            xfields->AddChild( xfield = node( "field", it->second ) );
-            xfield->AddAttribute( "name", it->first );
+            aWriter.Open( "field" );
+            aWriter.Attribute( "name", it->first );
+            aWriter.Text( it->second );
+            aWriter.Close();
         }
+
+        aWriter.Close();
     }
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeComponents( unsigned aCtl )
+void NETLIST_EXPORTER_GENERIC::writeComponents( NETLIST_WRITER& aWriter, unsigned aCtl )
 {
-    XNODE* xcomps = node( "components" );
+    aWriter.Open( "components" );
 
     m_ReferencesAlreadyFound.Clear();
     m_LibParts.clear();
+    m_unitsByRef.clear();
 
     SCH_SHEET_LIST sheetList = m_schematic->GetSheets();
 
@@ -279,94 +343,95 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeComponents( unsigned aCtl )
             // under XSL processing systems which do sequential searching within
             // an element.
 
-            XNODE* xcomp;  // current component being constructed
-            xcomps->AddChild( xcomp = node( "comp" ) );
+            aWriter.Open( "comp" );     // current component being written
 
-            xcomp->AddAttribute( "ref", comp->GetRef( &sheet ) );
-            addComponentFields( xcomp, comp, &sheetList[ii] );
+            aWriter.Attribute( "ref", comp->GetRef( &sheet ) );
+            writeComponentFields( aWriter, comp, &sheetList[ii] );
 
-            XNODE*  xlibsource;
-            xcomp->AddChild( xlibsource = node( "libsource" ) );
+            aWriter.Open( "libsource" );
 
             // "logical" library name, which is in anticipation of a better search
             // algorithm for parts based on "logical_lib.part" and where logical_lib
             // is merely the library name minus path and extension.
             if( comp->GetPartRef() )
-                xlibsource->AddAttribute( "lib", comp->GetPartRef()->GetLibId().GetLibNickname() );
+                aWriter.Attribute( "lib", comp->GetPartRef()->GetLibId().GetLibNickname() );
 
             // We only want the symbol name, not the full LIB_ID.
-            xlibsource->AddAttribute( "part", comp->GetLibId().GetLibItemName() );
-
-            xlibsource->AddAttribute( "description", comp->GetDescription() );
+            aWriter.Attribute( "part", comp->GetLibId().GetLibItemName() );
 
-            XNODE* xproperty;
+            aWriter.Attribute( "description", comp->GetDescription() );
+            aWriter.Close();
 
             std::vector<SCH_FIELD>& fields = comp->GetFields();
 
             for( size_t jj = MANDATORY_FIELDS; jj < fields.size(); ++jj )
             {
-                xcomp->AddChild( xproperty = node( "property" ) );
-                xproperty->AddAttribute( "name", fields[jj].GetName() );
-                xproperty->AddAttribute( "value", fields[jj].GetText() );
+                aWriter.Open( "property" );
+                aWriter.Attribute( "name", fields[jj].GetName() );
+                aWriter.Attribute( "value", fields[jj].GetText() );
+                aWriter.Close();
             }
 
             for( const SCH_FIELD& sheetField : sheet.Last()->GetFields() )
             {
-                xcomp->AddChild( xproperty = node( "property" ) );
-                xproperty->AddAttribute( "name", sheetField.GetName() );
-                xproperty->AddAttribute( "value", sheetField.GetText() );
+                aWriter.Open( "property" );
+                aWriter.Attribute( "name", sheetField.GetName() );
+                aWriter.Attribute( "value", sheetField.GetText() );
+                aWriter.Close();
             }
 
             if( !comp->GetIncludeInBom() )
             {
-                xcomp->AddChild( xproperty = node( "property" ) );
-                xproperty->AddAttribute( "name", "exclude_from_bom" );
+                aWriter.Open( "property" );
+                aWriter.Attribute( "name", "exclude_from_bom" );
+                aWriter.Close();
             }
 
             if( !comp->GetIncludeOnBoard() )
             {
-                xcomp->AddChild( xproperty = node( "property" ) );
-                xproperty->AddAttribute( "name", "exclude_from_board" );
+                aWriter.Open( "property" );
+                aWriter.Attribute( "name", "exclude_from_board" );
+                aWriter.Close();
             }
 
-            XNODE* xsheetpath;
-            xcomp->AddChild( xsheetpath = node( "sheetpath" ) );
+            aWriter.Open( "sheetpath" );
+            aWriter.Attribute( "names", sheet.PathHumanReadable() );
+            aWriter.Attribute( "tstamps", sheet.PathAsString() );
+            aWriter.Close();
 
-            xsheetpath->AddAttribute( "names", sheet.PathHumanReadable() );
-            xsheetpath->AddAttribute( "tstamps", sheet.PathAsString() );
-            xcomp->AddChild( node( "tstamp", comp->m_Uuid.AsString() ) );
+            aWriter.Leaf( "tstamp", comp->m_Uuid.AsString() );
+            aWriter.Close();
         }
     }
 
-    return xcomps;
+    aWriter.Close();
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeDesignHeader()
+void NETLIST_EXPORTER_GENERIC::writeDesignHeader( NETLIST_WRITER& aWriter )
 {
     SCH_SCREEN* screen;
-    XNODE*      xdesign = node( "design" );
-    XNODE*      xtitleBlock;
-    XNODE*      xsheet;
-    XNODE*      xcomment;
-    XNODE*      xtextvar;
     wxString    sheetTxt;
     wxFileName  sourceFileName;
 
+    aWriter.Open( "design" );
+
     // the root sheet is a special sheet, call it source
-    xdesign->AddChild( node( "source", m_schematic->GetFileName() ) );
+    aWriter.Leaf( "source", m_schematic->GetFileName() );
 
-    xdesign->AddChild( node( "date", DateAndTime() ) );
+    aWriter.Leaf( "date", DateAndTime() );
 
     // which Eeschema tool
-    xdesign->AddChild( node( "tool", wxString( "Eeschema " ) + GetBuildVersion() ) );
+    aWriter.Leaf( "tool", wxString( "Eeschema " ) + GetBuildVersion() );
 
     const std::map<wxString, wxString>& properties = m_schematic->Prj().GetTextVars();
 
     for( const std::pair<const wxString, wxString>& prop : properties )
     {
-        xdesign->AddChild( xtextvar = node( "textvar", prop.second ) );
-        xtextvar->AddAttribute( "name", prop.first );
+        aWriter.Open( "textvar" );
+        aWriter.Attribute( "name", prop.first );
+        aWriter.Text( prop.second );
+        aWriter.Close();
     }
 
     /*
@@ -378,98 +443,74 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeDesignHeader()
     {
         screen = sheetList[i].LastScreen();
 
-        xdesign->AddChild( xsheet = node( "sheet" ) );
+        aWriter.Open( "sheet" );
 
         // get the string representation of the sheet index number.
         // Note that sheet->GetIndex() is zero index base and we need to increment the
         // number by one to make it human readable
         sheetTxt.Printf( "%u", i + 1 );
-        xsheet->AddAttribute( "number", sheetTxt );
-        xsheet->AddAttribute( "name", sheetList[i].PathHumanReadable() );
-        xsheet->AddAttribute( "tstamps", sheetList[i].PathAsString() );
+        aWriter.Attribute( "number", sheetTxt );
+        aWriter.Attribute( "name", sheetList[i].PathHumanReadable() );
+        aWriter.Attribute( "tstamps", sheetList[i].PathAsString() );
 
 
         TITLE_BLOCK tb = screen->GetTitleBlock();
 
-        xsheet->AddChild( xtitleBlock = node( "title_block" ) );
+        aWriter.Open( "title_block" );
 
-        xtitleBlock->AddChild( node( "title", tb.GetTitle() ) );
-        xtitleBlock->AddChild( node( "company", tb.GetCompany() ) );
-        xtitleBlock->AddChild( node( "rev", tb.GetRevision() ) );
-        xtitleBlock->AddChild( node( "date", tb.GetDate() ) );
+        aWriter.Leaf( "title", tb.GetTitle() );
+        aWriter.Leaf( "company", tb.GetCompany() );
+        aWriter.Leaf( "rev", tb.GetRevision() );
+        aWriter.Leaf( "date", tb.GetDate() );
 
         // We are going to remove the fileName directories.
         sourceFileName = wxFileName( screen->GetFileName() );
-        xtitleBlock->AddChild( node( "source", sourceFileName.GetFullName() ) );
-
-        xtitleBlock->AddChild( xcomment = node( "comment" ) );
-        xcomment->AddAttribute( "number", "1" );
-        xcomment->AddAttribute( "value", tb.GetComment( 0 ) );
-
-        xtitleBlock->AddChild( xcomment = node( "comment" ) );
-        xcomment->AddAttribute( "number", "2" );
-        xcomment->AddAttribute( "value", tb.GetComment( 1 ) );
+        aWriter.Leaf( "source", sourceFileName.GetFullName() );
 
-        xtitleBlock->AddChild( xcomment = node( "comment" ) );
-        xcomment->AddAttribute( "number", "3" );
-        xcomment->AddAttribute( "value", tb.GetComment( 2 ) );
-
-        xtitleBlock->AddChild( xcomment = node( "comment" ) );
-        xcomment->AddAttribute( "number", "4" );
-        xcomment->AddAttribute( "value", tb.GetComment( 3 ) );
-
-        xtitleBlock->AddChild( xcomment = node( "comment" ) );
-        xcomment->AddAttribute( "number", "5" );
-        xcomment->AddAttribute( "value", tb.GetComment( 4 ) );
-
-        xtitleBlock->AddChild( xcomment = node( "comment" ) );
-        xcomment->AddAttribute( "number", "6" );
-        xcomment->AddAttribute( "value", tb.GetComment( 5 ) );
-
-        xtitleBlock->AddChild( xcomment = node( "comment" ) );
-        xcomment->AddAttribute( "number", "7" );
-        xcomment->AddAttribute( "value", tb.GetComment( 6 ) );
-
-        xtitleBlock->AddChild( xcomment = node( "comment" ) );
-        xcomment->AddAttribute( "number", "8" );
-        xcomment->AddAttribute( "value", tb.GetComment( 7 ) );
+        for( int ii = 0; ii < 9; ii++ )
+        {
+            aWriter.Open( "comment" );
+            aWriter.Attribute( "number", wxString::Format( "%d", ii + 1 ) );
+            aWriter.Attribute( "value", tb.GetComment( ii ) );
+            aWriter.Close();
+        }
 
-        xtitleBlock->AddChild( xcomment = node( "comment" ) );
-        xcomment->AddAttribute( "number", "9" );
-        xcomment->AddAttribute( "value", tb.GetComment( 8 ) );
+        aWriter.Close();    // title_block
+        aWriter.Close();    // sheet
     }
 
-    return xdesign;
+    aWriter.Close();
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeLibraries()
+void NETLIST_EXPORTER_GENERIC::writeLibraries( NETLIST_WRITER& aWriter )
 {
-    XNODE*            xlibs = node( "libraries" );     // auto_ptr
     SYMBOL_LIB_TABLE* symbolLibTable = m_schematic->Prj().SchSymbolLibTable();
 
+    aWriter.Open( "libraries" );
+
     for( std::set<wxString>::iterator it = m_libraries.begin(); it!=m_libraries.end();  ++it )
     {
         wxString    libNickname = *it;
-        XNODE*      xlibrary;
 
         if( symbolLibTable->HasLibrary( libNickname ) )
         {
-            xlibs->AddChild( xlibrary = node( "library" ) );
-            xlibrary->AddAttribute( "logical", libNickname );
-            xlibrary->AddChild( node( "uri", symbolLibTable->GetFullURI( libNickname ) ) );
+            aWriter.Open( "library" );
+            aWriter.Attribute( "logical", libNickname );
+            aWriter.Leaf( "uri", symbolLibTable->GetFullURI( libNickname ) );
+            aWriter.Close();
         }
 
         // @todo: add more fun stuff here
     }
 
-    return xlibs;
+    aWriter.Close();
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
+void NETLIST_EXPORTER_GENERIC::writeLibParts( NETLIST_WRITER& aWriter )
 {
-    XNODE*      xlibparts = node( "libparts" );   // auto_ptr
+    aWriter.Open( "libparts" );
 
     LIB_PINS    pinList;
     LIB_FIELDS  fieldList;
@@ -484,47 +525,49 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
         if( !libNickname.IsEmpty() )
             m_libraries.insert( libNickname );  // inserts component's library if unique
 
-        XNODE* xlibpart;
-        xlibparts->AddChild( xlibpart = node( "libpart" ) );
-        xlibpart->AddAttribute( "lib", libNickname );
-        xlibpart->AddAttribute( "part", lcomp->GetName()  );
+        aWriter.Open( "libpart" );
+        aWriter.Attribute( "lib", libNickname );
+        aWriter.Attribute( "part", lcomp->GetName()  );
 
         //----- show the important properties -------------------------
         if( !lcomp->GetDescription().IsEmpty() )
-            xlibpart->AddChild( node( "description", lcomp->GetDescription() ) );
+            aWriter.Leaf( "description", lcomp->GetDescription() );
 
         if( !lcomp->GetDatasheetField().GetText().IsEmpty() )
-            xlibpart->AddChild( node( "docs",  lcomp->GetDatasheetField().GetText() ) );
+            aWriter.Leaf( "docs",  lcomp->GetDatasheetField().GetText() );
 
         // Write the footprint list
         if( lcomp->GetFootprints().GetCount() )
         {
-            XNODE*  xfootprints;
-            xlibpart->AddChild( xfootprints = node( "footprints" ) );
+            aWriter.Open( "footprints" );
 
             for( unsigned i=0; i<lcomp->GetFootprints().GetCount(); ++i )
             {
-                xfootprints->AddChild( node( "fp", lcomp->GetFootprints()[i] ) );
+                aWriter.Leaf( "fp", lcomp->GetFootprints()[i] );
             }
+
+            aWriter.Close();
         }
 
         //----- show the fields here ----------------------------------
         fieldList.clear();
         lcomp->GetFields( fieldList );
 
-        XNODE*     xfields;
-        xlibpart->AddChild( xfields = node( "fields" ) );
+        aWriter.Open( "fields" );
 
         for( unsigned i=0;  i<fieldList.size();  ++i )
         {
             if( !fieldList[i].GetText().IsEmpty() )
             {
-                XNODE*     xfield;
-                xfields->AddChild( xfield = node( "field", fieldList[i].GetText() ) );
-                xfield->AddAttribute( "name", fieldList[i].GetCanonicalName() );
+                aWriter.Open( "field" );
+                aWriter.Attribute( "name", fieldList[i].GetCanonicalName() );
+                aWriter.Text( fieldList[i].GetText() );
+                aWriter.Close();
             }
         }
 
+        aWriter.Close();
+
         //----- show the pins here ------------------------------------
         pinList.clear();
         lcomp->GetPins( pinList, 0, 0 );
@@ -549,35 +592,32 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
 
         if( pinList.size() )
         {
-            XNODE*     pins;
+            aWriter.Open( "pins" );
 
-            xlibpart->AddChild( pins = node( "pins" ) );
             for( unsigned i=0; i<pinList.size();  ++i )
             {
-                XNODE*     pin;
-
-                pins->AddChild( pin = node( "pin" ) );
-                pin->AddAttribute( "num", pinList[i]->GetNumber() );
-                pin->AddAttribute( "name", pinList[i]->GetName() );
-                pin->AddAttribute( "type", pinList[i]->GetCanonicalElectricalTypeName() );
+                aWriter.Open( "pin" );
+                aWriter.Attribute( "num", pinList[i]->GetNumber() );
+                aWriter.Attribute( "name", pinList[i]->GetName() );
+                aWriter.Attribute( "type", pinList[i]->GetCanonicalElectricalTypeName() );
 
                 // caution: construction work site here, drive slowly
+                aWriter.Close();
             }
+
+            aWriter.Close();
         }
+
+        aWriter.Close();
     }
 
-    return xlibparts;
+    aWriter.Close();
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets()
+void NETLIST_EXPORTER_GENERIC::writeListOfNets( NETLIST_WRITER& aWriter )
 {
-    XNODE*      xnets = node( "nets" );      // auto_ptr if exceptions ever get used.
     wxString    netCodeTxt;
-    wxString    netName;
-    wxString    ref;
-
-    XNODE*      xnet = 0;
 
     /*  output:
         <net code="123" name="/cfcard.sch/WAIT#">
@@ -586,66 +626,64 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets()
         </net>
     */
 
+    aWriter.Open( "nets" );
+
     int code = 0;
 
+    // The pins of a net, with the reference of their component looked up only once
+    std::vector<std::pair<wxString, SCH_PIN*>> sorted_items;
+
     for( const auto& it : m_schematic->ConnectionGraph()->GetNetMap() )
     {
-        bool     added     = false;
-        wxString net_name  = it.first.first;
-        auto     subgraphs = it.second;
+        bool            added     = false;
+        const wxString& net_name  = it.first.first;
 
         // Code starts at 1
         code++;
 
-        XNODE* xnode;
-        std::vector<std::pair<SCH_PIN*, SCH_SHEET_PATH>> sorted_items;
+        sorted_items.clear();
 
-        for( CONNECTION_SUBGRAPH* subgraph : subgraphs )
+        for( CONNECTION_SUBGRAPH* subgraph : it.second )
         {
             const SCH_SHEET_PATH& sheet = subgraph->m_sheet;
 
             for( SCH_ITEM* item : subgraph->m_items )
             {
                 if( item->Type() == SCH_PIN_T )
-                    sorted_items.emplace_back( static_cast<SCH_PIN*>( item ), sheet );
+                {
+                    SCH_PIN* pin = static_cast<SCH_PIN*>( item );
+
+                    sorted_items.emplace_back( pin->GetParentComponent()->GetRef( &sheet ), pin );
+                }
             }
         }
 
         // Netlist ordering: Net name, then ref des, then pin name
         std::sort( sorted_items.begin(), sorted_items.end(),
-                   []( const std::pair<SCH_PIN*, SCH_SHEET_PATH>& a,
-                       const std::pair<SCH_PIN*, SCH_SHEET_PATH>& b )
+                   []( const std::pair<wxString, SCH_PIN*>& a,
+                       const std::pair<wxString, SCH_PIN*>& b )
                    {
-                       wxString ref_a = a.first->GetParentComponent()->GetRef( &a.second );
-                       wxString ref_b = b.first->GetParentComponent()->GetRef( &b.second );
-
-                       if( ref_a == ref_b )
-                           return a.first->GetNumber() < b.first->GetNumber();
+                       if( a.first == b.first )
+                           return a.second->GetNumber() < b.second->GetNumber();
 
-                       return ref_a < ref_b;
+                       return a.first < b.first;
                    } );
 
         // Some duplicates can exist, for example on multi-unit parts with duplicated
         // pins across units.  If the user connects the pins on each unit, they will
         // appear on separate subgraphs.  Remove those here:
         sorted_items.erase( std::unique( sorted_items.begin(), sorted_items.end(),
-                []( const std::pair<SCH_PIN*, SCH_SHEET_PATH>& a,
-                    const std::pair<SCH_PIN*, SCH_SHEET_PATH>& b )
+                []( const std::pair<wxString, SCH_PIN*>& a,
+                    const std::pair<wxString, SCH_PIN*>& b )
                 {
-                    wxString ref_a = a.first->GetParentComponent()->GetRef( &a.second );
-                    wxString ref_b = b.first->GetParentComponent()->GetRef( &b.second );
-
-                    return ref_a == ref_b && a.first->GetNumber() == b.first->GetNumber();
+                    return a.first == b.first && a.second->GetNumber() == b.second->GetNumber();
                 } ),
                 sorted_items.end() );
 
-        for( const std::pair<SCH_PIN*, SCH_SHEET_PATH>& pair : sorted_items )
+        for( const std::pair<wxString, SCH_PIN*>& pair : sorted_items )
         {
-            SCH_PIN* pin = pair.first;
-            SCH_SHEET_PATH sheet = pair.second;
-
-            wxString refText = pin->GetParentComponent()->GetRef( &sheet );
-            wxString pinText = pin->GetNumber();
+            const wxString& refText = pair.first;
+            SCH_PIN*        pin = pair.second;
 
             // Skip power symbols and virtual components
             if( refText[0] == wxChar( '#' ) )
@@ -653,17 +691,17 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets()
 
             if( !added )
             {
-                xnets->AddChild( xnet = node( "net" ) );
+                aWriter.Open( "net" );
                 netCodeTxt.Printf( "%d", code );
-                xnet->AddAttribute( "code", netCodeTxt );
-                xnet->AddAttribute( "name", net_name );
+                aWriter.Attribute( "code", netCodeTxt );
+                aWriter.Attribute( "name", net_name );
 
                 added = true;
             }
 
-            xnet->AddChild( xnode = node( "node" ) );
-            xnode->AddAttribute( "ref", refText );
-            xnode->AddAttribute( "pin", pinText );
+            aWriter.Open( "node" );
+            aWriter.Attribute( "ref", refText );
+            aWriter.Attribute( "pin", pin->GetNumber() );
 
             wxString pinName;
 
@@ -671,23 +709,16 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets()
                 pinName = pin->GetName();
 
             if( !pinName.IsEmpty() )
-                xnode->AddAttribute( "pinfunction", pinName );
-        }
-    }
+                aWriter.Attribute( "pinfunction", pinName );
 
-    return xnets;
-}
-
-
-XNODE* NETLIST_EXPORTER_GENERIC::node( const wxString& aName,
-        const wxString& aTextualContent /* = wxEmptyString*/ )
-{
-    XNODE* n = new XNODE( wxXML_ELEMENT_NODE, aName );
+            aWriter.Close();
+        }
 
-    if( aTextualContent.Len() > 0 )     // excludes wxEmptyString, the parameter's default value
-        n->AddChild( new XNODE( wxXML_TEXT_NODE, wxEmptyString, aTextualContent ) );
+        if( added )
+            aWriter.Close();
+    }
 
-    return n;
+    aWriter.Close();
 }
 
 
@@ -29,6 +29,7 @@
 #include <netlist_exporter.h>
 
 #include <project.h>
+#include <netlist_writer.h>
 #include <xnode.h>      // also nests: <wx/xml/xml.h>
 
 #include <sch_edit_frame.h>
@@ -86,56 +87,55 @@ public:
 #define GNL_ALL     ( GNL_LIBRARIES | GNL_COMPONENTS | GNL_PARTS | GNL_HEADER | GNL_NETS )
 
 protected:
-   /**
-     * A convenience function that creates a new XNODE with an optional textual child.
-     * It also provides some insulation from a possible change in XML library.
-     *
-     * @param aName is the name to associate with a new node of type wxXML_ELEMENT_NODE.
-     * @param aTextualContent is optional, and if given is the text to include in a child
-     *   of the returned node, and has type wxXML_TEXT_NODE.
-     */
-    XNODE* node( const wxString& aName, const wxString& aTextualContent = wxEmptyString );
-
     /**
-     * Build the entire document tree for the generic export.  This is factored
-     * out here so we can write the tree in either S-expression file format
-     * or in XML if we put the tree built here into a wxXmlDocument.
+     * Build the entire document tree for the generic export.  This is used to write the
+     * tree in XML, by putting it into a wxXmlDocument.
      * @param aCtl - a bitset or-ed together from GNL_ENUM values
      * @return XNODE* - the root nodes
      */
     XNODE* makeRoot( int aCtl = GNL_ALL );
 
     /**
-     * @return XNODE* - returns a sub-tree holding all the schematic components.
+     * Write the entire document for the generic export to \a aWriter, element by element.
+     * This is factored out here so we can write the document in either S-expression file
+     * format, in XML or straight into another netlist model.
+     * @param aCtl - a bitset or-ed together from GNL_ENUM values
      */
-    XNODE* makeComponents( unsigned aCtl );
+    void writeRoot( NETLIST_WRITER& aWriter, int aCtl = GNL_ALL );
 
     /**
-     * Fills out a project "design" header into an XML node.
-     * @return XNODE* - the design header
+     * Write the list of all the schematic components.
      */
-    XNODE* makeDesignHeader();
+    void writeComponents( NETLIST_WRITER& aWriter, unsigned aCtl );
 
     /**
-     * Fill out an XML node with the unique library parts and returns it.
-     * @return XNODE* - the library parts nodes
+     * Write the project "design" header.
      */
-    XNODE* makeLibParts();
+    void writeDesignHeader( NETLIST_WRITER& aWriter );
 
     /**
-     * Fill out an XML node with a list of nets and returns it.
-     * @return XNODE* - the list of nets nodes
+     * Write the unique library parts.
      */
-    XNODE* makeListOfNets();
+    void writeLibParts( NETLIST_WRITER& aWriter );
 
     /**
-     * Fill out an XML node with a list of used libraries and returns it.
-     * Must have called makeGenericLibParts() before this function.
-     * @return XNODE* - the library nodes
+     * Write the list of nets.
      */
-    XNODE* makeLibraries();
+    void writeListOfNets( NETLIST_WRITER& aWriter );
 
-    void addComponentFields(  XNODE* xcomp, SCH_COMPONENT* comp, SCH_SHEET_PATH* aSheet );
+    /**
+     * Write the list of used libraries.
+     * Must have called writeLibParts() before this function.
+     */
+    void writeLibraries( NETLIST_WRITER& aWriter );
+
+    void writeComponentFields( NETLIST_WRITER& aWriter, SCH_COMPONENT* comp,
+                               SCH_SHEET_PATH* aSheet );
+
+private:
+    /// The units of the multi-unit components, by lower case reference, in sheet order.
+    /// Filled on demand by writeComponentFields().
+    std::map<wxString, std::vector<std::pair<SCH_COMPONENT*, SCH_SHEET_PATH>>> m_unitsByRef;
 };
 
 #endif
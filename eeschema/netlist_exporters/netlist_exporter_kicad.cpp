@@ -30,7 +30,7 @@
 #include <confirm.h>
 
 #include <sch_edit_frame.h>
-#include <xnode.h>
+#include <richio.h>
 #include <connection_graph.h>
 #include "netlist_exporter_kicad.h"
 
@@ -52,9 +52,60 @@ bool NETLIST_EXPORTER_KICAD::WriteNetlist( const wxString& aOutFileName, unsigne
 }
 
 
+/**
+ * Writes the netlist elements to an OUTPUTFORMATTER as they come, in the same layout as
+ * XNODE::Format() would write the whole tree.
+ */
+class SEXPR_NETLIST_WRITER : public NETLIST_WRITER
+{
+public:
+    SEXPR_NETLIST_WRITER( OUTPUTFORMATTER* aOut ) :
+            m_out( aOut ),
+            m_nestLevel( 0 )
+    {
+    }
+
+    void Open( const char* aName ) override
+    {
+        // Every element but the root one starts on a new line
+        if( m_nestLevel > 0 )
+            m_out->Print( 0, "\n" );
+
+        m_out->Print( m_nestLevel++, "(%s", aName );
+    }
+
+    void Attribute( const char* aName, const wxString& aValue ) override
+    {
+        m_out->Print( 0, " (%s %s)", aName, m_out->Quotew( aValue ).c_str() );
+    }
+
+    void Text( const wxString& aText ) override
+    {
+        if( !aText.IsEmpty() )
+            m_out->Print( 0, " %s", m_out->Quotew( aText ).c_str() );
+    }
+
+    void Close() override
+    {
+        m_nestLevel--;
+        m_out->Print( 0, ")" );
+    }
+
+private:
+    OUTPUTFORMATTER* m_out;
+    int              m_nestLevel;
+};
+
+
 void NETLIST_EXPORTER_KICAD::Format( OUTPUTFORMATTER* aOut, int aCtl )
 {
-    std::unique_ptr<XNODE> xroot( makeRoot( aCtl ) );
+    SEXPR_NETLIST_WRITER writer( aOut );
+
+    writeRoot( writer, aCtl );
+}
+
 
-    xroot->Format( aOut, 0 );
+void NETLIST_EXPORTER_KICAD::Format( NETLIST_WRITER* aWriter, int aCtl )
+{
+    writeRoot( *aWriter, aCtl );
 }
@@ -57,6 +57,13 @@ public:
      * @throw IO_ERROR if any problems.
      */
     void Format( OUTPUTFORMATTER* aOutputFormatter, int aCtl );
+
+    /**
+     * Give this netlist to @a aWriter, element by element, without formatting it to text.
+     *
+     * @param aCtl is bit set composed by OR-ing together enum GNL bits.
+     */
+    void Format( NETLIST_WRITER* aWriter, int aCtl );
 };
 
 #endif
@@ -378,7 +378,7 @@ void SCH_CONNECTION::AppendInfoToMsgPanel( MSG_PANEL_ITEMS& aList ) const
 #if defined(DEBUG)
     // These messages are not flagged as translatable, because they are only debug messages
 
-    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity || !CONNECTION_GRAPH::m_allowRealTime )
+    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity )
         return;
 
     if( IsBus() )
@@ -71,6 +71,7 @@
 #include <tools/sch_editor_control.h>
 #include <tools/sch_line_wire_bus_tool.h>
 #include <tools/sch_move_tool.h>
+#include <trace_profiler.h>
 #include <widgets/infobar.h>
 #include <wildcards_and_files_ext.h>
 #include <wx/cmdline.h>
@@ -706,8 +707,8 @@ void SCH_EDIT_FRAME::OnModify()
     GetScreen()->SetModify();
     GetScreen()->SetSave();
 
-    if( ADVANCED_CFG::GetCfg().m_realTimeConnectivity && CONNECTION_GRAPH::m_allowRealTime )
-        RecalculateConnections( NO_CLEANUP );
+    if( ADVANCED_CFG::GetCfg().m_realTimeConnectivity )
+        RecalculateConnections( NO_CLEANUP, false );
 
     GetCanvas()->Refresh();
 }
@@ -1060,7 +1061,7 @@ void SCH_EDIT_FRAME::AddItemToScreenAndUndoList( SCH_SCREEN* aScreen, SCH_ITEM*
 
         // Update connectivity info for new item
         if( !aItem->IsMoving() )
-            RecalculateConnections( LOCAL_CLEANUP );
+            RecalculateConnections( LOCAL_CLEANUP, false );
     }
 
     aItem->ClearFlags( IS_NEW );
@@ -1125,8 +1126,11 @@ void SCH_EDIT_FRAME::UpdateTitle()
 }
 
 
-void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
+void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags,
+                                             bool aUnconditional )
 {
+    TRACE_ZONE( "SCH_EDIT_FRAME::RecalculateConnections", "schematic" );
+
     SCH_SHEET_LIST list = Schematic().GetSheets();
     PROF_COUNTER   timer;
 
@@ -1144,7 +1148,7 @@ void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
     timer.Stop();
     wxLogTrace( "CONN_PROFILE", "SchematicCleanUp() %0.4f ms", timer.msecs() );
 
-    Schematic().ConnectionGraph()->Recalculate( list, true );
+    Schematic().ConnectionGraph()->Recalculate( list, aUnconditional );
 }
 
 
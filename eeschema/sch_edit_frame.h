@@ -901,8 +901,11 @@ public:
 
     /**
      * Generates the connection data for the entire schematic hierarchy.
+     *
+     * @param aUnconditional set to false to only update the connections of the items that
+     *                       changed since the last call (see CONNECTION_GRAPH::Recalculate).
      */
-    void RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags );
+    void RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags, bool aUnconditional = true );
 
     /**
      * Allows Eeschema to install its preferences panels into the preferences dialog.
@@ -194,6 +194,7 @@ SCH_CONNECTION* SCH_ITEM::InitializeConnection( const SCH_SHEET_PATH& aSheet,
     {
         Connection( aSheet )->Reset();
         Connection( aSheet )->SetSheet( aSheet );
+        Connection( aSheet )->SetGraph( aGraph );
         return Connection( aSheet );
     }
 
@@ -112,6 +112,13 @@ public:
      */
     void Annotate();
 
+    /**
+     * Function IsAnnotationChanged
+     * returns whether Annotate() would change the reference or the unit of the component,
+     * so components which keep their annotation are left untouched.
+     */
+    bool IsAnnotationChanged() const;
+
     /**
      * Function Split
      * attempts to split the reference designator into a name (U) and number (1).  If the
@@ -326,6 +333,12 @@ public:
      * occurs with sheet number 3.  If there are 150 items in sheet number 2, then items are
      * referenced U201 to U351, and items in sheet 3 start from U352
      * </p>
+     * <p>
+     * Annotated components keep their reference.  Besides building the indexes of the list,
+     * only the components not annotated yet, and the packages their units can complete, are
+     * looked at.  Use SCH_REFERENCE::IsAnnotationChanged() to update only the components
+     * whose annotation changed.
+     * </p>
      */
     void Annotate( bool aUseSheetNum, int aSheetIntervalId, int aStartNumber,
                    SCH_MULTI_UNIT_REFERENCE_MAP aLockedUnitMap );
@@ -59,6 +59,7 @@
 #include <tool/common_tools.h>
 
 #include <thread>
+#include <unordered_map>
 #include <algorithm>
 #include <future>
 
@@ -1001,18 +1002,94 @@ void SCH_SCREEN::GetSheets( std::vector<SCH_ITEM*>* aItems )
 }
 
 
-bool SCH_SCREEN::TestDanglingEnds( const SCH_SHEET_PATH* aPath )
+bool SCH_SCREEN::TestDanglingEnds( const SCH_SHEET_PATH* aPath,
+                                   std::function<void( SCH_ITEM* )>* aChangedHandler )
 {
-    std::vector< DANGLING_END_ITEM > endPoints;
-    bool hasStateChanged = false;
+    std::vector<DANGLING_END_ITEM>                    endPoints;
+    std::unordered_map<wxPoint, std::vector<size_t>>  pointIndex;
+    std::unordered_map<SCH_ITEM*, size_t>             firstEndPoint;
+    bool                                              hasStateChanged = false;
 
     for( SCH_ITEM* item : Items() )
+    {
+        firstEndPoint[ item ] = endPoints.size();
         item->GetEndPoints( endPoints );
+    }
+
+    for( size_t ii = 0; ii < endPoints.size(); ++ii )
+        pointIndex[ endPoints[ii].GetPosition() ].push_back( ii );
+
+    std::vector<wxPoint>           points;
+    std::vector<size_t>            nearby;
+    std::vector<DANGLING_END_ITEM> nearbyEndPoints;
 
     for( SCH_ITEM* item : Items() )
     {
-        if( item->UpdateDanglingState( endPoints, aPath ) )
+        points.clear();
+        nearby.clear();
+        nearbyEndPoints.clear();
+
+        // Symbols test all their pins, not only the ones of their current unit
+        if( item->Type() == SCH_COMPONENT_T )
+        {
+            for( std::unique_ptr<SCH_PIN>& pin : static_cast<SCH_COMPONENT*>( item )->GetRawPins() )
+                points.push_back( pin->GetTransformedPosition() );
+        }
+        else
+        {
+            points = item->GetConnectionPoints();
+        }
+
+        for( const wxPoint& point : points )
+        {
+            auto it = pointIndex.find( point );
+
+            if( it != pointIndex.end() )
+            {
+                // Wire and bus ends are used by pairs: keep both ends of the segment
+                for( size_t ii : it->second )
+                {
+                    nearby.push_back( ii );
+
+                    switch( endPoints[ii].GetType() )
+                    {
+                    case WIRE_START_END:
+                    case BUS_START_END:   nearby.push_back( ii + 1 ); break;
+                    case WIRE_END_END:
+                    case BUS_END_END:     nearby.push_back( ii - 1 ); break;
+                    default:                                          break;
+                    }
+                }
+            }
+
+            // Labels and bus entries also connect to the middle of wires and buses
+            for( SCH_ITEM* line : Items().Overlapping( SCH_LINE_T, point, 1 ) )
+            {
+                auto first = firstEndPoint.find( line );
+
+                if( first != firstEndPoint.end() && first->second + 1 < endPoints.size()
+                        && endPoints[first->second].GetItem() == line )
+                {
+                    nearby.push_back( first->second );
+                    nearby.push_back( first->second + 1 );
+                }
+            }
+        }
+
+        // Same order as the full list, which the items rely on to pair segment ends
+        std::sort( nearby.begin(), nearby.end() );
+        nearby.erase( std::unique( nearby.begin(), nearby.end() ), nearby.end() );
+
+        for( size_t ii : nearby )
+            nearbyEndPoints.push_back( endPoints[ii] );
+
+        if( item->UpdateDanglingState( nearbyEndPoints, aPath ) )
+        {
             hasStateChanged = true;
+
+            if( aChangedHandler )
+                ( *aChangedHandler )( item );
+        }
     }
 
     return hasStateChanged;
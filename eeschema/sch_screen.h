@@ -25,6 +25,7 @@
 #ifndef SCREEN_H
 #define SCREEN_H
 
+#include <functional>
 #include <memory>
 #include <stddef.h>
 #include <unordered_set>
@@ -317,10 +318,17 @@ public:
 
     /**
      * Test all of the connectable objects in the schematic for unused connection points.
+     *
+     * Each item is only tested against the end points at its own connection points and the
+     * wires and buses going through them, found with a point index of the end points and
+     * with the item tree, rather than against all the end points of the screen.
+     *
      * @param aPath is a sheet path to pass to UpdateDanglingState if desired
+     * @param aChangedHandler is called for each item whose connection state changed, if given
      * @return True if any connection state changes were made.
      */
-    bool TestDanglingEnds( const SCH_SHEET_PATH* aPath = nullptr );
+    bool TestDanglingEnds( const SCH_SHEET_PATH* aPath = nullptr,
+                           std::function<void( SCH_ITEM* )>* aChangedHandler = nullptr );
 
     /**
      * Return all wires and junctions connected to \a aSegment which are not connected any
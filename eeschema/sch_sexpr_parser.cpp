@@ -27,6 +27,8 @@
 // For some reason wxWidgets is built with wxUSE_BASE64 unset so expose the wxWidgets
 // base64 code.
 #define wxUSE_BASE64 1
+#include <limits>
+
 #include <wx/base64.h>
 #include <wx/mstream.h>
 #include <wx/tokenzr.h>
@@ -63,7 +65,8 @@ SCH_SEXPR_PARSER::SCH_SEXPR_PARSER( LINE_READER* aLineReader ) :
     m_requiredVersion( 0 ),
     m_fieldId( 0 ),
     m_unit( 1 ),
-    m_convert( 1 )
+    m_convert( 1 ),
+    m_fastPath( true )
 {
 }
 
@@ -393,8 +396,53 @@ LIB_ITEM* SCH_SEXPR_PARSER::ParseDrawItem()
 }
 
 
+///> Longest text pooled by SCH_SEXPR_PARSER::pooledText(), longer ones are rarely repeated
+static const size_t MAX_POOLED_TEXT = 64;
+
+///> Number of decimals of a length in millimeters that internal units can represent
+static const int IU_DECIMALS = 4;
+
+static_assert( IU_PER_MM == 1e4, "IU_DECIMALS doesn't match IU_PER_MM" );
+
+
+bool SCH_SEXPR_PARSER::fastInternalUnits( const char* aText, int& aResult )
+{
+    // Same limit as parseInternalUnits(), values above it are clamped by the slow path
+    const long long int_limit = std::numeric_limits<int>::max() * 0.7071;
+
+    long long iu;
+
+    if( !ParseFixedPoint( aText, IU_DECIMALS, int_limit, iu ) )
+        return false;
+
+    aResult = (int) iu;
+    return true;
+}
+
+
+wxString SCH_SEXPR_PARSER::pooledText()
+{
+    const std::string& text = CurStr();
+
+    if( !m_fastPath || text.size() > MAX_POOLED_TEXT )
+        return FromUTF8();
+
+    auto it = m_stringPool.find( text );
+
+    if( it == m_stringPool.end() )
+        it = m_stringPool.emplace( text, FromUTF8() ).first;
+
+    return it->second;
+}
+
+
 double SCH_SEXPR_PARSER::parseDouble()
 {
+    double fastValue;
+
+    if( m_fastPath && ParseDecimal( CurText(), fastValue ) )
+        return fastValue;
+
     char* tmp;
 
     errno = 0;
@@ -733,7 +781,7 @@ void SCH_SEXPR_PARSER::parseProperty( std::unique_ptr<LIB_PART>& aSymbol )
         THROW_IO_ERROR( error );
     }
 
-    name = FromUTF8();
+    name = pooledText();
 
     if( name.IsEmpty() )
     {
@@ -753,7 +801,7 @@ void SCH_SEXPR_PARSER::parseProperty( std::unique_ptr<LIB_PART>& aSymbol )
     }
 
     // Empty property values are valid.
-    value = FromUTF8();
+    value = pooledText();
 
     field->SetText( value );
 
@@ -1206,7 +1254,7 @@ LIB_PIN* SCH_SEXPR_PARSER::parsePin()
                 THROW_IO_ERROR( error );
             }
 
-            pin->SetName( FromUTF8() );
+            pin->SetName( pooledText() );
             token = NextTok();
 
             if( token != T_RIGHT )
@@ -1241,7 +1289,7 @@ LIB_PIN* SCH_SEXPR_PARSER::parsePin()
                 THROW_IO_ERROR( error );
             }
 
-            pin->SetNumber( FromUTF8() );
+            pin->SetNumber( pooledText() );
             token = NextTok();
 
             if( token != T_RIGHT )
@@ -1279,7 +1327,7 @@ LIB_PIN* SCH_SEXPR_PARSER::parsePin()
                 THROW_IO_ERROR( error );
             }
 
-            alt.m_Name = FromUTF8();
+            alt.m_Name = pooledText();
 
             token = NextTok();
             alt.m_Type = parseType( token );
@@ -1445,7 +1493,7 @@ LIB_TEXT* SCH_SEXPR_PARSER::parseText()
         THROW_IO_ERROR( error );
     }
 
-    text->SetText( FromUTF8() );
+    text->SetText( pooledText() );
 
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
     {
@@ -1653,7 +1701,7 @@ SCH_FIELD* SCH_SEXPR_PARSER::parseSchField( SCH_ITEM* aParent )
         THROW_IO_ERROR( error );
     }
 
-    name = FromUTF8();
+    name = pooledText();
 
     if( name.IsEmpty() )
     {
@@ -1672,7 +1720,7 @@ SCH_FIELD* SCH_SEXPR_PARSER::parseSchField( SCH_ITEM* aParent )
     }
 
     // Empty property values are valid.
-    value = FromUTF8();
+    value = pooledText();
 
     std::unique_ptr<SCH_FIELD> field( new SCH_FIELD( wxDefaultPosition, -1, aParent, name ) );
 
@@ -1836,7 +1884,7 @@ void SCH_SEXPR_PARSER::parseSchSymbolInstances( SCH_SCREEN* aScreen )
                 {
                 case T_reference:
                     NeedSYMBOL();
-                    instance.m_Reference = FromUTF8();
+                    instance.m_Reference = pooledText();
                     NeedRIGHT();
                     break;
 
@@ -1847,13 +1895,13 @@ void SCH_SEXPR_PARSER::parseSchSymbolInstances( SCH_SCREEN* aScreen )
 
                 case T_value:
                     NeedSYMBOL();
-                    instance.m_Value = FromUTF8();
+                    instance.m_Value = pooledText();
                     NeedRIGHT();
                     break;
 
                 case T_footprint:
                     NeedSYMBOL();
-                    instance.m_Footprint = FromUTF8();
+                    instance.m_Footprint = pooledText();
                     NeedRIGHT();
                     break;
 
@@ -2084,7 +2132,7 @@ SCH_COMPONENT* SCH_SEXPR_PARSER::parseSchematicSymbol()
                 THROW_IO_ERROR( error );
             }
 
-            libName = FromUTF8();
+            libName = pooledText();
             NeedRIGHT();
             break;
         }
@@ -2225,14 +2273,14 @@ SCH_COMPONENT* SCH_SEXPR_PARSER::parseSchematicSymbol()
             SCH_PIN* pin = new SCH_PIN( nullptr, symbol.get() );
 
             NeedSYMBOL();
-            pin->SetNumber( FromUTF8() );
+            pin->SetNumber( pooledText() );
 
             token = NextTok();
 
             if( token == T_alternate )
             {
                 NeedSYMBOL();
-                pin->SetAlt( FromUTF8() );
+                pin->SetAlt( pooledText() );
                 NeedRIGHT();
             }
             else
@@ -2635,7 +2683,7 @@ SCH_TEXT* SCH_SEXPR_PARSER::parseSchText()
 
     NeedSYMBOL();
 
-    text->SetText( FromUTF8() );
+    text->SetText( pooledText() );
 
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
     {
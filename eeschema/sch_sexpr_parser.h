@@ -31,6 +31,8 @@
 #ifndef __SCH_SEXPR_PARSER_H__
 #define __SCH_SEXPR_PARSER_H__
 
+#include <unordered_map>
+
 #include <convert_to_biu.h>                      // IU_PER_MM
 #include <math/util.h>                           // KiROUND, Clamp
 
@@ -83,6 +85,10 @@ class SCH_SEXPR_PARSER : public SCHEMATIC_LEXER
     int m_unit;             ///< The current unit being parsed.
     int m_convert;          ///< The current body style being parsed.
     wxString m_symbolName;  ///< The current symbol name.
+    bool m_fastPath;        ///< Use the fast number conversions and the string pool.
+
+    ///> Texts of the file already converted from UTF-8, see pooledText()
+    std::unordered_map<std::string, wxString> m_stringPool;
 
     void parseHeader( TSCHEMATIC_T::T aHeaderType, int aFileVersion );
 
@@ -112,6 +118,22 @@ class SCH_SEXPR_PARSER : public SCHEMATIC_LEXER
      */
     double parseDouble();
 
+    /**
+     * Convert \a aText, a length in millimeters, to internal units if it has no more
+     * decimals than the internal units resolution.  The conversion is then exact, using
+     * integers only.
+     *
+     * @return false if the text must be converted through a double.
+     */
+    static bool fastInternalUnits( const char* aText, int& aResult );
+
+    /**
+     * Return the current token converted from UTF-8.  Short texts are pooled per parser, so
+     * the ones repeated through a file (field names and values, pin names, labels...) are
+     * only converted once.
+     */
+    wxString pooledText();
+
     inline double parseDouble( const char* aExpected )
     {
         NeedNUMBER( aExpected );
@@ -125,6 +147,11 @@ class SCH_SEXPR_PARSER : public SCHEMATIC_LEXER
 
     inline int parseInternalUnits()
     {
+        int iu;
+
+        if( m_fastPath && fastInternalUnits( CurText(), iu ) )
+            return iu;
+
         auto retval = parseDouble() * IU_PER_MM;
 
         // Schematic internal units are represented as integers.  Any values that are
@@ -137,7 +164,14 @@ class SCH_SEXPR_PARSER : public SCHEMATIC_LEXER
 
     inline int parseInternalUnits( const char* aExpected )
     {
-        auto retval = parseDouble( aExpected ) * IU_PER_MM;
+        NeedNUMBER( aExpected );
+
+        int iu;
+
+        if( m_fastPath && fastInternalUnits( CurText(), iu ) )
+            return iu;
+
+        auto retval = parseDouble() * IU_PER_MM;
 
         double int_limit = std::numeric_limits<int>::max() * 0.7071;
 
@@ -202,6 +236,13 @@ class SCH_SEXPR_PARSER : public SCHEMATIC_LEXER
 public:
     SCH_SEXPR_PARSER( LINE_READER* aLineReader = nullptr );
 
+    /**
+     * Enable or disable the fast number conversions and the string pool, which are used by
+     * default.  Both paths give the same results; the slow one is kept as a reference for
+     * the benchmarks and the tests.
+     */
+    void SetFastPath( bool aEnable ) { m_fastPath = aEnable; }
+
     void ParseLib( LIB_PART_MAP& aSymbolLibMap );
 
     LIB_PART* ParseSymbol( LIB_PART_MAP& aSymbolLibMap,
@@ -20,6 +20,9 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
 
 // For some reason wxWidgets is built with wxUSE_BASE64 unset so expose the wxWidgets
 // base64 code.
@@ -55,6 +58,7 @@
 #include <sch_file_versions.h>
 #include <schematic_lexer.h>
 #include <sch_sexpr_parser.h>
+#include <symbol_lib_index.h>
 #include <symbol_lib_table.h>  // for PropPowerSymsOnly definintion.
 #include <ee_selection.h>
 
@@ -285,7 +289,7 @@ static void formatStroke( OUTPUTFORMATTER* aFormatter, int aNestLevel,
  */
 class SCH_SEXPR_PLUGIN_CACHE
 {
-    static int      m_modHash;      // Keep track of the modification status of the library.
+    static std::atomic<int> m_modHash;  // Keep track of the modification status of the library.
 
     wxString        m_fileName;     // Absolute path and file name.
     wxFileName      m_libFileName;  // Absolute path and file name is required here.
@@ -293,6 +297,8 @@ class SCH_SEXPR_PLUGIN_CACHE
     LIB_PART_MAP    m_symbols;      // Map of names of #LIB_PART pointers.
     bool            m_isWritable;
     bool            m_isModified;
+    bool            m_isLoaded;     // All the symbols of the library are in m_symbols.
+    std::unique_ptr<SYMBOL_LIB_INDEX> m_index;  // Where to find the symbols not loaded yet.
     int             m_versionMajor;
     int             m_versionMinor;
     int             m_libType;      // Is this cache a component or symbol library.
@@ -301,6 +307,9 @@ class SCH_SEXPR_PLUGIN_CACHE
                                    const char** aOutput );
     LIB_PART*       removeSymbol( LIB_PART* aAlias );
 
+    /// Parse a symbol from its indexed location, nullptr if the file no longer matches the index
+    LIB_PART*       parseSymbol( const LIB_SYMBOL_INFO& aInfo );
+
     static void     saveSymbolDrawItem( LIB_ITEM* aItem, OUTPUTFORMATTER& aFormatter,
                                         int aNestLevel );
     static void     saveArc( LIB_ARC* aArc, OUTPUTFORMATTER& aFormatter, int aNestLevel = 0 );
@@ -334,8 +343,25 @@ public:
     /// Save the entire library to file m_libFileName;
     void Save();
 
+    /// Load all the symbols of the library.
     void Load();
 
+    /**
+     * Load the index of the library only: the symbols are then parsed one by one, when
+     * LoadSymbol() asks for them.  Falls back to Load() if the library cannot be indexed.
+     */
+    void LoadIndex();
+
+    bool IsLoaded() const { return m_isLoaded; }
+
+    void SetLoaded() { m_isLoaded = true; }
+
+    /// @return the symbol \a aName, parsed first if needed, or nullptr if there is none.
+    LIB_PART* LoadSymbol( const wxString& aName );
+
+    /// @return the index of the library, or nullptr if it wasn't loaded with LoadIndex().
+    const SYMBOL_LIB_INDEX* GetIndex() const { return m_index.get(); }
+
     void AddSymbol( const LIB_PART* aPart );
 
     void DeleteSymbol( const wxString& aName );
@@ -453,84 +479,150 @@ SCH_SHEET* SCH_SEXPR_PLUGIN::Load( const wxString& aFileName, SCHEMATIC* aSchema
 }
 
 
-// Everything below this comment is recursive.  Modify with care.
-
 void SCH_SEXPR_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
 {
-    SCH_SCREEN* screen = NULL;
+    // A sheet file to parse, and the folder of its parent file, which is the base of the file
+    // names of its sub-sheets
+    struct SHEET_FILE
+    {
+        SCH_SHEET*         m_sheet;
+        wxString           m_fileName;
+        wxString           m_error;
+        std::exception_ptr m_exception;
+    };
+
+    std::vector<std::pair<SCH_SHEET*, wxString>> sheets = { { aSheet, m_currentPath.top() } };
 
-    if( !aSheet->GetScreen() )
+    // The sub-sheet files are only known once their parent file is parsed, so the hierarchy
+    // is loaded level by level.  The files of a level are parsed in parallel, each into its
+    // own screen, and linked to their sheets here, on the calling thread.
+    while( !sheets.empty() )
     {
-        // SCH_SCREEN objects store the full path and file name where the SCH_SHEET object only
-        // stores the file name and extension.  Add the project path to the file name and
-        // extension to compare when calling SCH_SHEET::SearchHierarchy().
-        wxFileName fileName = aSheet->GetFileName();
+        std::vector<SHEET_FILE> files;
+
+        for( const std::pair<SCH_SHEET*, wxString>& entry : sheets )
+        {
+            SCH_SHEET*  sheet = entry.first;
+            SCH_SCREEN* screen = nullptr;
+
+            if( sheet->GetScreen() )
+                continue;
+
+            // SCH_SCREEN objects store the full path and file name where the SCH_SHEET object
+            // only stores the file name and extension.  Add the path of the parent file to
+            // compare when calling SCH_SHEET::SearchHierarchy().  This allows for sheet
+            // schematic files to be nested in folders relative to the file that uses them.
+            wxFileName fileName = sheet->GetFileName();
+
+            if( !fileName.IsAbsolute() )
+                fileName.MakeAbsolute( entry.second );
+
+            // Screens of the files of this level are already attached to their first sheet,
+            // so a file used by several sheets is only parsed once.
+            m_rootSheet->SearchHierarchy( fileName.GetFullPath(), &screen );
+
+            if( screen )
+            {
+                sheet->SetScreen( screen );
+                sheet->GetScreen()->SetParent( m_schematic );
+                // Do not need to load the sub-sheets - this has already been done.
+                continue;
+            }
 
-        if( !fileName.IsAbsolute() )
-            fileName.MakeAbsolute( m_currentPath.top() );
+            wxLogTrace( traceSchLegacyPlugin, "Loading        \"%s\"", fileName.GetFullPath() );
 
-        // Save the current path so that it gets restored when decending and ascending the
-        // sheet hierarchy which allows for sheet schematic files to be nested in folders
-        // relative to the last path a schematic was loaded from.
-        wxLogTrace( traceSchLegacyPlugin, "Saving path    \"%s\"", m_currentPath.top() );
-        m_currentPath.push( fileName.GetPath() );
-        wxLogTrace( traceSchLegacyPlugin, "Current path   \"%s\"", m_currentPath.top() );
-        wxLogTrace( traceSchLegacyPlugin, "Loading        \"%s\"", fileName.GetFullPath() );
+            sheet->SetScreen( new SCH_SCREEN( m_schematic ) );
+            sheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+            files.push_back( { sheet, fileName.GetFullPath(), wxEmptyString, nullptr } );
+        }
 
-        m_rootSheet->SearchHierarchy( fileName.GetFullPath(), &screen );
+        std::atomic<size_t> nextFile( 0 );
 
-        if( screen )
+        // Each file has its own parser and screen; the locale was switched by Load()
+        auto loader =
+                [&]()
+                {
+                    for( size_t ii = nextFile++; ii < files.size(); ii = nextFile++ )
+                    {
+                        SHEET_FILE& file = files[ii];
+
+                        try
+                        {
+                            loadFile( file.m_fileName, file.m_sheet );
+                        }
+                        catch( const IO_ERROR& ioe )
+                        {
+                            file.m_error = ioe.What();
+                            file.m_exception = std::current_exception();
+                        }
+                        catch( ... )
+                        {
+                            file.m_exception = std::current_exception();
+                        }
+                    }
+                };
+
+        size_t threadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                               files.size() );
+
+        if( threadCount > 1 )
         {
-            aSheet->SetScreen( screen );
-            aSheet->GetScreen()->SetParent( m_schematic );
-            // Do not need to load the sub-sheets - this has already been done.
+            // The default field names are translated and cached on first use
+            TEMPLATE_FIELDNAME::GetDefaultFieldName( REFERENCE );
+            SCH_SHEET::GetDefaultFieldName( SHEETNAME );
+
+            std::vector<std::thread> threads;
+
+            for( size_t ii = 0; ii < threadCount; ++ii )
+                threads.emplace_back( loader );
+
+            for( std::thread& thread : threads )
+                thread.join();
         }
         else
         {
-            aSheet->SetScreen( new SCH_SCREEN( m_schematic ) );
-            aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+            loader();
+        }
 
-            try
-            {
-                loadFile( fileName.GetFullPath(), aSheet );
-            }
-            catch( const IO_ERROR& ioe )
+        sheets.clear();
+
+        // Errors are reported and sub-sheets loaded in the file order, whatever order the
+        // files were parsed in
+        for( SHEET_FILE& file : files )
+        {
+            if( file.m_exception )
             {
-                // If there is a problem loading the root sheet, there is no recovery.
-                if( aSheet == m_rootSheet )
-                    throw( ioe );
+                // If there is a problem loading the root sheet, there is no recovery.  Only
+                // file errors are expected from the other sheets.
+                if( file.m_sheet == m_rootSheet || file.m_error.IsEmpty() )
+                    std::rethrow_exception( file.m_exception );
 
                 // For all subsheets, queue up the error message for the caller.
                 if( !m_error.IsEmpty() )
                     m_error += "\n";
 
-                m_error += ioe.What();
+                m_error += file.m_error;
             }
 
-            // This was moved out of the try{} block so that any sheets definitionsthat
-            // the plugin fully parsed before the exception was raised will be loaded.
-            for( auto aItem : aSheet->GetScreen()->Items().OfType( SCH_SHEET_T ) )
-            {
-                wxCHECK2( aItem->Type() == SCH_SHEET_T, /* do nothing */ );
-                auto sheet = static_cast<SCH_SHEET*>( aItem );
+            // Any sheet definitions the parser read before an error are loaded too
+            wxString path = wxFileName( file.m_fileName ).GetPath();
 
-                // Recursion starts here.
-                loadHierarchy( sheet );
-            }
+            for( SCH_ITEM* item : file.m_sheet->GetScreen()->Items().OfType( SCH_SHEET_T ) )
+                sheets.emplace_back( static_cast<SCH_SHEET*>( item ), path );
         }
-
-        m_currentPath.pop();
-        wxLogTrace( traceSchLegacyPlugin, "Restoring path \"%s\"", m_currentPath.top() );
     }
 }
 
 
 void SCH_SEXPR_PLUGIN::loadFile( const wxString& aFileName, SCH_SHEET* aSheet )
 {
-    FILE_LINE_READER reader( aFileName );
+    MMAP_LINE_READER reader( aFileName );
 
     SCH_SEXPR_PARSER parser( &reader );
 
+    if( m_props && m_props->Exists( SCH_SEXPR_PLUGIN::PropReferenceParser ) )
+        parser.SetFastPath( false );
+
     parser.ParseSchematic( aSheet );
 }
 
@@ -1223,14 +1315,15 @@ void SCH_SEXPR_PLUGIN::saveBusAlias( std::shared_ptr<BUS_ALIAS> aAlias, int aNes
 }
 
 
-int SCH_SEXPR_PLUGIN_CACHE::m_modHash = 1;     // starts at 1 and goes up
+std::atomic<int> SCH_SEXPR_PLUGIN_CACHE::m_modHash( 1 );     // starts at 1 and goes up
 
 
 SCH_SEXPR_PLUGIN_CACHE::SCH_SEXPR_PLUGIN_CACHE( const wxString& aFullPathAndFileName ) :
     m_fileName( aFullPathAndFileName ),
     m_libFileName( aFullPathAndFileName ),
     m_isWritable( true ),
-    m_isModified( false )
+    m_isModified( false ),
+    m_isLoaded( false )
 {
     m_versionMajor = -1;
     m_versionMinor = -1;
@@ -1398,11 +1491,40 @@ void SCH_SEXPR_PLUGIN_CACHE::Load()
     wxLogTrace( traceSchLegacyPlugin, "Loading sexpr symbol library file \"%s\"",
                 m_libFileName.GetFullPath() );
 
-    FILE_LINE_READER reader( m_libFileName.GetFullPath() );
+    bool parsed = false;
 
-    SCH_SEXPR_PARSER parser( &reader );
+    if( m_index && !m_symbols.empty() && m_index->IsUpToDate() )
+    {
+        // Some symbols were parsed on demand and are already in use: only parse the others
+        parsed = true;
 
-    parser.ParseLib( m_symbols );
+        for( const LIB_SYMBOL_INFO& info : m_index->GetSymbols() )
+        {
+            if( m_symbols.find( info.m_name ) == m_symbols.end() && !parseSymbol( info ) )
+            {
+                parsed = false;
+                break;
+            }
+        }
+    }
+
+    if( !parsed )
+    {
+        // The file doesn't match the index any longer: start over from the file itself
+        for( auto& symbol : m_symbols )
+            delete symbol.second;
+
+        m_symbols.clear();
+
+        FILE_LINE_READER reader( m_libFileName.GetFullPath() );
+
+        SCH_SEXPR_PARSER parser( &reader );
+
+        parser.ParseLib( m_symbols );
+    }
+
+    m_isLoaded = true;
+    m_index.reset();
     ++m_modHash;
 
     // Remember the file modification time of library file when the
@@ -1412,6 +1534,93 @@ void SCH_SEXPR_PLUGIN_CACHE::Load()
 }
 
 
+void SCH_SEXPR_PLUGIN_CACHE::LoadIndex()
+{
+    if( !m_libFileName.FileExists() )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Library file \"%s\" not found." ),
+                                          m_libFileName.GetFullPath() ) );
+    }
+
+    // Taken before reading the file, so a change while it is indexed causes a reload
+    m_fileModTime = GetLibModificationTime();
+
+    m_index.reset( new SYMBOL_LIB_INDEX );
+
+    if( !m_index->Load( m_libFileName.GetFullPath() ) )
+    {
+        // Let the parser report what is wrong with the file
+        m_index.reset();
+        Load();
+        return;
+    }
+
+    ++m_modHash;
+}
+
+
+LIB_PART* SCH_SEXPR_PLUGIN_CACHE::LoadSymbol( const wxString& aName )
+{
+    LIB_PART_MAP::const_iterator it = m_symbols.find( aName );
+
+    if( it != m_symbols.end() )
+        return it->second;
+
+    if( m_isLoaded || !m_index )
+        return nullptr;
+
+    const LIB_SYMBOL_INFO* info = m_index->Find( aName );
+
+    if( !info )
+        return nullptr;
+
+    if( LIB_PART* symbol = parseSymbol( *info ) )
+        return symbol;
+
+    // The library file changed since it was indexed: parse it all
+    Load();
+
+    it = m_symbols.find( aName );
+
+    return it != m_symbols.end() ? it->second : nullptr;
+}
+
+
+LIB_PART* SCH_SEXPR_PLUGIN_CACHE::parseSymbol( const LIB_SYMBOL_INFO& aInfo )
+{
+    wxCHECK( m_index, nullptr );
+
+    // A derived symbol cannot be parsed without its parent
+    if( !aInfo.IsRoot() && aInfo.m_parent != aInfo.m_name
+            && m_symbols.find( aInfo.m_parent ) == m_symbols.end() )
+    {
+        const LIB_SYMBOL_INFO* parent = m_index->Find( aInfo.m_parent );
+
+        if( parent && !parseSymbol( *parent ) )
+            return nullptr;
+    }
+
+    std::string text = m_index->ReadSymbol( aInfo );
+
+    if( text.empty() )
+        return nullptr;
+
+    wxLogTrace( traceSchLegacyPlugin, "Loading symbol \"%s\" from sexpr library file \"%s\"",
+                aInfo.m_name, m_libFileName.GetFullPath() );
+
+    STRING_LINE_READER reader( text, m_libFileName.GetFullPath() );
+    SCH_SEXPR_PARSER   parser( &reader );
+
+    parser.NeedLEFT();
+    parser.NextTok();
+
+    LIB_PART* symbol = parser.ParseSymbol( m_symbols, m_index->GetFileVersion() );
+
+    m_symbols[symbol->GetName()] = symbol;
+    return symbol;
+}
+
+
 void SCH_SEXPR_PLUGIN_CACHE::Save()
 {
     if( !m_isModified )
@@ -1967,7 +2176,7 @@ void SCH_SEXPR_PLUGIN_CACHE::DeleteSymbol( const wxString& aSymbolName )
 }
 
 
-void SCH_SEXPR_PLUGIN::cacheLib( const wxString& aLibraryFileName )
+void SCH_SEXPR_PLUGIN::cacheLib( const wxString& aLibraryFileName, bool aIndexOnly )
 {
     if( !m_cache || !m_cache->IsFile( aLibraryFileName ) || m_cache->IsFileChanged() )
     {
@@ -1980,9 +2189,17 @@ void SCH_SEXPR_PLUGIN::cacheLib( const wxString& aLibraryFileName )
         // must be updated.
         PART_LIBS::s_modify_generation++;
 
-        if( !isBuffering( m_props ) )
+        if( isBuffering( m_props ) )
+            m_cache->SetLoaded();
+        else if( aIndexOnly )
+            m_cache->LoadIndex();
+        else
             m_cache->Load();
     }
+    else if( !aIndexOnly && !m_cache->IsLoaded() )
+    {
+        m_cache->Load();
+    }
 }
 
 
@@ -2012,7 +2229,24 @@ void SCH_SEXPR_PLUGIN::EnumerateSymbolLib( wxArrayString&    aSymbolNameList,
 
     bool powerSymbolsOnly = ( aProperties &&
                               aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
-    cacheLib( aLibraryPath );
+    cacheLib( aLibraryPath, true );
+
+    if( const SYMBOL_LIB_INDEX* index = m_cache->GetIndex() )
+    {
+        // Same order as the map of the loaded symbols
+        LIB_PART_MAP names;
+
+        for( const LIB_SYMBOL_INFO& info : index->GetSymbols() )
+        {
+            if( !powerSymbolsOnly || info.m_isPower )
+                names[info.m_name] = nullptr;
+        }
+
+        for( const auto& name : names )
+            aSymbolNameList.Add( name.first );
+
+        return;
+    }
 
     const LIB_PART_MAP& symbols = m_cache->m_symbols;
 
@@ -2046,6 +2280,37 @@ void SCH_SEXPR_PLUGIN::EnumerateSymbolLib( std::vector<LIB_PART*>& aSymbolList,
 }
 
 
+void SCH_SEXPR_PLUGIN::EnumerateSymbolInfo( std::vector<LIB_SYMBOL_INFO>& aSymbolList,
+                                            const wxString&   aLibraryPath,
+                                            const PROPERTIES* aProperties )
+{
+    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
+
+    m_props = aProperties;
+
+    bool powerSymbolsOnly = ( aProperties &&
+                              aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
+    cacheLib( aLibraryPath, true );
+
+    if( const SYMBOL_LIB_INDEX* index = m_cache->GetIndex() )
+    {
+        for( const LIB_SYMBOL_INFO& info : index->GetSymbols() )
+        {
+            if( !powerSymbolsOnly || info.m_isPower )
+                aSymbolList.push_back( info );
+        }
+
+        return;
+    }
+
+    for( const auto& symbol : m_cache->m_symbols )
+    {
+        if( !powerSymbolsOnly || symbol.second->IsPower() )
+            aSymbolList.emplace_back( *symbol.second );
+    }
+}
+
+
 LIB_PART* SCH_SEXPR_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wxString& aSymbolName,
                                         const PROPERTIES* aProperties )
 {
@@ -2053,14 +2318,10 @@ LIB_PART* SCH_SEXPR_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wxSt
 
     m_props = aProperties;
 
-    cacheLib( aLibraryPath );
-
-    LIB_PART_MAP::const_iterator it = m_cache->m_symbols.find( aSymbolName );
-
-    if( it == m_cache->m_symbols.end() )
-        return nullptr;
+    // Only the requested symbol (and its parent) is parsed if the library isn't loaded yet
+    cacheLib( aLibraryPath, true );
 
-    return it->second;
+    return m_cache->LoadSymbol( aSymbolName );
 }
 
 
@@ -2204,3 +2465,4 @@ void SCH_SEXPR_PLUGIN::FormatPart( LIB_PART* part, OUTPUTFORMATTER & formatter )
 
 
 const char* SCH_SEXPR_PLUGIN::PropBuffering = "buffering";
+const char* SCH_SEXPR_PLUGIN::PropReferenceParser = "reference_parser";
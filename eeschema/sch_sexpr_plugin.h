@@ -82,6 +82,12 @@ public:
      */
     static const char* PropBuffering;
 
+    /**
+     * The property used to load schematics with the reference number conversions of the
+     * parser instead of its fast path, for the benchmarks and to check the fast path results.
+     */
+    static const char* PropReferenceParser;
+
     int GetModifyHash() const override;
 
     SCH_SHEET* Load( const wxString& aFileName, SCHEMATIC* aSchematic,
@@ -104,6 +110,9 @@ public:
     void EnumerateSymbolLib( std::vector<LIB_PART*>& aSymbolList,
                              const wxString&   aLibraryPath,
                              const PROPERTIES* aProperties = nullptr ) override;
+    void EnumerateSymbolInfo( std::vector<LIB_SYMBOL_INFO>& aSymbolList,
+                              const wxString&   aLibraryPath,
+                              const PROPERTIES* aProperties = nullptr ) override;
     LIB_PART* LoadSymbol( const wxString& aLibraryPath, const wxString& aAliasName,
                            const PROPERTIES* aProperties = nullptr ) override;
     void SaveSymbol( const wxString& aLibraryPath, const LIB_PART* aSymbol,
@@ -141,7 +150,11 @@ private:
     void saveText( SCH_TEXT* aText, int aNestLevel );
     void saveBusAlias( std::shared_ptr<BUS_ALIAS> aAlias, int aNestLevel );
 
-    void cacheLib( const wxString& aLibraryFileName );
+    /**
+     * Make sure m_cache holds \a aLibraryFileName.  With \a aIndexOnly, a library not loaded
+     * yet is only indexed and its symbols are parsed when they are requested.
+     */
+    void cacheLib( const wxString& aLibraryFileName, bool aIndexOnly = false );
     bool isBuffering( const PROPERTIES* aProperties );
 
 protected:
@@ -34,6 +34,8 @@
 
 #include <wx/stdpaths.h>
 #include <wx/dir.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
 
 #include <stdexcept>
 
@@ -43,7 +45,7 @@ using namespace std;
 
 static const wxChar* const traceNgspice = wxT( "KICAD_NGSPICE" );
 
-NGSPICE::NGSPICE()
+NGSPICE::NGSPICE( bool aPrivateLibrary )
         : m_ngSpice_Init( nullptr ),
           m_ngSpice_Circ( nullptr ),
           m_ngSpice_Command( nullptr ),
@@ -52,7 +54,9 @@ NGSPICE::NGSPICE()
           m_ngSpice_AllPlots( nullptr ),
           m_ngSpice_AllVecs( nullptr ),
           m_ngSpice_Running( nullptr ),
-          m_error( false )
+          m_error( false ),
+          m_initialized( false ),
+          m_privateLibrary( aPrivateLibrary )
 {
     init_dll();
 }
@@ -60,6 +64,11 @@ NGSPICE::NGSPICE()
 
 NGSPICE::~NGSPICE()
 {
+    if( !m_libraryCopy.IsEmpty() )
+    {
+        m_dll.Unload();
+        wxRemoveFile( m_libraryCopy );
+    }
 }
 
 
@@ -379,6 +388,9 @@ void NGSPICE::init_dll()
     if( !m_dll.IsLoaded() )
         throw std::runtime_error( "Missing ngspice shared library" );
 
+    if( m_privateLibrary )
+        loadPrivateCopy();
+
     m_error = false;
 
     // Obtain function pointers
@@ -391,7 +403,8 @@ void NGSPICE::init_dll()
     m_ngSpice_AllVecs = (ngSpice_AllVecs) m_dll.GetSymbol( "ngSpice_AllVecs" );
     m_ngSpice_Running = (ngSpice_Running) m_dll.GetSymbol( "ngSpice_running" ); // it is not a typo
 
-    m_ngSpice_Init( &cbSendChar, &cbSendStat, &cbControlledExit, NULL, NULL, &cbBGThreadRunning, this );
+    m_ngSpice_Init( &cbSendChar, &cbSendStat, &cbControlledExit, &cbSendData, &cbSendInitData,
+                    &cbBGThreadRunning, this );
 
     // Load a custom spinit file, to fix the problem with loading .cm files
     // Switch to the executable directory, so the relative paths are correct
@@ -452,6 +465,61 @@ void NGSPICE::init_dll()
 }
 
 
+void NGSPICE::loadPrivateCopy()
+{
+    // The library copies are named after this prefix, so they are not mistaken for the
+    // original library
+    const wxString copyPrefix( "kicad-ngspice" );
+
+    if( m_libraryCopy.IsEmpty() )
+    {
+        // wxDynamicLibrary doesn't tell where it found the library, look for it among the
+        // libraries loaded by the process
+        wxDynamicLibraryDetailsArray loaded = wxDynamicLibrary::ListLoaded();
+        wxString                     libraryPath;
+
+        for( size_t ii = 0; ii < loaded.GetCount(); ++ii )
+        {
+            const wxString& name = loaded[ii].GetName();
+
+            if( name.Lower().Contains( "ngspice" ) && !name.StartsWith( copyPrefix ) )
+            {
+                libraryPath = loaded[ii].GetPath();
+                break;
+            }
+        }
+
+        if( libraryPath.IsEmpty() )
+            throw std::runtime_error( "Cannot locate the ngspice shared library" );
+
+        wxString copy = wxFileName::CreateTempFileName( wxFileName::GetTempDir()
+                                                        + wxFileName::GetPathSeparator()
+                                                        + copyPrefix );
+
+        if( copy.IsEmpty() || !wxCopyFile( libraryPath, copy, true ) )
+        {
+            if( !copy.IsEmpty() )
+                wxRemoveFile( copy );
+
+            throw std::runtime_error( "Cannot copy the ngspice shared library" );
+        }
+
+        wxLogTrace( traceNgspice, "libngspice copied from %s to %s", libraryPath, copy );
+        m_libraryCopy = copy;
+    }
+
+    m_dll.Unload();
+    m_dll.Load( m_libraryCopy, wxDL_VERBATIM | wxDL_QUIET | wxDL_NOW );
+
+    if( !m_dll.IsLoaded() )
+    {
+        wxRemoveFile( m_libraryCopy );
+        m_libraryCopy.Clear();
+        throw std::runtime_error( "Cannot load the copy of the ngspice shared library" );
+    }
+}
+
+
 bool NGSPICE::loadSpinit( const string& aFileName )
 {
     if( !wxFileName::FileExists( aFileName ) )
@@ -563,6 +631,41 @@ int NGSPICE::cbControlledExit( int status, bool immediate, bool exit_upon_quit,
 }
 
 
+int NGSPICE::cbSendData( pvecvaluesall what, int count, int id, void* user )
+{
+    NGSPICE*              sim = reinterpret_cast<NGSPICE*>( user );
+    std::vector<COMPLEX>& values = sim->m_sentValues;
+
+    values.resize( what->veccount );
+
+    for( int ii = 0; ii < what->veccount; ii++ )
+        values[ii] = COMPLEX( what->vecsa[ii]->creal, what->vecsa[ii]->cimag );
+
+    sim->m_dataBuffer.Append( values );
+
+    return 0;
+}
+
+
+int NGSPICE::cbSendInitData( pvecinfoall what, int id, void* user )
+{
+    NGSPICE*       sim = reinterpret_cast<NGSPICE*>( user );
+    vector<string> names;
+    vector<bool>   isComplex;
+
+    // Called when a simulation creates its vectors
+    for( int ii = 0; ii < what->veccount; ii++ )
+    {
+        names.emplace_back( what->vecs[ii]->vecname );
+        isComplex.push_back( !what->vecs[ii]->is_real );
+    }
+
+    sim->m_dataBuffer.Reset( names, isComplex );
+
+    return 0;
+}
+
+
 void NGSPICE::validate()
 {
     if( m_error )
@@ -578,5 +681,3 @@ const std::string NGSPICE::GetNetlist() const
     return m_netlist;
 }
 
-
-bool NGSPICE::m_initialized = false;
@@ -35,7 +35,12 @@ class wxDynamicLibrary;
 class NGSPICE : public SPICE_SIMULATOR {
 
 public:
-    NGSPICE();
+    /**
+     * @param aPrivateLibrary makes the instance load its own copy of the ngspice library.
+     * ngspice keeps its state in global variables, so instances sharing the library share
+     * their circuits and results.
+     */
+    NGSPICE( bool aPrivateLibrary = false );
     virtual ~NGSPICE();
 
     ///> @copydoc SPICE_SIMULATOR::Init()
@@ -109,6 +114,9 @@ private:
 
     wxDynamicLibrary m_dll;
 
+    ///> Replaces the loaded ngspice library with a private copy of it
+    void loadPrivateCopy();
+
     ///> Executes commands from a file
     bool loadSpinit( const std::string& aFileName );
 
@@ -124,6 +132,8 @@ private:
     static int cbSendStat( char* what, int id, void* user );
     static int cbBGThreadRunning( bool is_running, int id, void* user );
     static int cbControlledExit( int status, bool immediate, bool exit_upon_quit, int id, void* user );
+    static int cbSendData( pvecvaluesall what, int count, int id, void* user );
+    static int cbSendInitData( pvecinfoall what, int id, void* user );
 
     // Assures ngspice is in a valid state and reinitializes it if need be
     void validate();
@@ -132,10 +142,19 @@ private:
     bool m_error;
 
     ///> NGspice should be initialized only once
-    static bool m_initialized;
+    bool m_initialized;
+
+    ///> Does the instance use its own copy of the ngspice library?
+    bool m_privateLibrary;
+
+    ///> Private copy of the ngspice library, empty until it is made
+    wxString m_libraryCopy;
 
     ///> current netlist
     std::string m_netlist;
+
+    ///> Values of the point sent by cbSendData(), kept to avoid allocating them at every point
+    std::vector<COMPLEX> m_sentValues;
 };
 
 #endif /* NGSPICE_H */
@@ -0,0 +1,176 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * https://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "sim_data_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <wx/string.h>
+
+
+constexpr size_t SIM_DATA_BUFFER::CHUNK_SIZE;
+
+
+SIM_DATA_BUFFER::SIM_DATA_BUFFER() :
+        m_enabled( false ),
+        m_runId( 0 ),
+        m_length( 0 )
+{
+}
+
+
+void SIM_DATA_BUFFER::SetEnabled( bool aEnabled )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    m_enabled = aEnabled;
+
+    if( !m_enabled )
+    {
+        m_vectors.clear();
+        m_length = 0;
+    }
+}
+
+
+void SIM_DATA_BUFFER::Reset( const std::vector<std::string>& aNames,
+                             const std::vector<bool>& aComplex )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( !m_enabled )
+        return;
+
+    m_vectors.clear();
+    m_vectors.resize( aNames.size() );
+    m_length = 0;
+    m_runId++;
+
+    for( size_t ii = 0; ii < aNames.size(); ++ii )
+    {
+        m_vectors[ii].m_name = aNames[ii];
+        m_vectors[ii].m_complex = ii < aComplex.size() && aComplex[ii];
+    }
+}
+
+
+void SIM_DATA_BUFFER::Append( const std::vector<std::complex<double>>& aValues )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( !m_enabled || aValues.size() != m_vectors.size() )
+        return;
+
+    size_t chunk = m_length / CHUNK_SIZE;
+    size_t offset = m_length % CHUNK_SIZE;
+
+    for( size_t ii = 0; ii < m_vectors.size(); ++ii )
+    {
+        VECTOR& vector = m_vectors[ii];
+
+        if( offset == 0 )
+        {
+            vector.m_real.emplace_back( new double[CHUNK_SIZE] );
+
+            // Chunks of the imaginary parts are only allocated for complex vectors
+            if( vector.m_complex )
+                vector.m_imag.emplace_back( new double[CHUNK_SIZE] );
+        }
+
+        vector.m_real[chunk][offset] = aValues[ii].real();
+
+        if( vector.m_complex )
+            vector.m_imag[chunk][offset] = aValues[ii].imag();
+    }
+
+    m_length++;
+}
+
+
+unsigned int SIM_DATA_BUFFER::GetRunId() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    return m_runId;
+}
+
+
+size_t SIM_DATA_BUFFER::GetLength() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    return m_length;
+}
+
+
+int SIM_DATA_BUFFER::FindVector( const std::string& aName ) const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    wxString                    name( aName );
+    wxString                    node;
+
+    // Node voltages are named after the node, V(node) is how they are requested
+    if( name.Len() > 3 && name.Upper().StartsWith( "V(" ) && name.EndsWith( ")" ) )
+        node = name.Mid( 2, name.Len() - 3 );
+
+    for( size_t ii = 0; ii < m_vectors.size(); ++ii )
+    {
+        wxString vectorName( m_vectors[ii].m_name );
+
+        if( vectorName.CmpNoCase( name ) == 0 || vectorName.CmpNoCase( node ) == 0 )
+            return (int) ii;
+    }
+
+    return -1;
+}
+
+
+size_t SIM_DATA_BUFFER::Read( int aVector, size_t aFirst, size_t aCount, SIM_DATA_PART aPart,
+                              std::vector<double>& aValues ) const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( aVector < 0 || aVector >= (int) m_vectors.size() || aFirst >= m_length )
+        return 0;
+
+    const VECTOR& vector = m_vectors[aVector];
+    bool          isComplex = vector.m_complex;
+    size_t        last = std::min( m_length, aFirst + aCount );
+
+    aValues.reserve( aValues.size() + last - aFirst );
+
+    for( size_t ii = aFirst; ii < last; ++ii )
+    {
+        double real = vector.m_real[ii / CHUNK_SIZE][ii % CHUNK_SIZE];
+        double imag = isComplex ? vector.m_imag[ii / CHUNK_SIZE][ii % CHUNK_SIZE] : 0.0;
+
+        // Same conventions as SPICE_SIMULATOR::GetMagPlot() and GetPhasePlot()
+        if( aPart == SDP_PHASE )
+            aValues.push_back( isComplex ? atan2( imag, real ) : 0.0 );
+        else
+            aValues.push_back( isComplex ? hypot( real, imag ) : real );
+    }
+
+    return last - aFirst;
+}
@@ -0,0 +1,109 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * https://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef SIM_DATA_BUFFER_H
+#define SIM_DATA_BUFFER_H
+
+#include <complex>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+///> Part of a vector value read from SIM_DATA_BUFFER
+enum SIM_DATA_PART
+{
+    SDP_MAGNITUDE,  ///< Magnitude of complex values, real values as they are
+    SDP_PHASE       ///< Phase of complex values, zero for real values
+};
+
+
+/**
+ * @brief Vectors of the running simulation, as the simulator computes them.
+ *
+ * The simulator thread appends the values of every vector at each computed point, while the
+ * user interface thread reads the points added since its previous read.  Values are stored
+ * in fixed size chunks, so appending never moves the values already stored.
+ */
+class SIM_DATA_BUFFER
+{
+public:
+    SIM_DATA_BUFFER();
+
+    ///> Enables storing the vectors, the buffer ignores the simulator when disabled
+    void SetEnabled( bool aEnabled );
+
+    /**
+     * @brief Starts a new run.  Called by the simulator.
+     * @param aNames are the names of the vectors of the run.
+     * @param aComplex tells for every vector if it holds complex values.
+     */
+    void Reset( const std::vector<std::string>& aNames, const std::vector<bool>& aComplex );
+
+    /**
+     * @brief Adds a point.  Called by the simulator.
+     * @param aValues holds a value for every vector, in the order given to Reset().
+     */
+    void Append( const std::vector<std::complex<double>>& aValues );
+
+    ///> Returns a number changing with every run
+    unsigned int GetRunId() const;
+
+    ///> Returns the number of points of the current run
+    size_t GetLength() const;
+
+    ///> Returns the index of a vector (case insensitive, like Spice, and V(node) finds the
+    ///> voltage of node), or -1 if there is none
+    int FindVector( const std::string& aName ) const;
+
+    /**
+     * @brief Appends values of a vector to \a aValues.
+     * @param aFirst is the first point to read.
+     * @param aCount is the number of points to read, if there are so many.
+     * @return The number of points read.
+     */
+    size_t Read( int aVector, size_t aFirst, size_t aCount, SIM_DATA_PART aPart,
+                 std::vector<double>& aValues ) const;
+
+private:
+    ///> Values per chunk
+    static constexpr size_t CHUNK_SIZE = 65536;
+
+    struct VECTOR
+    {
+        std::string                            m_name;
+        bool                                   m_complex;
+        std::vector<std::unique_ptr<double[]>> m_real;
+        std::vector<std::unique_ptr<double[]>> m_imag;     ///< Empty for real vectors
+    };
+
+    ///> Guards the vectors against the simulator thread
+    mutable std::mutex m_mutex;
+
+    bool                m_enabled;
+    unsigned int        m_runId;
+    size_t              m_length;
+    std::vector<VECTOR> m_vectors;
+};
+
+#endif /* SIM_DATA_BUFFER_H */
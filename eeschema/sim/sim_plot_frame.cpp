@@ -25,6 +25,13 @@
  */
 
 #include <wx/stc/stc.h>
+#include <wx/numdlg.h>
+#include <wx/textdlg.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
 
 #include <sch_edit_frame.h>
 #include <eeschema_id.h>
@@ -32,12 +39,14 @@
 #include <confirm.h>
 #include <bitmaps.h>
 #include <wildcards_and_files_ext.h>
+#include <widgets/progress_reporter.h>
 #include <widgets/tuner_slider.h>
 #include <dialogs/dialog_signal_list.h>
 #include "netlist_exporter_pspice_sim.h"
 #include <pgm_base.h>
 #include "sim_plot_frame.h"
 #include "sim_plot_panel.h"
+#include "sim_sweep.h"
 #include "spice_simulator.h"
 #include "spice_reporter.h"
 #include <menus_helpers.h>
@@ -164,6 +173,11 @@ SIM_PLOT_FRAME::SIM_PLOT_FRAME( KIWAY* aKiway, wxWindow* aParent )
     m_reporter = new SIM_THREAD_REPORTER( this );
     m_simulator->SetReporter( m_reporter );
 
+    // Transient analyses are plotted while they run, from the vectors sent by the simulator
+    m_streamRunId = m_simulator->GetDataBuffer().GetRunId();
+    m_streamTimer.SetOwner( this );
+    Bind( wxEVT_TIMER, &SIM_PLOT_FRAME::onSimStreamTimer, this, m_streamTimer.GetId() );
+
     updateNetlistExporter();
 
     Connect( EVT_SIM_UPDATE, wxCommandEventHandler( SIM_PLOT_FRAME::onSimUpdate ), NULL, this );
@@ -200,9 +214,17 @@ SIM_PLOT_FRAME::SIM_PLOT_FRAME( KIWAY* aKiway, wxWindow* aParent )
     Bind( wxEVT_COMMAND_MENU_SELECTED, &SIM_PLOT_FRAME::onAddSignal,   this, m_addSignals->GetId() );
     Bind( wxEVT_COMMAND_MENU_SELECTED, &SIM_PLOT_FRAME::onProbe,       this, m_probeSignals->GetId() );
     Bind( wxEVT_COMMAND_MENU_SELECTED, &SIM_PLOT_FRAME::onTune,        this, m_tuneValue->GetId() );
+    Bind( wxEVT_COMMAND_MENU_SELECTED, &SIM_PLOT_FRAME::onToleranceAnalysis, this,
+          m_toleranceAnalysis->GetId() );
     Bind( wxEVT_COMMAND_MENU_SELECTED, &SIM_PLOT_FRAME::onShowNetlist, this, m_showNetlist->GetId() );
     Bind( wxEVT_COMMAND_MENU_SELECTED, &SIM_PLOT_FRAME::onSettings,    this, m_settings->GetId() );
 
+#ifdef __WXMAC__
+    // The sweep simulators load private copies of the ngspice library, found among the
+    // libraries of the process, but wxDynamicLibrary::ListLoaded() doesn't list them on macOS
+    m_toleranceAnalysis->Enable( false );
+#endif
+
     m_toolBar->Realize();
 
     m_welcomePanel = new SIM_PANEL_BASE( ST_UNKNOWN, m_plotNotebook, wxID_ANY );
@@ -229,6 +251,7 @@ SIM_PLOT_FRAME::SIM_PLOT_FRAME( KIWAY* aKiway, wxWindow* aParent )
 
 SIM_PLOT_FRAME::~SIM_PLOT_FRAME()
 {
+    m_streamTimer.Stop();
     m_simulator->SetReporter( nullptr );
     delete m_reporter;
     delete m_signalsIconColorList;
@@ -458,6 +481,9 @@ void SIM_PLOT_FRAME::StartSimulation( const wxString& aSimCommand )
     m_simulator->LoadNetlist( formatter.GetString() );
     updateTuners();
     applyTuners();
+
+    // Other analyses are not plotted while they run, and storing their points is a waste
+    m_simulator->GetDataBuffer().SetEnabled( m_exporter->GetSimType() == ST_TRANSIENT );
     m_simulator->Run();
 }
 
@@ -652,7 +678,14 @@ void SIM_PLOT_FRAME::removePlot( const wxString& aPlotName, bool aErase )
     if( !plotPanel )
         return;
 
-    if( aErase )
+    std::vector<wxString>& envelopes = m_plots[plotPanel].m_envelopes;
+    auto                   envelopeIt = std::find( envelopes.begin(), envelopes.end(), aPlotName );
+
+    if( envelopeIt != envelopes.end() )
+    {
+        envelopes.erase( envelopeIt );
+    }
+    else if( aErase )
     {
         auto& traceMap = m_plots[plotPanel].m_traces;
         auto traceIt = traceMap.find( aPlotName );
@@ -896,6 +929,15 @@ void SIM_PLOT_FRAME::applyTuners()
 }
 
 
+void SIM_PLOT_FRAME::removeEnvelopes( SIM_PLOT_PANEL* aPanel )
+{
+    for( const wxString& envelope : m_plots[aPanel].m_envelopes )
+        aPanel->DeleteTrace( envelope );
+
+    m_plots[aPanel].m_envelopes.clear();
+}
+
+
 bool SIM_PLOT_FRAME::loadWorkbook( const wxString& aPath )
 {
     m_plots.clear();
@@ -1357,6 +1399,160 @@ void SIM_PLOT_FRAME::onTune( wxCommandEvent& event )
     m_schematicFrame->Raise();
 }
 
+void SIM_PLOT_FRAME::onToleranceAnalysis( wxCommandEvent& event )
+{
+    SIM_PLOT_PANEL* plotPanel = CurrentPlot();
+
+    if( !plotPanel || IsSimulationRunning() )
+        return;
+
+    std::string netlist = m_simulator->GetNetlist();
+    SIM_TYPE    simType = m_exporter->GetSimType();
+
+    if( netlist.empty() || simType != plotPanel->GetType() || m_plots[plotPanel].m_traces.empty() )
+    {
+        DisplayInfoMessage( this, _( "Run the simulation of the current plot first." ) );
+        return;
+    }
+
+    if( m_tuners.empty() )
+    {
+        DisplayInfoMessage( this, _( "Tune the components to vary first." ) );
+        return;
+    }
+
+    double tolerance;
+
+    if( !wxGetTextFromUser( _( "Tolerance of the tuned components (%):" ),
+                            _( "Tolerance Analysis" ), "5", this ).ToDouble( &tolerance )
+            || tolerance <= 0.0 )
+    {
+        return;
+    }
+
+    long variantCount = wxGetNumberFromUser( _( "Number of simulated variants:" ), wxEmptyString,
+                                             _( "Tolerance Analysis" ), 100, 2, 10000, this );
+
+    if( variantCount < 0 )
+        return;
+
+    SIM_SWEEP sweep( netlist, simType );
+
+    for( TUNER_SLIDER* tuner : m_tuners )
+    {
+        SIM_SWEEP_PARAM param( tuner->GetSpiceName(), tuner->GetValue().ToDouble() );
+        param.m_tolerance = tolerance / 100.0;
+        sweep.AddParam( param );
+    }
+
+    std::vector<const TRACE_DESC*> descriptors;
+
+    for( const auto& trace : m_plots[plotPanel].m_traces )
+    {
+        const TRACE_DESC& desc = trace.second;
+
+        // Phases are not swept, the sweep stores the magnitude of complex vectors.  Nor are
+        // the steps of two-source DC analyses, which are one vector split in several traces.
+        if( ( desc.GetType() & SPT_AC_PHASE ) || trace.first != desc.GetTitle() )
+            continue;
+
+        sweep.AddSignal( m_exporter->ComponentToVector( desc.GetName(), desc.GetType(),
+                                                        desc.GetParam() ) );
+        descriptors.push_back( &desc );
+    }
+
+    if( descriptors.empty() )
+        return;
+
+    sweep.MakeMonteCarloVariants( (size_t) variantCount );
+
+    SIM_SWEEP_RESULTS    results( 0, 0 );
+    std::exception_ptr   error;
+    std::atomic<bool>    done( false );
+    WX_PROGRESS_REPORTER progressReporter( this, _( "Tolerance Analysis" ), 1 );
+
+    progressReporter.Report( _( "Simulating the variants..." ) );
+
+    {
+        // The locale is global: switch it once for the simulators of the sweep, and keep the
+        // main thread refreshing the progress dialog until they are done
+        LOCALE_IO toggle;
+
+        std::thread runner(
+                [&]()
+                {
+                    try
+                    {
+                        results = sweep.Run();
+                    }
+                    catch( ... )
+                    {
+                        error = std::current_exception();
+                    }
+
+                    done = true;
+                } );
+
+        while( !done )
+        {
+            progressReporter.SetCurrentProgress( (double) sweep.GetDoneCount()
+                                                 / sweep.GetVariantCount() );
+
+            // Cancel again until the sweep ends, in case it had not started yet
+            if( progressReporter.IsCancelled() || !progressReporter.KeepRefreshing() )
+                sweep.Cancel();
+
+            wxMilliSleep( 20 );
+        }
+
+        runner.join();
+    }
+
+    if( error )
+    {
+        try
+        {
+            std::rethrow_exception( error );
+        }
+        catch( const std::exception& e )
+        {
+            DisplayError( this, wxString::Format( _( "Tolerance analysis failed: %s" ),
+                                                  e.what() ) );
+        }
+
+        return;
+    }
+
+    // The variants which were not simulated are invalid
+    if( progressReporter.IsCancelled() )
+        return;
+
+    removeEnvelopes( plotPanel );
+
+    for( size_t ii = 0; ii < descriptors.size(); ++ii )
+    {
+        std::vector<double> x, min, max;
+
+        if( !results.GetEnvelope( ii, x, min, max ) )
+            continue;
+
+        for( const auto& bound : { std::make_pair( _( "min" ), &min ),
+                                   std::make_pair( _( "max" ), &max ) } )
+        {
+            wxString name = wxString::Format( "%s (%s)", descriptors[ii]->GetTitle(),
+                                              bound.first );
+
+            plotPanel->AddTrace( name, (int) x.size(), x.data(), bound.second->data(),
+                                 descriptors[ii]->GetType() );
+            m_plots[plotPanel].m_envelopes.push_back( name );
+        }
+    }
+
+    updateSignalList();
+    plotPanel->GetPlotWin()->UpdateAll();
+}
+
+
 void SIM_PLOT_FRAME::onShowNetlist( wxCommandEvent& event )
 {
     class NETLIST_VIEW_DIALOG : public wxDialog
@@ -1412,6 +1608,8 @@ void SIM_PLOT_FRAME::doCloseWindow()
 {
     SaveSettings( config() );
 
+    m_streamTimer.Stop();
+
     if( IsSimulationRunning() )
         m_simulator->Stop();
 
@@ -1473,6 +1671,9 @@ void SIM_PLOT_FRAME::onSimStarted( wxCommandEvent& aEvent )
 {
     m_toolBar->SetToolNormalBitmap( ID_SIM_RUN, KiBitmap( sim_stop_xpm ) );
     SetCursor( wxCURSOR_ARROWWAIT );
+
+    if( m_exporter->GetSimType() == ST_TRANSIENT )
+        m_streamTimer.Start( 250 );
 }
 
 
@@ -1481,6 +1682,12 @@ void SIM_PLOT_FRAME::onSimFinished( wxCommandEvent& aEvent )
     m_toolBar->SetToolNormalBitmap( ID_SIM_RUN, KiBitmap( sim_run_xpm ) );
     SetCursor( wxCURSOR_ARROW );
 
+    m_streamTimer.Stop();
+
+    // The final values are read from the simulator vectors, release the streamed ones
+    if( !IsSimulationRunning() )
+        m_simulator->GetDataBuffer().SetEnabled( false );
+
     SIM_TYPE simType = m_exporter->GetSimType();
 
     if( simType == ST_UNKNOWN )
@@ -1502,6 +1709,8 @@ void SIM_PLOT_FRAME::onSimFinished( wxCommandEvent& aEvent )
 
         wxCHECK_RET( plotPanel, "not a SIM_PLOT_PANEL"  );
 
+        removeEnvelopes( plotPanel );
+
         for( auto it = traceMap.begin(); it != traceMap.end(); /* iteration occurs in the loop */)
         {
             if( !updatePlot( it->second, plotPanel ) )
@@ -1548,6 +1757,75 @@ void SIM_PLOT_FRAME::onSimFinished( wxCommandEvent& aEvent )
 }
 
 
+void SIM_PLOT_FRAME::onSimStreamTimer( wxTimerEvent& aEvent )
+{
+    SIM_PLOT_PANEL* plotPanel = dynamic_cast<SIM_PLOT_PANEL*>( currentPlotWindow() );
+
+    // The final values are plotted by onSimFinished(), from the simulator vectors
+    if( !plotPanel || !IsSimulationRunning() || m_exporter->GetSimType() != ST_TRANSIENT
+            || plotPanel->GetType() != ST_TRANSIENT )
+    {
+        return;
+    }
+
+    const SIM_DATA_BUFFER& buffer = m_simulator->GetDataBuffer();
+    int xVector = buffer.FindVector( m_simulator->GetXAxis( ST_TRANSIENT ) );
+
+    if( xVector < 0 )
+        return;
+
+    unsigned int runId = buffer.GetRunId();
+    bool         newRun = runId != m_streamRunId;
+    size_t       length = buffer.GetLength();
+
+    m_streamRunId = runId;
+
+    for( const auto& entry : m_plots[plotPanel].m_traces )
+    {
+        auto trace = plotPanel->GetTraces().find( entry.first );
+
+        if( trace == plotPanel->GetTraces().end() )
+            continue;
+
+        const TRACE_DESC& desc = entry.second;
+        wxString          spiceVector = m_exporter->ComponentToVector( desc.GetName(),
+                                                                       desc.GetType(),
+                                                                       desc.GetParam() );
+        int               yVector = buffer.FindVector( spiceVector.ToStdString() );
+
+        if( yVector < 0 )
+            continue;
+
+        // A new run replaces the points of the previous one
+        size_t first = newRun ? 0 : trace->second->GetDataX().size();
+
+        if( first >= length && !newRun )
+            continue;
+
+        std::vector<double> x, y;
+
+        buffer.Read( xVector, first, length - first, SDP_MAGNITUDE, x );
+        buffer.Read( yVector, first, length - first, SDP_MAGNITUDE, y );
+
+        // Another run may have started in between
+        if( x.size() != y.size() )
+            continue;
+
+        if( newRun )
+            trace->second->SetData( x, y );
+        else
+            trace->second->AppendData( x, y );
+    }
+
+    // Rescaling the axes to the new points moves the view, so it is left as it is once the
+    // user zoomed or panned the plot
+    if( plotPanel->IsViewFitted() )
+        plotPanel->ResetScales();
+
+    plotPanel->GetPlotWin()->UpdateAll();
+}
+
+
 void SIM_PLOT_FRAME::onSimUpdate( wxCommandEvent& aEvent )
 {
     if( IsSimulationRunning() )
@@ -41,10 +41,12 @@
 #include <dialogs/dialog_sim_settings.h>
 
 #include <wx/event.h>
+#include <wx/timer.h>
 
 #include <list>
 #include <memory>
 #include <map>
+#include <vector>
 
 class SCH_EDIT_FRAME;
 class SCH_COMPONENT;
@@ -268,6 +270,11 @@ private:
      */
     void applyTuners();
 
+    /**
+     * @brief Removes the tolerance analysis envelopes of a plot.
+     */
+    void removeEnvelopes( SIM_PLOT_PANEL* aPanel );
+
     /**
      * @brief Loads plot settings from a file.
      * @param aPath is the file name.
@@ -326,6 +333,7 @@ private:
     void onAddSignal( wxCommandEvent& event );
     void onProbe( wxCommandEvent& event );
     void onTune( wxCommandEvent& event );
+    void onToleranceAnalysis( wxCommandEvent& event );
     void onShowNetlist( wxCommandEvent& event );
 
     void doCloseWindow() override;
@@ -336,6 +344,9 @@ private:
     void onSimStarted( wxCommandEvent& aEvent );
     void onSimFinished( wxCommandEvent& aEvent );
 
+    ///> Plots the transient analysis points computed since the previous call
+    void onSimStreamTimer( wxTimerEvent& aEvent );
+
     // adjust the sash dimension of splitter windows after reading
     // the config settings
     // must be called after the config settings are read, and once the
@@ -363,6 +374,9 @@ private:
 
         ///> Spice directive used to execute the simulation
         wxString m_simCommand;
+
+        ///> Traces of the tolerance analysis envelopes, removed by the next simulation
+        std::vector<wxString> m_envelopes;
     };
 
     ///> Map of plot panels and associated data
@@ -400,6 +414,12 @@ private:
     ///> Panel that was used as the most recent one for simulations
     SIM_PLOT_PANEL* m_lastSimPlot;
 
+    ///> Refreshes the plot while a simulation runs
+    wxTimer m_streamTimer;
+
+    ///> Run of the simulator data buffer shown by the plot
+    unsigned int m_streamRunId;
+
     ///> imagelists uset to add a small coloured icon to signal names
     ///> and cursors name, the same color as the corresponding signal traces
     wxImageList* m_signalsIconColorList;
@@ -62,6 +62,9 @@ SIM_PLOT_FRAME_BASE::SIM_PLOT_FRAME_BASE( wxWindow* parent, wxWindowID id, const
 	m_tuneValue = new wxMenuItem( m_simulationMenu, ID_MENU_TUNE_SIGNALS, wxString( _("Tune Component Value") ) + wxT('\t') + wxT("T"), wxEmptyString, wxITEM_NORMAL );
 	m_simulationMenu->Append( m_tuneValue );
 
+	m_toleranceAnalysis = new wxMenuItem( m_simulationMenu, ID_MENU_TOLERANCE_ANALYSIS, wxString( _("Tolerance Analysis...") ) , _("Runs the simulation with random values of the tuned components within their tolerance, and plots the range of the signals."), wxITEM_NORMAL );
+	m_simulationMenu->Append( m_toleranceAnalysis );
+
 	m_simulationMenu->AppendSeparator();
 
 	m_showNetlist = new wxMenuItem( m_simulationMenu, ID_MENU_SHOW_NETLIST, wxString( _("Show SPICE Netlist...") ) , _("Shows current simulation's netlist. Useful for debugging SPICE errors."), wxITEM_NORMAL );
@@ -38,12 +38,13 @@
 #define ID_MENU_ADD_SIGNAL 1003
 #define ID_MENU_PROBE_SIGNALS 1004
 #define ID_MENU_TUNE_SIGNALS 1005
-#define ID_MENU_SHOW_NETLIST 1006
-#define ID_MENU_SET_SIMUL 1007
-#define ID_MENU_SHOW_GRID 1008
-#define ID_MENU_SHOW_LEGEND 1009
-#define ID_MENU_DOTTED 1010
-#define ID_MENU_WHITE_BG 1011
+#define ID_MENU_TOLERANCE_ANALYSIS 1006
+#define ID_MENU_SHOW_NETLIST 1007
+#define ID_MENU_SET_SIMUL 1008
+#define ID_MENU_SHOW_GRID 1009
+#define ID_MENU_SHOW_LEGEND 1010
+#define ID_MENU_DOTTED 1011
+#define ID_MENU_WHITE_BG 1012
 
 ///////////////////////////////////////////////////////////////////////////////
 /// Class SIM_PLOT_FRAME_BASE
@@ -60,6 +61,7 @@ class SIM_PLOT_FRAME_BASE : public KIWAY_PLAYER
 		wxMenuItem* m_addSignals;
 		wxMenuItem* m_probeSignals;
 		wxMenuItem* m_tuneValue;
+		wxMenuItem* m_toleranceAnalysis;
 		wxMenuItem* m_showNetlist;
 		wxMenuItem* m_settings;
 		wxMenu* m_viewMenu;
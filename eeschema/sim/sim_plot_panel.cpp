@@ -650,6 +650,14 @@ void SIM_PLOT_PANEL::ResetScales()
 }
 
 
+bool SIM_PLOT_PANEL::IsViewFitted() const
+{
+    // Plot coordinates are normalized to the scale ranges, see mpWindow::UpdateBBox()
+    return m_plotWin->GetDesiredXmin() == 0.0 && m_plotWin->GetDesiredXmax() == 1.0
+           && m_plotWin->GetDesiredYmin() == 0.0 && m_plotWin->GetDesiredYmax() == 1.0;
+}
+
+
 wxColour SIM_PLOT_PANEL::generateColor()
 {
     const unsigned int colorCount = m_masterFrame->GetPlotColorCount() - SIM_TRACE_COLOR;
@@ -113,6 +113,19 @@ public:
         mpFXYVector::SetData( aX, aY );
     }
 
+    /**
+     * @brief Adds points at the end of the trace, e.g. while the simulation runs.
+     * @param aX are the X axis values.
+     * @param aY are the Y axis values.
+     */
+    void AppendData( const std::vector<double>& aX, const std::vector<double>& aY ) override
+    {
+        if( m_cursor )
+            m_cursor->Update();
+
+        mpFXYVector::AppendData( aX, aY );
+    }
+
     const std::vector<double>& GetDataX() const
     {
         return m_xs;
@@ -273,6 +286,9 @@ public:
     ///> Resets scale ranges to fit the current traces
     void ResetScales();
 
+    ///> Returns true if the view shows the whole scale ranges, i.e. it was not zoomed nor panned
+    bool IsViewFitted() const;
+
     ///> Update trace line style
     void UpdateTraceStyle( TRACE* trace );
 
@@ -0,0 +1,417 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * https://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "sim_sweep.h"
+#include "spice_simulator.h"
+
+#include <common.h>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <thread>
+
+#include <wx/debug.h>
+
+
+static const double NO_VALUE = std::numeric_limits<double>::quiet_NaN();
+
+
+/**
+ * Interpolates linearly aY at aAt along aX, which is monotonic in either direction.  Without
+ * X axis, the value is the last one of aY.
+ */
+static double interpolate( const std::vector<double>& aX, const std::vector<double>& aY,
+                           double aAt )
+{
+    if( aX.empty() )
+        return aY.empty() ? NO_VALUE : aY.back();
+
+    size_t count = std::min( aX.size(), aY.size() );
+
+    if( count == 0 )
+        return NO_VALUE;
+
+    auto begin = aX.begin();
+    auto end = aX.begin() + count;
+    auto it = aX[0] <= aX[count - 1] ? std::lower_bound( begin, end, aAt )
+                                     : std::lower_bound( begin, end, aAt, std::greater<double>() );
+
+    if( it == begin )
+        return aY[0];
+
+    if( it == end )
+        return aY[count - 1];
+
+    size_t ii = it - begin;
+    double x0 = aX[ii - 1];
+    double x1 = aX[ii];
+
+    if( x1 == x0 )
+        return aY[ii];
+
+    return aY[ii - 1] + ( aAt - x0 ) / ( x1 - x0 ) * ( aY[ii] - aY[ii - 1] );
+}
+
+
+SIM_SWEEP_RESULTS::SIM_SWEEP_RESULTS( size_t aVariantCount, size_t aSignalCount ) :
+        m_valid( aVariantCount, false ),
+        m_xAxis( aVariantCount ),
+        m_signals( aSignalCount, std::vector<std::vector<double>>( aVariantCount ) )
+{
+}
+
+
+void SIM_SWEEP_RESULTS::SetResult( size_t aVariant, std::vector<double> aXAxis,
+                                   std::vector<std::vector<double>> aSignals )
+{
+    wxASSERT( aSignals.size() == m_signals.size() );
+
+    m_xAxis[aVariant] = std::move( aXAxis );
+
+    for( size_t ii = 0; ii < m_signals.size() && ii < aSignals.size(); ++ii )
+        m_signals[ii][aVariant] = std::move( aSignals[ii] );
+
+    m_valid[aVariant] = true;
+}
+
+
+double SIM_SWEEP_RESULTS::valueAt( size_t aSignal, size_t aVariant, double aX ) const
+{
+    return interpolate( m_xAxis[aVariant], m_signals[aSignal][aVariant], aX );
+}
+
+
+bool SIM_SWEEP_RESULTS::GetEnvelope( size_t aSignal, std::vector<double>& aX,
+                                     std::vector<double>& aMin, std::vector<double>& aMax ) const
+{
+    auto first = std::find( m_valid.begin(), m_valid.end(), true );
+
+    aX.clear();
+    aMin.clear();
+    aMax.clear();
+
+    if( first == m_valid.end() )
+        return false;
+
+    size_t reference = first - m_valid.begin();
+
+    aX = m_xAxis[reference];
+    aMin = m_signals[aSignal][reference];
+
+    // Without X axis, the signal has a single value
+    if( !aX.empty() )
+        aMin.resize( std::min( aX.size(), aMin.size() ) );
+    else if( aMin.size() > 1 )
+        aMin.erase( aMin.begin(), aMin.end() - 1 );
+
+    aX.resize( std::min( aX.size(), aMin.size() ) );
+    aMax = aMin;
+
+    for( size_t variant = reference + 1; variant < m_valid.size(); ++variant )
+    {
+        if( !m_valid[variant] )
+            continue;
+
+        for( size_t ii = 0; ii < aMin.size(); ++ii )
+        {
+            double value = valueAt( aSignal, variant, aX.empty() ? 0.0 : aX[ii] );
+
+            if( std::isnan( value ) )
+                continue;
+
+            aMin[ii] = std::min( aMin[ii], value );
+            aMax[ii] = std::max( aMax[ii], value );
+        }
+    }
+
+    return true;
+}
+
+
+std::vector<double> SIM_SWEEP_RESULTS::GetValuesAt( size_t aSignal, double aX ) const
+{
+    std::vector<double> values;
+
+    for( size_t variant = 0; variant < m_valid.size(); ++variant )
+    {
+        if( m_valid[variant] )
+            values.push_back( valueAt( aSignal, variant, aX ) );
+    }
+
+    return values;
+}
+
+
+std::vector<size_t> SIM_SWEEP_RESULTS::Histogram( const std::vector<double>& aValues,
+                                                  size_t aBinCount, double& aMin, double& aMax )
+{
+    std::vector<size_t> bins( aBinCount, 0 );
+
+    aMin = std::numeric_limits<double>::infinity();
+    aMax = -std::numeric_limits<double>::infinity();
+
+    for( double value : aValues )
+    {
+        if( std::isfinite( value ) )
+        {
+            aMin = std::min( aMin, value );
+            aMax = std::max( aMax, value );
+        }
+    }
+
+    if( aMin > aMax )
+    {
+        aMin = aMax = 0.0;
+        return bins;
+    }
+
+    if( aBinCount == 0 )
+        return bins;
+
+    double width = ( aMax - aMin ) / aBinCount;
+
+    for( double value : aValues )
+    {
+        if( !std::isfinite( value ) )
+            continue;
+
+        size_t bin = width > 0.0 ? (size_t) ( ( value - aMin ) / width ) : 0;
+
+        // The maximum falls in the last bin
+        bins[std::min( bin, aBinCount - 1 )]++;
+    }
+
+    return bins;
+}
+
+
+SIM_SWEEP::SIM_SWEEP( const std::string& aNetlist, SIM_TYPE aSimType ) :
+        m_netlist( aNetlist ),
+        m_simType( aSimType ),
+        m_variantCount( 0 ),
+        m_cancelled( false ),
+        m_doneCount( 0 )
+{
+}
+
+
+void SIM_SWEEP::AddParam( const SIM_SWEEP_PARAM& aParam )
+{
+    m_params.push_back( aParam );
+    m_variants.clear();
+    m_variantCount = 0;
+}
+
+
+void SIM_SWEEP::AddSignal( const wxString& aVector )
+{
+    m_signals.push_back( aVector );
+}
+
+
+void SIM_SWEEP::MakeMonteCarloVariants( size_t aCount, unsigned int aSeed )
+{
+    std::mt19937                     generator( aSeed );
+    std::uniform_real_distribution<> uniform( -1.0, 1.0 );
+    std::normal_distribution<>       gaussian( 0.0, 1.0 / 3.0 );
+
+    m_variants.assign( m_params.size(), std::vector<double>( aCount ) );
+    m_variantCount = aCount;
+
+    // Variants are drawn one after the other, so a variant doesn't depend on the count
+    for( size_t variant = 0; variant < aCount; ++variant )
+    {
+        for( size_t ii = 0; ii < m_params.size(); ++ii )
+        {
+            const SIM_SWEEP_PARAM& param = m_params[ii];
+            double                 deviation = 0.0;
+
+            if( variant > 0 && param.m_tolerance > 0.0 )
+            {
+                if( param.m_distribution == SSD_GAUSSIAN )
+                {
+                    do
+                    {
+                        deviation = gaussian( generator );
+                    } while( std::abs( deviation ) > 1.0 );
+                }
+                else
+                {
+                    deviation = uniform( generator );
+                }
+            }
+
+            m_variants[ii][variant] = param.m_nominal * ( 1.0 + deviation * param.m_tolerance );
+        }
+    }
+}
+
+
+void SIM_SWEEP::MakeGridVariants()
+{
+    size_t count = 1;
+
+    for( const SIM_SWEEP_PARAM& param : m_params )
+        count *= std::max<size_t>( 1, param.m_gridValues.size() );
+
+    m_variants.assign( m_params.size(), std::vector<double>( count ) );
+    m_variantCount = count;
+
+    for( size_t variant = 0; variant < count; ++variant )
+    {
+        size_t index = variant;
+
+        for( size_t ii = 0; ii < m_params.size(); ++ii )
+        {
+            const std::vector<double>& values = m_params[ii].m_gridValues;
+
+            if( values.empty() )
+            {
+                m_variants[ii][variant] = m_params[ii].m_nominal;
+            }
+            else
+            {
+                m_variants[ii][variant] = values[index % values.size()];
+                index /= values.size();
+            }
+        }
+    }
+}
+
+
+SIM_SWEEP_RESULTS SIM_SWEEP::Run( unsigned int aWorkerCount )
+{
+    size_t            variantCount = GetVariantCount();
+    SIM_SWEEP_RESULTS results( variantCount, m_signals.size() );
+
+    m_cancelled = false;
+    m_doneCount = 0;
+
+    if( variantCount == 0 )
+        return results;
+
+    if( aWorkerCount == 0 )
+        aWorkerCount = std::max( 1u, std::thread::hardware_concurrency() );
+
+    size_t workerCount = std::min<size_t>( aWorkerCount, variantCount );
+
+    // Switched here for the worker threads, see LOCALE_IO
+    LOCALE_IO toggle;
+
+    // Simulators are created by the calling thread, their initialization is not thread safe
+    std::vector<std::shared_ptr<SPICE_SIMULATOR>> simulators;
+
+    for( size_t ii = 0; ii < workerCount; ++ii )
+        simulators.push_back( SPICE_SIMULATOR::CreateWorkerInstance( "ngspice" ) );
+
+    std::atomic<size_t>             nextVariant( 0 );
+    std::vector<std::exception_ptr> errors( workerCount );
+
+    auto worker =
+            [&]( size_t aWorker )
+            {
+                try
+                {
+                    runVariants( *simulators[aWorker], nextVariant, results );
+                }
+                catch( ... )
+                {
+                    errors[aWorker] = std::current_exception();
+                }
+            };
+
+    if( workerCount == 1 )
+    {
+        worker( 0 );
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+
+        for( size_t ii = 0; ii < workerCount; ++ii )
+            threads.emplace_back( worker, ii );
+
+        for( std::thread& thread : threads )
+            thread.join();
+    }
+
+    for( const std::exception_ptr& error : errors )
+    {
+        if( error )
+            std::rethrow_exception( error );
+    }
+
+    return results;
+}
+
+
+void SIM_SWEEP::runVariants( SPICE_SIMULATOR& aSimulator, std::atomic<size_t>& aNextVariant,
+                             SIM_SWEEP_RESULTS& aResults )
+{
+    size_t      variantCount = GetVariantCount();
+    std::string xAxis = aSimulator.GetXAxis( m_simType );
+
+    aSimulator.LoadNetlist( m_netlist );
+
+    for( size_t variant = aNextVariant++; variant < variantCount && !m_cancelled;
+         variant = aNextVariant++ )
+    {
+        for( size_t ii = 0; ii < m_params.size(); ++ii )
+        {
+            aSimulator.Command( wxString::Format( "alter %s = %.12g", m_params[ii].m_device,
+                                                  m_variants[ii][variant] ).ToStdString() );
+        }
+
+        // Runs in this thread, unlike SPICE_SIMULATOR::Run()
+        aSimulator.Command( "run" );
+
+        std::vector<double>              x;
+        std::vector<std::vector<double>> signals;
+        bool                             valid = true;
+
+        if( !xAxis.empty() )
+        {
+            x = aSimulator.GetMagPlot( xAxis );
+            valid = !x.empty();
+        }
+
+        for( const wxString& signal : m_signals )
+        {
+            signals.push_back( aSimulator.GetMagPlot( signal.ToStdString() ) );
+            valid = valid && !signals.back().empty();
+        }
+
+        if( valid )
+            aResults.SetResult( variant, std::move( x ), std::move( signals ) );
+
+        // ngspice keeps the vectors of every run, and the ones of this run would be read if
+        // the next one fails
+        aSimulator.Command( "destroy all" );
+        ++m_doneCount;
+    }
+}
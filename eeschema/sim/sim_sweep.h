@@ -0,0 +1,252 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * https://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef SIM_SWEEP_H
+#define SIM_SWEEP_H
+
+#include "sim_types.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <wx/string.h>
+
+class SPICE_SIMULATOR;
+
+///> How the values of a parameter are spread within its tolerance in Monte-Carlo variants
+enum SIM_SWEEP_DISTRIBUTION
+{
+    SSD_UNIFORM,
+    SSD_GAUSSIAN    ///< The tolerance is three standard deviations, values beyond are redrawn
+};
+
+
+///> Component value varied by a sweep
+struct SIM_SWEEP_PARAM
+{
+    SIM_SWEEP_PARAM( const wxString& aDevice, double aNominal ) :
+            m_device( aDevice ),
+            m_nominal( aNominal ),
+            m_tolerance( 0.0 ),
+            m_distribution( SSD_UNIFORM )
+    {
+    }
+
+    ///> Spice device (@see NETLIST_EXPORTER_PSPICE::GetSpiceDevice()).  Its value is the
+    ///> resistance, capacitance or inductance of passives, and the DC value of sources.
+    wxString m_device;
+
+    double m_nominal;
+
+    ///> Relative tolerance of the Monte-Carlo variants (e.g. 0.05 for 5%)
+    double m_tolerance;
+
+    SIM_SWEEP_DISTRIBUTION m_distribution;
+
+    ///> Values of the parameter grid
+    std::vector<double> m_gridValues;
+};
+
+
+/**
+ * @brief Simulation results of the variants of a sweep.
+ *
+ * Every signal is stored as one column per variant, so the envelope of a signal or its
+ * distribution at a given point is computed without copying the results.
+ */
+class SIM_SWEEP_RESULTS
+{
+public:
+    SIM_SWEEP_RESULTS( size_t aVariantCount, size_t aSignalCount );
+
+    size_t GetVariantCount() const
+    {
+        return m_valid.size();
+    }
+
+    ///> Returns false if the simulation of the variant failed
+    bool IsValid( size_t aVariant ) const
+    {
+        return m_valid[aVariant];
+    }
+
+    ///> Returns the X axis of a variant, empty for analyses without one (operating point)
+    const std::vector<double>& GetXAxis( size_t aVariant ) const
+    {
+        return m_xAxis[aVariant];
+    }
+
+    const std::vector<double>& GetSignal( size_t aSignal, size_t aVariant ) const
+    {
+        return m_signals[aSignal][aVariant];
+    }
+
+    /**
+     * @brief Stores the results of a variant.  Results of different variants may be stored
+     * from different threads.
+     * @param aSignals holds the signals in the order they were added to the sweep.
+     */
+    void SetResult( size_t aVariant, std::vector<double> aXAxis,
+                    std::vector<std::vector<double>> aSignals );
+
+    /**
+     * @brief Computes the lower and upper bounds of a signal over the valid variants.
+     * As the X axes of the variants may differ (e.g. transient time steps), the variants are
+     * interpolated at the points of the first valid variant.
+     * @param aX receives the X axis of the envelope.
+     * @return False if no variant is valid.
+     */
+    bool GetEnvelope( size_t aSignal, std::vector<double>& aX, std::vector<double>& aMin,
+                      std::vector<double>& aMax ) const;
+
+    /**
+     * @brief Returns the value of a signal at \a aX for every valid variant, interpolated
+     * between the simulated points.  For analyses without X axis, it is the signal value.
+     */
+    std::vector<double> GetValuesAt( size_t aSignal, double aX ) const;
+
+    /**
+     * @brief Counts values in \a aBinCount bins of equal width.
+     * @param aMin and @param aMax receive the range of the bins (the range of the values).
+     */
+    static std::vector<size_t> Histogram( const std::vector<double>& aValues, size_t aBinCount,
+                                          double& aMin, double& aMax );
+
+private:
+    ///> Returns the value of a signal of a variant at aX
+    double valueAt( size_t aSignal, size_t aVariant, double aX ) const;
+
+    ///> Valid flags of the variants (not a vector<bool>, as they are set from several threads)
+    std::vector<char> m_valid;
+
+    ///> X axes of the variants
+    std::vector<std::vector<double>> m_xAxis;
+
+    ///> Signal columns, indexed by signal and variant
+    std::vector<std::vector<std::vector<double>>> m_signals;
+};
+
+
+/**
+ * @brief Runs a simulation for many variants of the component values of a circuit, e.g. for
+ * tolerance analysis.
+ *
+ * The variants are simulated in parallel, each worker thread driving its own simulator
+ * instance (@see SPICE_SIMULATOR::CreateWorkerInstance()).  Component values are changed
+ * with the Spice "alter" command between the runs, so the netlist is loaded only once per
+ * worker.
+ */
+class SIM_SWEEP
+{
+public:
+    /**
+     * @param aNetlist is the circuit to simulate, as made by NETLIST_EXPORTER_PSPICE_SIM.
+     * @param aSimType is the analysis of the simulation command of the netlist.
+     */
+    SIM_SWEEP( const std::string& aNetlist, SIM_TYPE aSimType );
+
+    ///> Adds a varied component value.  Variants have to be made again afterwards.
+    void AddParam( const SIM_SWEEP_PARAM& aParam );
+
+    ///> Adds a vector to collect (e.g. V(3), I(R1)).  Complex vectors are stored as magnitude.
+    void AddSignal( const wxString& aVector );
+
+    const std::vector<SIM_SWEEP_PARAM>& GetParams() const
+    {
+        return m_params;
+    }
+
+    const std::vector<wxString>& GetSignals() const
+    {
+        return m_signals;
+    }
+
+    /**
+     * @brief Makes \a aCount variants.  The first one has the nominal values, the other ones
+     * values drawn within the tolerances of the parameters.
+     * @param aSeed makes the variants reproducible.
+     */
+    void MakeMonteCarloVariants( size_t aCount, unsigned int aSeed = 0 );
+
+    /**
+     * @brief Makes a variant for every combination of the grid values of the parameters, the
+     * first parameter varying the fastest.  Parameters without grid values keep their nominal
+     * value.
+     */
+    void MakeGridVariants();
+
+    size_t GetVariantCount() const
+    {
+        return m_variants.empty() ? m_variantCount : m_variants.front().size();
+    }
+
+    ///> Returns the value of a parameter in every variant
+    const std::vector<double>& GetParamValues( size_t aParam ) const
+    {
+        return m_variants[aParam];
+    }
+
+    /**
+     * @brief Simulates every variant.  It returns once all the variants are simulated or the
+     * sweep is cancelled.  It may run in a worker thread, as long as no other simulator is
+     * created meanwhile.
+     * @param aWorkerCount is the number of simulations running in parallel, 0 for one per CPU.
+     * @throw std::exception if a simulator cannot be created.
+     */
+    SIM_SWEEP_RESULTS Run( unsigned int aWorkerCount = 0 );
+
+    ///> Stops a running sweep, the variants which are not simulated are invalid
+    void Cancel()
+    {
+        m_cancelled = true;
+    }
+
+    ///> Returns the number of variants simulated by the running sweep
+    size_t GetDoneCount() const
+    {
+        return m_doneCount;
+    }
+
+private:
+    ///> Simulates variants with a simulator until there are no more
+    void runVariants( SPICE_SIMULATOR& aSimulator, std::atomic<size_t>& aNextVariant,
+                      SIM_SWEEP_RESULTS& aResults );
+
+    std::string m_netlist;
+    SIM_TYPE    m_simType;
+
+    std::vector<SIM_SWEEP_PARAM> m_params;
+    std::vector<wxString>        m_signals;
+
+    ///> Parameter values of the variants, indexed by parameter and variant
+    std::vector<std::vector<double>> m_variants;
+
+    ///> Number of variants, when there is no parameter
+    size_t m_variantCount;
+
+    std::atomic<bool>   m_cancelled;
+    std::atomic<size_t> m_doneCount;
+};
+
+#endif /* SIM_SWEEP_H */
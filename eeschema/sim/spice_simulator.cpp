@@ -45,6 +45,12 @@ std::shared_ptr<SPICE_SIMULATOR> SPICE_SIMULATOR::CreateInstance( const std::str
     return NULL;
 }
 
+
+std::shared_ptr<SPICE_SIMULATOR> SPICE_SIMULATOR::CreateWorkerInstance( const std::string& )
+{
+    return std::make_shared<NGSPICE>( true );
+}
+
 wxString SPICE_SIMULATOR::TypeToName( SIM_TYPE aType, bool aShortName )
 {
     switch( aType )
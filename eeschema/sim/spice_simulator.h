@@ -25,6 +25,7 @@
 #ifndef SPICE_SIMULATOR_H
 #define SPICE_SIMULATOR_H
 
+#include "sim_data_buffer.h"
 #include "sim_types.h"
 
 #include <string>
@@ -48,6 +49,15 @@ public:
     ///> Creates a simulator instance of particular type (currently only ngspice is handled)
     static std::shared_ptr<SPICE_SIMULATOR> CreateInstance( const std::string& aName );
 
+    /**
+     * @brief Creates a simulator instance independent of the one returned by CreateInstance()
+     * and of the other worker instances, so simulations can run in parallel in them.
+     * It has to be called from the main thread, as the simulator initialization changes the
+     * working directory.
+     * @throw std::exception if the simulator cannot be created.
+     */
+    static std::shared_ptr<SPICE_SIMULATOR> CreateWorkerInstance( const std::string& aName );
+
     ///> Initializes the simulator
     virtual void Init() = 0;
 
@@ -160,9 +170,21 @@ public:
      */
     static wxString TypeToName( SIM_TYPE aType, bool aShortName );
 
+    /**
+     * @brief Returns the buffer receiving the vectors while the simulation runs.  It has to
+     * be enabled to be filled.
+     */
+    SIM_DATA_BUFFER& GetDataBuffer()
+    {
+        return m_dataBuffer;
+    }
+
 protected:
     ///> Reporter object to receive simulation log
     SPICE_REPORTER* m_reporter;
+
+    ///> Vectors of the running simulation
+    SIM_DATA_BUFFER m_dataBuffer;
 };
 
 #endif /* SPICE_SIMULATOR_H */
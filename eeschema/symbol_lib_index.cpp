@@ -0,0 +1,590 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cctype>
+#include <cstdlib>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/textfile.h>
+
+#include <cache_file.h>
+#include <class_libentry.h>
+#include <lib_field.h>
+#include <lib_pin.h>
+#include <kicad_string.h>
+#include <mapped_file.h>
+#include <sch_file_versions.h>
+#include <trace_helpers.h>
+
+#include <symbol_lib_index.h>
+
+
+///> Version of the saved index format, increment it when the content changes
+#define SYMBOL_INDEX_FORMAT "symbol-index 2"
+
+///> Lines per symbol in the saved index
+#define SYMBOL_INDEX_LINES 11
+
+
+LIB_SYMBOL_INFO::LIB_SYMBOL_INFO( LIB_PART& aPart ) :
+        m_nickname( aPart.GetLibNickname() ),
+        m_name( aPart.GetName() ),
+        m_description( aPart.GetDescription() ),
+        m_keywords( aPart.GetKeyWords() ),
+        m_footprint( aPart.GetFootprintField().GetText() ),
+        m_unitCount( aPart.GetUnitCount() ),
+        m_isPower( aPart.IsPower() ),
+        m_offset( 0 ),
+        m_length( 0 )
+{
+    LIB_PART* root = &aPart;
+
+    if( aPart.IsAlias() )
+    {
+        std::shared_ptr<LIB_PART> parent = aPart.GetParent().lock();
+
+        if( parent )
+        {
+            m_parent = parent->GetName();
+            root = parent.get();
+        }
+    }
+
+    LIB_PINS pins;
+    root->GetPins( pins, 0, 1 );
+    m_pinCount = (int) pins.size();
+
+    for( const wxString& filter : aPart.GetFootprints() )
+    {
+        if( !m_fpFilters.IsEmpty() )
+            m_fpFilters += ' ';
+
+        m_fpFilters += filter;
+    }
+}
+
+
+wxString LIB_SYMBOL_INFO::GetSearchText()
+{
+    // Matches are scored by offset from front of string, so inclusion of this spacer
+    // discounts matches found after it.
+    static const wxString discount( wxT( "        " ) );
+
+    wxString text = m_keywords + discount + m_description;
+
+    if( !m_footprint.IsEmpty() )
+        text += discount + m_footprint;
+
+    return text;
+}
+
+
+wxString LIB_SYMBOL_INFO::GetUnitReference( int aUnit )
+{
+    return LIB_PART::SubReference( aUnit, false );
+}
+
+
+namespace
+{
+
+/**
+ * Just enough of a s-expression reader to find the symbols of a library file and the few
+ * fields the index needs.  Everything else is skipped without being tokenized.
+ */
+class SCANNER
+{
+public:
+    SCANNER( const char* aData, size_t aSize ) :
+            m_start( aData ),
+            m_pos( aData ),
+            m_end( aData + aSize )
+    {
+    }
+
+    size_t Offset() const { return m_pos - m_start; }
+
+    /**
+     * Skips the blanks and consumes \a aChar if it comes next.
+     */
+    bool Consume( char aChar )
+    {
+        while( m_pos < m_end && isspace( (unsigned char) *m_pos ) )
+            ++m_pos;
+
+        if( m_pos == m_end || *m_pos != aChar )
+            return false;
+
+        ++m_pos;
+        return true;
+    }
+
+    /**
+     * Reads a symbol or a quoted string, with its escape sequences resolved.
+     */
+    bool Atom( std::string& aAtom )
+    {
+        aAtom.clear();
+
+        while( m_pos < m_end && isspace( (unsigned char) *m_pos ) )
+            ++m_pos;
+
+        if( m_pos == m_end || *m_pos == '(' || *m_pos == ')' )
+            return false;
+
+        if( *m_pos != '"' )
+        {
+            while( m_pos < m_end && !isspace( (unsigned char) *m_pos ) && *m_pos != '('
+                    && *m_pos != ')' )
+            {
+                aAtom += *m_pos++;
+            }
+
+            return true;
+        }
+
+        for( ++m_pos; m_pos < m_end; ++m_pos )
+        {
+            if( *m_pos == '"' )
+            {
+                ++m_pos;
+                return true;
+            }
+
+            if( *m_pos == '\\' && m_pos + 1 < m_end )
+            {
+                switch( *++m_pos )
+                {
+                case 'n': aAtom += '\n';    break;
+                case 'r': aAtom += '\r';    break;
+                default:  aAtom += *m_pos;  break;
+                }
+            }
+            else
+            {
+                aAtom += *m_pos;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Skips the rest of the current list, up to and including its closing parenthesis.
+     */
+    bool SkipList()
+    {
+        int depth = 1;
+
+        while( m_pos < m_end )
+        {
+            char c = *m_pos++;
+
+            if( c == '"' )
+            {
+                while( m_pos < m_end && *m_pos != '"' )
+                {
+                    if( *m_pos == '\\' && m_pos + 1 < m_end )
+                        ++m_pos;
+
+                    ++m_pos;
+                }
+
+                if( m_pos < m_end )
+                    ++m_pos;
+            }
+            else if( c == '(' )
+            {
+                depth++;
+            }
+            else if( c == ')' && --depth == 0 )
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    const char* m_start;
+    const char* m_pos;
+    const char* m_end;
+};
+
+
+/**
+ * Scans a symbol, once its "(symbol" is consumed, up to and including its closing
+ * parenthesis.
+ */
+bool scanSymbol( SCANNER& aScanner, LIB_SYMBOL_INFO& aInfo )
+{
+    std::string atom;
+    std::string value;
+
+    if( !aScanner.Atom( atom ) )
+        return false;
+
+    aInfo.m_name = FROM_UTF8( atom.c_str() );
+
+    const std::string prefix = atom + "_";
+
+    while( aScanner.Consume( '(' ) )
+    {
+        if( !aScanner.Atom( atom ) )
+            return false;
+
+        if( atom == "extends" )
+        {
+            if( !aScanner.Atom( value ) )
+                return false;
+
+            aInfo.m_parent = FROM_UTF8( value.c_str() );
+        }
+        else if( atom == "power" )
+        {
+            aInfo.m_isPower = true;
+        }
+        else if( atom == "property" )
+        {
+            if( !aScanner.Atom( atom ) || !aScanner.Atom( value ) )
+                return false;
+
+            if( atom == "ki_description" )
+                aInfo.m_description = FROM_UTF8( value.c_str() );
+            else if( atom == "ki_keywords" )
+                aInfo.m_keywords = FROM_UTF8( value.c_str() );
+            else if( atom == "ki_fp_filters" )
+                aInfo.m_fpFilters = FROM_UTF8( value.c_str() );
+            else if( atom == "Footprint" )
+                aInfo.m_footprint = FROM_UTF8( value.c_str() );
+        }
+        else if( atom == "symbol" )
+        {
+            // Units are named after their symbol: "NAME_unit_convert"
+            int unit = 1;
+            int convert = 1;
+
+            if( !aScanner.Atom( atom ) )
+                return false;
+
+            if( atom.compare( 0, prefix.size(), prefix ) == 0 )
+            {
+                const char* suffix = atom.c_str() + prefix.size();
+                char*       next = nullptr;
+
+                unit = (int) strtol( suffix, &next, 10 );
+
+                if( *next == '_' )
+                    convert = (int) strtol( next + 1, nullptr, 10 );
+            }
+
+            if( unit > aInfo.m_unitCount )
+                aInfo.m_unitCount = unit;
+
+            while( aScanner.Consume( '(' ) )
+            {
+                if( !aScanner.Atom( atom ) )
+                    return false;
+
+                if( atom == "pin" && convert <= 1 )
+                    aInfo.m_pinCount++;
+
+                if( !aScanner.SkipList() )
+                    return false;
+            }
+
+            if( !aScanner.Consume( ')' ) )
+                return false;
+
+            continue;
+        }
+
+        if( !aScanner.SkipList() )
+            return false;
+    }
+
+    return aScanner.Consume( ')' );
+}
+
+} // namespace
+
+
+SYMBOL_LIB_INDEX::SYMBOL_LIB_INDEX() :
+        m_fileSize( 0 ),
+        m_fileHash( 0 ),
+        m_fileVersion( SEXPR_SYMBOL_LIB_FILE_VERSION )
+{
+}
+
+
+bool SYMBOL_LIB_INDEX::Load( const wxString& aLibraryPath )
+{
+    wxString indexFileName = GetIndexFileName( aLibraryPath );
+
+    if( read( indexFileName ) && m_libraryPath == aLibraryPath && IsUpToDate() )
+        return true;
+
+    if( !Build( aLibraryPath ) )
+        return false;
+
+    write( indexFileName );
+    return true;
+}
+
+
+bool SYMBOL_LIB_INDEX::Build( const wxString& aLibraryPath )
+{
+    wxFileName fn( aLibraryPath );
+
+    m_libraryPath = aLibraryPath;
+    m_fileVersion = SEXPR_SYMBOL_LIB_FILE_VERSION;
+    m_symbols.clear();
+    m_symbolIndex.clear();
+
+    if( !fn.FileExists() )
+        return false;
+
+    MAPPED_FILE file;
+
+    if( !file.Open( aLibraryPath ) )
+        return false;
+
+    m_fileSize = (long long) file.Size();
+    m_fileHash = HashContent( file.Data(), file.Size() );
+
+    SCANNER     scanner( file.Data(), file.Size() );
+    std::string atom;
+    bool        ok = scanner.Consume( '(' ) && scanner.Atom( atom ) && atom == "kicad_symbol_lib";
+
+    while( ok && scanner.Consume( '(' ) )
+    {
+        size_t start = scanner.Offset() - 1;
+
+        if( !scanner.Atom( atom ) )
+        {
+            ok = false;
+        }
+        else if( atom == "symbol" )
+        {
+            LIB_SYMBOL_INFO info;
+
+            info.m_offset = start;
+            ok = scanSymbol( scanner, info );
+            info.m_length = scanner.Offset() - start;
+
+            m_symbolIndex[info.m_name] = m_symbols.size();
+            m_symbols.push_back( info );
+        }
+        else
+        {
+            if( atom == "version" && scanner.Atom( atom ) )
+                m_fileVersion = atoi( atom.c_str() );
+
+            ok = scanner.SkipList();
+        }
+    }
+
+    if( !ok || !scanner.Consume( ')' ) )
+    {
+        wxLogTrace( traceSchLegacyPlugin, "Cannot index symbol library \"%s\"", aLibraryPath );
+
+        m_symbols.clear();
+        m_symbolIndex.clear();
+        return false;
+    }
+
+    // Derived symbols share the units and pins of their parent
+    for( LIB_SYMBOL_INFO& info : m_symbols )
+    {
+        if( const LIB_SYMBOL_INFO* parent = info.IsRoot() ? nullptr : Find( info.m_parent ) )
+        {
+            info.m_unitCount = parent->m_unitCount;
+            info.m_pinCount = parent->m_pinCount;
+        }
+    }
+
+    return true;
+}
+
+
+bool SYMBOL_LIB_INDEX::IsUpToDate() const
+{
+    wxFileName         fn( m_libraryPath );
+    unsigned long long hash = 0;
+
+    if( !fn.FileExists() || (long long) fn.GetSize().GetValue() != m_fileSize )
+        return false;
+
+    return HashFileContent( m_libraryPath, hash ) && hash == m_fileHash;
+}
+
+
+std::string SYMBOL_LIB_INDEX::ReadSymbol( const LIB_SYMBOL_INFO& aSymbol ) const
+{
+    std::string text( aSymbol.m_length, '\0' );
+    wxFFile     file( m_libraryPath, "rb" );
+
+    if( aSymbol.m_length == 0 || !file.IsOpened() || !file.Seek( aSymbol.m_offset )
+            || file.Read( &text[0], aSymbol.m_length ) != aSymbol.m_length )
+    {
+        return std::string();
+    }
+
+    // The symbol must still be there, and end where it used to
+    SCANNER     scanner( text.data(), text.size() );
+    std::string atom;
+
+    if( !scanner.Consume( '(' ) || !scanner.Atom( atom ) || atom != "symbol"
+            || !scanner.Atom( atom ) || FROM_UTF8( atom.c_str() ) != aSymbol.m_name
+            || !scanner.SkipList() || scanner.Offset() != text.size() )
+    {
+        wxLogTrace( traceSchLegacyPlugin, "Symbol \"%s\" not found at its indexed location "
+                    "in \"%s\"", aSymbol.m_name, m_libraryPath );
+
+        return std::string();
+    }
+
+    return text;
+}
+
+
+const LIB_SYMBOL_INFO* SYMBOL_LIB_INDEX::Find( const wxString& aName ) const
+{
+    auto it = m_symbolIndex.find( aName );
+
+    return it != m_symbolIndex.end() ? &m_symbols[it->second] : nullptr;
+}
+
+
+wxString SYMBOL_LIB_INDEX::GetIndexFileName( const wxString& aLibraryPath )
+{
+    return GetLibraryIndexFileName( "symbol-index", aLibraryPath );
+}
+
+
+bool SYMBOL_LIB_INDEX::read( const wxString& aIndexFileName )
+{
+    wxTextFile file( aIndexFileName );
+
+    m_symbols.clear();
+    m_symbolIndex.clear();
+
+    if( !file.Exists() || !file.Open() )
+        return false;
+
+    bool ok = file.GetLineCount() >= 6 && file.GetFirstLine() == SYMBOL_INDEX_FORMAT;
+
+    if( ok )
+    {
+        long     version = 0;
+        long     count = 0;
+
+        m_libraryPath = file.GetNextLine();
+
+        ok = file.GetNextLine().ToLongLong( &m_fileSize )
+                && file.GetNextLine().ToULongLong( &m_fileHash, 16 )
+                && file.GetNextLine().ToLong( &version )
+                && file.GetNextLine().ToLong( &count )
+                && file.GetLineCount() == 6 + (size_t) count * SYMBOL_INDEX_LINES;
+
+        m_fileVersion = (int) version;
+
+        for( long ii = 0; ok && ii < count; ++ii )
+        {
+            LIB_SYMBOL_INFO info;
+            long            pinCount = 0;
+            long            unitCount = 0;
+            long            isPower = 0;
+            unsigned long   offset = 0;
+            unsigned long   length = 0;
+
+            info.m_name = file.GetNextLine();
+            info.m_parent = file.GetNextLine();
+            info.m_description = UnescapeString( file.GetNextLine() );
+            info.m_keywords = UnescapeString( file.GetNextLine() );
+            info.m_footprint = UnescapeString( file.GetNextLine() );
+            info.m_fpFilters = UnescapeString( file.GetNextLine() );
+
+            ok = file.GetNextLine().ToLong( &pinCount )
+                    && file.GetNextLine().ToLong( &unitCount )
+                    && file.GetNextLine().ToLong( &isPower )
+                    && file.GetNextLine().ToULong( &offset )
+                    && file.GetNextLine().ToULong( &length );
+
+            info.m_pinCount = (int) pinCount;
+            info.m_unitCount = (int) unitCount;
+            info.m_isPower = isPower != 0;
+            info.m_offset = offset;
+            info.m_length = length;
+
+            m_symbolIndex[info.m_name] = m_symbols.size();
+            m_symbols.push_back( info );
+        }
+    }
+
+    file.Close();
+
+    if( !ok )
+    {
+        m_symbols.clear();
+        m_symbolIndex.clear();
+    }
+
+    return ok;
+}
+
+
+void SYMBOL_LIB_INDEX::write( const wxString& aIndexFileName ) const
+{
+    wxString content;
+
+    content << SYMBOL_INDEX_FORMAT << '\n';
+    content << m_libraryPath << '\n';
+    content << wxString::Format( "%lld\n", m_fileSize );
+    content << wxString::Format( "%016llx\n", m_fileHash );
+    content << wxString::Format( "%d\n", m_fileVersion );
+    content << wxString::Format( "%lu\n", (unsigned long) m_symbols.size() );
+
+    for( const LIB_SYMBOL_INFO& info : m_symbols )
+    {
+        content << info.m_name << '\n';
+        content << info.m_parent << '\n';
+        content << EscapeString( info.m_description, CTX_LINE ) << '\n';
+        content << EscapeString( info.m_keywords, CTX_LINE ) << '\n';
+        content << EscapeString( info.m_footprint, CTX_LINE ) << '\n';
+        content << EscapeString( info.m_fpFilters, CTX_LINE ) << '\n';
+        content << wxString::Format( "%d\n", info.m_pinCount );
+        content << wxString::Format( "%d\n", info.m_unitCount );
+        content << ( info.m_isPower ? "1\n" : "0\n" );
+        content << wxString::Format( "%lu\n", (unsigned long) info.m_offset );
+        content << wxString::Format( "%lu\n", (unsigned long) info.m_length );
+    }
+
+    WriteFileAtomically( aIndexFileName,
+                         [&]( wxFFile& aFile )
+                         {
+                             return aFile.Write( content, wxConvUTF8 );
+                         } );
+}
@@ -0,0 +1,168 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file symbol_lib_index.h
+ * Lightweight index of the symbols of a s-expression symbol library file.
+ */
+
+#ifndef SYMBOL_LIB_INDEX_H
+#define SYMBOL_LIB_INDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <lib_tree_item.h>
+
+class LIB_PART;
+
+
+/**
+ * What the symbol chooser needs to know about a symbol, without the symbol itself.
+ *
+ * Symbols from s-expression libraries also know where they are stored in their library
+ * file, so they can be parsed on their own when they are actually needed.
+ */
+class LIB_SYMBOL_INFO : public LIB_TREE_ITEM
+{
+public:
+    LIB_SYMBOL_INFO() :
+            m_pinCount( 0 ),
+            m_unitCount( 1 ),
+            m_isPower( false ),
+            m_offset( 0 ),
+            m_length( 0 )
+    {
+    }
+
+    /**
+     * Describes a symbol which is already loaded.
+     */
+    explicit LIB_SYMBOL_INFO( LIB_PART& aPart );
+
+    LIB_ID GetLibId() const override { return LIB_ID( m_nickname, m_name ); }
+
+    wxString GetName() const override { return m_name; }
+
+    wxString GetLibNickname() const override { return m_nickname; }
+
+    wxString GetDescription() override { return m_description; }
+
+    /**
+     * Same as LIB_PART::GetSearchText(), so the matches are scored the same way.
+     */
+    wxString GetSearchText() override;
+
+    bool IsRoot() const override { return m_parent.IsEmpty(); }
+
+    int GetUnitCount() const override { return m_unitCount; }
+
+    wxString GetUnitReference( int aUnit ) override;
+
+    wxString m_nickname;
+    wxString m_name;
+    wxString m_parent;          ///< Name of the symbol this one extends, if any
+    wxString m_description;
+    wxString m_keywords;
+    wxString m_footprint;
+    wxString m_fpFilters;       ///< Space separated footprint filters
+    int      m_pinCount;        ///< Pins of the normal body style
+    int      m_unitCount;
+    bool     m_isPower;
+
+    size_t   m_offset;          ///< Offset of the symbol in the library file, in bytes
+    size_t   m_length;          ///< Length of the symbol in the library file, in bytes
+};
+
+
+/**
+ * SYMBOL_LIB_INDEX
+ *
+ * Lists the symbols of a .kicad_sym file and where each of them is stored in the file.
+ *
+ * The index is built by scanning the file for its top level symbols, which is much faster
+ * than parsing them.  It is then saved in the user settings folder and reused until the
+ * content of the library file changes (size or content hash).
+ */
+class SYMBOL_LIB_INDEX
+{
+public:
+    SYMBOL_LIB_INDEX();
+
+    /**
+     * Function Load
+     * reads the saved index of \a aLibraryPath, or builds and saves it if it is missing or
+     * out of date.
+     *
+     * @return true on success, false if the file is not a s-expression symbol library that
+     * could be indexed.  The library has to be parsed as a whole in this case.
+     */
+    bool Load( const wxString& aLibraryPath );
+
+    /**
+     * Function Build
+     * scans \a aLibraryPath and fills the index, without reading or writing the saved index.
+     */
+    bool Build( const wxString& aLibraryPath );
+
+    /**
+     * Function IsUpToDate
+     * @return true if the library file hasn't been changed since the index was built.  The
+     * whole file is hashed: modification times are not reliable enough (coarse on some file
+     * systems, kept by copies and by version control tools).
+     */
+    bool IsUpToDate() const;
+
+    /**
+     * Function ReadSymbol
+     * @return the text of symbol \a aSymbol in the library file, or an empty string if the
+     * file doesn't match the index any longer: the text must be a whole symbol list with the
+     * name of \a aSymbol.
+     */
+    std::string ReadSymbol( const LIB_SYMBOL_INFO& aSymbol ) const;
+
+    const LIB_SYMBOL_INFO* Find( const wxString& aName ) const;
+
+    const std::vector<LIB_SYMBOL_INFO>& GetSymbols() const { return m_symbols; }
+
+    int GetFileVersion() const { return m_fileVersion; }
+
+    /**
+     * @return the name of the file the index of \a aLibraryPath is saved to.
+     */
+    static wxString GetIndexFileName( const wxString& aLibraryPath );
+
+private:
+    bool read( const wxString& aIndexFileName );
+    void write( const wxString& aIndexFileName ) const;
+
+    wxString                     m_libraryPath;
+    long long                    m_fileSize;
+    unsigned long long           m_fileHash;        ///< HashContent() of the library file
+    int                          m_fileVersion;
+    std::vector<LIB_SYMBOL_INFO> m_symbols;         ///< In file order, parents first
+    std::map<wxString, size_t>   m_symbolIndex;     ///< Symbol names to m_symbols indices
+};
+
+#endif  // SYMBOL_LIB_INDEX_H
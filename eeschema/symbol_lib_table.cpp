@@ -351,6 +351,32 @@ void SYMBOL_LIB_TABLE::LoadSymbolLib( std::vector<LIB_PART*>& aSymbolList,
 }
 
 
+void SYMBOL_LIB_TABLE::LoadSymbolInfo( std::vector<LIB_SYMBOL_INFO>& aSymbolList,
+                                       const wxString& aNickname, bool aPowerSymbolsOnly )
+{
+    SYMBOL_LIB_TABLE_ROW* row = FindRow( aNickname );
+    wxCHECK( row && row->plugin, /* void */  );
+
+    wxString options = row->GetOptions();
+    size_t   first = aSymbolList.size();
+
+    if( aPowerSymbolsOnly )
+        row->SetOptions( row->GetOptions() + " " + PropPowerSymsOnly );
+
+    row->SetLoaded( false );
+    row->plugin->EnumerateSymbolInfo( aSymbolList, row->GetFullURI( true ),
+                                      row->GetProperties() );
+    row->SetLoaded( true );
+
+    if( aPowerSymbolsOnly )
+        row->SetOptions( options );
+
+    // Same as LoadSymbolLib(): only this layer knows the actual library nickname.
+    for( size_t ii = first; ii < aSymbolList.size(); ++ii )
+        aSymbolList[ii].m_nickname = row->GetNickName();
+}
+
+
 LIB_PART* SYMBOL_LIB_TABLE::LoadSymbol( const wxString& aNickname, const wxString& aSymbolName )
 {
     SYMBOL_LIB_TABLE_ROW* row = FindRow( aNickname );
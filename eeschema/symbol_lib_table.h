@@ -29,6 +29,7 @@
 #include <sch_io_mgr.h>
 #include <lib_id.h>
 #include <class_libentry.h>
+#include <symbol_lib_index.h>
 
 //class LIB_PART;
 class SYMBOL_LIB_TABLE_GRID;
@@ -82,6 +83,14 @@ public:
      */
     bool Refresh();
 
+    /**
+     * Return the plugin reading this library, which caches it.
+     *
+     * The plugin is created by SYMBOL_LIB_TABLE::FindRow().  It is not thread-safe, but the
+     * plugins of different rows can be used from different threads.
+     */
+    SCH_PLUGIN* GetPlugin() const { return plugin; }
+
 protected:
     SYMBOL_LIB_TABLE_ROW( const SYMBOL_LIB_TABLE_ROW& aRow ) :
         LIB_TABLE_ROW( aRow ),
@@ -168,6 +177,19 @@ public:
     void LoadSymbolLib( std::vector<LIB_PART*>& aAliasList, const wxString& aNickname,
                         bool aPowerSymbolsOnly = false );
 
+    /**
+     * Return the descriptions of the symbols of the library given by @a aNickname, without
+     * loading the symbols themselves if the library can be indexed.
+     *
+     * @param aSymbolList is a reference to an array for the symbol descriptions.
+     * @param aNickname is a locator for the "library", it is a "name" in LIB_TABLE_ROW.
+     * @param aPowerSymbolsOnly is a flag to enumerate only power symbols.
+     *
+     * @throw IO_ERROR if the library cannot be found or loaded.
+     */
+    void LoadSymbolInfo( std::vector<LIB_SYMBOL_INFO>& aSymbolList, const wxString& aNickname,
+                         bool aPowerSymbolsOnly = false );
+
     /**
      * Load a #LIB_PART having @a aName from the library given by @a aNickname.
      *
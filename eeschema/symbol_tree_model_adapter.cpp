@@ -19,12 +19,19 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include <wx/tokenzr.h>
 #include <wx/window.h>
-#include <widgets/app_progress_dialog.h>
+#include <widgets/progress_reporter.h>
 
+#include <common.h>
 #include <eda_pattern_match.h>
+#include <properties.h>
 #include <symbol_lib_table.h>
+#include <template_fieldnames.h>
 #include <class_libentry.h>
 #include <generate_alias_info.h>
 
@@ -33,9 +40,6 @@
 
 bool SYMBOL_TREE_MODEL_ADAPTER::m_show_progress = true;
 
-#define PROGRESS_INTERVAL_MILLIS 66
-
-
 SYMBOL_TREE_MODEL_ADAPTER::PTR SYMBOL_TREE_MODEL_ADAPTER::Create( EDA_BASE_FRAME* aParent,
                                                                   LIB_TABLE* aLibs )
 {
@@ -56,49 +60,180 @@ SYMBOL_TREE_MODEL_ADAPTER::~SYMBOL_TREE_MODEL_ADAPTER()
 void SYMBOL_TREE_MODEL_ADAPTER::AddLibraries( const std::vector<wxString>& aNicknames,
                                               wxWindow* aParent )
 {
-    APP_PROGRESS_DIALOG* prg = nullptr;
-    wxLongLong        nextUpdate = wxGetUTCTimeMillis() + (PROGRESS_INTERVAL_MILLIS / 2);
+    // A library to load.  The library table isn't thread-safe, so everything the loaders
+    // need from it is read beforehand, including the row plugins FindRow() creates.
+    struct LIBRARY
+    {
+        SYMBOL_LIB_TABLE_ROW*        m_row = nullptr;
+        wxString                     m_uri;
+        PROPERTIES                   m_properties;
+        std::vector<LIB_SYMBOL_INFO> m_symbols;
+        wxString                     m_error;
+        bool                         m_loaded = false;
+    };
+
+    bool                 onlyPowerSymbols = ( GetFilter() == CMP_FILTER_POWER );
+    std::vector<LIBRARY> libraries( aNicknames.size() );
+
+    for( size_t ii = 0; ii < aNicknames.size(); ++ii )
+    {
+        LIBRARY& library = libraries[ii];
+
+        try
+        {
+            library.m_row = m_libs->FindRow( aNicknames[ii] );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            library.m_error = ioe.What();
+            continue;
+        }
+
+        if( !library.m_row )
+            continue;
+
+        library.m_uri = library.m_row->GetFullURI( true );
+
+        if( library.m_row->GetProperties() )
+            library.m_properties = *library.m_row->GetProperties();
+
+        if( onlyPowerSymbols )
+            library.m_properties[ SYMBOL_LIB_TABLE::PropPowerSymsOnly ] = "";
+    }
+
+    std::unique_ptr<WX_PROGRESS_REPORTER> progressReporter;
 
     if( m_show_progress )
     {
-        prg = new APP_PROGRESS_DIALOG( _( "Loading Symbol Libraries" ), wxEmptyString,
-                                       aNicknames.size(), aParent );
+        progressReporter = std::make_unique<WX_PROGRESS_REPORTER>( aParent,
+                _( "Loading Symbol Libraries" ), 1 );
+        progressReporter->SetMaxProgress( (int) libraries.size() );
+        progressReporter->Report( _( "Loading symbol libraries..." ) );
+    }
+
+    std::atomic<size_t> nextLibrary( 0 );
+    std::atomic<size_t> librariesDone( 0 );
+    std::atomic<bool>   cancelled( false );
+
+    // The locale is global: switch it once for all the loaders, and keep the main thread
+    // waiting until they are done (see FOOTPRINT_LIST_IMPL::JoinWorkers())
+    LOCALE_IO toggle;
+
+    // The default field names are translated and cached on first use, without a lock: fill
+    // the cache before the loaders create the symbol fields
+    TEMPLATE_FIELDNAME::GetDefaultFieldName( REFERENCE );
+
+    auto loader =
+            [&]()
+            {
+                for( size_t ii = nextLibrary++; ii < libraries.size() && !cancelled;
+                     ii = nextLibrary++ )
+                {
+                    LIBRARY& library = libraries[ii];
+
+                    if( library.m_row && library.m_error.IsEmpty() )
+                    {
+                        try
+                        {
+                            // Each library has its own plugin, which cannot be shared
+                            // between threads.  Reading through the row's plugin leaves its
+                            // cache ready for the symbols previewed or placed later.
+                            SCH_PLUGIN* pi = library.m_row->GetPlugin();
+
+                            if( pi )
+                            {
+                                pi->EnumerateSymbolInfo( library.m_symbols, library.m_uri,
+                                                         &library.m_properties );
+                                library.m_loaded = true;
+                            }
+                        }
+                        catch( const IO_ERROR& ioe )
+                        {
+                            library.m_error = ioe.What();
+                        }
+                        catch( const std::exception& e )
+                        {
+                            library.m_error = FROM_UTF8( e.what() );
+                        }
+                    }
+
+                    if( progressReporter )
+                        progressReporter->AdvanceProgress();
+
+                    librariesDone++;
+                }
+            };
+
+    size_t threadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                           libraries.size() );
+    std::vector<std::thread> threads;
+
+    for( size_t ii = 0; ii < std::max<size_t>( threadCount, 1 ); ++ii )
+        threads.emplace_back( loader );
+
+    while( !cancelled && librariesDone < libraries.size() )
+    {
+        if( progressReporter && !progressReporter->KeepRefreshing() )
+            cancelled = true;
+
+        wxMilliSleep( 20 );
     }
 
-    unsigned int ii = 0;
+    for( std::thread& thread : threads )
+        thread.join();
 
-    for( const auto& nickname : aNicknames )
+    // Libraries are added in the table order, whatever order they were loaded in
+    for( size_t ii = 0; ii < libraries.size(); ++ii )
     {
-        if( prg && wxGetUTCTimeMillis() > nextUpdate )
+        LIBRARY& library = libraries[ii];
+
+        if( !library.m_error.IsEmpty() )
         {
-            prg->Update( ii, wxString::Format( _( "Loading library \"%s\"" ), nickname ) );
+            wxLogError( wxString::Format( _( "Error loading symbol library %s.\n\n%s" ),
+                                          aNicknames[ii],
+                                          library.m_error ) );
+            continue;
+        }
+
+        if( !library.m_loaded )
+            continue;
+
+        library.m_row->SetLoaded( true );
+
+        if( library.m_symbols.empty() )
+            continue;
 
-            nextUpdate = wxGetUTCTimeMillis() + PROGRESS_INTERVAL_MILLIS;
+        std::vector<LIB_TREE_ITEM*> comp_list;
+
+        // Only the library table knows the actual library nickname
+        for( LIB_SYMBOL_INFO& symbol : library.m_symbols )
+        {
+            symbol.m_nickname = aNicknames[ii];
+            comp_list.push_back( &symbol );
         }
 
-        AddLibrary( nickname );
-        ii++;
+        DoAddLibrary( aNicknames[ii], m_libs->GetDescription( aNicknames[ii] ), comp_list,
+                      false );
     }
 
     m_tree.AssignIntrinsicRanks();
 
-    if( prg )
-    {
-        prg->Destroy();
+    if( progressReporter )
         m_show_progress = false;
-    }
 }
 
 
 void SYMBOL_TREE_MODEL_ADAPTER::AddLibrary( wxString const& aLibNickname )
 {
-    bool                        onlyPowerSymbols = ( GetFilter() == CMP_FILTER_POWER );
-    std::vector<LIB_PART*>      symbols;
-    std::vector<LIB_TREE_ITEM*> comp_list;
+    bool                         onlyPowerSymbols = ( GetFilter() == CMP_FILTER_POWER );
+    std::vector<LIB_SYMBOL_INFO> symbols;
+    std::vector<LIB_TREE_ITEM*>  comp_list;
 
+    // The tree only needs the symbol descriptions: the symbols themselves are loaded when
+    // they are previewed or placed
     try
     {
-        m_libs->LoadSymbolLib( symbols, aLibNickname, onlyPowerSymbols );
+        m_libs->LoadSymbolInfo( symbols, aLibNickname, onlyPowerSymbols );
     }
     catch( const IO_ERROR& ioe )
     {
@@ -110,7 +245,9 @@ void SYMBOL_TREE_MODEL_ADAPTER::AddLibrary( wxString const& aLibNickname )
 
     if( symbols.size() > 0 )
     {
-        comp_list.assign( symbols.begin(), symbols.end() );
+        for( LIB_SYMBOL_INFO& symbol : symbols )
+            comp_list.push_back( &symbol );
+
         DoAddLibrary( aLibNickname, m_libs->GetDescription( aLibNickname ), comp_list, false );
     }
 }
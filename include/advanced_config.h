@@ -142,6 +142,18 @@ public:
      */
     bool m_DebugZoneFiller;
 
+    /**
+     * Keep a binary snapshot of each loaded board next to its file, to load it faster the
+     * next times while the file is unchanged.
+     */
+    bool m_BoardSnapshots;
+
+    /**
+     * Directory receiving a trace of the instrumented code (@see TRACE_PROFILER) of each
+     * module, written when the module ends.  Tracing is disabled when empty.
+     */
+    wxString m_TraceProfilerPath;
+
 private:
     ADVANCED_CFG();
 
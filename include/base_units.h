@@ -215,6 +215,24 @@ wxString GetAbbreviatedUnitsLabel( EDA_UNITS aUnit, bool aUseMils = false,
  */
 std::string FormatInternalUnits( int aValue );
 
+/**
+ * Function FormatInternalUnits
+ * writes the same text as FormatInternalUnits( int ) to \a aBuf, without any allocation.
+ *
+ * @param aBuf is the destination, at least 16 characters long.  The text is nul terminated.
+ * @return the length of the text.
+ */
+int FormatInternalUnits( int aValue, char* aBuf );
+
+/**
+ * Function FormatInternalUnits
+ * writes the coordinates \a aX and \a aY, separated by a space, to \a aBuf.
+ *
+ * @param aBuf is the destination, at least 32 characters long.  The text is nul terminated.
+ * @return the length of the text.
+ */
+int FormatInternalUnits( int aX, int aY, char* aBuf );
+
 /**
  * Function FormatAngle
  * converts \a aAngle from board units to a string appropriate for writing to file.
@@ -0,0 +1,87 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file cache_file.h
+ * Helpers for the files KiCad writes to avoid work on the next run (library indexes, board
+ * snapshots, 3D model caches), which can be read by other threads or instances at any time.
+ */
+
+#ifndef CACHE_FILE_H_
+#define CACHE_FILE_H_
+
+#include <cstddef>
+#include <functional>
+#include <wx/string.h>
+
+class wxFFile;
+
+
+/**
+ * Function WriteFileAtomically
+ * writes a file under a temporary name in its folder, and renames it once complete, so
+ * another thread or instance never reads a partial file.  The folder is created if needed.
+ *
+ * @param aFileName is the full path of the file.
+ * @param aWriter writes the content to the temporary file, opened in binary mode, and
+ * returns false if it fails.
+ * @return true if the file was written.
+ */
+bool WriteFileAtomically( const wxString& aFileName,
+                          const std::function<bool( wxFFile& aFile )>& aWriter );
+
+/**
+ * Function GetLibraryIndexFileName
+ * returns the path of the index file of a library, in the \a aIndexDir folder of the user
+ * settings (@see SetLibraryIndexRoot()).  Libraries with the same name in different folders
+ * get different files.
+ *
+ * @param aLibraryPath is the full path of the library file or folder.
+ * @param aExtension is the extension of the index file.
+ */
+wxString GetLibraryIndexFileName( const wxString& aIndexDir, const wxString& aLibraryPath,
+                                  const wxString& aExtension = wxT( "idx" ) );
+
+/**
+ * Function SetLibraryIndexRoot
+ * moves the index folders of GetLibraryIndexFileName() to \a aRoot, or back to the user
+ * settings if it is empty.  Used by the unit tests, which must not write in the user settings.
+ */
+void SetLibraryIndexRoot( const wxString& aRoot );
+
+/**
+ * Function HashContent
+ * returns a 64 bit FNV-1a hash of \a aSize bytes at \a aData, to find out if the content
+ * a cache file was made from has changed.  Not suitable against deliberate collisions.
+ */
+unsigned long long HashContent( const char* aData, size_t aSize );
+
+/**
+ * Function HashFileContent
+ * computes HashContent() of the whole content of \a aFileName.
+ *
+ * @return false if the file cannot be read.
+ */
+bool HashFileContent( const wxString& aFileName, unsigned long long& aHash );
+
+#endif  // CACHE_FILE_H_
@@ -212,6 +212,12 @@ enum class EDA_UNITS
  * The constructor sets a "C" language locale option, to read/print files with floating
  * point  numbers.  The destructor insures that the default locale is restored if an
  * exception is thrown or not.
+ *
+ * The locale is global: the first LOCALE_IO switches it and the last one destroyed restores
+ * it, whichever threads they are in.  A LOCALE_IO constructed while another thread switches
+ * the locale waits for the switch to be done.  Since wxWidgets expects the locale to be
+ * changed by the main thread, code parsing in several threads should construct a LOCALE_IO
+ * before starting them.
  */
 class LOCALE_IO
 {
@@ -220,13 +226,13 @@ public:
     ~LOCALE_IO();
 
 private:
-    // allow for nesting of LOCALE_IO instantiations
-    static std::atomic<unsigned int> m_c_count;
+    // allow for nesting of LOCALE_IO instantiations, guarded by a mutex
+    static unsigned int m_c_count;
 
     // The locale in use before switching to the "C" locale
     // (the locale can be set by user, and is not always the system locale)
-    std::string m_user_locale;
-    wxLocale*   m_wxLocale;
+    static std::string m_user_locale;
+    static wxLocale*   m_wxLocale;
 };
 
 /**
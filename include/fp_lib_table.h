@@ -154,6 +154,16 @@ public:
     void FootprintEnumerate( wxArrayString& aFootprintNames, const wxString& aNickname,
                              bool aBestEfforts );
 
+    /**
+     * Function FootprintEnumerateInfo
+     * returns the footprints of the library given by @a aNickname with their description,
+     * keywords and pad counts, as #PLUGIN::FootprintEnumerateInfo().
+     *
+     * @throw IO_ERROR if the library cannot be found, or footprint cannot be loaded.
+     */
+    void FootprintEnumerateInfo( std::vector<FOOTPRINT_INDEX_ENTRY>& aFootprints,
+                                 const wxString& aNickname, bool aBestEfforts );
+
     /**
      * Generate a hashed timestamp representing the last-mod-times of the library indicated
      * by \a aNickname, or all libraries if \a aNickname is NULL.
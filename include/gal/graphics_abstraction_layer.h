@@ -115,6 +115,16 @@ public:
     virtual void DrawPolyline( const VECTOR2D aPointList[], int aListSize ) {};
     virtual void DrawPolyline( const SHAPE_LINE_CHAIN& aLineChain ) {};
 
+    /**
+     * @brief Draw a set of polylines sharing the current stroke attributes in a single call.
+     *
+     * Backends may override it to batch the whole set (e.g. a complete stroke font text)
+     * instead of issuing one DrawPolyline() per list.
+     *
+     * @param aPointLists is the list of polylines to draw.
+     */
+    virtual void DrawPolylines( const std::vector<std::vector<VECTOR2D>>& aPointLists );
+
     /**
      * @brief Draw a circle using world coordinates.
      *
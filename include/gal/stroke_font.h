@@ -31,6 +31,7 @@
 
 #include <deque>
 #include <algorithm>
+#include <memory>
 
 #include <utf8.h>
 
@@ -45,6 +46,18 @@ class GAL;
 typedef std::vector<std::vector<VECTOR2D>*> GLYPH;
 typedef std::vector<GLYPH*>                 GLYPH_LIST;
 
+/**
+ * Geometry of a complete text drawn with the stroke font.
+ *
+ * Glyph strokes and overbars are already scaled, italicized, mirrored and justified, and
+ * are expressed in the text frame, i.e. before the text position and rotation are applied.
+ */
+struct STROKE_TEXT_GEOMETRY
+{
+    std::vector<std::vector<VECTOR2D>>          m_strokes;      ///< Glyph polylines
+    std::vector<std::pair<VECTOR2D, VECTOR2D>>  m_overbars;     ///< Overbar segments
+};
+
 /**
  * @brief Class STROKE_FONT implements stroke font drawing.
  *
@@ -111,7 +124,11 @@ public:
      */
     static double GetInterline( double aGlyphHeight );
 
-
+    /**
+     * Drop all the cached text geometries.
+     * The cache is shared by all the STROKE_FONT instances (and thus by all the painters).
+     */
+    static void ClearTextCache();
 
 private:
     GAL*                      m_gal;                  ///< Pointer to the GAL
@@ -144,12 +161,31 @@ private:
     BOX2D computeBoundingBox( const GLYPH* aGlyph, double aGlyphWidth ) const;
 
     /**
-     * @brief Draws a single line of text. Multiline texts should be split before using the
-     * function.
+     * @brief Returns the geometry of a text drawn with the current GAL text attributes, either
+     * from the shared text cache or freshly computed (and then stored in the cache).
+     *
+     * @param aText is the text to be drawn (can be a multiline text).
+     */
+    std::shared_ptr<const STROKE_TEXT_GEOMETRY> getTextGeometry( const UTF8& aText ) const;
+
+    /**
+     * @brief Computes the geometry of a complete (possibly multiline) text.
+     *
+     * @param aText is the text to be drawn.
+     * @param aGeometry is the container receiving the strokes and overbars.
+     */
+    void buildTextGeometry( const UTF8& aText, STROKE_TEXT_GEOMETRY& aGeometry ) const;
+
+    /**
+     * @brief Computes the geometry of a single line of text. Multiline texts should be split
+     * before using the function.
      *
      * @param aText is the text to be drawn.
+     * @param aOffset is the position of the line origin in the text frame.
+     * @param aGeometry is the container receiving the strokes and overbars.
      */
-    void drawSingleLineText( const UTF8& aText );
+    void buildSingleLineText( const UTF8& aText, const VECTOR2D& aOffset,
+                              STROKE_TEXT_GEOMETRY& aGeometry ) const;
 
     /**
      * @brief Returns number of lines for a given text.
@@ -133,6 +133,7 @@ class PGM_BASE;
 class KIWAY;
 class KIWAY_PLAYER;
 class wxTopLevelWindow;
+class KIWAY_MAIL_OBJECT;
 
 
 /**
@@ -356,10 +357,12 @@ public:
      * Function ExpressMail
      * send aPayload to aDestination from aSource.  Recipient receives this in its
      * KIWAY_PLAYER::KiwayMailIn() function and can efficiently switch() based on
-     * aCommand in there.
+     * aCommand in there.  aMailObject is an optional object going along with the
+     * payload, see KIWAY_MAIL_OBJECT.
      */
     VTBL_ENTRY void ExpressMail( FRAME_T aDestination, MAIL_T aCommand,
-                                 std::string& aPayload, wxWindow* aSource = NULL );
+                                 std::string& aPayload, wxWindow* aSource = NULL,
+                                 KIWAY_MAIL_OBJECT* aMailObject = NULL );
 
     /**
      * Function Prj
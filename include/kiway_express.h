@@ -32,6 +32,20 @@
 #include <mail_type.h>
 
 
+/**
+ * KIWAY_MAIL_OBJECT
+ * is the base of the objects a KIWAY_EXPRESS can carry along with its payload, for data
+ * which would be costly to exchange as text.  The type of the object is given by the mail
+ * command.  The object belongs to the sender and, as mails are delivered synchronously,
+ * lives until KIWAY::ExpressMail() returns.
+ */
+class KIWAY_MAIL_OBJECT
+{
+public:
+    virtual ~KIWAY_MAIL_OBJECT() {}
+};
+
+
 /**
  * KIWAY_EXPRESS
  * carries a payload from one KIWAY_PLAYER to another within a PROJECT.
@@ -62,12 +76,18 @@ public:
     std::string&  GetPayload()                          { return m_payload; }
     void SetPayload( const std::string& aPayload )      { m_payload = aPayload; }
 
+    /**
+     * Function GetMailObject
+     * returns the object attached to the mail by the sender, or NULL.
+     */
+    KIWAY_MAIL_OBJECT* GetMailObject()                  { return m_mailObject; }
+
     KIWAY_EXPRESS* Clone() const override   { return new KIWAY_EXPRESS( *this ); }
 
     //KIWAY_EXPRESS() {}
 
     KIWAY_EXPRESS( FRAME_T aDestination, MAIL_T aCommand, std::string& aPayload,
-                   wxWindow* aSource = NULL );
+                   wxWindow* aSource = NULL, KIWAY_MAIL_OBJECT* aMailObject = NULL );
 
     KIWAY_EXPRESS( const KIWAY_EXPRESS& anOther );
 
@@ -81,6 +101,7 @@ public:
 private:
     FRAME_T         m_destination;      ///< could have been a bitmap indicating multiple recipients
     std::string&    m_payload;          ///< very often s-expression text, but not always
+    KIWAY_MAIL_OBJECT* m_mailObject;    ///< owned by the sender, can be NULL
 
     // possible new ideas here.
 };
@@ -0,0 +1,81 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file mapped_file.h
+ * Private, copy-on-write memory mapping of a whole file.
+ */
+
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <wx/string.h>
+
+
+/**
+ * MAPPED_FILE
+ * maps the content of a file in the address space of the process.
+ *
+ * The mapping is private (copy-on-write): the pages are shared with the OS file cache until
+ * they are written to, and writes are never carried back to the file.
+ */
+class MAPPED_FILE
+{
+public:
+    MAPPED_FILE();
+    ~MAPPED_FILE();
+
+    MAPPED_FILE( const MAPPED_FILE& ) = delete;
+    MAPPED_FILE& operator=( const MAPPED_FILE& ) = delete;
+
+    /**
+     * Function Open
+     * maps the whole content of \a aFileName, releasing any previous mapping.
+     *
+     * @return true on success; empty files cannot be mapped.
+     */
+    bool Open( const wxString& aFileName );
+
+    /**
+     * Function Close
+     * releases the mapping. The pointers obtained from Data() are no longer valid.
+     */
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr; }
+
+    char* Data() const { return m_data; }
+
+    size_t Size() const { return m_size; }
+
+private:
+    char*  m_data;
+    size_t m_size;
+
+#ifdef _WIN32
+    void*  m_mapping;       ///< HANDLE of the file mapping object
+#endif
+};
+
+#endif  // MAPPED_FILE_H_
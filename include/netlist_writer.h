@@ -0,0 +1,82 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file netlist_writer.h
+ * Receiver of the elements of a generic netlist, as they are produced by Eeschema.
+ */
+
+#ifndef NETLIST_WRITER_H
+#define NETLIST_WRITER_H
+
+#include <kiway_express.h>
+#include <wx/string.h>
+
+
+/**
+ * NETLIST_WRITER
+ *
+ * Receives the generic netlist document (export, design, components, libparts, libraries
+ * and nets) one element at a time, in document order.  The netlist exporters use it to
+ * write the netlist without building the whole document tree first.
+ *
+ * The attributes of an element are always given before its text and its child elements.
+ *
+ * The class only has inline members, so an object from one kiface can be filled by
+ * another one: Pcbnew attaches its own writer to MAIL_SCH_GET_NETLIST to get the netlist
+ * without formatting and parsing it.
+ */
+class NETLIST_WRITER : public KIWAY_MAIL_OBJECT
+{
+public:
+    virtual ~NETLIST_WRITER() {}
+
+    /**
+     * Starts a child element of the current element, or the root element.
+     */
+    virtual void Open( const char* aName ) = 0;
+
+    virtual void Attribute( const char* aName, const wxString& aValue ) = 0;
+
+    /**
+     * Adds a text to the current element.  Empty texts are ignored.
+     */
+    virtual void Text( const wxString& aText ) = 0;
+
+    /**
+     * Ends the current element.
+     */
+    virtual void Close() = 0;
+
+    /**
+     * Writes an element holding only a text.
+     */
+    void Leaf( const char* aName, const wxString& aText )
+    {
+        Open( aName );
+        Text( aText );
+        Close();
+    }
+};
+
+#endif  // NETLIST_WRITER_H
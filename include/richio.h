@@ -38,6 +38,7 @@
 #include <wx/wx.h>
 
 #include <ki_exception.h>
+#include <mapped_file.h>
 
 
 /**
@@ -247,6 +248,53 @@ public:
 };
 
 
+/**
+ * MMAP_LINE_READER
+ * is a LINE_READER that maps a whole file in memory and hands out its lines where they
+ * are in the mapping, without copying them.
+ *
+ * The lines are NOT nul terminated: only the Length() bytes of the Line() may be used, as
+ * DSNLEXER does.  Use FILE_LINE_READER for code which needs C strings.
+ */
+class MMAP_LINE_READER : public LINE_READER
+{
+protected:
+    MAPPED_FILE m_file;
+    size_t      m_ndx;      ///< offset of the next line in the mapping
+    char*       m_buffer;   ///< line buffer of the LINE_READER, used at end of file
+
+public:
+
+    /**
+     * Constructor MMAP_LINE_READER
+     * maps @a aFileName, which is also used for error reporting.
+     *
+     * @param aStartingLineNumber is the initial line number to report on error, see
+     *  FILE_LINE_READER.
+     * @param aMaxLineLength is the length of the longest accepted line.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened.
+     */
+    MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MMAP_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Function Rewind
+     * goes back to the beginning of the file and resets the line number back to zero.
+     */
+    void Rewind()
+    {
+        m_ndx = 0;
+        m_lineNum = 0;
+    }
+};
+
+
 /**
  * STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -396,6 +444,26 @@ public:
      */
     int PRINTF_FUNC Print( int nestLevel, const char* fmt, ... );
 
+    /**
+     * Function Append
+     * writes \a aText as it is.  Texts which are already formatted, such as long lists of
+     * coordinates put together in a local buffer, are written much faster than with Print().
+     *
+     * @param aText is the text to write.
+     * @param aCount is the number of bytes of \a aText to write.
+     * @throw IO_ERROR, if there is a problem outputting, such as a full disk.
+     */
+    void Append( const char* aText, int aCount )
+    {
+        if( aCount > 0 )
+            write( aText, aCount );
+    }
+
+    void Append( const std::string& aText )
+    {
+        Append( aText.data(), (int) aText.size() );
+    }
+
     /**
      * Function GetQuoteChar
      * performs quote character need determination.
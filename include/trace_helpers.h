@@ -182,6 +182,13 @@ extern const wxChar* const traceSchSheetPaths;
  */
 extern const wxChar* const traceEnvVars;
 
+/**
+ * Flag to enable debug output of the trace profiler (#TRACE_PROFILER).
+ *
+ * Use "KICAD_TRACE_PROFILER" to enable.
+ */
+extern const wxChar* const traceTraceProfiler;
+
 ///@}
 
 /**
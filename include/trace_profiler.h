@@ -0,0 +1,234 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file trace_profiler.h:
+ * @brief Records the time spent in zones of code by every thread, for offline analysis.
+ */
+
+#ifndef TRACE_PROFILER_H
+#define TRACE_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class wxString;
+
+
+/**
+ * A zone recorded by TRACE_PROFILER: a named span of time of a thread.
+ */
+struct TRACE_EVENT
+{
+    const char* m_name;         ///< Zone name, with static storage duration or interned
+    const char* m_category;     ///< Zone category, with static storage duration
+    int64_t     m_start;        ///< Start time, in ns since the profiler was enabled
+    int64_t     m_duration;     ///< Duration, in ns
+    uint32_t    m_thread;       ///< Thread which ran the zone, numbered from 1
+};
+
+
+/**
+ * The class TRACE_PROFILER collects the zones (@see SCOPED_TRACE_ZONE) run by all the threads
+ * of a module, and exports them to the Chrome trace event format, which is read by
+ * chrome://tracing, Perfetto or Speedscope.
+ *
+ * Every thread records its zones in its own ring buffer, which keeps the latest RING_SIZE
+ * zones of the thread.  Nothing is recorded, nor allocated, until the profiler is enabled,
+ * and a disabled zone costs a relaxed atomic load.
+ *
+ * Modules (kifaces) have their own profiler.  It is enabled when they start if the
+ * "TraceProfilerPath" advanced config setting is set, and its trace is written in that
+ * directory when they end.
+ */
+class TRACE_PROFILER
+{
+public:
+    ///> Number of zones kept for each thread
+    static constexpr size_t RING_SIZE = 16384;
+
+    static TRACE_PROFILER& Instance();
+
+    static bool IsEnabled()
+    {
+        return s_enabled.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * Starts or stops recording.  Starting discards the zones already recorded, and
+     * restarts the time of the trace.
+     */
+    void Enable( bool aEnable );
+
+    ///> Returns the time in ns since the profiler was enabled
+    int64_t Timestamp() const;
+
+    /**
+     * Records a zone of the calling thread.
+     * @param aName and @param aCategory have to last as long as the profiler, see Intern().
+     */
+    void Record( const char* aName, const char* aCategory, int64_t aStart, int64_t aDuration );
+
+    ///> Returns a copy of \a aName lasting as long as the profiler, for names built at run time
+    const char* Intern( const std::string& aName );
+
+    ///> Discards the recorded zones
+    void Clear();
+
+    ///> Returns the recorded zones of all the threads, sorted by start time
+    std::vector<TRACE_EVENT> GetEvents() const;
+
+    /**
+     * Writes the recorded zones as a Chrome trace event JSON document.
+     * @param aProcessName names the process in the trace viewers.
+     */
+    void ExportChromeTrace( std::ostream& aStream, const std::string& aProcessName ) const;
+
+    /**
+     * Writes the recorded zones as a Chrome trace event JSON file.
+     * @return false if the file cannot be written.
+     */
+    bool ExportChromeTrace( const wxString& aFileName, const std::string& aProcessName ) const;
+
+private:
+    TRACE_PROFILER();
+
+    ///> Ring buffer of a thread.  Buffers of finished threads are reused by new threads.
+    struct THREAD_BUFFER
+    {
+        THREAD_BUFFER() :
+                m_thread( 0 ),
+                m_count( 0 ),
+                m_retired( false )
+        {
+        }
+
+        ///> Only contended by the threads reading the trace
+        mutable std::mutex       m_mutex;
+        uint32_t                 m_thread;
+        std::vector<TRACE_EVENT> m_events;      ///< Allocated by the first recorded zone
+        uint64_t                 m_count;       ///< Number of zones ever recorded
+        std::atomic<bool>        m_retired;     ///< Set when the thread has finished
+    };
+
+    ///> Returns the buffer of the calling thread
+    THREAD_BUFFER& threadBuffer();
+
+    static std::atomic<bool> s_enabled;
+
+    ///> Time the profiler was enabled, in steady clock ns
+    std::atomic<int64_t> m_epoch;
+
+    std::atomic<uint32_t> m_nextThread;
+
+    ///> Guards the buffer list and the interned names
+    mutable std::mutex m_mutex;
+
+    std::vector<std::shared_ptr<THREAD_BUFFER>> m_buffers;
+    std::unordered_set<std::string>             m_names;
+};
+
+
+/**
+ * The class SCOPED_TRACE_ZONE records the time spent in its scope with TRACE_PROFILER, when
+ * the profiler is enabled.  Use it through the TRACE_ZONE macro:
+ *
+ * void ZONE_FILLER::Fill()
+ * {
+ *     TRACE_ZONE( "ZONE_FILLER::Fill", "zones" );
+ *     ...
+ * }
+ */
+class SCOPED_TRACE_ZONE
+{
+public:
+    /**
+     * @param aName is the zone name.  It has to be a string literal.
+     * @param aCategory is the zone category (e.g. "drc", "router").  It has to be a string
+     * literal.
+     */
+    SCOPED_TRACE_ZONE( const char* aName, const char* aCategory ) :
+            m_name( aName ),
+            m_category( aCategory ),
+            m_start( -1 )
+    {
+        if( TRACE_PROFILER::IsEnabled() )
+            start();
+    }
+
+    /**
+     * @param aName is the zone name, built at run time (e.g. a DRC provider name).
+     * @param aCategory is the zone category.  It has to be a string literal.
+     */
+    SCOPED_TRACE_ZONE( const std::string& aName, const char* aCategory ) :
+            m_name( nullptr ),
+            m_category( aCategory ),
+            m_start( -1 )
+    {
+        if( TRACE_PROFILER::IsEnabled() )
+        {
+            m_name = TRACE_PROFILER::Instance().Intern( aName );
+            start();
+        }
+    }
+
+    ~SCOPED_TRACE_ZONE()
+    {
+        if( m_start < 0 )
+            return;
+
+        // Both ends of the zone are taken from the same clock, see TRACE_PROFILER::Timestamp()
+        TRACE_PROFILER& profiler = TRACE_PROFILER::Instance();
+
+        profiler.Record( m_name, m_category, m_start, profiler.Timestamp() - m_start );
+    }
+
+    SCOPED_TRACE_ZONE( const SCOPED_TRACE_ZONE& ) = delete;
+    SCOPED_TRACE_ZONE& operator=( const SCOPED_TRACE_ZONE& ) = delete;
+
+private:
+    void start()
+    {
+        m_start = TRACE_PROFILER::Instance().Timestamp();
+    }
+
+    const char* m_name;
+    const char* m_category;
+    int64_t     m_start;        ///< -1 when the profiler was disabled at construction
+};
+
+
+#define TRACE_ZONE_CONCAT_IMPL( a, b ) a##b
+#define TRACE_ZONE_CONCAT( a, b ) TRACE_ZONE_CONCAT_IMPL( a, b )
+
+///> Records the time spent in the current scope, see SCOPED_TRACE_ZONE
+#define TRACE_ZONE( aName, aCategory ) \
+    SCOPED_TRACE_ZONE TRACE_ZONE_CONCAT( traceZone, __LINE__ )( aName, aCategory )
+
+#endif  // TRACE_PROFILER_H
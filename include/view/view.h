@@ -426,6 +426,17 @@ public:
         m_layers[aLayer].target = aTarget;
     }
 
+    /**
+     * Function GetLayerTarget()
+     * Returns the rendering target of a particular layer.
+     * @param aLayer is the layer.
+     */
+    inline RENDER_TARGET GetLayerTarget( int aLayer ) const
+    {
+        wxCHECK( aLayer < (int) m_layers.size(), TARGET_CACHED );
+        return m_layers.at( aLayer ).target;
+    }
+
     /**
      * Function SetLayerOrder()
      * Sets rendering order of a particular layer. Lower values are rendered first.
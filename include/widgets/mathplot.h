@@ -62,6 +62,7 @@
 #define WXDLLIMPEXP_DATA_MATHPLOT( type ) type
 #endif
 
+#include <functional>
 #include <vector>
 
 // #include <wx/wx.h>
@@ -1540,6 +1541,62 @@ protected:
     DECLARE_EVENT_TABLE()
 };
 
+// -----------------------------------------------------------------------------
+// mpMinMaxIndex
+// -----------------------------------------------------------------------------
+
+/** Finds the lowest and highest points of the ranges of a set of points in logarithmic time,
+ *  so mpFXYVector plots only the extremes of the points falling in every pixel column.
+ *  It does not hold the points: they are passed to every method, and must be the ones the
+ *  index was last updated with.
+ */
+class WXDLLIMPEXP_MATHPLOT mpMinMaxIndex
+{
+public:
+    /** Indices of the lowest and highest point of a range of points
+     */
+    struct MINMAX
+    {
+        unsigned int min, max;
+    };
+
+    mpMinMaxIndex() : m_sortedX( true ) {}
+
+    /** Updates the index for the points added from aFirst, or rebuilds it if aFirst is 0.
+     *  Both vectors MUST be of the same length.
+     */
+    void Update( const std::vector<double>& aXs, const std::vector<double>& aYs, size_t aFirst );
+
+    /** Returns true when the X values are sorted in ascending order
+     */
+    bool IsSortedX() const { return m_sortedX; }
+
+    /** Finds the lowest and highest points among the points aFirst to aLast - 1.
+     *  The X values have to be sorted.
+     */
+    MINMAX RangeMinMax( const std::vector<double>& aYs, size_t aFirst, size_t aLast ) const;
+
+    /** Returns in aIndices the lowest and highest point of every pixel column from aStartPx
+     *  to aEndPx, and a point on each side of these columns.  aColumn returns the pixel column
+     *  of a X value.
+     *  Returns false when every point has to be plotted: X values not sorted, or not more
+     *  points than pixel columns.
+     */
+    bool Decimate( const std::vector<double>& aXs, const std::vector<double>& aYs,
+                   wxCoord aStartPx, wxCoord aEndPx,
+                   const std::function<double( double )>& aColumn,
+                   std::vector<size_t>& aIndices ) const;
+
+private:
+    /** Min/max pyramid of the Y values: level 0 holds the lowest and highest point of every
+     *  block of 4 points, each next level merges two blocks of the previous one.
+     *  Empty when the points cannot be decimated (X values not sorted).
+     */
+    std::vector<std::vector<MINMAX>> m_pyramid;
+
+    bool m_sortedX;
+};
+
 // -----------------------------------------------------------------------------
 // mpFXYVector - provided by Jose Luis Blanco
 // -----------------------------------------------------------------------------
@@ -1579,11 +1636,24 @@ public:
      */
     virtual void SetData( const std::vector<double>& xs, const std::vector<double>& ys );
 
+    /** Adds points at the end of the data, e.g. while they are computed.
+     *  Both vectors MUST be of the same length. This method DOES NOT refresh the mpWindow; do it manually.
+     * @sa SetData
+     */
+    virtual void AppendData( const std::vector<double>& xs, const std::vector<double>& ys );
+
     /** Clears all the data, leaving the layer empty.
      * @sa SetData
      */
     void Clear();
 
+    /** Layer plot handler.
+     *  When the layer is continuous, the X values are sorted and there are more points than
+     *  pixel columns, only the minimum and maximum points of the data falling in every pixel
+     *  column are plotted.
+     */
+    virtual void Plot( wxDC& dc, mpWindow& w ) override;
+
 protected:
     /** The internal copy of the set of data to draw.
      */
@@ -1597,6 +1667,22 @@ protected:
      */
     double m_minX, m_maxX, m_minY, m_maxY;
 
+    /** Index of the lowest and highest points of the ranges of the data
+     */
+    mpMinMaxIndex m_minMaxIndex;
+
+    /** Indices of the points to plot, when the data is decimated
+     */
+    std::vector<size_t> m_plotIndices;
+
+    /** True while plotting decimated data, GetNextXY() returns the m_plotIndices points
+     */
+    bool m_decimated;
+
+    /** Updates the bounding box and the min/max index for points added from aFirst
+     */
+    void updateData( size_t aFirst );
+
     /** Rewind value enumeration with mpFXY::GetNextXY.
      *  Overridden in this implementation.
      */
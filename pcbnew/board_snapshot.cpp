@@ -0,0 +1,638 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <wx/ffile.h>
+
+#include <cache_file.h>
+#include <class_board.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <common.h>
+#include <kicad_plugin.h>
+#include <mapped_file.h>
+#include <md5_hash.h>
+#include <netinfo.h>
+#include <pcb_parser.h>
+#include <profile.h>
+#include <richio.h>
+#include <trace_helpers.h>
+#include <trace_profiler.h>
+
+#include <board_snapshot.h>
+
+
+///> Magic string at the beginning of the snapshots
+static const char SNAPSHOT_MAGIC[8] = { 'K', 'I', 'P', 'C', 'B', 'S', 'N', 'P' };
+
+///> Version of the snapshot format, increment it when the content changes
+#define SNAPSHOT_FORMAT 1
+
+///> Written as is, to recognize the snapshots made on a machine of another byte order
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+
+///> Kinds of the track records
+enum SNAPSHOT_TRACK : uint8_t
+{
+    SNAPSHOT_SEGMENT,
+    SNAPSHOT_ARC,
+    SNAPSHOT_VIA
+};
+
+
+namespace
+{
+
+/**
+ * Appends plain values to a binary buffer.
+ */
+class SNAPSHOT_WRITER
+{
+public:
+    template<typename T>
+    void Put( T aValue )
+    {
+        static_assert( std::is_arithmetic<T>::value, "only plain values are written" );
+        m_data.append( reinterpret_cast<const char*>( &aValue ), sizeof( T ) );
+    }
+
+    void PutString( const std::string& aText )
+    {
+        Put<uint32_t>( (uint32_t) aText.size() );
+        m_data.append( aText );
+    }
+
+    void PutPoint( const VECTOR2I& aPoint )
+    {
+        Put<int32_t>( aPoint.x );
+        Put<int32_t>( aPoint.y );
+    }
+
+    void PutChain( const SHAPE_LINE_CHAIN& aChain )
+    {
+        Put<uint32_t>( (uint32_t) aChain.PointCount() );
+
+        for( int ii = 0; ii < aChain.PointCount(); ++ii )
+            PutPoint( aChain.CPoint( ii ) );
+    }
+
+    std::string& Data() { return m_data; }
+
+private:
+    std::string m_data;
+};
+
+
+/**
+ * Reads the values appended by a SNAPSHOT_WRITER.
+ * @throw IO_ERROR when reading past the end of the data.
+ */
+class SNAPSHOT_READER
+{
+public:
+    SNAPSHOT_READER( const char* aData, size_t aSize ) :
+            m_data( aData ),
+            m_size( aSize ),
+            m_pos( 0 )
+    {
+    }
+
+    template<typename T>
+    T Get()
+    {
+        T value;
+
+        memcpy( &value, need( sizeof( T ) ), sizeof( T ) );
+        return value;
+    }
+
+    std::string GetString()
+    {
+        uint32_t    size = Get<uint32_t>();
+        const char* text = need( size );
+
+        return std::string( text, size );
+    }
+
+    wxPoint GetPoint()
+    {
+        int32_t x = Get<int32_t>();
+        int32_t y = Get<int32_t>();
+
+        return wxPoint( x, y );
+    }
+
+    /**
+     * Reads a count of items taking at least \a aItemSize bytes each, so a damaged count
+     * cannot make the caller allocate or loop much more than the data holds.
+     * @throw IO_ERROR if the rest of the data is too small for that many items.
+     */
+    template<typename T = uint32_t>
+    T GetCount( size_t aItemSize )
+    {
+        T count = Get<T>();
+
+        if( count > ( m_size - m_pos ) / aItemSize )
+            THROW_IO_ERROR( _( "Invalid item count in board snapshot" ) );
+
+        return count;
+    }
+
+private:
+    const char* need( size_t aSize )
+    {
+        if( aSize > m_size - m_pos )
+            THROW_IO_ERROR( _( "Truncated board snapshot" ) );
+
+        const char* data = m_data + m_pos;
+        m_pos += aSize;
+        return data;
+    }
+
+    const char* m_data;
+    size_t      m_size;
+    size_t      m_pos;
+};
+
+
+/**
+ * Writes the nets, tracks and zone fills of \a aBoard.
+ * @return false if the board cannot be restored from a snapshot.
+ */
+bool writeItems( BOARD* aBoard, SNAPSHOT_WRITER& aOut )
+{
+    // The tracks refer to the nets by their index in the net table, which holds the net
+    // names: the net codes are renumbered when the board is formatted
+    std::vector<NETINFO_ITEM*>                        netTable;
+    std::unordered_map<const NETINFO_ITEM*, uint32_t> netIndices;
+    SNAPSHOT_WRITER                                   tracks;
+
+    // The tracks are sorted as PCB_IO sorts them, so the board is the same as the saved one
+    std::set<TRACK*, TRACK::cmp_tracks> sortedTracks( aBoard->Tracks().begin(),
+                                                      aBoard->Tracks().end() );
+
+    if( sortedTracks.size() != aBoard->Tracks().size() )
+        return false;
+
+    for( TRACK* track : sortedTracks )
+    {
+        NETINFO_ITEM* net = track->GetNet();
+
+        if( !net )
+            return false;
+
+        auto it = netIndices.find( net );
+
+        if( it == netIndices.end() )
+        {
+            it = netIndices.emplace( net, (uint32_t) netTable.size() ).first;
+            netTable.push_back( net );
+        }
+
+        switch( track->Type() )
+        {
+        case PCB_TRACE_T: tracks.Put<uint8_t>( SNAPSHOT_SEGMENT ); break;
+        case PCB_ARC_T:   tracks.Put<uint8_t>( SNAPSHOT_ARC );     break;
+        case PCB_VIA_T:   tracks.Put<uint8_t>( SNAPSHOT_VIA );     break;
+        default:          return false;
+        }
+
+        tracks.PutString( TO_UTF8( track->m_Uuid.AsString() ) );
+        tracks.Put<uint32_t>( it->second );
+        tracks.Put<uint32_t>( track->GetStatus() );
+        tracks.PutPoint( track->GetStart() );
+        tracks.PutPoint( track->GetEnd() );
+        tracks.Put<int32_t>( track->GetWidth() );
+
+        if( track->Type() == PCB_VIA_T )
+        {
+            VIA*         via = static_cast<VIA*>( track );
+            PCB_LAYER_ID top;
+            PCB_LAYER_ID bottom;
+
+            via->LayerPair( &top, &bottom );
+
+            tracks.Put<int32_t>( top );
+            tracks.Put<int32_t>( bottom );
+            tracks.Put<int32_t>( via->GetDrill() );
+            tracks.Put<int32_t>( static_cast<int>( via->GetViaType() ) );
+            tracks.Put<uint8_t>( via->GetRemoveUnconnected() );
+            tracks.Put<uint8_t>( via->GetKeepTopBottom() );
+        }
+        else
+        {
+            tracks.Put<int32_t>( track->GetLayer() );
+
+            if( track->Type() == PCB_ARC_T )
+                tracks.PutPoint( static_cast<ARC*>( track )->GetMid() );
+        }
+    }
+
+    aOut.Put<uint32_t>( (uint32_t) netTable.size() );
+
+    for( NETINFO_ITEM* net : netTable )
+        aOut.PutString( TO_UTF8( net->GetNetname() ) );
+
+    aOut.Put<uint64_t>( sortedTracks.size() );
+    aOut.Data().append( tracks.Data() );
+
+    // The zones are found back from their uuid, which must be unique
+    std::set<KIID>                     zoneIds;
+    std::vector<ZONE_CONTAINER*>       filledZones;
+
+    for( ZONE_CONTAINER* zone : aBoard->Zones() )
+    {
+        if( !zoneIds.insert( zone->m_Uuid ).second )
+            return false;
+
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            if( !zone->GetFilledPolysList( layer ).IsEmpty() || !zone->FillSegments( layer ).empty() )
+            {
+                filledZones.push_back( zone );
+                break;
+            }
+        }
+    }
+
+    aOut.Put<uint32_t>( (uint32_t) filledZones.size() );
+
+    for( ZONE_CONTAINER* zone : filledZones )
+    {
+        std::vector<PCB_LAYER_ID> layers;
+
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            if( !zone->GetFilledPolysList( layer ).IsEmpty() || !zone->FillSegments( layer ).empty() )
+                layers.push_back( layer );
+        }
+
+        aOut.PutString( TO_UTF8( zone->m_Uuid.AsString() ) );
+        aOut.Put<uint32_t>( (uint32_t) layers.size() );
+
+        for( PCB_LAYER_ID layer : layers )
+        {
+            const SHAPE_POLY_SET&    polys = zone->GetFilledPolysList( layer );
+            const ZONE_SEGMENT_FILL& segments = zone->FillSegments( layer );
+
+            aOut.Put<int32_t>( layer );
+            aOut.Put<uint32_t>( (uint32_t) polys.OutlineCount() );
+
+            for( int ii = 0; ii < polys.OutlineCount(); ++ii )
+            {
+                aOut.Put<uint8_t>( zone->IsIsland( layer, ii ) );
+                aOut.Put<uint32_t>( (uint32_t) polys.HoleCount( ii ) );
+                aOut.PutChain( polys.COutline( ii ) );
+
+                for( int jj = 0; jj < polys.HoleCount( ii ); ++jj )
+                    aOut.PutChain( polys.CHole( ii, jj ) );
+            }
+
+            aOut.Put<uint32_t>( (uint32_t) segments.size() );
+
+            for( const SEG& segment : segments )
+            {
+                aOut.PutPoint( segment.A );
+                aOut.PutPoint( segment.B );
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Adds the tracks and the zone fills written by writeItems() to \a aBoard, parsed from
+ * the text of the snapshot.
+ */
+void readItems( SNAPSHOT_READER& aIn, BOARD* aBoard )
+{
+    // Net names: a length
+    std::vector<NETINFO_ITEM*> netTable( aIn.GetCount( 4 ) );
+
+    for( NETINFO_ITEM*& net : netTable )
+    {
+        wxString name = FROM_UTF8( aIn.GetString().c_str() );
+
+        net = name.IsEmpty() ? aBoard->FindNet( NETINFO_LIST::UNCONNECTED )
+                             : aBoard->FindNet( name );
+
+        if( !net )
+            THROW_IO_ERROR( wxString::Format( _( "Net \"%s\" not found" ), name ) );
+    }
+
+    // Segments: kind, uuid length, net, status, start, end, width and layer
+    for( uint64_t count = aIn.GetCount<uint64_t>( 37 ); count; --count )
+    {
+        std::unique_ptr<TRACK> track;
+        uint8_t                kind = aIn.Get<uint8_t>();
+
+        switch( kind )
+        {
+        case SNAPSHOT_SEGMENT: track.reset( new TRACK( aBoard ) ); break;
+        case SNAPSHOT_ARC:     track.reset( new ARC( aBoard ) );   break;
+        case SNAPSHOT_VIA:     track.reset( new VIA( aBoard ) );   break;
+        default:               THROW_IO_ERROR( _( "Unknown track in board snapshot" ) );
+        }
+
+        const_cast<KIID&>( track->m_Uuid ) = KIID( FROM_UTF8( aIn.GetString().c_str() ) );
+
+        uint32_t netIndex = aIn.Get<uint32_t>();
+
+        if( netIndex >= netTable.size() )
+            THROW_IO_ERROR( _( "Invalid net in board snapshot" ) );
+
+        track->SetNet( netTable[netIndex] );
+        track->SetStatus( static_cast<STATUS_FLAGS>( aIn.Get<uint32_t>() ) );
+        track->SetStart( aIn.GetPoint() );
+        track->SetEnd( aIn.GetPoint() );
+        track->SetWidth( aIn.Get<int32_t>() );
+
+        if( kind == SNAPSHOT_VIA )
+        {
+            VIA*         via = static_cast<VIA*>( track.get() );
+            PCB_LAYER_ID top = ToLAYER_ID( aIn.Get<int32_t>() );
+            PCB_LAYER_ID bottom = ToLAYER_ID( aIn.Get<int32_t>() );
+
+            via->SetLayerPair( top, bottom );
+            via->SetDrill( aIn.Get<int32_t>() );
+            via->SetViaType( static_cast<VIATYPE>( aIn.Get<int32_t>() ) );
+            via->SetRemoveUnconnected( aIn.Get<uint8_t>() != 0 );
+            via->SetKeepTopBottom( aIn.Get<uint8_t>() != 0 );
+        }
+        else
+        {
+            track->SetLayer( ToLAYER_ID( aIn.Get<int32_t>() ) );
+
+            if( kind == SNAPSHOT_ARC )
+                static_cast<ARC*>( track.get() )->SetMid( aIn.GetPoint() );
+        }
+
+        aBoard->Add( track.release(), ADD_MODE::APPEND );
+    }
+
+    std::map<wxString, ZONE_CONTAINER*> zones;
+
+    for( ZONE_CONTAINER* zone : aBoard->Zones() )
+        zones[zone->m_Uuid.AsString()] = zone;
+
+    // Zones: uuid length and layer count
+    for( uint32_t count = aIn.GetCount( 8 ); count; --count )
+    {
+        wxString id = FROM_UTF8( aIn.GetString().c_str() );
+        auto     it = zones.find( id );
+
+        if( it == zones.end() )
+            THROW_IO_ERROR( wxString::Format( _( "Zone %s not found" ), id ) );
+
+        ZONE_CONTAINER* zone = it->second;
+        bool            filled = false;
+
+        // Layers: layer, polygon count and segment count
+        for( uint32_t layerCount = aIn.GetCount( 12 ); layerCount; --layerCount )
+        {
+            PCB_LAYER_ID   layer = ToLAYER_ID( aIn.Get<int32_t>() );
+            SHAPE_POLY_SET polys;
+            uint32_t       polyCount = aIn.GetCount( 9 );   // island, hole and point counts
+
+            for( uint32_t ii = 0; ii < polyCount; ++ii )
+            {
+                bool     island = aIn.Get<uint8_t>() != 0;
+                uint32_t holeCount = aIn.GetCount( 4 );     // point count
+                int      outline = polys.NewOutline();
+
+                if( island )
+                    zone->SetIsIsland( layer, outline );
+
+                for( uint32_t jj = 0; jj <= holeCount; ++jj )
+                {
+                    // The outline first, then its holes
+                    int hole = jj == 0 ? -1 : polys.NewHole( outline );
+
+                    for( uint32_t pointCount = aIn.GetCount( 8 ); pointCount; --pointCount )
+                    {
+                        wxPoint pt = aIn.GetPoint();
+                        polys.Append( pt.x, pt.y, outline, hole );
+                    }
+                }
+            }
+
+            if( polyCount )
+            {
+                zone->SetFilledPolysList( layer, polys );
+                filled = true;
+            }
+
+            ZONE_SEGMENT_FILL segments( aIn.GetCount( 16 ) );
+
+            for( SEG& segment : segments )
+            {
+                segment.A = aIn.GetPoint();
+                segment.B = aIn.GetPoint();
+            }
+
+            if( !segments.empty() )
+                zone->SetFillSegments( layer, segments );
+        }
+
+        if( filled )
+            zone->CalculateFilledArea();
+    }
+}
+
+
+/**
+ * @return the MD5 hash of the content of \a aFileName, or an empty string if the file
+ * cannot be read.
+ */
+std::string hashFile( const wxString& aFileName )
+{
+    MAPPED_FILE file;
+
+    if( !file.Open( aFileName ) )
+        return std::string();
+
+    MD5_HASH hash;
+    size_t   done = 0;
+
+    hash.Init();
+
+    // MD5_HASH takes 32 bit lengths
+    while( done < file.Size() )
+    {
+        uint32_t length = (uint32_t) std::min<size_t>( file.Size() - done, 1u << 30 );
+
+        hash.Hash( reinterpret_cast<uint8_t*>( file.Data() + done ), length );
+        done += length;
+    }
+
+    hash.Finalize();
+
+    return hash.Format();
+}
+
+} // namespace
+
+
+BOARD_SNAPSHOT::BOARD_SNAPSHOT( const wxString& aBoardFileName ) :
+        m_boardFileName( aBoardFileName ),
+        m_boardHash( hashFile( aBoardFileName ) )
+{
+}
+
+
+wxString BOARD_SNAPSHOT::GetFileName( const wxString& aBoardFileName )
+{
+    return aBoardFileName + wxT( "_snapshot" );
+}
+
+
+BOARD* BOARD_SNAPSHOT::Load()
+{
+    if( m_boardHash.empty() )
+        return nullptr;
+
+    TRACE_ZONE( "BOARD_SNAPSHOT::Load", "io" );
+    PROF_COUNTER timer;
+    MAPPED_FILE  file;
+    wxString     fileName = GetFileName( m_boardFileName );
+
+    if( !file.Open( fileName ) )
+        return nullptr;
+
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        LOCALE_IO       toggle;
+        SNAPSHOT_READER in( file.Data(), file.Size() );
+        std::string     magic( SNAPSHOT_MAGIC, sizeof( SNAPSHOT_MAGIC ) );
+
+        if( in.GetString() != magic
+                || in.Get<uint32_t>() != SNAPSHOT_BYTE_ORDER
+                || in.Get<uint32_t>() != SNAPSHOT_FORMAT
+                || in.Get<uint32_t>() != SEXPR_BOARD_FILE_VERSION
+                || in.GetString() != m_boardHash )
+        {
+            wxLogTrace( traceKicadPcbPlugin, "Board snapshot %s is out of date", fileName );
+            return nullptr;
+        }
+
+        STRING_LINE_READER reader( in.GetString(), fileName );
+        PCB_PARSER         parser( &reader );
+
+        parser.SetBoardItemsHook( [&]( BOARD* aBoard )
+                                  {
+                                      readItems( in, aBoard );
+                                  } );
+
+        BOARD_ITEM* item = parser.Parse();
+
+        board.reset( dynamic_cast<BOARD*>( item ) );
+
+        if( !board )
+        {
+            delete item;
+            return nullptr;
+        }
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        wxLogTrace( traceKicadPcbPlugin, "Cannot read board snapshot %s: %s", fileName,
+                    ioe.What() );
+        return nullptr;
+    }
+
+    wxLogTrace( traceKicadPcbPlugin, "Loaded board snapshot %s in %.1f ms", fileName,
+                timer.msecs() );
+
+    return board.release();
+}
+
+
+void BOARD_SNAPSHOT::Save( BOARD* aBoard )
+{
+    if( m_boardHash.empty() )
+        return;
+
+    TRACE_ZONE( "BOARD_SNAPSHOT::Save", "io" );
+
+    wxString        fileName = GetFileName( m_boardFileName );
+    SNAPSHOT_WRITER out;
+
+    out.PutString( std::string( SNAPSHOT_MAGIC, sizeof( SNAPSHOT_MAGIC ) ) );
+    out.Put<uint32_t>( SNAPSHOT_BYTE_ORDER );
+    out.Put<uint32_t>( SNAPSHOT_FORMAT );
+    out.Put<uint32_t>( SEXPR_BOARD_FILE_VERSION );
+    out.PutString( m_boardHash );
+
+    try
+    {
+        LOCALE_IO        toggle;
+        STRING_FORMATTER formatter;
+        PCB_IO           io( CTL_FOR_SNAPSHOT );
+
+        // As PCB_IO::Save() does, without the tracks and the zone fills
+        io.m_board = aBoard;
+        io.m_mapping->SetBoard( aBoard );
+        io.m_out = &formatter;
+
+        formatter.Print( 0, "(kicad_pcb (version %d) (generator pcbnew)\n",
+                         SEXPR_BOARD_FILE_VERSION );
+        io.Format( aBoard, 1 );
+        formatter.Print( 0, ")\n" );
+
+        out.PutString( formatter.GetString() );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        wxLogTrace( traceKicadPcbPlugin, "Cannot format board snapshot: %s", ioe.What() );
+        return;
+    }
+
+    if( !writeItems( aBoard, out ) )
+    {
+        wxLogTrace( traceKicadPcbPlugin, "Board %s cannot have a snapshot", m_boardFileName );
+        return;
+    }
+
+    if( !WriteFileAtomically( fileName,
+                              [&]( wxFFile& aFile )
+                              {
+                                  return aFile.Write( out.Data().data(), out.Data().size() )
+                                         == out.Data().size();
+                              } ) )
+    {
+        wxLogTrace( traceKicadPcbPlugin, "Cannot write board snapshot %s", fileName );
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file board_snapshot.h
+ * Binary load-time cache of a board file.
+ */
+
+#ifndef BOARD_SNAPSHOT_H
+#define BOARD_SNAPSHOT_H
+
+#include <string>
+
+#include <wx/string.h>
+
+class BOARD;
+
+
+/**
+ * BOARD_SNAPSHOT
+ *
+ * Saves a board just loaded from its file next to the file, in a form which loads faster,
+ * and loads it back instead of the file while the file content is unchanged.
+ *
+ * The snapshot holds the board formatted without its tracks and zone fills, which are most
+ * of a routed board, and those in binary: the net table, the tracks, arcs and vias, and
+ * the filled polygons of the zones.  The board file remains the reference: the snapshot is
+ * only used when it was made from a file with the same MD5 hash, by the same version of
+ * the board format, and any problem reading it falls back to parsing the file.
+ */
+class BOARD_SNAPSHOT
+{
+public:
+    /**
+     * Hashes the current content of \a aBoardFileName.
+     */
+    BOARD_SNAPSHOT( const wxString& aBoardFileName );
+
+    /**
+     * Function Load
+     * @return the board of the snapshot, or nullptr if there is no snapshot made from the
+     * current content of the board file, or it cannot be read.
+     */
+    BOARD* Load();
+
+    /**
+     * Function Save
+     * writes the snapshot of \a aBoard, which was just loaded from the board file.  Errors
+     * are only traced, since the snapshot is a cache.
+     */
+    void Save( BOARD* aBoard );
+
+    /**
+     * @return the name of the snapshot file of \a aBoardFileName.
+     */
+    static wxString GetFileName( const wxString& aBoardFileName );
+
+private:
+    wxString    m_boardFileName;
+    std::string m_boardHash;        ///< MD5 of the board file, empty if it couldn't be read
+};
+
+#endif  // BOARD_SNAPSHOT_H
@@ -28,6 +28,7 @@
 #include <widgets/progress_reporter.h>
 #include <geometry/geometry_utils.h>
 #include <board_commit.h>
+#include <trace_profiler.h>
 
 #include <thread>
 #include <mutex>
@@ -200,6 +201,8 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
 
 void CN_CONNECTIVITY_ALGO::searchConnections()
 {
+    TRACE_ZONE( "CN_CONNECTIVITY_ALGO::searchConnections", "connectivity" );
+
 #ifdef PROFILE
     PROF_COUNTER garbage_collection( "garbage-collection" );
 #endif
@@ -237,6 +240,8 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
         auto conn_lambda = [&nextItem, &dirtyItems]
                             ( CN_LIST* aItemList, PROGRESS_REPORTER* aReporter) -> size_t
         {
+            TRACE_ZONE( "CN_CONNECTIVITY_ALGO::searchConnections worker", "connectivity" );
+
             for( size_t i = nextItem++; i < dirtyItems.size(); i = nextItem++ )
             {
                 CN_VISITOR visitor( dirtyItems[i] );
@@ -404,6 +409,8 @@ void reportProgress( PROGRESS_REPORTER* aReporter, int aCount, int aSize, int aD
 
 void CN_CONNECTIVITY_ALGO::Build( BOARD* aBoard, PROGRESS_REPORTER* aReporter )
 {
+    TRACE_ZONE( "CN_CONNECTIVITY_ALGO::Build", "connectivity" );
+
     const int delta = 100;  // Number of additions between 2 calls to the progress bar
     int ii = 0;
     int size = 0;
@@ -523,6 +530,8 @@ void CN_CONNECTIVITY_ALGO::propagateConnections( BOARD_COMMIT* aCommit )
 
 void CN_CONNECTIVITY_ALGO::PropagateNets( BOARD_COMMIT* aCommit )
 {
+    TRACE_ZONE( "CN_CONNECTIVITY_ALGO::PropagateNets", "connectivity" );
+
     m_connClusters = SearchClusters( CSM_PROPAGATE );
     propagateConnections( aCommit );
 }
@@ -561,6 +570,8 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( ZONE_CONTAINER* aZone,
 
 void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLATED_ISLAND_LIST>& aZones )
 {
+    TRACE_ZONE( "CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands", "connectivity" );
+
     for( auto& z : aZones )
     {
         Remove( z.m_zone );
@@ -34,6 +34,7 @@
 #include <connectivity/connectivity_data.h>
 #include <connectivity/connectivity_algo.h>
 #include <ratsnest/ratsnest_data.h>
+#include <trace_profiler.h>
 
 CONNECTIVITY_DATA::CONNECTIVITY_DATA()
 {
@@ -80,6 +81,8 @@ bool CONNECTIVITY_DATA::Update( BOARD_ITEM* aItem )
 
 void CONNECTIVITY_DATA::Build( BOARD* aBoard, PROGRESS_REPORTER* aReporter )
 {
+    TRACE_ZONE( "CONNECTIVITY_DATA::Build", "connectivity" );
+
     m_connAlgo.reset( new CN_CONNECTIVITY_ALGO );
     m_connAlgo->Build( aBoard, aReporter );
 
@@ -110,6 +113,8 @@ void CONNECTIVITY_DATA::Move( const VECTOR2I& aDelta )
 
 void CONNECTIVITY_DATA::updateRatsnest()
 {
+    TRACE_ZONE( "CONNECTIVITY_DATA::updateRatsnest", "connectivity" );
+
     #ifdef PROFILE
     PROF_COUNTER rnUpdate( "update-ratsnest" );
     #endif
@@ -129,6 +134,8 @@ void CONNECTIVITY_DATA::updateRatsnest()
 
     auto update_lambda = [&nextNet, &dirty_nets]() -> size_t
     {
+        TRACE_ZONE( "CONNECTIVITY_DATA::updateRatsnest worker", "connectivity" );
+
         for( size_t i = nextNet++; i < dirty_nets.size(); i = nextNet++ )
             dirty_nets[i]->Update();
 
@@ -163,6 +170,8 @@ void CONNECTIVITY_DATA::addRatsnestCluster( const std::shared_ptr<CN_CLUSTER>& a
 
 void CONNECTIVITY_DATA::RecalculateRatsnest( BOARD_COMMIT* aCommit  )
 {
+    TRACE_ZONE( "CONNECTIVITY_DATA::RecalculateRatsnest", "connectivity" );
+
     m_connAlgo->PropagateNets( aCommit );
 
     int lastNet = m_connAlgo->NetCount();
@@ -25,6 +25,7 @@
 
 #include <fctsys.h>
 #include <reporter.h>
+#include <trace_profiler.h>
 #include <widgets/progress_reporter.h>
 #include <drc/drc_engine.h>
 #include <drc/drc_rule_parser.h>
@@ -366,6 +367,8 @@ bool DRC_ENGINE::CompileRules()
  */
 void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
 {
+    TRACE_ZONE( "DRC_ENGINE::InitEngine", "drc" );
+
     m_testProviders = DRC_TEST_PROVIDER_REGISTRY::Instance().GetTestProviders();
 
     for( DRC_TEST_PROVIDER* provider : m_testProviders )
@@ -390,6 +393,8 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
 void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aTestTracksAgainstZones,
                            bool aReportAllTrackErrors, bool aTestFootprints )
 {
+    TRACE_ZONE( "DRC_ENGINE::RunTests", "drc" );
+
     m_userUnits = aUnits;
 
     // Note: set these first.  The phase counts may be dependent on some of them.
@@ -421,6 +426,8 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aTestTracksAgainstZones,
 
         ReportAux( wxString::Format( "Run DRC provider: '%s'", provider->GetName() ) );
 
+        TRACE_ZONE( provider->GetName().ToStdString(), "drc" );
+
         if( !provider->Run() )
             break;
     }
@@ -34,6 +34,7 @@
 #include <fp_lib_table.h>
 #include <kiface_i.h>
 #include <trace_helpers.h>
+#include <trace_profiler.h>
 #include <lockfile.cpp>
 #include <netlist_reader/pcb_netlist.h>
 #include <pcbnew_id.h>
@@ -489,6 +490,8 @@ int PCB_EDIT_FRAME::inferLegacyEdgeClearance( BOARD* aBoard )
 
 bool PCB_EDIT_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, int aCtl )
 {
+    TRACE_ZONE( "PCB_EDIT_FRAME::OpenProjectFiles", "io" );
+
     // This is for python:
     if( aFileSet.size() != 1 )
     {
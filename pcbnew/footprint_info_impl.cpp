@@ -26,6 +26,7 @@
 #include <common.h>
 #include <fctsys.h>
 #include <footprint_info.h>
+#include <footprint_lib_index.h>
 #include <fp_lib_table.h>
 #include <html_messagebox.h>
 #include <io_mgr.h>
@@ -259,11 +260,11 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
 
             while( this->m_queue_out.pop( nickname ) && !m_cancelled )
             {
-                wxArrayString fpnames;
+                std::vector<FOOTPRINT_INDEX_ENTRY> footprints;
 
                 try
                 {
-                    m_lib_table->FootprintEnumerate( fpnames, nickname, false );
+                    m_lib_table->FootprintEnumerateInfo( footprints, nickname, false );
                 }
                 catch( const IO_ERROR& ioe )
                 {
@@ -283,10 +284,16 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
                     }
                 }
 
-                for( unsigned jj = 0; jj < fpnames.size() && !m_cancelled; ++jj )
+                // Libraries with an index give the footprint descriptions without parsing
+                // the footprints
+                for( unsigned jj = 0; jj < footprints.size() && !m_cancelled; ++jj )
                 {
-                    wxString fpname = fpnames[jj];
-                    FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO_IMPL( this, nickname, fpname );
+                    const FOOTPRINT_INDEX_ENTRY& fp = footprints[jj];
+                    FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO_IMPL( nickname, fp.m_name,
+                                                                      fp.m_description,
+                                                                      fp.m_keywords, 0,
+                                                                      fp.m_padCount,
+                                                                      fp.m_uniquePadCount );
                     queue_parsed.move_push( std::unique_ptr<FOOTPRINT_INFO>( fpinfo ) );
                 }
 
@@ -0,0 +1,166 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <wx/ffile.h>
+#include <wx/textfile.h>
+
+#include <cache_file.h>
+#include <class_module.h>
+#include <kicad_string.h>
+#include <trace_helpers.h>
+
+#include <footprint_lib_index.h>
+
+
+///> Version of the saved index format, increment it when the content changes
+#define FOOTPRINT_INDEX_FORMAT "footprint-index 1"
+
+///> Lines per footprint in the saved index
+#define FOOTPRINT_INDEX_LINES 6
+
+
+FOOTPRINT_INDEX_ENTRY::FOOTPRINT_INDEX_ENTRY( const wxString& aName, const MODULE& aModule,
+                                              long long aFileModTime ) :
+        m_name( aName ),
+        m_description( aModule.GetDescription() ),
+        m_keywords( aModule.GetKeywords() ),
+        m_padCount( aModule.GetPadCount( DO_NOT_INCLUDE_NPTH ) ),
+        m_uniquePadCount( aModule.GetUniquePadCount( DO_NOT_INCLUDE_NPTH ) ),
+        m_fileModTime( aFileModTime )
+{
+}
+
+
+FOOTPRINT_LIB_INDEX::FOOTPRINT_LIB_INDEX( const wxString& aLibraryPath ) :
+        m_libraryPath( aLibraryPath )
+{
+}
+
+
+bool FOOTPRINT_LIB_INDEX::Read()
+{
+    wxTextFile file( GetIndexFileName( m_libraryPath ) );
+
+    m_footprints.clear();
+    m_footprintIndex.clear();
+
+    if( !file.Exists() || !file.Open() )
+        return false;
+
+    bool ok = file.GetLineCount() >= 3 && file.GetFirstLine() == FOOTPRINT_INDEX_FORMAT
+                && file.GetNextLine() == m_libraryPath;
+
+    if( ok )
+    {
+        long count = 0;
+
+        ok = file.GetNextLine().ToLong( &count )
+                && file.GetLineCount() == 3 + (size_t) count * FOOTPRINT_INDEX_LINES;
+
+        for( long ii = 0; ok && ii < count; ++ii )
+        {
+            FOOTPRINT_INDEX_ENTRY entry;
+            unsigned long         padCount = 0;
+            unsigned long         uniquePadCount = 0;
+
+            entry.m_name = file.GetNextLine();
+            entry.m_description = UnescapeString( file.GetNextLine() );
+            entry.m_keywords = UnescapeString( file.GetNextLine() );
+
+            ok = file.GetNextLine().ToULong( &padCount )
+                    && file.GetNextLine().ToULong( &uniquePadCount )
+                    && file.GetNextLine().ToLongLong( &entry.m_fileModTime );
+
+            entry.m_padCount = (unsigned) padCount;
+            entry.m_uniquePadCount = (unsigned) uniquePadCount;
+
+            m_footprintIndex[entry.m_name] = m_footprints.size();
+            m_footprints.push_back( entry );
+        }
+    }
+
+    file.Close();
+
+    if( !ok )
+    {
+        m_footprints.clear();
+        m_footprintIndex.clear();
+    }
+
+    return ok;
+}
+
+
+void FOOTPRINT_LIB_INDEX::Write() const
+{
+    wxString indexFileName = GetIndexFileName( m_libraryPath );
+    wxString content;
+
+    content << FOOTPRINT_INDEX_FORMAT << '\n';
+    content << m_libraryPath << '\n';
+    content << wxString::Format( "%lu\n", (unsigned long) m_footprints.size() );
+
+    for( const FOOTPRINT_INDEX_ENTRY& entry : m_footprints )
+    {
+        content << entry.m_name << '\n';
+        content << EscapeString( entry.m_description, CTX_LINE ) << '\n';
+        content << EscapeString( entry.m_keywords, CTX_LINE ) << '\n';
+        content << wxString::Format( "%u\n", entry.m_padCount );
+        content << wxString::Format( "%u\n", entry.m_uniquePadCount );
+        content << wxString::Format( "%lld\n", entry.m_fileModTime );
+    }
+
+    if( !WriteFileAtomically( indexFileName,
+                              [&]( wxFFile& aFile )
+                              {
+                                  return aFile.Write( content, wxConvUTF8 );
+                              } ) )
+    {
+        wxLogTrace( traceKicadPcbPlugin, "Cannot write footprint library index \"%s\"",
+                    indexFileName );
+    }
+}
+
+
+const FOOTPRINT_INDEX_ENTRY* FOOTPRINT_LIB_INDEX::Find( const wxString& aName ) const
+{
+    auto it = m_footprintIndex.find( aName );
+
+    return it != m_footprintIndex.end() ? &m_footprints[it->second] : nullptr;
+}
+
+
+void FOOTPRINT_LIB_INDEX::SetFootprints( std::vector<FOOTPRINT_INDEX_ENTRY> aFootprints )
+{
+    m_footprints = std::move( aFootprints );
+    m_footprintIndex.clear();
+
+    for( size_t ii = 0; ii < m_footprints.size(); ++ii )
+        m_footprintIndex[m_footprints[ii].m_name] = ii;
+}
+
+
+wxString FOOTPRINT_LIB_INDEX::GetIndexFileName( const wxString& aLibraryPath )
+{
+    return GetLibraryIndexFileName( "footprint-index", aLibraryPath );
+}
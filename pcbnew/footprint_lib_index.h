@@ -0,0 +1,121 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file footprint_lib_index.h
+ * Saved index of the footprints of a footprint library.
+ */
+
+#ifndef FOOTPRINT_LIB_INDEX_H
+#define FOOTPRINT_LIB_INDEX_H
+
+#include <map>
+#include <vector>
+
+#include <wx/string.h>
+
+class MODULE;
+
+
+/**
+ * What the footprint lists of CvPcb, the footprint chooser and the footprint viewer need to
+ * know about a footprint, without the footprint itself.
+ */
+struct FOOTPRINT_INDEX_ENTRY
+{
+    FOOTPRINT_INDEX_ENTRY() :
+            m_padCount( 0 ),
+            m_uniquePadCount( 0 ),
+            m_fileModTime( 0 )
+    {
+    }
+
+    /**
+     * Describes a footprint which is already loaded.
+     */
+    FOOTPRINT_INDEX_ENTRY( const wxString& aName, const MODULE& aModule,
+                           long long aFileModTime = 0 );
+
+    wxString  m_name;
+    wxString  m_description;
+    wxString  m_keywords;
+    unsigned  m_padCount;           ///< Pads, without the NPTH ones
+    unsigned  m_uniquePadCount;     ///< Pad names, without the NPTH pads
+    long long m_fileModTime;        ///< Of the footprint file, in milliseconds since the epoch
+};
+
+
+/**
+ * FOOTPRINT_LIB_INDEX
+ *
+ * Lists the footprints of a .pretty folder with their description and the modification time
+ * of their file.
+ *
+ * The index is saved in the user settings folder, where every process listing the library
+ * finds it.  A footprint whose file has the same modification time as in the index doesn't
+ * need to be parsed to be listed.
+ */
+class FOOTPRINT_LIB_INDEX
+{
+public:
+    FOOTPRINT_LIB_INDEX( const wxString& aLibraryPath );
+
+    /**
+     * Function Read
+     * reads the saved index of the library.
+     *
+     * @return false if there is none, or it cannot be read.  The index is empty then.
+     */
+    bool Read();
+
+    /**
+     * Function Write
+     * saves the index, replacing the saved one.  Errors are only traced, since the index is
+     * a cache.
+     */
+    void Write() const;
+
+    /**
+     * @return the footprint \a aName, or nullptr if it is not in the index.
+     */
+    const FOOTPRINT_INDEX_ENTRY* Find( const wxString& aName ) const;
+
+    /**
+     * Replaces the footprints of the index.
+     */
+    void SetFootprints( std::vector<FOOTPRINT_INDEX_ENTRY> aFootprints );
+
+    const std::vector<FOOTPRINT_INDEX_ENTRY>& GetFootprints() const { return m_footprints; }
+
+    /**
+     * @return the name of the file the index of \a aLibraryPath is saved to.
+     */
+    static wxString GetIndexFileName( const wxString& aLibraryPath );
+
+private:
+    wxString                           m_libraryPath;
+    std::vector<FOOTPRINT_INDEX_ENTRY> m_footprints;
+    std::map<wxString, size_t>         m_footprintIndex;    ///< Names to m_footprints indices
+};
+
+#endif  // FOOTPRINT_LIB_INDEX_H
@@ -172,6 +172,15 @@ void GITHUB_PLUGIN::FootprintEnumerate( wxArrayString& aFootprintNames, const wx
 }
 
 
+void GITHUB_PLUGIN::FootprintEnumerateInfo( std::vector<FOOTPRINT_INDEX_ENTRY>& aFootprints,
+                                            const wxString& aLibPath, bool aBestEfforts,
+                                            const PROPERTIES* aProperties )
+{
+    // The library is the zip archive and the local pretty folder: there is no index of it
+    PLUGIN::FootprintEnumerateInfo( aFootprints, aLibPath, aBestEfforts, aProperties );
+}
+
+
 void GITHUB_PLUGIN::PrefetchLib(
         const wxString& aLibraryPath, const PROPERTIES* aProperties )
 {
@@ -170,6 +170,10 @@ public:
     void FootprintEnumerate( wxArrayString& aFootprintNames, const wxString& aLibPath,
                              bool aBestEfforts, const PROPERTIES* aProperties = NULL ) override;
 
+    void FootprintEnumerateInfo( std::vector<FOOTPRINT_INDEX_ENTRY>& aFootprints,
+                                 const wxString& aLibPath, bool aBestEfforts,
+                                 const PROPERTIES* aProperties = NULL ) override;
+
     void PrefetchLib( const wxString& aLibraryPath,
                       const PROPERTIES* aProperties = NULL ) override;
 
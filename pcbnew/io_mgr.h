@@ -28,6 +28,7 @@
 #include <richio.h>
 #include <map>
 #include <functional>
+#include <vector>
 #include <wx/time.h>
 
 #include <config.h>
@@ -36,6 +37,7 @@ class BOARD;
 class PLUGIN;
 class MODULE;
 class PROPERTIES;
+struct FOOTPRINT_INDEX_ENTRY;
 
 
 /**
@@ -363,6 +365,23 @@ public:
     virtual void FootprintEnumerate( wxArrayString& aFootprintNames, const wxString& aLibraryPath,
                                      bool aBestEfforts, const PROPERTIES* aProperties = NULL );
 
+    /**
+     * Function FootprintEnumerateInfo
+     * returns the names of the footprints of a library, as FootprintEnumerate(), along with
+     * their description, keywords and pad counts.  Plugins keeping an index of their
+     * libraries give them without loading the footprints.
+     *
+     * The default implementation loads the footprints listed by FootprintEnumerate().
+     *
+     * @param aFootprints receives the footprints of the library.
+     *
+     * @throw IO_ERROR as FootprintEnumerate(), once the footprints which could be read are
+     *  in @a aFootprints.
+     */
+    virtual void FootprintEnumerateInfo( std::vector<FOOTPRINT_INDEX_ENTRY>& aFootprints,
+                                         const wxString& aLibraryPath, bool aBestEfforts,
+                                         const PROPERTIES* aProperties = NULL );
+
     /**
      * Generate a timestamp representing all the files in the library (including the library
      * directory).
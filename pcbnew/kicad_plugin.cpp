@@ -28,6 +28,9 @@
 #include <advanced_config.h>
 #include <base_units.h>
 #include <trace_helpers.h>
+#include <trace_profiler.h>
+#include <board_snapshot.h>
+#include <footprint_lib_index.h>
 #include <class_board.h>
 #include <class_module.h>
 #include <class_pcb_text.h>
@@ -43,12 +46,145 @@
 #include <pcb_parser.h>
 #include <pcbnew_settings.h>
 #include <boost/ptr_container/ptr_map.hpp>
+#include <atomic>
+#include <thread>
 #include <convert_basic_shapes_to_polygon.h>    // for enum RECT_CHAMFER_POSITIONS definition
 #include <kiface_i.h>
 
 using namespace PCB_KEYS_T;
 
 
+/**
+ * Helper class putting the point lists of polygons together in a local buffer, and writing
+ * them to an OUTPUTFORMATTER in large blocks with Append().
+ *
+ * Filled zones can have millions of points, and formatting each of them through Print()
+ * is most of the time spent saving a board.  The text is the same as Print() would write.
+ */
+class XY_FORMATTER
+{
+public:
+    XY_FORMATTER( OUTPUTFORMATTER* aOut ) :
+            m_out( aOut )
+    {
+        m_buffer.reserve( BLOCK_SIZE + 256 );
+    }
+
+    /**
+     * Same as OUTPUTFORMATTER::Print( aNestLevel, "%s", aText ).
+     */
+    void Print( int aNestLevel, const char* aText )
+    {
+        indent( aNestLevel );
+        m_buffer += aText;
+        flushIfFull();
+    }
+
+    /**
+     * Writes "(xy X Y)", in millimetres.
+     */
+    void XY( int aNestLevel, int aX, int aY )
+    {
+        char buf[64];
+        int  len = FormatInternalUnits( aX, aY, buf );
+
+        indent( aNestLevel );
+        m_buffer += "(xy ";
+        m_buffer.append( buf, len );
+        m_buffer += ')';
+        flushIfFull();
+    }
+
+    void XY( int aNestLevel, const VECTOR2I& aPoint )
+    {
+        XY( aNestLevel, aPoint.x, aPoint.y );
+    }
+
+    /**
+     * Writes the buffered text.  Must be called before writing to the OUTPUTFORMATTER
+     * directly, and when done.
+     */
+    void Flush()
+    {
+        m_out->Append( m_buffer );
+        m_buffer.clear();
+    }
+
+private:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    void indent( int aNestLevel )
+    {
+        if( aNestLevel > 0 )
+            m_buffer.append( 2 * aNestLevel, ' ' );     // Same as OUTPUTFORMATTER::Print()
+    }
+
+    void flushIfFull()
+    {
+        if( m_buffer.size() >= BLOCK_SIZE )
+            Flush();
+    }
+
+    OUTPUTFORMATTER* m_out;
+    std::string      m_buffer;
+};
+
+
+/**
+ * Parses the footprint file \a aFullName of the library \a aLibPath with \a aParser.  Any
+ * number of threads can parse footprints at the same time, each with its own parser.
+ */
+static MODULE* parseFootprint( PCB_PARSER& aParser, const wxString& aLibPath,
+                               const wxString& aFullName )
+{
+    wxString         fullPath = aLibPath + wxT( '/' ) + aFullName;
+    MMAP_LINE_READER reader( fullPath );
+
+    aParser.SetLineReader( &reader );
+
+    BOARD_ITEM* item = aParser.Parse();
+    MODULE*     footprint = dynamic_cast<MODULE*>( item );
+
+    if( !footprint )
+    {
+        delete item;
+        THROW_IO_ERROR( wxString::Format( _( "File \"%s\" does not contain a footprint." ),
+                                          fullPath ) );
+    }
+
+    footprint->SetFPID( LIB_ID( wxEmptyString, aFullName.BeforeLast( '.' ) ) );
+    return footprint;
+}
+
+
+///> Footprint parsing threads started by all the caches, see reserveParserThreads()
+static std::atomic<size_t> s_parserThreads( 0 );
+
+
+/**
+ * Reserves up to \a aWanted footprint parsing threads, in addition to the thread loading the
+ * library, within one thread per core for the whole process.  The libraries are themselves
+ * often loaded by several threads (see FOOTPRINT_LIST_IMPL::JoinWorkers()), which then
+ * mostly parse their footprints on their own instead of each starting a thread per core.
+ *
+ * @return the number of threads which can be started; release them when they are done.
+ */
+static size_t reserveParserThreads( size_t aWanted )
+{
+    size_t cores = std::thread::hardware_concurrency();
+    size_t maxThreads = cores > 1 ? cores - 1 : 0;
+    size_t running = s_parserThreads.load();
+    size_t reserved = 0;
+
+    do
+    {
+        reserved = running < maxThreads ? std::min( aWanted, maxThreads - running ) : 0;
+    } while( reserved && !s_parserThreads.compare_exchange_weak( running, running + reserved ) );
+
+    return reserved;
+}
+
+
 /**
  * Helper class for creating a footprint library cache.
  *
@@ -60,19 +196,32 @@ using namespace PCB_KEYS_T;
 class FP_CACHE_ITEM
 {
     WX_FILENAME             m_filename;
-    std::unique_ptr<MODULE> m_module;
+    std::unique_ptr<MODULE> m_module;   // nullptr until needed, when listed from the index
+    FOOTPRINT_INDEX_ENTRY   m_info;
 
 public:
-    FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName );
+    FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName, long long aFileModTime = 0 );
+    FP_CACHE_ITEM( const FOOTPRINT_INDEX_ENTRY& aInfo, const WX_FILENAME& aFileName );
+
+    const WX_FILENAME&           GetFileName() const { return m_filename; }
+    const MODULE*                GetModule()   const { return m_module.get(); }
+    const FOOTPRINT_INDEX_ENTRY& GetInfo()     const { return m_info; }
 
-    const WX_FILENAME& GetFileName() const { return m_filename; }
-    const MODULE*      GetModule()   const { return m_module.get(); }
+    void SetModule( MODULE* aModule ) { m_module.reset( aModule ); }
 };
 
 
-FP_CACHE_ITEM::FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName ) :
+FP_CACHE_ITEM::FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName,
+                              long long aFileModTime ) :
     m_filename( aFileName ),
-    m_module( aModule )
+    m_module( aModule ),
+    m_info( aFileName.GetName(), *aModule, aFileModTime )
+{ }
+
+
+FP_CACHE_ITEM::FP_CACHE_ITEM( const FOOTPRINT_INDEX_ENTRY& aInfo, const WX_FILENAME& aFileName ) :
+    m_filename( aFileName ),
+    m_info( aInfo )
 { }
 
 
@@ -112,8 +261,19 @@ public:
      */
     void Save( MODULE* aModule = NULL );
 
+    /**
+     * Load the list of the footprints of the library.  The footprints whose file didn't
+     * change since the library index was saved are only parsed by GetModule(); the others
+     * are parsed now, and the index is updated.
+     */
     void Load();
 
+    /**
+     * @return the footprint \a aFootprintName, parsed first if needed, or nullptr if there
+     * is none.
+     */
+    const MODULE* GetModule( const wxString& aFootprintName );
+
     void Remove( const wxString& aFootprintName );
 
     /**
@@ -140,6 +300,9 @@ public:
      * @return true if \a aPath is the same as the cache path.
      */
     bool IsPath( const wxString& aPath ) const;
+
+private:
+    MODULE* parseModule( const WX_FILENAME& aFileName );
 };
 
 
@@ -174,6 +337,9 @@ void FP_CACHE::Save( MODULE* aModule )
         if( aModule && aModule != it->second->GetModule() )
             continue;
 
+        if( !it->second->GetModule() )
+            it->second->SetModule( parseModule( it->second->GetFileName() ) );
+
         WX_FILENAME fn = it->second->GetFileName();
 
         wxString tempFileName =
@@ -224,6 +390,8 @@ void FP_CACHE::Save( MODULE* aModule )
 
 void FP_CACHE::Load()
 {
+    TRACE_ZONE( "FP_CACHE::Load", "io" );
+
     m_cache_dirty = false;
     m_cache_timestamp = 0;
 
@@ -237,48 +405,170 @@ void FP_CACHE::Load()
         THROW_IO_ERROR( msg );
     }
 
+    // Switched here, before the parsing threads start (see LOCALE_IO)
+    LOCALE_IO toggle;
+
     wxString fullName;
     wxString fileSpec = wxT( "*." ) + KiCadFootprintFileExtension;
+    wxString cacheError;
 
     // wxFileName construction is egregiously slow.  Construct it once and just swap out
     // the filename thereafter.
     WX_FILENAME fn( m_lib_raw_path, wxT( "dummyName" ) );
 
-    if( dir.GetFirst( &fullName, fileSpec ) )
+    FOOTPRINT_LIB_INDEX                index( m_lib_raw_path );
+    std::vector<FOOTPRINT_INDEX_ENTRY> indexed;
+    bool                               indexChanged = !index.Read();
+
+    struct FOOTPRINT_FILE
     {
-        wxString cacheError;
+        wxString                     m_fullName;
+        long long                    m_modTime = 0;
+        const FOOTPRINT_INDEX_ENTRY* m_entry = nullptr;     ///< if unchanged since indexed
+        std::unique_ptr<MODULE>      m_module;
+        std::exception_ptr           m_exception;
+    };
+
+    std::vector<FOOTPRINT_FILE> files;
 
+    if( dir.GetFirst( &fullName, fileSpec ) )
+    {
         do
         {
             fn.SetFullName( fullName );
 
-            // Queue I/O errors so only files that fail to parse don't get loaded.
-            try
-            {
-                FILE_LINE_READER    reader( fn.GetFullPath() );
+            files.emplace_back();
 
-                m_owner->m_parser->SetLineReader( &reader );
+            FOOTPRINT_FILE& file = files.back();
 
-                MODULE*     footprint = (MODULE*) m_owner->m_parser->Parse();
-                wxString    fpName = fn.GetName();
+            file.m_fullName = fullName;
+            file.m_modTime = fn.GetTimestamp();
+            file.m_entry = index.Find( fn.GetName() );
 
-                footprint->SetFPID( LIB_ID( wxEmptyString, fpName ) );
-                m_modules.insert( fpName, new FP_CACHE_ITEM( footprint, fn ) );
+            if( file.m_entry && file.m_entry->m_fileModTime != file.m_modTime )
+                file.m_entry = nullptr;
 
-                m_cache_timestamp += fn.GetTimestamp();
-            }
-            catch( const IO_ERROR& ioe )
+        } while( dir.GetNext( &fullName ) );
+    }
+
+    // The footprints missing from the index are parsed by several threads, each with its
+    // own parser.  They are added below in the directory order, so the cache and the errors
+    // are the same whatever thread parsed which footprint.
+    std::vector<FOOTPRINT_FILE*> toParse;
+
+    for( FOOTPRINT_FILE& file : files )
+    {
+        if( !file.m_entry )
+            toParse.push_back( &file );
+    }
+
+    std::atomic<size_t> nextFile( 0 );
+
+    auto parseFiles =
+            [&]()
             {
-                if( !cacheError.IsEmpty() )
-                    cacheError += "\n\n";
+                TRACE_ZONE( "FP_CACHE::Load worker", "io" );
+                PCB_PARSER parser;
 
-                cacheError += ioe.What();
-            }
-        } while( dir.GetNext( &fullName ) );
+                for( size_t ii = nextFile++; ii < toParse.size(); ii = nextFile++ )
+                {
+                    FOOTPRINT_FILE* file = toParse[ii];
+
+                    try
+                    {
+                        file->m_module.reset( parseFootprint( parser, m_lib_raw_path,
+                                                              file->m_fullName ) );
+                    }
+                    catch( ... )
+                    {
+                        file->m_exception = std::current_exception();
+                    }
+                }
+            };
+
+    // This thread parses too
+    size_t threadCount = toParse.size() > 1 ? reserveParserThreads( toParse.size() - 1 ) : 0;
+
+    std::vector<std::thread> threads;
+
+    for( size_t ii = 0; ii < threadCount; ++ii )
+        threads.emplace_back( parseFiles );
+
+    if( !toParse.empty() )
+        parseFiles();
+
+    for( std::thread& thread : threads )
+        thread.join();
+
+    s_parserThreads -= threadCount;
 
-        if( !cacheError.IsEmpty() )
-            THROW_IO_ERROR( cacheError );
+    for( FOOTPRINT_FILE& file : files )
+    {
+        fn.SetFullName( file.m_fullName );
+
+        wxString fpName = fn.GetName();
+
+        if( file.m_entry )
+        {
+            m_modules.insert( fpName, new FP_CACHE_ITEM( *file.m_entry, fn ) );
+            indexed.push_back( *file.m_entry );
+            m_cache_timestamp += file.m_modTime;
+            continue;
+        }
+
+        indexChanged = true;
+
+        // Queue I/O errors so only files that fail to parse don't get loaded.
+        try
+        {
+            if( file.m_exception )
+                std::rethrow_exception( file.m_exception );
+
+            FP_CACHE_ITEM* item = new FP_CACHE_ITEM( file.m_module.release(), fn, file.m_modTime );
+
+            m_modules.insert( fpName, item );
+            indexed.push_back( item->GetInfo() );
+
+            m_cache_timestamp += file.m_modTime;
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            if( !cacheError.IsEmpty() )
+                cacheError += "\n\n";
+
+            cacheError += ioe.What();
+        }
     }
+
+    // Also when footprints were removed
+    if( indexChanged || indexed.size() != index.GetFootprints().size() )
+    {
+        index.SetFootprints( std::move( indexed ) );
+        index.Write();
+    }
+
+    if( !cacheError.IsEmpty() )
+        THROW_IO_ERROR( cacheError );
+}
+
+
+const MODULE* FP_CACHE::GetModule( const wxString& aFootprintName )
+{
+    MODULE_ITER it = m_modules.find( aFootprintName );
+
+    if( it == m_modules.end() )
+        return nullptr;
+
+    if( !it->second->GetModule() )
+        it->second->SetModule( parseModule( it->second->GetFileName() ) );
+
+    return it->second->GetModule();
+}
+
+
+MODULE* FP_CACHE::parseModule( const WX_FILENAME& aFileName )
+{
+    return parseFootprint( *m_owner->m_parser, aFileName.GetPath(), aFileName.GetFullName() );
 }
 
 
@@ -653,11 +943,14 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
     // Do not save MARKER_PCBs, they can be regenerated easily.
 
     // Save the tracks and vias.
-    for( auto track : sorted_tracks )
-        Format( track, aNestLevel );
+    if( !( m_ctl & CTL_OMIT_TRACKS ) )
+    {
+        for( auto track : sorted_tracks )
+            Format( track, aNestLevel );
 
-    if( sorted_tracks.size() )
-        m_out->Print( 0, "\n" );
+        if( sorted_tracks.size() )
+            m_out->Print( 0, "\n" );
+    }
 
     // Save the polygon (which are the newer technology) zones.
     for( auto zone : sorted_zones )
@@ -800,23 +1093,29 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
             SHAPE_LINE_CHAIN& outline = poly.Outline( 0 );
             int pointsCount = outline.PointCount();
 
-            m_out->Print( aNestLevel, "(gr_poly (pts\n" );
+            XY_FORMATTER xy( m_out );
+            bool         compact = ADVANCED_CFG::GetCfg().m_CompactSave;
+
+            xy.Print( aNestLevel, "(gr_poly (pts\n" );
 
             for( int ii = 0; ii < pointsCount;  ++ii )
             {
                 int nestLevel = 0;
 
-                if( ii && ( !( ii%4 ) || !ADVANCED_CFG::GetCfg().m_CompactSave ) )   // newline every 4 pts
+                if( ii && ( !( ii%4 ) || !compact ) )   // newline every 4 pts
                 {
                     nestLevel = aNestLevel + 1;
-                    m_out->Print( 0, "\n" );
+                    xy.Print( 0, "\n" );
                 }
 
-                m_out->Print( nestLevel, "%s(xy %s)",
-                              nestLevel ? "" : " ", FormatInternalUnits( outline.CPoint( ii ) ).c_str() );
+                if( !nestLevel )
+                    xy.Print( 0, " " );
+
+                xy.XY( nestLevel, outline.CPoint( ii ) );
             }
 
-            m_out->Print( 0, ")" );
+            xy.Print( 0, ")" );
+            xy.Flush();
         }
         else
         {
@@ -886,23 +1185,29 @@ void PCB_IO::format( EDGE_MODULE* aModuleDrawing, int aNestLevel ) const
             SHAPE_LINE_CHAIN& outline = poly.Outline( 0 );
             int pointsCount = outline.PointCount();
 
-            m_out->Print( aNestLevel, "(fp_poly (pts" );
+            XY_FORMATTER xy( m_out );
+            bool         compact = ADVANCED_CFG::GetCfg().m_CompactSave;
+
+            xy.Print( aNestLevel, "(fp_poly (pts" );
 
             for( int ii = 0; ii < pointsCount;  ++ii )
             {
                 int nestLevel = 0;
 
-                if( ii && ( !( ii%4 ) || !ADVANCED_CFG::GetCfg().m_CompactSave ) )   // newline every 4 pts
+                if( ii && ( !( ii%4 ) || !compact ) )   // newline every 4 pts
                 {
                     nestLevel = aNestLevel + 1;
-                    m_out->Print( 0, "\n" );
+                    xy.Print( 0, "\n" );
                 }
 
-                m_out->Print( nestLevel, "%s(xy %s)",
-                              nestLevel ? "" : " ", FormatInternalUnits( outline.CPoint( ii ) ).c_str() );
+                if( !nestLevel )
+                    xy.Print( 0, " " );
+
+                xy.XY( nestLevel, outline.CPoint( ii ) );
             }
 
-            m_out->Print( 0, ")" );
+            xy.Print( 0, ")" );
+            xy.Flush();
         }
         else
         {
@@ -1490,7 +1795,10 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
                     break;      // Malformed polygon.
 
                 {
-                m_out->Print( nested_level, "(gr_poly (pts\n");
+                XY_FORMATTER xy( m_out );
+                bool         compact = ADVANCED_CFG::GetCfg().m_CompactSave;
+
+                xy.Print( nested_level, "(gr_poly (pts\n");
 
                 // Write the polygon corners coordinates:
                 int newLine = 0;
@@ -1498,19 +1806,24 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
                 for( const VECTOR2I &pt : primitive->GetPolyShape().COutline( 0 ).CPoints() )
                 {
                     if( newLine == 0 )
-                        m_out->Print( nested_level+1, "(xy %s)",
-                                      FormatInternalUnits( (wxPoint) pt ).c_str() );
+                    {
+                        xy.XY( nested_level+1, pt );
+                    }
                     else
-                        m_out->Print( 0, " (xy %s)",
-                                      FormatInternalUnits( (wxPoint) pt ).c_str() );
+                    {
+                        xy.Print( 0, " " );
+                        xy.XY( 0, pt );
+                    }
 
-                    if( ++newLine > 4 || !ADVANCED_CFG::GetCfg().m_CompactSave )
+                    if( ++newLine > 4 || !compact )
                     {
                         newLine = 0;
-                        m_out->Print( 0, "\n" );
+                        xy.Print( 0, "\n" );
                     }
                 }
 
+                xy.Flush();
+
                 m_out->Print( 0, ") (width %s))", FormatInternalUnits( primitive->GetWidth() ).c_str() );
                 }
                 break;
@@ -1635,6 +1948,29 @@ void PCB_IO::format( TEXTE_MODULE* aText, int aNestLevel ) const
 
 void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
 {
+    // Boards have a lot of tracks: the line is put together here and written at once,
+    // rather than with several Print() calls.
+    std::string line;
+    char        buf[64];
+
+    auto addCoords =
+            [&]( const char* aKeyword, int aX, int aY )
+            {
+                line += aKeyword;
+                line.append( buf, FormatInternalUnits( aX, aY, buf ) );
+                line += ')';
+            };
+
+    auto addValue =
+            [&]( const char* aKeyword, int aValue )
+            {
+                line += aKeyword;
+                line.append( buf, FormatInternalUnits( aValue, buf ) );
+                line += ')';
+            };
+
+    line.append( 2 * aNestLevel, ' ' );     // Same as OUTPUTFORMATTER::Print()
+
     if( aTrack->Type() == PCB_VIA_T )
     {
         PCB_LAYER_ID  layer1, layer2;
@@ -1645,7 +1981,7 @@ void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
         wxCHECK_RET( board != 0, wxT( "Via " ) + via->GetSelectMenuText( EDA_UNITS::MILLIMETRES )
                                          + wxT( " has no parent." ) );
 
-        m_out->Print( aNestLevel, "(via" );
+        line += "(via";
 
         via->LayerPair( &layer1, &layer2 );
 
@@ -1655,66 +1991,75 @@ void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
             break;
 
         case VIATYPE::BLIND_BURIED:
-            m_out->Print( 0, " blind" );
+            line += " blind";
             break;
 
         case VIATYPE::MICROVIA:
-            m_out->Print( 0, " micro" );
+            line += " micro";
             break;
 
         default:
             THROW_IO_ERROR( wxString::Format( _( "unknown via type %d"  ), via->GetViaType() ) );
         }
 
-        m_out->Print( 0, " (at %s) (size %s)",
-                      FormatInternalUnits( aTrack->GetStart() ).c_str(),
-                      FormatInternalUnits( aTrack->GetWidth() ).c_str() );
+        addCoords( " (at ", aTrack->GetStart().x, aTrack->GetStart().y );
+        addValue( " (size ", aTrack->GetWidth() );
 
         if( via->GetDrill() != UNDEFINED_DRILL_DIAMETER )
-            m_out->Print( 0, " (drill %s)", FormatInternalUnits( via->GetDrill() ).c_str() );
+            addValue( " (drill ", via->GetDrill() );
 
-        m_out->Print( 0, " (layers %s %s)",
-                      m_out->Quotew( LSET::Name( layer1 ) ).c_str(),
-                      m_out->Quotew( LSET::Name( layer2 ) ).c_str() );
+        line += " (layers ";
+        line += m_out->Quotew( LSET::Name( layer1 ) );
+        line += ' ';
+        line += m_out->Quotew( LSET::Name( layer2 ) );
+        line += ')';
 
         if( via->GetRemoveUnconnected() )
         {
-            m_out->Print( 0, " (remove_unused_layers)" );
+            line += " (remove_unused_layers)";
 
             if( via->GetKeepTopBottom() )
-                m_out->Print( 0, " (keep_end_layers)" );
+                line += " (keep_end_layers)";
         }
     }
     else if( aTrack->Type() == PCB_ARC_T )
     {
         const ARC* arc = static_cast<const ARC*>( aTrack );
 
-        m_out->Print( aNestLevel, "(arc (start %s) (mid %s) (end %s) (width %s)",
-                FormatInternalUnits( arc->GetStart() ).c_str(),
-                FormatInternalUnits( arc->GetMid() ).c_str(),
-                FormatInternalUnits( arc->GetEnd() ).c_str(),
-                FormatInternalUnits( arc->GetWidth() ).c_str() );
+        addCoords( "(arc (start ", arc->GetStart().x, arc->GetStart().y );
+        addCoords( " (mid ", arc->GetMid().x, arc->GetMid().y );
+        addCoords( " (end ", arc->GetEnd().x, arc->GetEnd().y );
+        addValue( " (width ", arc->GetWidth() );
 
-        m_out->Print( 0, " (layer %s)", m_out->Quotew( LSET::Name( arc->GetLayer() ) ).c_str() );
+        line += " (layer ";
+        line += m_out->Quotew( LSET::Name( arc->GetLayer() ) );
+        line += ')';
     }
     else
     {
-        m_out->Print( aNestLevel, "(segment (start %s) (end %s) (width %s)",
-                      FormatInternalUnits( aTrack->GetStart() ).c_str(),
-                      FormatInternalUnits( aTrack->GetEnd() ).c_str(),
-                      FormatInternalUnits( aTrack->GetWidth() ).c_str() );
+        addCoords( "(segment (start ", aTrack->GetStart().x, aTrack->GetStart().y );
+        addCoords( " (end ", aTrack->GetEnd().x, aTrack->GetEnd().y );
+        addValue( " (width ", aTrack->GetWidth() );
 
-        m_out->Print( 0, " (layer %s)", m_out->Quotew( LSET::Name( aTrack->GetLayer() ) ).c_str() );
+        line += " (layer ";
+        line += m_out->Quotew( LSET::Name( aTrack->GetLayer() ) );
+        line += ')';
     }
 
     if( aTrack->IsLocked() )
-        m_out->Print( 0, " (locked)" );
+        line += " (locked)";
 
-    m_out->Print( 0, " (net %d)", m_mapping->Translate( aTrack->GetNetCode() ) );
+    line += " (net ";
+    line += std::to_string( m_mapping->Translate( aTrack->GetNetCode() ) );
+    line += ')';
 
-    m_out->Print( 0, " (tstamp %s)", TO_UTF8( aTrack->m_Uuid.AsString() ) );
+    line += " (tstamp ";
+    line += TO_UTF8( aTrack->m_Uuid.AsString() );
+    line += ")";
 
-    m_out->Print( 0, ")\n" );
+    line += ")\n";
+
+    m_out->Append( line );
 }
 
 
@@ -1873,7 +2218,9 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
     m_out->Print( 0, ")\n" );
 
-    int newLine = 0;
+    XY_FORMATTER xy( m_out );
+    bool         compact = ADVANCED_CFG::GetCfg().m_CompactSave;
+    int          newLine = 0;
 
     if( aZone->GetNumCorners() )
     {
@@ -1885,29 +2232,30 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
             if( new_polygon )
             {
                 newLine = 0;
-                m_out->Print( aNestLevel+1, "(polygon\n" );
-                m_out->Print( aNestLevel+2, "(pts\n" );
+                xy.Print( aNestLevel+1, "(polygon\n" );
+                xy.Print( aNestLevel+2, "(pts\n" );
                 new_polygon = false;
                 is_closed = false;
             }
 
             if( newLine == 0 )
-                m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FormatInternalUnits( iterator->x ).c_str(),
-                              FormatInternalUnits( iterator->y ).c_str() );
+            {
+                xy.XY( aNestLevel+3, *iterator );
+            }
             else
-                m_out->Print( 0, " (xy %s %s)",
-                              FormatInternalUnits( iterator->x ).c_str(),
-                              FormatInternalUnits( iterator->y ).c_str() );
+            {
+                xy.Print( 0, " " );
+                xy.XY( 0, *iterator );
+            }
 
-            if( newLine < 4 && ADVANCED_CFG::GetCfg().m_CompactSave )
+            if( newLine < 4 && compact )
             {
                 newLine += 1;
             }
             else
             {
                 newLine = 0;
-                m_out->Print( 0, "\n" );
+                xy.Print( 0, "\n" );
             }
 
             if( iterator.IsEndContour() )
@@ -1915,10 +2263,10 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
                 is_closed = true;
 
                 if( newLine != 0 )
-                    m_out->Print( 0, "\n" );
+                    xy.Print( 0, "\n" );
 
-                m_out->Print( aNestLevel+2, ")\n" );
-                m_out->Print( aNestLevel+1, ")\n" );
+                xy.Print( aNestLevel+2, ")\n" );
+                xy.Print( aNestLevel+1, ")\n" );
                 new_polygon = true;
             }
         }
@@ -1926,15 +2274,17 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         if( !is_closed )    // Should not happen, but...
         {
             if( newLine != 0 )
-                m_out->Print( 0, "\n" );
+                xy.Print( 0, "\n" );
 
-            m_out->Print( aNestLevel+2, ")\n" );
-            m_out->Print( aNestLevel+1, ")\n" );
+            xy.Print( aNestLevel+2, ")\n" );
+            xy.Print( aNestLevel+1, ")\n" );
         }
     }
 
     // Save the PolysList (filled areas)
-    for( PCB_LAYER_ID layer : aZone->GetLayerSet().Seq() )
+    bool omitFill = ( m_ctl & CTL_OMIT_FILLS ) && aZone->Type() == PCB_ZONE_AREA_T;
+
+    for( PCB_LAYER_ID layer : omitFill ? LSEQ() : aZone->GetLayerSet().Seq() )
     {
         const SHAPE_POLY_SET& fv = aZone->GetFilledPolysList( layer );
         newLine                  = 0;
@@ -1945,40 +2295,45 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
             bool new_polygon = true;
             bool is_closed   = false;
 
+            std::string layerLine = "(layer ";
+            layerLine += TO_UTF8( BOARD::GetStandardLayerName( layer ) );
+            layerLine += ")\n";
+
             for( auto it = fv.CIterate(); it; ++it )
             {
                 if( new_polygon )
                 {
                     newLine = 0;
-                    m_out->Print( aNestLevel + 1, "(filled_polygon\n" );
-                    m_out->Print( aNestLevel + 2, "(layer %s)\n",
-                            TO_UTF8( BOARD::GetStandardLayerName( layer ) ) );
+                    xy.Print( aNestLevel + 1, "(filled_polygon\n" );
+                    xy.Print( aNestLevel + 2, layerLine.c_str() );
 
                     if( aZone->IsIsland( layer, poly_index ) )
-                        m_out->Print( aNestLevel + 2, "(island)\n" );
+                        xy.Print( aNestLevel + 2, "(island)\n" );
 
-                    m_out->Print( aNestLevel + 2, "(pts\n" );
+                    xy.Print( aNestLevel + 2, "(pts\n" );
                     new_polygon = false;
                     is_closed   = false;
                     poly_index++;
                 }
 
                 if( newLine == 0 )
-                    m_out->Print( aNestLevel + 3, "(xy %s %s)",
-                            FormatInternalUnits( it->x ).c_str(),
-                            FormatInternalUnits( it->y ).c_str() );
+                {
+                    xy.XY( aNestLevel + 3, *it );
+                }
                 else
-                    m_out->Print( 0, " (xy %s %s)", FormatInternalUnits( it->x ).c_str(),
-                            FormatInternalUnits( it->y ).c_str() );
+                {
+                    xy.Print( 0, " " );
+                    xy.XY( 0, *it );
+                }
 
-                if( newLine < 4 && ADVANCED_CFG::GetCfg().m_CompactSave )
+                if( newLine < 4 && compact )
                 {
                     newLine += 1;
                 }
                 else
                 {
                     newLine = 0;
-                    m_out->Print( 0, "\n" );
+                    xy.Print( 0, "\n" );
                 }
 
                 if( it.IsEndContour() )
@@ -1986,18 +2341,20 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
                     is_closed = true;
 
                     if( newLine != 0 )
-                        m_out->Print( 0, "\n" );
+                        xy.Print( 0, "\n" );
 
-                    m_out->Print( aNestLevel + 2, ")\n" );
-                    m_out->Print( aNestLevel + 1, ")\n" );
+                    xy.Print( aNestLevel + 2, ")\n" );
+                    xy.Print( aNestLevel + 1, ")\n" );
                     new_polygon = true;
                 }
             }
 
             if( !is_closed ) // Should not happen, but...
-                m_out->Print( aNestLevel + 1, ")\n" );
+                xy.Print( aNestLevel + 1, ")\n" );
         }
 
+        xy.Flush();
+
         // Save the filling segments list
         const auto& segs = aZone->FillSegments( layer );
 
@@ -2018,6 +2375,8 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         }
     }
 
+    xy.Flush();
+
     m_out->Print( aNestLevel, ")\n" );
 }
 
@@ -2043,9 +2402,22 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER reader( aFileName );
+    TRACE_ZONE( "PCB_IO::Load", "io" );
 
-    BOARD* board = DoLoad( reader, aAppendToMe, aProperties );
+    // The snapshot only replaces a whole board
+    bool           useSnapshot = !aAppendToMe && ADVANCED_CFG::GetCfg().m_BoardSnapshots;
+    BOARD_SNAPSHOT snapshot( useSnapshot ? aFileName : wxString() );
+    BOARD*         board = useSnapshot ? snapshot.Load() : nullptr;
+
+    if( !board )
+    {
+        MMAP_LINE_READER reader( aFileName );
+
+        board = DoLoad( reader, aAppendToMe, aProperties );
+
+        if( useSnapshot && m_parser->GetRequiredVersion() == SEXPR_BOARD_FILE_VERSION )
+            snapshot.Save( board );
+    }
 
     // Give the filename to the board if it's new
     if( !aAppendToMe )
@@ -2117,6 +2489,7 @@ void PCB_IO::validateCache( const wxString& aLibraryPath, bool checkModified )
 void PCB_IO::FootprintEnumerate( wxArrayString& aFootprintNames, const wxString& aLibPath,
                                  bool aBestEfforts, const PROPERTIES* aProperties )
 {
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
     LOCALE_IO toggle;     // toggles on, then off, the C locale.
     wxDir     dir( aLibPath );
     wxString  errorMsg;
@@ -2143,6 +2516,34 @@ void PCB_IO::FootprintEnumerate( wxArrayString& aFootprintNames, const wxString&
 }
 
 
+void PCB_IO::FootprintEnumerateInfo( std::vector<FOOTPRINT_INDEX_ENTRY>& aFootprints,
+                                     const wxString& aLibPath, bool aBestEfforts,
+                                     const PROPERTIES* aProperties )
+{
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
+    LOCALE_IO                   toggle;     // toggles on, then off, the C locale.
+    wxString  errorMsg;
+
+    init( aProperties );
+
+    try
+    {
+        validateCache( aLibPath );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        errorMsg = ioe.What();
+    }
+
+    // The footprints listed from the library index are not parsed
+    for( MODULE_CITER it = m_cache->GetModules().begin(); it != m_cache->GetModules().end(); ++it )
+        aFootprints.push_back( it->second->GetInfo() );
+
+    if( !errorMsg.IsEmpty() && !aBestEfforts )
+        THROW_IO_ERROR( errorMsg );
+}
+
+
 const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
                                     const wxString& aFootprintName,
                                     const PROPERTIES* aProperties,
@@ -2161,14 +2562,7 @@ const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
         // do nothing with the error
     }
 
-    const MODULE_MAP& mods = m_cache->GetModules();
-
-    MODULE_CITER it = mods.find( aFootprintName );
-
-    if( it == mods.end() )
-        return nullptr;
-
-    return it->second->GetModule();
+    return m_cache->GetModule( aFootprintName );
 }
 
 
@@ -2176,6 +2570,8 @@ const MODULE* PCB_IO::GetEnumeratedFootprint( const wxString& aLibraryPath,
                                               const wxString& aFootprintName,
                                               const PROPERTIES* aProperties )
 {
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
+
     return getFootprint( aLibraryPath, aFootprintName, aProperties, false );
 }
 
@@ -2199,6 +2595,8 @@ bool PCB_IO::FootprintExists( const wxString& aLibraryPath, const wxString& aFoo
 MODULE* PCB_IO::FootprintLoad( const wxString& aLibraryPath, const wxString& aFootprintName,
                                const PROPERTIES* aProperties )
 {
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
+
     const MODULE* footprint = getFootprint( aLibraryPath, aFootprintName, aProperties, true );
     return footprint ? (MODULE*) footprint->Duplicate() : nullptr;
 }
@@ -2207,6 +2605,7 @@ MODULE* PCB_IO::FootprintLoad( const wxString& aLibraryPath, const wxString& aFo
 void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootprint,
                             const PROPERTIES* aProperties )
 {
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
     LOCALE_IO   toggle;     // toggles on, then off, the C locale.
 
     init( aProperties );
@@ -2311,6 +2710,7 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
 void PCB_IO::FootprintDelete( const wxString& aLibraryPath, const wxString& aFootprintName,
                               const PROPERTIES* aProperties )
 {
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
     LOCALE_IO   toggle;     // toggles on, then off, the C locale.
 
     init( aProperties );
@@ -2342,6 +2742,7 @@ void PCB_IO::FootprintLibCreate( const wxString& aLibraryPath, const PROPERTIES*
                                           aLibraryPath.GetData() ) );
     }
 
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
     LOCALE_IO   toggle;
 
     init( aProperties );
@@ -2417,6 +2818,8 @@ bool PCB_IO::FootprintLibDelete( const wxString& aLibraryPath, const PROPERTIES*
     wxMilliSleep( 250L );
 #endif
 
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
+
     if( m_cache && !m_cache->IsPath( aLibraryPath ) )
     {
         delete m_cache;
@@ -2429,6 +2832,7 @@ bool PCB_IO::FootprintLibDelete( const wxString& aLibraryPath, const PROPERTIES*
 
 bool PCB_IO::IsFootprintLibWritable( const wxString& aLibraryPath )
 {
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
     LOCALE_IO   toggle;
 
     init( NULL );
@@ -26,6 +26,7 @@
 #define KICAD_PLUGIN_H_
 
 #include <io_mgr.h>
+#include <mutex>
 #include <string>
 #include <layers_id_colors_and_visibility.h>
 
@@ -101,6 +102,8 @@ class TEXTE_PCB;
                                                 // (always saved with potion 0,0 and rotation = 0 in library)
 //#define CTL_OMIT_HIDE             (1 << 6)    // found and defined in eda_text.h
 #define CTL_OMIT_LIBNAME            (1 << 7)    ///< Omit lib alias when saving (used for board/not library)
+#define CTL_OMIT_TRACKS             (1 << 8)    ///< Omit tracks and vias (kept in a board snapshot)
+#define CTL_OMIT_FILLS              (1 << 9)    ///< Omit board zone fills (kept in a board snapshot)
 
 
 // common combinations of the above:
@@ -115,16 +118,21 @@ class TEXTE_PCB;
 /// a BOARD file underneath IO_MGR.
 #define CTL_FOR_BOARD               (CTL_OMIT_INITIAL_COMMENTS)
 
+/// Format the text part of a board snapshot (see BOARD_SNAPSHOT)
+#define CTL_FOR_SNAPSHOT            (CTL_FOR_BOARD|CTL_OMIT_TRACKS|CTL_OMIT_FILLS)
+
 
 /**
  * PCB_IO
  * is a PLUGIN derivation for saving and loading Pcbnew s-expression formatted files.
  *
- * @note This class is not thread safe, but it is re-entrant multiple times in sequence.
+ * @note The footprint library functions can be called by several threads at the same time.
+ * The board functions are not thread safe, but are re-entrant multiple times in sequence.
  */
 class PCB_IO : public PLUGIN
 {
     friend class FP_CACHE;
+    friend class BOARD_SNAPSHOT;
 
 public:
 
@@ -155,6 +163,10 @@ public:
     void FootprintEnumerate( wxArrayString& aFootprintNames, const wxString& aLibraryPath,
                              bool aBestEfforts, const PROPERTIES* aProperties = NULL ) override;
 
+    void FootprintEnumerateInfo( std::vector<FOOTPRINT_INDEX_ENTRY>& aFootprints,
+                                 const wxString& aLibraryPath, bool aBestEfforts,
+                                 const PROPERTIES* aProperties = NULL ) override;
+
     const MODULE* GetEnumeratedFootprint( const wxString& aLibraryPath,
                                           const wxString& aFootprintName,
                                           const PROPERTIES* aProperties = NULL ) override;
@@ -217,6 +229,7 @@ protected:
     const
     PROPERTIES*     m_props;        ///< passed via Save() or Load(), no ownership, may be NULL.
     FP_CACHE*       m_cache;        ///< Footprint library cache.
+    std::mutex      m_cacheMutex;   ///< Held by the footprint library functions
 
     LINE_READER*    m_reader;       ///< no ownership here.
     wxString        m_filename;     ///< for saves only, name is in m_reader for loads
@@ -230,6 +243,7 @@ protected:
     NETINFO_MAPPING*    m_mapping;  ///< mapping for net codes, so only not empty net codes
                                     ///< are stored with consecutive integers as net codes
 
+    /// Called with m_cacheMutex held, as getFootprint()
     void validateCache( const wxString& aLibraryPath, bool checkModified = true );
 
     const MODULE* getFootprint( const wxString& aLibraryPath, const wxString& aFootprintName,
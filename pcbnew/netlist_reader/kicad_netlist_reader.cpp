@@ -561,3 +561,197 @@ void KICAD_NETLIST_PARSER::parseLibPartList()
 
     }
 }
+
+
+// KICAD_NETLIST_BUILDER
+bool KICAD_NETLIST_BUILDER::isCurrent( const char* aName, const char* aParent ) const
+{
+    size_t depth = m_path.size();
+
+    return depth >= 2 && m_path[depth - 1] == aName && m_path[depth - 2] == aParent;
+}
+
+
+void KICAD_NETLIST_BUILDER::Open( const char* aName )
+{
+    m_path.emplace_back( aName );
+
+    if( isCurrent( "comp", "components" ) )
+    {
+        m_ref.Clear();
+        m_value.Clear();
+        m_footprint.Clear();
+        m_library.Clear();
+        m_name.Clear();
+        m_sheetPath.clear();
+        m_uuid.Clear();
+        m_properties.clear();
+    }
+    else if( isCurrent( "property", "comp" ) )
+    {
+        m_propName.Clear();
+        m_propValue.Clear();
+    }
+    else if( isCurrent( "libpart", "libparts" ) )
+    {
+        m_library.Clear();
+        m_name.Clear();
+        m_footprintFilters.Clear();
+        m_pinCount = 0;
+    }
+    else if( isCurrent( "pin", "pins" ) )
+    {
+        m_pinCount++;
+    }
+    else if( isCurrent( "net", "nets" ) )
+    {
+        m_netCode.Clear();
+        m_netName.Clear();
+    }
+    else if( isCurrent( "node", "net" ) )
+    {
+        m_ref.Clear();
+        m_pinNumber.Clear();
+        m_pinFunction.Clear();      // By default: no pin function.
+    }
+}
+
+
+void KICAD_NETLIST_BUILDER::Attribute( const char* aName, const wxString& aValue )
+{
+    if( m_path.empty() )
+        return;
+
+    const std::string& current = m_path.back();
+    const std::string  name = aName;
+
+    if( current == "comp" || current == "node" )
+    {
+        if( name == "ref" )
+            m_ref = aValue;
+        else if( name == "pin" )
+            m_pinNumber = aValue;
+        else if( name == "pinfunction" )
+            m_pinFunction = aValue;
+    }
+    else if( current == "libsource" || current == "libpart" )
+    {
+        if( name == "lib" )
+            m_library = aValue;
+        else if( name == "part" )
+            m_name = aValue;
+    }
+    else if( current == "property" )
+    {
+        if( name == "name" )
+            m_propName = aValue;
+        else if( name == "value" )
+            m_propValue = aValue;
+    }
+    else if( current == "sheetpath" )
+    {
+        if( name == "tstamps" )
+            m_sheetPath = KIID_PATH( aValue );
+    }
+    else if( current == "net" )
+    {
+        if( name == "code" )
+        {
+            m_netCode = aValue;
+        }
+        else if( name == "name" )
+        {
+            m_netName = aValue;
+
+            if( m_netName.IsEmpty() )      // Give a dummy net name like N-000109
+                m_netName = wxT( "N-00000" ) + m_netCode;
+        }
+    }
+}
+
+
+void KICAD_NETLIST_BUILDER::Text( const wxString& aText )
+{
+    if( isCurrent( "value", "comp" ) )
+        m_value = aText;
+    else if( isCurrent( "footprint", "comp" ) )
+        m_footprint = aText;
+    else if( isCurrent( "tstamp", "comp" ) )
+        m_uuid = aText;
+    else if( isCurrent( "fp", "footprints" ) )
+        m_footprintFilters.Add( aText );
+}
+
+
+void KICAD_NETLIST_BUILDER::Close()
+{
+    if( isCurrent( "comp", "components" ) )
+    {
+        LIB_ID fpid;
+
+        if( !m_footprint.IsEmpty() && fpid.Parse( m_footprint, LIB_ID::ID_PCB, true ) >= 0 )
+        {
+            if( m_error.IsEmpty() )
+                m_error.Printf( _( "Invalid footprint ID \"%s\" in netlist." ), m_footprint );
+        }
+        else
+        {
+            KIID_PATH path = m_sheetPath;
+            path.push_back( KIID( m_uuid ) );
+
+            COMPONENT* component = new COMPONENT( fpid, m_ref, m_value, path );
+            component->SetName( m_name );
+            component->SetLibrary( m_library );
+            component->SetProperties( m_properties );
+            m_netlist->AddComponent( component );
+
+            // The first component wins, as in NETLIST::GetComponentByReference()
+            m_componentsByRef.emplace( m_ref, component );
+            m_componentsByLibSource[ std::make_pair( m_library, m_name ) ].push_back( component );
+        }
+    }
+    else if( isCurrent( "property", "comp" ) )
+    {
+        if( !m_propName.IsEmpty() )
+            m_properties[ m_propName ] = m_propValue;
+    }
+    else if( isCurrent( "libpart", "libparts" ) )
+    {
+        // Set up all of the components that reference this component library part definition.
+        auto it = m_componentsByLibSource.find( std::make_pair( m_library, m_name ) );
+
+        if( it != m_componentsByLibSource.end() )
+        {
+            for( COMPONENT* component : it->second )
+            {
+                component->SetFootprintFilters( m_footprintFilters );
+                component->SetPinCount( m_pinCount );
+            }
+        }
+    }
+    else if( isCurrent( "node", "net" ) )
+    {
+        auto it = m_componentsByRef.find( m_ref );
+
+        // Cannot happen if the netlist is valid.
+        if( it == m_componentsByRef.end() )
+        {
+            if( m_error.IsEmpty() )
+            {
+                m_error.Printf( _( "Cannot find component with reference designator \"%s\" "
+                                   "in netlist." ),
+                                m_ref );
+            }
+        }
+        else
+        {
+            it->second->AddNet( m_pinNumber, m_netName, m_pinFunction );
+        }
+    }
+    else if( m_path.size() == 1 && m_path[0] == "export" )
+    {
+        m_exported = true;
+    }
+
+    m_path.pop_back();
+}
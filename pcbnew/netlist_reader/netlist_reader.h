@@ -30,6 +30,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include <boost/ptr_container/ptr_vector.hpp>
 
 #include <fctsys.h>
@@ -37,6 +41,8 @@
 #include <lib_id.h>
 
 #include <netlist_lexer.h>    // netlist_lexer is common to Eeschema and Pcbnew
+#include <netlist_writer.h>
+#include <common.h>      // KIID_PATH
 
 
 class NETLIST;
@@ -402,4 +408,74 @@ public:
 };
 
 
+/**
+ * KICAD_NETLIST_BUILDER
+ * fills a NETLIST with the elements of a KiCad netlist as they are written, so the netlist
+ * exported by Eeschema can be used without formatting it to text and parsing it again.
+ *
+ * It reads the same information as KICAD_NETLIST_PARSER.  Errors don't interrupt the
+ * writer, which may belong to another kiface: they are reported by GetError() afterwards.
+ */
+class KICAD_NETLIST_BUILDER : public NETLIST_WRITER
+{
+public:
+    KICAD_NETLIST_BUILDER( NETLIST* aNetlist ) :
+        m_netlist( aNetlist ),
+        m_exported( false ),
+        m_pinCount( 0 )
+    {
+    }
+
+    void Open( const char* aName ) override;
+    void Attribute( const char* aName, const wxString& aValue ) override;
+    void Text( const wxString& aText ) override;
+    void Close() override;
+
+    /**
+     * @return the first error found in the netlist, or an empty string if there was none.
+     */
+    const wxString& GetError() const { return m_error; }
+
+    /**
+     * @return true once the whole "export" root element was written, false if nothing was
+     *         (Eeschema not running, or not ready to export a netlist).
+     */
+    bool IsExported() const { return m_exported; }
+
+private:
+    bool isCurrent( const char* aName, const char* aParent ) const;
+
+    NETLIST*                      m_netlist;
+    std::vector<std::string>      m_path;           ///< Names of the open elements
+    wxString                      m_error;
+    bool                          m_exported;       ///< The root element was closed
+
+    ///> Components by reference and by library source, for the nets and the libparts
+    std::map<wxString, COMPONENT*>                                  m_componentsByRef;
+    std::map<std::pair<wxString, wxString>, std::vector<COMPONENT*>> m_componentsByLibSource;
+
+    // The component being read
+    wxString                      m_ref;
+    wxString                      m_value;
+    wxString                      m_footprint;
+    wxString                      m_library;
+    wxString                      m_name;
+    KIID_PATH                     m_sheetPath;
+    wxString                      m_uuid;
+    std::map<wxString, wxString>  m_properties;
+    wxString                      m_propName;
+    wxString                      m_propValue;
+
+    // The library part being read
+    wxArrayString                 m_footprintFilters;
+    int                           m_pinCount;
+
+    // The net and the node being read
+    wxString                      m_netCode;
+    wxString                      m_netName;
+    wxString                      m_pinNumber;
+    wxString                      m_pinFunction;
+};
+
+
 #endif   // NETLIST_READER_H
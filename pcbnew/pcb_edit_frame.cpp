@@ -1374,17 +1374,19 @@ bool PCB_EDIT_FRAME::FetchNetlistFromSchematic( NETLIST& aNetlist, FETCH_NETLIST
     else if( aMode == QUIET_ANNOTATION )
         payload = "quiet-annotate";
 
-    Kiway().ExpressMail( FRAME_SCH, MAIL_SCH_GET_NETLIST, payload, this );
+    // Let Eeschema fill the netlist directly, rather than formatting it for us to parse it
+    KICAD_NETLIST_BUILDER netlistBuilder( &aNetlist );
 
-    try
-    {
-        auto lineReader = new STRING_LINE_READER( payload, _( "Eeschema netlist" ) );
-        KICAD_NETLIST_READER netlistReader( lineReader, &aNetlist );
-        netlistReader.LoadNetlist();
-    }
-    catch( const IO_ERROR& )
+    Kiway().ExpressMail( FRAME_SCH, MAIL_SCH_GET_NETLIST, payload, this, &netlistBuilder );
+
+    // Eeschema writes nothing when it is not running, or when the schematic cannot be
+    // netlisted; it already told the user why in the latter case.
+    if( !netlistBuilder.IsExported() )
+        return false;
+
+    if( !netlistBuilder.GetError().IsEmpty() )
     {
-        assert( false ); // should never happen
+        wxFAIL_MSG( netlistBuilder.GetError() ); // should never happen
         return false;
     }
 
@@ -27,11 +27,19 @@
  * @brief Pcbnew s-expression file format parser implementation.
  */
 
+#include <atomic>
 #include <cerrno>
+#include <cstring>
+#include <exception>
+#include <thread>
+
 #include <common.h>
 #include <confirm.h>
 #include <macros.h>
+#include <profile.h>
 #include <title_block.h>
+#include <trace_helpers.h>
+#include <trace_profiler.h>
 #include <trigo.h>
 
 #include <class_board.h>
@@ -135,8 +143,34 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 }
 
 
+///> Number of decimals of a length in millimeters that board units can represent
+static const int IU_DECIMALS = 6;
+
+static_assert( IU_PER_MM == 1e6, "IU_DECIMALS doesn't match IU_PER_MM" );
+
+///> Largest board unit value, see parseBoardUnits().  Values above it are clamped by the slow path
+static const long long BOARD_UNITS_LIMIT = std::numeric_limits<int>::max() * 0.7071;
+
+
+bool PCB_PARSER::fastBoardUnits( const char* aText, int& aResult )
+{
+    long long iu;
+
+    if( !ParseFixedPoint( aText, IU_DECIMALS, BOARD_UNITS_LIMIT, iu ) )
+        return false;
+
+    aResult = (int) iu;
+    return true;
+}
+
+
 double PCB_PARSER::parseDouble()
 {
+    double fastValue;
+
+    if( m_fastPath && ParseDecimal( CurText(), fastValue ) )
+        return fastValue;
+
     char* tmp;
 
     errno = 0;
@@ -219,10 +253,16 @@ wxString PCB_PARSER::GetRequiredVersion()
 
 wxPoint PCB_PARSER::parseXY()
 {
+    wxPoint pt;
+
     if( CurTok() != T_LEFT )
+    {
+        if( nextXY( pt ) )
+            return pt;
+
         NeedLEFT();
+    }
 
-    wxPoint pt;
     T token = NextTok();
 
     if( token != T_xy )
@@ -237,6 +277,23 @@ wxPoint PCB_PARSER::parseXY()
 }
 
 
+bool PCB_PARSER::nextXY( wxPoint& aPoint )
+{
+    long long x;
+    long long y;
+
+    if( !m_fastPath
+            || !NextFixedPointPair( GetTokenText( T_xy ), IU_DECIMALS, BOARD_UNITS_LIMIT, x, y ) )
+    {
+        return false;
+    }
+
+    aPoint.x = (int) x;
+    aPoint.y = (int) y;
+    return true;
+}
+
+
 void PCB_PARSER::parseXY( int* aX, int* aY )
 {
     wxPoint pt = parseXY();
@@ -536,12 +593,9 @@ BOARD* PCB_PARSER::parseBOARD()
 }
 
 
-BOARD* PCB_PARSER::parseBOARD_unchecked()
+void PCB_PARSER::parseBoardSections( std::map<wxString, wxString>& aProperties )
 {
     T token;
-    std::map<wxString, wxString> properties;
-
-    parseHeader();
 
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
     {
@@ -553,92 +607,561 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         if( token == T_page && m_requiredVersion <= 20200119 )
             token = T_paper;
 
-        switch( token )
+        // The items are most of a board file, and can be parsed independently once the
+        // layers and nets are known
+        if( m_parallelLoad && isParallelItem( token ) && parseItemsInParallel( aProperties ) )
+            return;
+
+        parseBoardSection( token, aProperties );
+    }
+}
+
+
+void PCB_PARSER::parseBoardSection( T aToken, std::map<wxString, wxString>& aProperties )
+{
+    switch( aToken )
+    {
+    case T_general:
+        parseGeneralSection();
+        break;
+
+    case T_paper:
+        parsePAGE_INFO();
+        break;
+
+    case T_title_block:
+        parseTITLE_BLOCK();
+        break;
+
+    case T_layers:
+        parseLayers();
+        break;
+
+    case T_setup:
+        parseSetup();
+        break;
+
+    case T_property:
+        aProperties.insert( parseProperty() );
+        break;
+
+    case T_net:
+        parseNETINFO_ITEM();
+        break;
+
+    case T_net_class:
+        parseNETCLASS();
+        m_board->m_LegacyNetclassesLoaded = true;
+        break;
+
+    case T_group:
+        parseGROUP();
+        break;
+
+    default:
+        if( !isParallelItem( aToken ) )
         {
-        case T_general:
-            parseGeneralSection();
-            break;
+            wxString err;
+            err.Printf( _( "Unknown token \"%s\"" ), GetChars( FromUTF8() ) );
+            THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+        }
 
-        case T_paper:
-            parsePAGE_INFO();
-            break;
+        m_board->Add( parseBoardItem( aToken ), ADD_MODE::APPEND );
+    }
+}
 
-        case T_title_block:
-            parseTITLE_BLOCK();
-            break;
 
-        case T_layers:
-            parseLayers();
-            break;
+bool PCB_PARSER::isParallelItem( T aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_rect:
+    case T_gr_line:
+    case T_gr_poly:
+    case T_gr_text:
+    case T_dimension:
+    case T_module:
+    case T_segment:
+    case T_arc:
+    case T_via:
+    case T_zone:
+    case T_target:
+        return true;
 
-        case T_setup:
-            parseSetup();
-            break;
+    default:
+        return false;
+    }
+}
 
-        case T_property:
-            properties.insert( parseProperty() );
-            break;
 
-        case T_net:
-            parseNETINFO_ITEM();
-            break;
+BOARD_ITEM* PCB_PARSER::parseBoardItem( T aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_rect:
+    case T_gr_line:
+    case T_gr_poly:
+        return parseDRAWSEGMENT();
 
-        case T_net_class:
-            parseNETCLASS();
-            m_board->m_LegacyNetclassesLoaded = true;
-            break;
+    case T_gr_text:
+        return parseTEXTE_PCB();
 
-        case T_gr_arc:
-        case T_gr_circle:
-        case T_gr_curve:
-        case T_gr_rect:
-        case T_gr_line:
-        case T_gr_poly:
-            m_board->Add( parseDRAWSEGMENT(), ADD_MODE::APPEND );
-            break;
+    case T_dimension:
+        return parseDIMENSION();
 
-        case T_gr_text:
-            m_board->Add( parseTEXTE_PCB(), ADD_MODE::APPEND );
-            break;
+    case T_module:
+        return parseMODULE();
 
-        case T_dimension:
-            m_board->Add( parseDIMENSION(), ADD_MODE::APPEND );
-            break;
+    case T_segment:
+        return parseTRACK();
 
-        case T_module:
-            m_board->Add( parseMODULE(), ADD_MODE::APPEND );
-            break;
+    case T_arc:
+        return parseARC();
 
-        case T_segment:
-            m_board->Add( parseTRACK(), ADD_MODE::APPEND );
-            break;
+    case T_via:
+        return parseVIA();
 
-        case T_arc:
-            m_board->Add( parseARC(), ADD_MODE::APPEND );
-            break;
+    case T_zone:
+        return parseZONE_CONTAINER( m_board );
+
+    case T_target:
+        return parsePCB_TARGET();
+
+    default:
+        return nullptr;
+    }
+}
+
+
+/**
+ * TEXT_RANGE_LINE_READER
+ * reads the lines of a part of a text, e.g. one section of a board file read in memory.
+ * The line numbers and offsets are the ones of the whole text, for the error messages.
+ */
+class TEXT_RANGE_LINE_READER : public LINE_READER
+{
+public:
+    /**
+     * @param aLineBegin is the offset of the line holding \a aBegin, which is line
+     *  \a aLineNumber of the text.
+     * @param aBegin is the offset of the first character to read.  The characters of the
+     *  first line before it are read as spaces.
+     * @param aEnd is the offset after the last character to read.
+     */
+    TEXT_RANGE_LINE_READER( const std::string& aText, size_t aLineBegin, size_t aBegin,
+                            size_t aEnd, unsigned aLineNumber, const wxString& aSource ) :
+            LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
+            m_text( aText ),
+            m_ndx( aLineBegin ),
+            m_begin( aBegin ),
+            m_end( aEnd )
+    {
+        m_source = aSource;
+        m_lineNum = aLineNumber - 1;
+    }
+
+    char* ReadLine() override
+    {
+        size_t nlOffset = m_text.find( '\n', m_ndx );
+
+        if( nlOffset == std::string::npos || nlOffset >= m_end )
+            m_length = m_end - m_ndx;
+        else
+            m_length = nlOffset - m_ndx + 1;     // include the newline, so +1
+
+        if( m_length )
+        {
+            if( m_length >= m_maxLineLength )
+                THROW_IO_ERROR( _( "Line length exceeded" ) );
+
+            if( m_length + 1 > m_capacity )   // +1 for terminating nul
+                expandCapacity( m_length + 1 );
+
+            memcpy( m_line, &m_text[m_ndx], m_length );
+
+            if( m_ndx < m_begin )
+                memset( m_line, ' ', std::min<size_t>( m_begin - m_ndx, m_length ) );
+
+            m_ndx += m_length;
+        }
+
+        ++m_lineNum;      // this gets incremented even if no bytes were read
+        m_line[m_length] = 0;
+
+        return m_length ? m_line : NULL;
+    }
+
+private:
+    const std::string& m_text;
+    size_t             m_ndx;
+    size_t             m_begin;
+    size_t             m_end;
+};
+
+
+///> A top level section of a board file read in memory
+struct BOARD_SECTION
+{
+    T        m_token;       ///< the keyword of the section
+    size_t   m_lineBegin;   ///< offset of the line of the opening parenthesis
+    size_t   m_begin;       ///< offset of the opening parenthesis
+    size_t   m_end;         ///< offset after the closing parenthesis
+    unsigned m_line;        ///< line number of the opening parenthesis
+};
 
-        case T_group:
-            parseGROUP();
-            break;
 
-        case T_via:
-            m_board->Add( parseVIA(), ADD_MODE::APPEND );
+void PCB_PARSER::shareBoardState( const PCB_PARSER& aParser )
+{
+    m_board           = aParser.m_board;
+    m_layerIndices    = aParser.m_layerIndices;
+    m_layerMasks      = aParser.m_layerMasks;
+    m_netCodes        = aParser.m_netCodes;
+    m_tooRecent       = aParser.m_tooRecent;
+    m_requiredVersion = aParser.m_requiredVersion;
+    m_resetKIIDs      = aParser.m_resetKIIDs;
+    m_fastPath        = aParser.m_fastPath;
+
+    m_deferBoardChanges = true;
+}
+
+
+void PCB_PARSER::mergeBoardState( PCB_PARSER& aWorker )
+{
+    m_undefinedLayers.insert( aWorker.m_undefinedLayers.begin(),
+                              aWorker.m_undefinedLayers.end() );
+    m_resetKIIDMap.insert( aWorker.m_resetKIIDMap.begin(), aWorker.m_resetKIIDMap.end() );
+
+    // Footprints may declare their own version
+    m_requiredVersion = std::max( m_requiredVersion, aWorker.m_requiredVersion );
+    m_tooRecent       = m_tooRecent || aWorker.m_tooRecent;
+}
+
+
+bool PCB_PARSER::parseItemsInParallel( std::map<wxString, wxString>& aProperties )
+{
+    // The opening parenthesis of the current item must be on the current line
+    const char* parenthesis = start + curOffset;
+
+    while( parenthesis > start && *parenthesis != '(' )
+        --parenthesis;
+
+    if( *parenthesis != '(' || std::thread::hardware_concurrency() < 2 )
+        return false;
+
+    TRACE_ZONE( "PCB_PARSER::parseItemsInParallel", "io" );
+    PROF_COUNTER timer;
+
+    // Read the rest of the file, from the beginning of the current line
+    const unsigned firstLine = CurLineNumber();
+    const wxString source = CurSource();
+    std::string    text( start, limit );
+    const size_t   firstItem = parenthesis - start;
+
+    while( reader->ReadLine() )
+        text.append( reader->Line(), reader->Length() );
+
+    // Find the top level sections, up to the end of the board.  The parenthesis in
+    // strings and comments are skipped as NextTok() does.
+    std::vector<BOARD_SECTION> sections;
+    bool                       complete = false;
+    int                        depth = 0;
+    unsigned                   line = firstLine;
+    size_t                     lineBegin = 0;
+    bool                       lineStart = false;   // only blanks since the line beginning
+    bool                       tokenStart = true;   // after a separator
+
+    for( size_t ii = firstItem; ii < text.size() && !complete; ++ii )
+    {
+        const char cc = text[ii];
+
+        switch( cc )
+        {
+        case '\n':
+            ++line;
+            lineBegin = ii + 1;
+            lineStart = true;
+            tokenStart = true;
+            continue;
+
+        case ' ':
+        case '\r':
+        case '\t':
+        case '\0':
+            tokenStart = true;
+            continue;
+
+        case '(':
+            if( depth++ == 0 )
+            {
+                size_t kwEnd = ii + 1;
+
+                while( kwEnd < text.size() && !strchr( " \t\r\n()", text[kwEnd] )
+                        && text[kwEnd] != '\0' )
+                {
+                    ++kwEnd;
+                }
+
+                std::string keyword( text, ii + 1, kwEnd - ii - 1 );
+
+                sections.push_back( { (T) findToken( keyword ), lineBegin, ii, 0, line } );
+            }
+
+            tokenStart = true;
             break;
 
-        case T_zone:
-            m_board->Add( parseZONE_CONTAINER( m_board ), ADD_MODE::APPEND );
+        case ')':
+            if( depth == 0 )
+                complete = true;            // end of the board
+            else if( --depth == 0 )
+                sections.back().m_end = ii + 1;
+
+            tokenStart = true;
             break;
 
-        case T_target:
-            m_board->Add( parsePCB_TARGET(), ADD_MODE::APPEND );
+        case '#':
+            if( lineStart && !commentsAreTokens )
+            {
+                ii = std::min( text.find( '\n', ii ), text.size() ) - 1;
+                continue;
+            }
+
+            tokenStart = false;
             break;
 
+        case '"':
+            if( tokenStart )
+            {
+                // Strings end on the same line, after any escaped character
+                for( ++ii; ii < text.size() && text[ii] != '"'; ++ii )
+                {
+                    if( text[ii] == '\\' )
+                        ++ii;
+
+                    if( ii < text.size() && text[ii] == '\n' )
+                    {
+                        ii = text.size();
+                        break;
+                    }
+                }
+
+                if( ii >= text.size() )
+                    depth = -1;             // un-terminated string
+
+                tokenStart = false;
+                break;
+            }
+
+            KI_FALLTHROUGH;
+
         default:
-            wxString err;
-            err.Printf( _( "Unknown token \"%s\"" ), GetChars( FromUTF8() ) );
-            THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+            // Only sections are expected between the sections
+            if( depth == 0 )
+                depth = -1;
+
+            tokenStart = false;
+        }
+
+        if( depth < 0 )
+            break;
+
+        lineStart = false;
+    }
+
+    if( !complete || depth < 0 )
+    {
+        // Let the lexer find and report the error
+        TEXT_RANGE_LINE_READER rest( text, 0, firstItem, text.size(), firstLine, source );
+
+        PushReader( &rest );
+        m_parallelLoad = false;
+
+        try
+        {
+            parseBoardSections( aProperties );
+        }
+        catch( ... )
+        {
+            PopReader();
+            m_parallelLoad = true;
+            throw;
+        }
+
+        PopReader();
+        m_parallelLoad = true;
+        return true;
+    }
+
+    for( size_t ii = 0; ii < sections.size(); )
+    {
+        // A run of items is parsed by the loader threads, any other section here
+        size_t runEnd = ii;
+
+        while( runEnd < sections.size() && isParallelItem( sections[runEnd].m_token ) )
+            ++runEnd;
+
+        if( runEnd > ii )
+        {
+            parseItemRun( text, source, sections, ii, runEnd );
+            ii = runEnd;
+            continue;
+        }
+
+        const BOARD_SECTION&   section = sections[ii++];
+        TEXT_RANGE_LINE_READER sectionReader( text, section.m_lineBegin, section.m_begin,
+                                              section.m_end, section.m_line, source );
+
+        PushReader( &sectionReader );
+
+        try
+        {
+            NeedLEFT();
+            T token = NextTok();
+
+            if( token == T_page && m_requiredVersion <= 20200119 )
+                token = T_paper;
+
+            parseBoardSection( token, aProperties );
+        }
+        catch( ... )
+        {
+            PopReader();
+            throw;
+        }
+
+        PopReader();
+    }
+
+    wxLogTrace( traceKicadPcbPlugin, wxT( "Parsed %d board sections in %.1f ms" ),
+                (int) sections.size(), timer.msecs() );
+
+    return true;
+}
+
+
+void PCB_PARSER::parseItemRun( const std::string& aText, const wxString& aSource,
+                               const std::vector<BOARD_SECTION>& aSections, size_t aBegin,
+                               size_t aEnd )
+{
+    struct ITEM_SLOT
+    {
+        BOARD_ITEM*        m_item = nullptr;
+        std::exception_ptr m_exception;
+        bool               m_legacySegmentFill = false;
+        std::vector<std::pair<ZONE_CONTAINER*, wxString>> m_zoneNets;
+    };
+
+    std::vector<ITEM_SLOT> slots( aEnd - aBegin );
+    std::atomic<size_t>    nextSlot( 0 );
+
+    size_t threadCount = std::min<size_t>( std::thread::hardware_concurrency(), slots.size() );
+
+    std::vector<std::unique_ptr<PCB_PARSER>> workers;
+
+    for( size_t ii = 0; ii < threadCount; ++ii )
+    {
+        workers.emplace_back( new PCB_PARSER() );
+        workers.back()->shareBoardState( *this );
+    }
+
+    auto parseItems =
+            [&]( PCB_PARSER* aWorker )
+            {
+                TRACE_ZONE( "PCB_PARSER::parseItemRun worker", "io" );
+
+                for( size_t ii = nextSlot++; ii < slots.size(); ii = nextSlot++ )
+                {
+                    const BOARD_SECTION&   section = aSections[aBegin + ii];
+                    ITEM_SLOT&             slot = slots[ii];
+                    TEXT_RANGE_LINE_READER sectionReader( aText, section.m_lineBegin,
+                                                          section.m_begin, section.m_end,
+                                                          section.m_line, aSource );
+
+                    aWorker->PushReader( &sectionReader );
+
+                    try
+                    {
+                        aWorker->NeedLEFT();
+                        slot.m_item = aWorker->parseBoardItem( (T) aWorker->NextTok() );
+                    }
+                    catch( ... )
+                    {
+                        slot.m_exception = std::current_exception();
+                    }
+
+                    aWorker->PopReader();
+
+                    slot.m_legacySegmentFill = aWorker->m_legacySegmentFill;
+                    slot.m_zoneNets.swap( aWorker->m_deferredZoneNets );
+
+                    aWorker->m_legacySegmentFill = false;
+                    aWorker->m_deferredZoneNets.clear();
+                }
+            };
+
+    if( threadCount > 1 )
+    {
+        std::vector<std::thread> threads;
+
+        for( size_t ii = 0; ii < threadCount; ++ii )
+            threads.emplace_back( parseItems, workers[ii].get() );
+
+        for( std::thread& thread : threads )
+            thread.join();
+    }
+    else
+    {
+        parseItems( workers[0].get() );
+    }
+
+    for( std::unique_ptr<PCB_PARSER>& worker : workers )
+        mergeBoardState( *worker );
+
+    // Add the items as parseBoardSections() would have, up to the first error
+    size_t ii = 0;
+
+    try
+    {
+        for( ; ii < slots.size(); ++ii )
+        {
+            ITEM_SLOT& slot = slots[ii];
+
+            if( slot.m_exception )
+                std::rethrow_exception( slot.m_exception );
+
+            if( slot.m_legacySegmentFill )
+                convertLegacySegmentFill();
+
+            for( const std::pair<ZONE_CONTAINER*, wxString>& zoneNet : slot.m_zoneNets )
+                fixZoneNet( zoneNet.first, zoneNet.second );
+
+            m_board->Add( slot.m_item, ADD_MODE::APPEND );
         }
     }
+    catch( ... )
+    {
+        for( ; ii < slots.size(); ++ii )
+            delete slots[ii].m_item;
+
+        throw;
+    }
+}
+
+
+BOARD* PCB_PARSER::parseBOARD_unchecked()
+{
+    std::map<wxString, wxString> properties;
+
+    parseHeader();
+    parseBoardSections( properties );
+
+    if( m_boardItemsHook )
+        m_boardItemsHook( m_board );
 
     m_board->SetProperties( properties );
 
@@ -2231,8 +2754,7 @@ DRAWSEGMENT* PCB_PARSER::parseDRAWSEGMENT( bool aAllowCirclesZeroWidth )
 
         std::vector< wxPoint > pts;
 
-        while( (token = NextTok()) != T_RIGHT )
-            pts.push_back( parseXY() );
+        parseXYList( [&]( const wxPoint& aPt ) { pts.push_back( aPt ); } );
 
         segment->SetPolyPoints( pts );
     }
@@ -3347,8 +3869,7 @@ EDGE_MODULE* PCB_PARSER::parseEDGE_MODULE()
 
         std::vector< wxPoint > pts;
 
-        while( (token = NextTok()) != T_RIGHT )
-            pts.push_back( parseXY() );
+        parseXYList( [&]( const wxPoint& aPt ) { pts.push_back( aPt ); } );
 
         segment->SetPolyPoints( pts );
     }
@@ -4411,24 +4932,12 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
                     if( token == T_segment )    // deprecated
                     {
                         // SEGMENT fill mode no longer supported.  Make sure user is OK with converting them.
-                        if( m_showLegacyZoneWarning )
-                        {
-                            KIDIALOG dlg( nullptr,
-                                          _( "The legacy segment fill mode is no longer supported.\n"
-                                             "Convert zones to polygon fills?"),
-                                          _( "Legacy Zone Warning" ),
-                                          wxYES_NO | wxICON_WARNING );
-
-                            dlg.DoNotShowCheckbox( __FILE__, __LINE__ );
-
-                            if( dlg.ShowModal() == wxID_NO )
-                                THROW_IO_ERROR( wxT( "CANCEL" ) );
-
-                            m_showLegacyZoneWarning = false;
-                        }
+                        if( m_deferBoardChanges )
+                            m_legacySegmentFill = true;
+                        else
+                            convertLegacySegmentFill();
 
                         zone->SetFillMode( ZONE_FILL_MODE::POLYGONS );
-                        m_board->SetModified();
                     }
                     else if( token == T_hatch )
                         zone->SetFillMode( ZONE_FILL_MODE::HATCH_PATTERN );
@@ -4623,10 +5132,7 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
                 if( token != T_pts )
                     Expecting( T_pts );
 
-                for( token = NextTok(); token != T_RIGHT; token = NextTok() )
-                {
-                    corners.push_back( parseXY() );
-                }
+                parseXYList( [&]( const wxPoint& aPt ) { corners.push_back( aPt ); } );
 
                 NeedRIGHT();
 
@@ -4681,10 +5187,7 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
                 if( island )
                     zone->SetIsIsland( filledLayer, idx );
 
-                for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
-                {
-                    poly.Append( parseXY() );
-                }
+                parseXYList( [&]( const wxPoint& aPt ) { poly.Append( aPt ); } );
 
                 NeedRIGHT();
 
@@ -4779,21 +5282,10 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
         // Can happens which old boards, with nonexistent nets ...
         // or after being edited by hand
         // We try to fix the mismatch.
-        NETINFO_ITEM* net = m_board->FindNet( netnameFromfile );
-
-        if( net )   // An existing net has the same net name. use it for the zone
-            zone->SetNetCode( net->GetNet() );
-        else    // Not existing net: add a new net to keep trace of the zone netname
-        {
-            int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
-            m_board->Add( net );
-
-            // Store the new code mapping
-            pushValueIntoMap( newnetcode, net->GetNet() );
-            // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
-        }
+        if( m_deferBoardChanges )
+            m_deferredZoneNets.emplace_back( zone.get(), netnameFromfile );
+        else
+            fixZoneNet( zone.get(), netnameFromfile );
     }
 
     // Clear flags used in zone edition:
@@ -4803,6 +5295,48 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
 }
 
 
+void PCB_PARSER::fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetname )
+{
+    NETINFO_ITEM* net = m_board->FindNet( aNetname );
+
+    if( net )   // An existing net has the same net name. use it for the zone
+        aZone->SetNetCode( net->GetNet() );
+    else    // Not existing net: add a new net to keep trace of the zone netname
+    {
+        int newnetcode = m_board->GetNetCount();
+        net = new NETINFO_ITEM( m_board, aNetname, newnetcode );
+        m_board->Add( net );
+
+        // Store the new code mapping
+        pushValueIntoMap( newnetcode, net->GetNet() );
+        // and update the zone netcode
+        aZone->SetNetCode( net->GetNet() );
+    }
+}
+
+
+void PCB_PARSER::convertLegacySegmentFill()
+{
+    if( m_showLegacyZoneWarning )
+    {
+        KIDIALOG dlg( nullptr,
+                      _( "The legacy segment fill mode is no longer supported.\n"
+                         "Convert zones to polygon fills?"),
+                      _( "Legacy Zone Warning" ),
+                      wxYES_NO | wxICON_WARNING );
+
+        dlg.DoNotShowCheckbox( __FILE__, __LINE__ );
+
+        if( dlg.ShowModal() == wxID_NO )
+            THROW_IO_ERROR( wxT( "CANCEL" ) );
+
+        m_showLegacyZoneWarning = false;
+    }
+
+    m_board->SetModified();
+}
+
+
 PCB_TARGET* PCB_PARSER::parsePCB_TARGET()
 {
     wxCHECK_MSG( CurTok() == T_target, NULL,
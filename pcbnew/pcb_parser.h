@@ -36,7 +36,11 @@
 #include <math/util.h>                           // KiROUND, Clamp
 #include <pcb_lexer.h>
 
+#include <functional>
+#include <map>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 
 class ARC;
@@ -60,6 +64,7 @@ class ZONE_CONTAINER;
 class MARKER_PCB;
 class MODULE_3D_SETTINGS;
 struct LAYER;
+struct BOARD_SECTION;
 
 
 /**
@@ -84,6 +89,17 @@ class PCB_PARSER : public PCB_LEXER
     KIID_MAP            m_resetKIIDMap;     ///< if resetting UUIDs, record new ones to update groups with
 
     bool                m_showLegacyZoneWarning;
+    bool                m_fastPath;         ///< use the fast number and point list conversions
+    bool                m_parallelLoad;     ///< parse the board items with several threads
+
+    ///> True in the parsers of the loader threads, which must leave the board unchanged.
+    ///> The changes are recorded below and made by the main parser, in the file order.
+    bool                m_deferBoardChanges;
+    bool                m_legacySegmentFill;    ///< a zone with the legacy segment fill was read
+    std::vector<std::pair<ZONE_CONTAINER*, wxString>> m_deferredZoneNets;
+
+    ///> Adds the items which are not in the parsed text, see SetBoardItemsHook()
+    std::function<void( BOARD* )> m_boardItemsHook;
 
     // Group membership info refers to other Uuids in the file.
     // We don't want to rely on group declarations being last in the file, so
@@ -189,6 +205,85 @@ class PCB_PARSER : public PCB_LEXER
      */
     BOARD*          parseBOARD_unchecked();
 
+    /**
+     * Function parseBoardSections
+     * parses the sections of a board up to its closing parenthesis.
+     */
+    void            parseBoardSections( std::map<wxString, wxString>& aProperties );
+
+    /**
+     * Function parseBoardSection
+     * parses the board section starting with \a aToken, which has just been read.
+     */
+    void            parseBoardSection( PCB_KEYS_T::T aToken,
+                                       std::map<wxString, wxString>& aProperties );
+
+    /**
+     * Function parseBoardItem
+     * parses the board item starting with \a aToken, which has just been read, without
+     * adding it to the board.
+     *
+     * @return the item, or nullptr if \a aToken doesn't start an item isParallelItem()
+     *  accepts.
+     */
+    BOARD_ITEM*     parseBoardItem( PCB_KEYS_T::T aToken );
+
+    /**
+     * Function isParallelItem
+     * @return true for the board items which can be parsed by the loader threads.
+     */
+    static bool     isParallelItem( PCB_KEYS_T::T aToken );
+
+    /**
+     * Function parseItemsInParallel
+     * reads the rest of the board file in memory, splits it in its top level sections
+     * and parses the sections of items with several threads, the other sections here.
+     * The items are added to the board in the file order.
+     *
+     * The current token is the keyword of the first item.
+     *
+     * @return false, without reading anything, if the file can't be read that way.  The
+     *  board is then parsed by parseBoardSections() as usual.
+     */
+    bool            parseItemsInParallel( std::map<wxString, wxString>& aProperties );
+
+    /**
+     * Function parseItemRun
+     * parses the items of \a aSections [aBegin, aEnd) of the board text \a aText with
+     * several threads, and adds them to the board in this order.
+     */
+    void            parseItemRun( const std::string& aText, const wxString& aSource,
+                                  const std::vector<BOARD_SECTION>& aSections, size_t aBegin,
+                                  size_t aEnd );
+
+    /**
+     * Function shareBoardState
+     * prepares this parser to parse items of the board \a aParser is loading, from a
+     * loader thread.  The board, its layers and nets are only read.
+     */
+    void            shareBoardState( const PCB_PARSER& aParser );
+
+    /**
+     * Function mergeBoardState
+     * takes what the loader thread parser \a aWorker learnt about the file.
+     */
+    void            mergeBoardState( PCB_PARSER& aWorker );
+
+    /**
+     * Function fixZoneNet
+     * gives \a aZone the net named \a aNetname, when its net code doesn't match it,
+     * creating the net if needed.
+     */
+    void            fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetname );
+
+    /**
+     * Function convertLegacySegmentFill
+     * asks the user, once, to convert the legacy segment fill of zones.
+     *
+     * @throw IO_ERROR if the user cancels the loading.
+     */
+    void            convertLegacySegmentFill();
+
 
     /**
      * Function lookUpLayer
@@ -238,6 +333,42 @@ class PCB_PARSER : public PCB_LEXER
 
     void parseXY( int* aX, int* aY );
 
+    /**
+     * Function nextXY
+     * reads the next (xy X Y) at once with DSNLEXER::NextFixedPointPair(), if its
+     * coordinates convert exactly to board units.
+     *
+     * @return false if the point must be read token by token, nothing was read then.
+     */
+    bool nextXY( wxPoint& aPoint );
+
+    /**
+     * Function parseXYList
+     * parses the (xy X Y) points of a pts list, up to and including its closing
+     * parenthesis, and gives them to \a aAddPoint one at a time.
+     *
+     * @throw PARSE_ERROR if the coordinate pair syntax is incorrect.
+     */
+    template <typename ADD_POINT>
+    void parseXYList( ADD_POINT aAddPoint )
+    {
+        wxPoint pt;
+
+        for( ; ; )
+        {
+            if( nextXY( pt ) )
+            {
+                aAddPoint( pt );
+                continue;
+            }
+
+            if( NextTok() == T_RIGHT )
+                break;
+
+            aAddPoint( parseXY() );
+        }
+    }
+
     std::pair<wxString, wxString> parseProperty();
 
     /**
@@ -261,6 +392,16 @@ class PCB_PARSER : public PCB_LEXER
      */
     double parseDouble();
 
+    /**
+     * Function fastBoardUnits
+     * converts \a aText, a length in millimeters, to board units if it has no more decimals
+     * than the board units resolution.  The conversion is then exact, using integers only,
+     * and gives the same result as the conversion through a double.
+     *
+     * @return false if the text must be converted through a double.
+     */
+    static bool fastBoardUnits( const char* aText, int& aResult );
+
     inline double parseDouble( const char* aExpected )
     {
         NeedNUMBER( aExpected );
@@ -274,6 +415,11 @@ class PCB_PARSER : public PCB_LEXER
 
     inline int parseBoardUnits()
     {
+        int iu;
+
+        if( m_fastPath && fastBoardUnits( CurText(), iu ) )
+            return iu;
+
         // There should be no major rounding issues here, since the values in
         // the file are in mm and get converted to nano-meters.
         // See test program tools/test-nm-biu-to-ascii-mm-round-tripping.cpp
@@ -292,7 +438,14 @@ class PCB_PARSER : public PCB_LEXER
 
     inline int parseBoardUnits( const char* aExpected )
     {
-        auto retval = parseDouble( aExpected ) * IU_PER_MM;
+        NeedNUMBER( aExpected );
+
+        int iu;
+
+        if( m_fastPath && fastBoardUnits( CurText(), iu ) )
+            return iu;
+
+        auto retval = parseDouble() * IU_PER_MM;
 
         // N.B. we currently represent board units as integers.  Any values that are
         // larger or smaller than those board units represent undefined behavior for
@@ -345,7 +498,11 @@ public:
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
         m_board( 0 ),
-        m_resetKIIDs( false )
+        m_resetKIIDs( false ),
+        m_fastPath( true ),
+        m_parallelLoad( true ),
+        m_deferBoardChanges( false ),
+        m_legacySegmentFill( false )
     {
         init();
     }
@@ -365,6 +522,25 @@ public:
         return ret;
     }
 
+    /**
+     * Enable or disable the fast number and point list conversions, which are used by
+     * default.  Both paths give the same results; the slow one is kept as a reference for
+     * the benchmarks and the tests.
+     */
+    void SetFastPath( bool aEnable ) { m_fastPath = aEnable; }
+
+    /**
+     * Enable or disable the parsing of the board items by several threads, which is used
+     * by default.  The board is the same either way.
+     */
+    void SetParallelLoad( bool aEnable ) { m_parallelLoad = aEnable; }
+
+    /**
+     * Set a function called once the sections of a board are parsed, before the groups
+     * are resolved, to add items which are not in the parsed text (see BOARD_SNAPSHOT).
+     */
+    void SetBoardItemsHook( std::function<void( BOARD* )> aHook ) { m_boardItemsHook = aHook; }
+
     void SetBoard( BOARD* aBoard )
     {
         init();
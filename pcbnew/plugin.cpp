@@ -22,6 +22,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <footprint_lib_index.h>
 #include <io_mgr.h>
 #include <properties.h>
 
@@ -65,6 +66,45 @@ void PLUGIN::FootprintEnumerate( wxArrayString& aFootprintNames, const wxString&
 }
 
 
+void PLUGIN::FootprintEnumerateInfo( std::vector<FOOTPRINT_INDEX_ENTRY>& aFootprints,
+                                     const wxString& aLibraryPath, bool aBestEfforts,
+                                     const PROPERTIES* aProperties )
+{
+    // default implementation
+    wxArrayString names;
+    wxString      errorMsg;
+
+    try
+    {
+        FootprintEnumerate( names, aLibraryPath, aBestEfforts, aProperties );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        // Some of the footprints may have been read
+        errorMsg = ioe.What();
+    }
+
+    for( const wxString& name : names )
+    {
+        const MODULE* footprint = GetEnumeratedFootprint( aLibraryPath, name, aProperties );
+
+        if( footprint )
+        {
+            aFootprints.emplace_back( name, *footprint );
+        }
+        else
+        {
+            // Should happen only with malformed/broken libraries
+            aFootprints.emplace_back();
+            aFootprints.back().m_name = name;
+        }
+    }
+
+    if( !errorMsg.IsEmpty() )
+        THROW_IO_ERROR( errorMsg );
+}
+
+
 void PLUGIN::PrefetchLib( const wxString& aLibraryPath, const PROPERTIES* aProperties )
 {
     (void) aLibraryPath;
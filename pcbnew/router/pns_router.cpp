@@ -31,6 +31,7 @@
 
 #include <pgm_base.h>
 #include <settings/settings_manager.h>
+#include <trace_profiler.h>
 
 #include <pcb_painter.h>
 #include <pcbnew_settings.h>
@@ -98,6 +99,8 @@ ROUTER::~ROUTER()
 
 void ROUTER::SyncWorld()
 {
+    TRACE_ZONE( "PNS::ROUTER::SyncWorld", "router" );
+
     ClearWorld();
 
     m_world = std::make_unique<NODE>( );
@@ -139,6 +142,8 @@ bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aItem, int aDragMode )
 
 bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM_SET aStartItems, int aDragMode )
 {
+    TRACE_ZONE( "PNS::ROUTER::StartDragging", "router" );
+
     if( aStartItems.Empty() )
         return false;
 
@@ -193,7 +198,8 @@ bool ROUTER::isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer )
 }
 
 bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
-{   
+{
+    TRACE_ZONE( "PNS::ROUTER::StartRouting", "router" );
 
     if( ! isStartingPointRoutable( aP, aLayer ) )
     {
@@ -256,6 +262,8 @@ void ROUTER::DisplayItems( const ITEM_SET& aItems )
 
 void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
+    TRACE_ZONE( "PNS::ROUTER::Move", "router" );
+
     m_currentEnd = aP;
 
     if( m_logger )
@@ -386,6 +394,8 @@ void ROUTER::movePlacing( const VECTOR2I& aP, ITEM* aEndItem )
 
 void ROUTER::CommitRouting( NODE* aNode )
 {
+    TRACE_ZONE( "PNS::ROUTER::CommitRouting", "router" );
+
     if( m_state == ROUTE_TRACK && !m_placer->HasPlacedAnything() )
         return;
 
@@ -406,6 +416,8 @@ void ROUTER::CommitRouting( NODE* aNode )
 
 bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 {
+    TRACE_ZONE( "PNS::ROUTER::FixRoute", "router" );
+
     bool rv = false;
 
     if( m_logger )
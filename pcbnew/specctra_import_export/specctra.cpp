@@ -261,7 +261,7 @@ void SPECCTRA_DB::LoadPCB( const wxString& aFilename )
 
 void SPECCTRA_DB::LoadSESSION( const wxString& aFilename )
 {
-    FILE_LINE_READER curr_reader( aFilename );
+    MMAP_LINE_READER curr_reader( aFilename );
 
     PushReader( &curr_reader );
 
@@ -46,6 +46,7 @@
 #include <confirm.h>
 #include <convert_to_biu.h>
 #include <math/util.h>      // for KiROUND
+#include <trace_profiler.h>
 #include "zone_filler.h"
 
 static const double s_RoundPadThermalSpokeAngle = 450;      // in deci-degrees
@@ -84,6 +85,8 @@ void ZONE_FILLER::SetProgressReporter( PROGRESS_REPORTER* aReporter )
 
 bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWindow* aParent )
 {
+    TRACE_ZONE( "ZONE_FILLER::Fill", "zones" );
+
     std::vector<std::pair<ZONE_CONTAINER*, PCB_LAYER_ID>> toFill;
     std::vector<CN_ZONE_ISOLATED_ISLAND_LIST> islandsList;
 
@@ -194,6 +197,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
     auto fill_lambda =
             [&]( PROGRESS_REPORTER* aReporter )
             {
+                TRACE_ZONE( "ZONE_FILLER::Fill worker", "zones" );
                 size_t num = 0;
 
                 for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
@@ -432,6 +436,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
     auto tri_lambda =
             [&]( PROGRESS_REPORTER* aReporter ) -> size_t
             {
+                TRACE_ZONE( "ZONE_FILLER::Fill triangulation worker", "zones" );
                 size_t num = 0;
 
                 for( size_t i = nextItem++; i < islandsList.size(); i = nextItem++ )
@@ -1086,6 +1091,7 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone, PCB_LAYER_I
 bool ZONE_FILLER::fillSingleZone( ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
                                   SHAPE_POLY_SET& aRawPolys, SHAPE_POLY_SET& aFinalPolys )
 {
+    TRACE_ZONE( "ZONE_FILLER::fillSingleZone", "zones" );
     SHAPE_POLY_SET smoothedPoly;
 
     /*
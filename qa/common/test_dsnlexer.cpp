@@ -0,0 +1,194 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <dsnlexer.h>
+#include <richio.h>
+
+#include <cstdlib>
+#include <string>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+
+BOOST_AUTO_TEST_SUITE( DsnLexer )
+
+
+/**
+ * The fast conversion gives the same doubles as strtod(), and refuses what it can't
+ * convert exactly
+ */
+BOOST_AUTO_TEST_CASE( ParseDecimal )
+{
+    for( const char* text : { "0", "-0", "1", "-1.5", "+2.25", ".5", "5.", "123.456789",
+                              "0.1", "0.3", "-1234567.891", "3.14159265358979" } )
+    {
+        double value;
+
+        BOOST_TEST_INFO( text );
+        BOOST_REQUIRE( DSNLEXER::ParseDecimal( text, value ) );
+        BOOST_CHECK_EQUAL( value, strtod( text, nullptr ) );
+    }
+
+    double value;
+
+    for( const char* text : { "", "-", ".", "1e3", "1.2.3", "12a", "nan", "1234567890123456789" } )
+    {
+        BOOST_TEST_INFO( text );
+        BOOST_CHECK( !DSNLEXER::ParseDecimal( text, value ) );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( ParseFixedPoint )
+{
+    long long value;
+
+    BOOST_CHECK( DSNLEXER::ParseFixedPoint( "1.25", 4, 1000000, value ) );
+    BOOST_CHECK_EQUAL( value, 12500 );
+
+    BOOST_CHECK( DSNLEXER::ParseFixedPoint( "-0.000001", 6, 1000000, value ) );
+    BOOST_CHECK_EQUAL( value, -1 );
+
+    BOOST_CHECK( DSNLEXER::ParseFixedPoint( "100", 4, 1000000, value ) );
+    BOOST_CHECK_EQUAL( value, 1000000 );
+
+    // Too many decimals, over the limit, not a plain decimal number
+    BOOST_CHECK( !DSNLEXER::ParseFixedPoint( "0.00001", 4, 1000000, value ) );
+    BOOST_CHECK( !DSNLEXER::ParseFixedPoint( "100.0001", 4, 1000000, value ) );
+    BOOST_CHECK( !DSNLEXER::ParseFixedPoint( "1e2", 4, 1000000, value ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( NextFixedPointPair )
+{
+    DSNLEXER lexer( "(pts (xy 1 -2.5) ( xy  0.75 3 )\n"
+                    "\n"
+                    "# comment\n"
+                    "  (xy 4 5) (xy 1e3 0) (xy 6 7)\n"
+                    "(xy 8\n"
+                    "9))" );
+
+    long long x;
+    long long y;
+
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_LEFT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+
+    // Not a xy list
+    BOOST_CHECK( !lexer.NextFixedPointPair( "pts", 2, 10000, x, y ) );
+
+    BOOST_REQUIRE( lexer.NextFixedPointPair( "xy", 2, 10000, x, y ) );
+    BOOST_CHECK_EQUAL( x, 100 );
+    BOOST_CHECK_EQUAL( y, -250 );
+    BOOST_CHECK_EQUAL( lexer.CurTok(), DSN_RIGHT );
+
+    BOOST_REQUIRE( lexer.NextFixedPointPair( "xy", 2, 10000, x, y ) );
+    BOOST_CHECK_EQUAL( x, 75 );
+    BOOST_CHECK_EQUAL( y, 300 );
+
+    // Over the blank and comment lines
+    BOOST_REQUIRE( lexer.NextFixedPointPair( "xy", 2, 10000, x, y ) );
+    BOOST_CHECK_EQUAL( x, 400 );
+    BOOST_CHECK_EQUAL( y, 500 );
+
+    // The exponent needs the token by token path
+    BOOST_CHECK( !lexer.NextFixedPointPair( "xy", 2, 10000, x, y ) );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_LEFT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_NUMBER );
+    BOOST_CHECK_EQUAL( lexer.CurStr(), "1e3" );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_NUMBER );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_RIGHT );
+
+    BOOST_REQUIRE( lexer.NextFixedPointPair( "xy", 2, 10000, x, y ) );
+    BOOST_CHECK_EQUAL( x, 600 );
+    BOOST_CHECK_EQUAL( y, 700 );
+
+    // Split over two lines
+    BOOST_CHECK( !lexer.NextFixedPointPair( "xy", 2, 10000, x, y ) );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_LEFT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_NUMBER );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_NUMBER );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_RIGHT );
+
+    BOOST_CHECK( !lexer.NextFixedPointPair( "xy", 2, 10000, x, y ) );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_RIGHT );
+    BOOST_CHECK( !lexer.NextFixedPointPair( "xy", 2, 10000, x, y ) );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_EOF );
+}
+
+
+/**
+ * Lexing the lines of a file mapping, which are not nul terminated, gives the same tokens
+ * and line numbers as lexing the lines read by a FILE_LINE_READER
+ */
+BOOST_AUTO_TEST_CASE( MmapLineReader )
+{
+    const std::string text = "(kicad_pcb (version 4)\n"
+                             "# comment\n"
+                             "\n"
+                             "  (net 1 \"a b\") (xy 1.5 -2)\n"
+                             "  (end)";    // no newline at end of file
+
+    for( const std::string& content : { text, std::string() } )
+    {
+        wxString fileName = wxFileName::CreateTempFileName( "dsnlexer" );
+
+        {
+            wxFFile file( fileName, "wb" );
+            BOOST_REQUIRE( file.IsOpened() );
+            BOOST_REQUIRE( file.Write( content.data(), content.size() ) == content.size() );
+        }
+
+        {
+            FILE_LINE_READER fileReader( fileName );
+            MMAP_LINE_READER mmapReader( fileName );
+            DSNLEXER         fileLexer( nullptr, 0, &fileReader );
+            DSNLEXER         mmapLexer( nullptr, 0, &mmapReader );
+            int              tok;
+
+            do
+            {
+                tok = fileLexer.NextTok();
+
+                BOOST_CHECK_EQUAL( mmapLexer.NextTok(), tok );
+                BOOST_CHECK_EQUAL( mmapLexer.CurStr(), fileLexer.CurStr() );
+                BOOST_CHECK_EQUAL( mmapLexer.CurLineNumber(), fileLexer.CurLineNumber() );
+                BOOST_CHECK_EQUAL( mmapLexer.CurOffset(), fileLexer.CurOffset() );
+                BOOST_CHECK_EQUAL( std::string( mmapLexer.CurLine() ),
+                                   std::string( fileLexer.CurLine() ) );
+            } while( tok != DSN_EOF );
+        }
+
+        wxRemoveFile( fileName );
+    }
+
+    BOOST_CHECK_THROW( MMAP_LINE_READER( "/this/file/does/not/exist" ), IO_ERROR );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
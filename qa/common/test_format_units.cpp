@@ -26,7 +26,11 @@
 #include <base_units.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <vector>
 
 struct UnitFixture
 {
@@ -74,4 +78,65 @@ BOOST_AUTO_TEST_CASE( wxPointUnitFormat )
 }
 
 
+/**
+ * The value formatted with floating point numbers, as it was before the integer formatting
+ */
+static std::string formatWithPrintf( int aValue )
+{
+    char   buf[50];
+    double engUnits = aValue / IU_PER_MM;
+    int    len;
+
+    if( engUnits != 0.0 && fabs( engUnits ) <= 0.0001 )
+    {
+        len = snprintf( buf, sizeof( buf ), "%.10f", engUnits );
+
+        while( --len > 0 && buf[len] == '0' )
+            buf[len] = '\0';
+
+        if( buf[len] == '.' )
+            buf[len] = '\0';
+        else
+            ++len;
+    }
+    else
+    {
+        len = snprintf( buf, sizeof( buf ), "%.10g", engUnits );
+    }
+
+    return std::string( buf, len );
+}
+
+
+/**
+ * Check the integer formatting gives the same text as printf
+ */
+BOOST_AUTO_TEST_CASE( IntegerUnitFormat )
+{
+    std::vector<int> values = { 0, 1, -1, 9, 10, 99, 100, 101, -100, 1000, 123456, -350000,
+                                1000000, 25400, 2540000, 999999999,
+                                std::numeric_limits<int>::min(),
+                                std::numeric_limits<int>::max() };
+
+    for( int ii = -20000; ii <= 20000; ii += 7 )
+        values.push_back( ii );
+
+    for( long long ii = 1; ii <= std::numeric_limits<int>::max(); ii = ii * 3 + 1 )
+    {
+        values.push_back( (int) ii );
+        values.push_back( (int) -ii );
+    }
+
+    for( int value : values )
+    {
+        char buf[32];
+        int  len = FormatInternalUnits( value, buf );
+
+        BOOST_CHECK_EQUAL( std::string( buf, len ), formatWithPrintf( value ) );
+        BOOST_CHECK_EQUAL( FormatInternalUnits( value ), formatWithPrintf( value ) );
+        BOOST_CHECK_EQUAL( (size_t) len, strlen( buf ) );
+    }
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,207 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for mpMinMaxIndex, the decimation of the mpFXYVector plots
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Code under test
+#include <widgets/mathplot.h>
+
+
+/**
+ * Random points with sorted X values, and their min/max index
+ */
+struct MIN_MAX_INDEX_FIXTURE
+{
+    MIN_MAX_INDEX_FIXTURE() :
+            m_random( 1234 )
+    {
+    }
+
+    ///> Appends aCount points, and updates the index for them
+    void append( size_t aCount )
+    {
+        std::uniform_real_distribution<double> y( -1.0, 1.0 );
+        size_t                                 first = m_xs.size();
+
+        for( size_t ii = 0; ii < aCount; ++ii )
+        {
+            m_xs.push_back( (double) m_xs.size() );
+            m_ys.push_back( y( m_random ) );
+        }
+
+        m_index.Update( m_xs, m_ys, first );
+    }
+
+    ///> Checks RangeMinMax() against a search of every point of random ranges
+    void checkRandomRanges( size_t aCount )
+    {
+        std::uniform_int_distribution<size_t> bound( 0, m_xs.size() - 1 );
+
+        for( size_t ii = 0; ii < aCount; ++ii )
+        {
+            size_t a = bound( m_random );
+            size_t b = bound( m_random );
+            size_t first = std::min( a, b );
+            size_t last = std::max( a, b ) + 1;
+
+            BOOST_TEST_CONTEXT( "Range " << first << " to " << last << " of " << m_xs.size() )
+            {
+                mpMinMaxIndex::MINMAX minmax = m_index.RangeMinMax( m_ys, first, last );
+
+                auto expMin = std::min_element( m_ys.begin() + first, m_ys.begin() + last );
+                auto expMax = std::max_element( m_ys.begin() + first, m_ys.begin() + last );
+
+                BOOST_CHECK_EQUAL( minmax.min, (size_t) ( expMin - m_ys.begin() ) );
+                BOOST_CHECK_EQUAL( minmax.max, (size_t) ( expMax - m_ys.begin() ) );
+            }
+        }
+    }
+
+    std::mt19937        m_random;
+    std::vector<double> m_xs;
+    std::vector<double> m_ys;
+    mpMinMaxIndex       m_index;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( MathPlot, MIN_MAX_INDEX_FIXTURE )
+
+
+/**
+ * Check the index of points appended in uneven chunks, as streamed by the simulator
+ */
+BOOST_AUTO_TEST_CASE( RangeMinMaxChunks )
+{
+    const size_t chunks[] = { 1, 2, 3, 1, 5, 7, 4, 13, 64, 1, 250, 31, 1000, 3, 2047 };
+
+    for( size_t chunk : chunks )
+    {
+        append( chunk );
+
+        BOOST_TEST_CONTEXT( "After appending " << chunk << " points" )
+        {
+            BOOST_CHECK( m_index.IsSortedX() );
+            checkRandomRanges( 100 );
+        }
+    }
+
+    // Ranges of the first points
+    BOOST_CHECK_EQUAL( m_index.RangeMinMax( m_ys, 5, 6 ).min, 5u );
+    BOOST_CHECK_EQUAL( m_index.RangeMinMax( m_ys, 5, 6 ).max, 5u );
+}
+
+
+/**
+ * Check the decimated points are the extremes of every pixel column, and a point on each side
+ */
+BOOST_AUTO_TEST_CASE( DecimateColumns )
+{
+    append( 1000 );
+
+    // 10 points per column, columns 20 to 49 are shown
+    auto column =
+            []( double x )
+            {
+                return std::trunc( x / 10.0 );
+            };
+
+    std::vector<size_t> indices;
+
+    BOOST_REQUIRE( m_index.Decimate( m_xs, m_ys, 20, 49, column, indices ) );
+
+    std::vector<size_t> expected = { 199 };
+
+    for( size_t px = 20; px <= 49; ++px )
+    {
+        auto first = m_ys.begin() + 10 * px;
+        size_t min = std::min_element( first, first + 10 ) - m_ys.begin();
+        size_t max = std::max_element( first, first + 10 ) - m_ys.begin();
+
+        expected.push_back( std::min( min, max ) );
+        expected.push_back( std::max( min, max ) );
+    }
+
+    expected.push_back( 500 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( indices.begin(), indices.end(), expected.begin(),
+                                   expected.end() );
+
+    // Not more points than columns
+    BOOST_CHECK( !m_index.Decimate( m_xs, m_ys, 0, 999, column, indices ) );
+    BOOST_CHECK( indices.empty() );
+}
+
+
+/**
+ * Check points with unsorted X values are all plotted
+ */
+BOOST_AUTO_TEST_CASE( UnsortedFallback )
+{
+    append( 500 );
+
+    std::vector<size_t> indices;
+
+    auto column =
+            []( double x )
+            {
+                return std::trunc( x / 10.0 );
+            };
+
+    BOOST_REQUIRE( m_index.Decimate( m_xs, m_ys, 0, 49, column, indices ) );
+
+    // A point going back along the X axis
+    m_xs.push_back( 10.0 );
+    m_ys.push_back( 0.0 );
+    m_index.Update( m_xs, m_ys, m_xs.size() - 1 );
+
+    BOOST_CHECK( !m_index.IsSortedX() );
+    BOOST_CHECK( !m_index.Decimate( m_xs, m_ys, 0, 49, column, indices ) );
+    BOOST_CHECK( indices.empty() );
+
+    // Sorted points appended afterwards do not sort the data
+    append( 500 );
+
+    BOOST_CHECK( !m_index.IsSortedX() );
+    BOOST_CHECK( !m_index.Decimate( m_xs, m_ys, 0, 49, column, indices ) );
+
+    // Until the index is rebuilt for new data
+    m_xs.resize( 500 );
+    m_ys.resize( 500 );
+    m_index.Update( m_xs, m_ys, 0 );
+
+    BOOST_CHECK( m_index.IsSortedX() );
+    BOOST_CHECK( m_index.Decimate( m_xs, m_ys, 0, 49, column, indices ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,168 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for TRACE_PROFILER
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Code under test
+#include <trace_profiler.h>
+
+
+/**
+ * Enables the profiler for a test, and disables it afterwards
+ */
+struct TRACE_PROFILER_FIXTURE
+{
+    TRACE_PROFILER_FIXTURE()
+    {
+        TRACE_PROFILER::Instance().Enable( true );
+    }
+
+    ~TRACE_PROFILER_FIXTURE()
+    {
+        TRACE_PROFILER::Instance().Enable( false );
+        TRACE_PROFILER::Instance().Clear();
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( TraceProfiler, TRACE_PROFILER_FIXTURE )
+
+
+/**
+ * Check nothing is recorded while the profiler is disabled
+ */
+BOOST_AUTO_TEST_CASE( Disabled )
+{
+    TRACE_PROFILER::Instance().Enable( false );
+
+    {
+        TRACE_ZONE( "disabled", "test" );
+    }
+
+    BOOST_CHECK( TRACE_PROFILER::Instance().GetEvents().empty() );
+}
+
+
+/**
+ * Check nested zones are recorded, the enclosing one first
+ */
+BOOST_AUTO_TEST_CASE( NestedZones )
+{
+    {
+        TRACE_ZONE( "outer", "test" );
+
+        {
+            TRACE_ZONE( std::string( "inner " ) + "zone", "test" );
+        }
+    }
+
+    std::vector<TRACE_EVENT> events = TRACE_PROFILER::Instance().GetEvents();
+
+    BOOST_REQUIRE_EQUAL( events.size(), 2 );
+    BOOST_CHECK_EQUAL( std::string( events[0].m_name ), "outer" );
+    BOOST_CHECK_EQUAL( std::string( events[1].m_name ), "inner zone" );
+    BOOST_CHECK_EQUAL( std::string( events[1].m_category ), "test" );
+    BOOST_CHECK_EQUAL( events[0].m_thread, events[1].m_thread );
+    BOOST_CHECK( events[1].m_start >= events[0].m_start );
+    BOOST_CHECK( events[1].m_start + events[1].m_duration
+                 <= events[0].m_start + events[0].m_duration );
+}
+
+
+/**
+ * Check zones of different threads are told apart
+ */
+BOOST_AUTO_TEST_CASE( Threads )
+{
+    std::thread worker(
+            []()
+            {
+                TRACE_ZONE( "worker", "test" );
+            } );
+
+    worker.join();
+
+    {
+        TRACE_ZONE( "main", "test" );
+    }
+
+    std::vector<TRACE_EVENT> events = TRACE_PROFILER::Instance().GetEvents();
+
+    BOOST_REQUIRE_EQUAL( events.size(), 2 );
+    BOOST_CHECK_NE( events[0].m_thread, events[1].m_thread );
+}
+
+
+/**
+ * Check a thread keeps its latest zones
+ */
+BOOST_AUTO_TEST_CASE( RingBuffer )
+{
+    for( size_t ii = 0; ii < TRACE_PROFILER::RING_SIZE; ++ii )
+    {
+        TRACE_ZONE( "old", "test" );
+    }
+
+    {
+        TRACE_ZONE( "new", "test" );
+    }
+
+    std::vector<TRACE_EVENT> events = TRACE_PROFILER::Instance().GetEvents();
+
+    BOOST_REQUIRE_EQUAL( events.size(), TRACE_PROFILER::RING_SIZE );
+    BOOST_CHECK_EQUAL( std::string( events.back().m_name ), "new" );
+}
+
+
+/**
+ * Check the Chrome trace event export
+ */
+BOOST_AUTO_TEST_CASE( ChromeTrace )
+{
+    {
+        TRACE_ZONE( "a \"quoted\" zone", "test" );
+    }
+
+    std::ostringstream stream;
+
+    TRACE_PROFILER::Instance().ExportChromeTrace( stream, "qa_common" );
+
+    const std::string trace = stream.str();
+
+    BOOST_CHECK_EQUAL( trace.find( "{\"traceEvents\":[" ), 0 );
+    BOOST_CHECK( trace.find( "\"args\":{\"name\":\"qa_common\"}" ) != std::string::npos );
+    BOOST_CHECK( trace.find( "{\"name\":\"a \\\"quoted\\\" zone\",\"cat\":\"test\",\"ph\":\"X\"" )
+                 != std::string::npos );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -22,8 +22,10 @@
  */
 
 #include <wx/wx.h>
+#include <dsnlexer.h>
 #include <richio.h>
 
+#include <algorithm>
 #include <chrono>
 #include <ios>
 #include <functional>
@@ -303,6 +305,42 @@ static void bench_wxbis_reuse( const wxFileName& aFile, int aReps, BENCH_REPORT&
     }
 }
 
+/**
+ * Benchmark reading the file as s-expression tokens with a DSNLEXER on a given LINE_READER
+ * implementation, as the board and schematic parsers do, converting the numbers with
+ * strtod() or with the fast locale independent conversion of the lexer.  The lines read
+ * are the line numbers reached.
+ */
+template<typename LR, bool FAST_NUMBERS>
+static void bench_dsnlexer( const wxFileName& aFile, int aReps, BENCH_REPORT& report )
+{
+    for( int i = 0; i < aReps; ++i)
+    {
+        LR               reader( aFile.GetFullPath() );
+        DSNLEXER         lexer( nullptr, 0, &reader );
+        int              tok;
+
+        while( ( tok = lexer.NextTok() ) != DSN_EOF )
+        {
+            if( tok != DSN_NUMBER )
+            {
+                report.charAcc += (unsigned char) lexer.CurText()[0];
+                continue;
+            }
+
+            double value;
+
+            if( !FAST_NUMBERS || !DSNLEXER::ParseDecimal( lexer.CurText(), value ) )
+                value = strtod( lexer.CurText(), nullptr );
+
+            report.charAcc += (unsigned) value;
+        }
+
+        report.linesRead += reader.LineNumber();
+    }
+}
+
+
 /**
  * List of available benchmarks
  */
@@ -324,6 +362,12 @@ static std::vector<BENCHMARK> benchmarkList =
     { 'B', bench_wxbis_reuse<wxFileInputStream>, "wxFileIStream, buf'd, reused" },
     { 'c', bench_wxbis<wxFFileInputStream>, "wxFFileIStream. buf'd" },
     { 'C', bench_wxbis_reuse<wxFFileInputStream>, "wxFFileIStream, buf'd, reused" },
+    { 'm', bench_line_reader<MMAP_LINE_READER>, "RichIO MMAP_L_R" },
+    { 'M', bench_line_reader_reuse<MMAP_LINE_READER>, "RichIO MMAP_L_R, reused" },
+    { 'x', bench_dsnlexer<FILE_LINE_READER, false>, "DSNLEXER, strtod numbers" },
+    { 'X', bench_dsnlexer<FILE_LINE_READER, true>, "DSNLEXER, fast numbers" },
+    { 'y', bench_dsnlexer<MMAP_LINE_READER, false>, "DSNLEXER, mmap, strtod numbers" },
+    { 'Y', bench_dsnlexer<MMAP_LINE_READER, true>, "DSNLEXER, mmap, fast numbers" },
 };
 
 
@@ -406,6 +450,8 @@ int io_benchmark_func( int argc, char* argv[] )
     os << "  Repetitions:    " << (int) reps << std::endl;
     os << std::endl;
 
+    const double fileMB = inFile.GetSize().ToDouble() / ( 1024.0 * 1024.0 );
+
     for( auto& bmark : benchmarkList )
     {
         if( bench.size() && !bench.Contains( bmark.triggerChar ) )
@@ -413,8 +459,12 @@ int io_benchmark_func( int argc, char* argv[] )
 
         BENCH_REPORT report = executeBenchMark( bmark, reps, inFile );
 
-        os << wxString::Format( "%-30s %u lines, acc: %u in %u ms",
-                bmark.name, report.linesRead, report.charAcc, (int) report.benchDurMs.count() )
+        // Throughput over all the repetitions, so the benchmarks can be compared directly
+        const double secs = std::max<long long>( report.benchDurMs.count(), 1 ) / 1000.0;
+
+        os << wxString::Format( "%-30s %u lines, acc: %u in %u ms, %.1f MB/s",
+                bmark.name, report.linesRead, report.charAcc, (int) report.benchDurMs.count(),
+                fileMB * reps / secs )
             << std::endl;;
     }
 
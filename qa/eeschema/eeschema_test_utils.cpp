@@ -25,6 +25,14 @@
 
 #include <cstdlib>
 
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <connection_graph.h>
+#include <project.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <wildcards_and_files_ext.h>
+
 wxFileName KI_TEST::GetEeschemaTestDataDir()
 {
     const char* env = std::getenv( "KICAD_TEST_EESCHEMA_DATA_DIR" );
@@ -47,3 +55,68 @@ wxFileName KI_TEST::GetEeschemaTestDataDir()
 
     return wxFileName{ fn };
 }
+
+
+KI_TEST::SCHEMATIC_TEST_FIXTURE::SCHEMATIC_TEST_FIXTURE() :
+        m_schematic( nullptr ),
+        m_manager( true )
+{
+    m_pi = SCH_IO_MGR::FindPlugin( SCH_IO_MGR::SCH_KICAD );
+}
+
+
+wxString KI_TEST::SCHEMATIC_TEST_FIXTURE::getSchematicFile( const wxString& aBaseName )
+{
+    wxFileName fn = GetEeschemaTestDataDir();
+    fn.AppendDir( "netlists" );
+    fn.AppendDir( aBaseName );
+    fn.SetName( aBaseName );
+    fn.SetExt( KiCadSchematicFileExtension );
+
+    return fn.GetFullPath();
+}
+
+
+void KI_TEST::SCHEMATIC_TEST_FIXTURE::loadSchematic( const wxString& aBaseName )
+{
+    wxString fn = getSchematicFile( aBaseName );
+
+    BOOST_TEST_MESSAGE( fn );
+
+    wxFileName pro( fn );
+    pro.SetExt( ProjectFileExtension );
+
+    m_manager.LoadProject( pro.GetFullPath() );
+
+    m_manager.Prj().SetElem( PROJECT::ELEM_SCH_PART_LIBS, nullptr );
+
+    m_schematic.Reset();
+    m_schematic.SetProject( &m_manager.Prj() );
+    m_schematic.SetRoot( m_pi->Load( fn, &m_schematic ) );
+
+    BOOST_REQUIRE_EQUAL( m_pi->GetError().IsEmpty(), true );
+
+    m_schematic.CurrentSheet().push_back( &m_schematic.Root() );
+
+    SCH_SCREENS screens( m_schematic.Root() );
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        screen->UpdateLocalLibSymbolLinks();
+
+    SCH_SHEET_LIST sheets = m_schematic.GetSheets();
+
+    // Restore all of the loaded symbol instances from the root sheet screen.
+    sheets.UpdateSymbolInstances( m_schematic.RootScreen()->GetSymbolInstances() );
+
+    sheets.AnnotatePowerSymbols();
+
+    // NOTE: This is required for multi-unit symbols to be correct
+    // Normally called from SCH_EDIT_FRAME::FixupJunctions() but could be refactored
+    for( SCH_SHEET_PATH& sheet : sheets )
+        sheet.UpdateAllScreenReferences();
+
+    // NOTE: SchematicCleanUp is not called; QA schematics must already be clean or else
+    // SchematicCleanUp must be freed from its UI dependencies.
+
+    m_schematic.ConnectionGraph()->Recalculate( sheets, true );
+}
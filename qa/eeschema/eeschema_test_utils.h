@@ -26,6 +26,10 @@
 
 #include <wx/filename.h>
 
+#include <sch_io_mgr.h>
+#include <schematic.h>
+#include <settings/settings_manager.h>
+
 namespace KI_TEST
 {
 
@@ -39,6 +43,32 @@ namespace KI_TEST
  */
 wxFileName GetEeschemaTestDataDir();
 
+
+/**
+ * A fixture for the tests working on one of the schematics of the netlist test data,
+ * loaded with its project and with its connectivity computed.
+ */
+class SCHEMATIC_TEST_FIXTURE
+{
+public:
+    SCHEMATIC_TEST_FIXTURE();
+
+    virtual ~SCHEMATIC_TEST_FIXTURE() {}
+
+    ///> Returns the full path of the schematic \a aBaseName of the netlist test data
+    static wxString getSchematicFile( const wxString& aBaseName );
+
+    ///> Loads the schematic \a aBaseName of the netlist test data, and its project
+    void loadSchematic( const wxString& aBaseName );
+
+    ///> Schematic to load
+    SCHEMATIC m_schematic;
+
+    SCH_PLUGIN* m_pi;
+
+    SETTINGS_MANAGER m_manager;
+};
+
 } // namespace KI_TEST
 
 #endif // QA_EESCHEMA_EESCHEMA_TEST_UTILS__H
\ No newline at end of file
@@ -0,0 +1,135 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+/**
+ * @file
+ * Test suite for SIM_DATA_BUFFER
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+#include <cmath>
+#include <vector>
+
+// Code under test
+#include <sim/sim_data_buffer.h>
+
+
+BOOST_AUTO_TEST_SUITE( SimDataBuffer )
+
+
+/**
+ * Check a disabled buffer ignores the simulator
+ */
+BOOST_AUTO_TEST_CASE( Disabled )
+{
+    SIM_DATA_BUFFER buffer;
+
+    buffer.Reset( { "time" }, { false } );
+    buffer.Append( { 1.0 } );
+
+    BOOST_CHECK_EQUAL( buffer.GetLength(), 0 );
+    BOOST_CHECK_EQUAL( buffer.FindVector( "time" ), -1 );
+}
+
+
+/**
+ * Check points are read back across chunks, and reads are limited to the stored points
+ */
+BOOST_AUTO_TEST_CASE( ReadAcrossChunks )
+{
+    SIM_DATA_BUFFER buffer;
+    const size_t    count = 150000;
+
+    buffer.SetEnabled( true );
+    buffer.Reset( { "time", "out" }, { false, false } );
+
+    for( size_t ii = 0; ii < count; ++ii )
+        buffer.Append( { (double) ii, 2.0 * ii } );
+
+    BOOST_REQUIRE_EQUAL( buffer.GetLength(), count );
+
+    std::vector<double> values;
+
+    BOOST_CHECK_EQUAL( buffer.Read( 1, 65530, 10, SDP_MAGNITUDE, values ), 10 );
+    BOOST_CHECK_EQUAL( buffer.Read( 1, count - 5, 10, SDP_MAGNITUDE, values ), 5 );
+    BOOST_CHECK_EQUAL( buffer.Read( 1, count, 10, SDP_MAGNITUDE, values ), 0 );
+    BOOST_REQUIRE_EQUAL( values.size(), 15 );
+
+    for( size_t ii = 0; ii < 10; ++ii )
+        BOOST_CHECK_EQUAL( values[ii], 2.0 * ( 65530 + ii ) );
+
+    BOOST_CHECK_EQUAL( values[10], 2.0 * ( count - 5 ) );
+}
+
+
+/**
+ * Check vectors are found by name or as node voltages, and new runs replace the vectors
+ */
+BOOST_AUTO_TEST_CASE( FindVectorAndRuns )
+{
+    SIM_DATA_BUFFER buffer;
+
+    buffer.SetEnabled( true );
+    buffer.Reset( { "time", "net-_r1-pad1_", "v1#branch" }, { false, false, false } );
+
+    unsigned int runId = buffer.GetRunId();
+
+    BOOST_CHECK_EQUAL( buffer.FindVector( "time" ), 0 );
+    BOOST_CHECK_EQUAL( buffer.FindVector( "V(Net-_R1-Pad1_)" ), 1 );
+    BOOST_CHECK_EQUAL( buffer.FindVector( "V1#branch" ), 2 );
+    BOOST_CHECK_EQUAL( buffer.FindVector( "V(missing)" ), -1 );
+
+    buffer.Append( { 0.0, 1.0, 2.0 } );
+    buffer.Reset( { "frequency", "out" }, { true, true } );
+
+    BOOST_CHECK_NE( buffer.GetRunId(), runId );
+    BOOST_CHECK_EQUAL( buffer.GetLength(), 0 );
+    BOOST_CHECK_EQUAL( buffer.FindVector( "time" ), -1 );
+}
+
+
+/**
+ * Check complex values are read as magnitude and phase
+ */
+BOOST_AUTO_TEST_CASE( ComplexParts )
+{
+    SIM_DATA_BUFFER buffer;
+
+    buffer.SetEnabled( true );
+    buffer.Reset( { "frequency", "out" }, { true, true } );
+    buffer.Append( { { 10.0, 0.0 }, { 3.0, 4.0 } } );
+
+    std::vector<double> mag, phase;
+
+    buffer.Read( 1, 0, 1, SDP_MAGNITUDE, mag );
+    buffer.Read( 1, 0, 1, SDP_PHASE, phase );
+
+    BOOST_REQUIRE_EQUAL( mag.size(), 1 );
+    BOOST_REQUIRE_EQUAL( phase.size(), 1 );
+    BOOST_CHECK_CLOSE( mag[0], 5.0, 1e-9 );
+    BOOST_CHECK_CLOSE( phase[0], std::atan2( 4.0, 3.0 ), 1e-9 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,229 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for SIM_SWEEP variants and SIM_SWEEP_RESULTS
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+#include <stdexcept>
+#include <vector>
+
+// Code under test
+#include <sim/sim_sweep.h>
+#include <sim/spice_simulator.h>
+
+
+BOOST_AUTO_TEST_SUITE( SimSweep )
+
+
+/**
+ * Check the grid variants cover every combination of the grid values
+ */
+BOOST_AUTO_TEST_CASE( GridVariants )
+{
+    SIM_SWEEP       sweep( "", ST_TRANSIENT );
+    SIM_SWEEP_PARAM r1( "R1", 1e3 );
+    SIM_SWEEP_PARAM c1( "C1", 1e-9 );
+    SIM_SWEEP_PARAM v1( "V1", 5.0 );
+
+    r1.m_gridValues = { 1e3, 2e3, 3e3 };
+    c1.m_gridValues = { 1e-9, 2e-9 };
+
+    sweep.AddParam( r1 );
+    sweep.AddParam( c1 );
+    sweep.AddParam( v1 );
+    sweep.MakeGridVariants();
+
+    BOOST_REQUIRE_EQUAL( sweep.GetVariantCount(), 6 );
+
+    const std::vector<double> r = { 1e3, 2e3, 3e3, 1e3, 2e3, 3e3 };
+    const std::vector<double> c = { 1e-9, 1e-9, 1e-9, 2e-9, 2e-9, 2e-9 };
+    const std::vector<double> v( 6, 5.0 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( sweep.GetParamValues( 0 ).begin(),
+                                   sweep.GetParamValues( 0 ).end(), r.begin(), r.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( sweep.GetParamValues( 1 ).begin(),
+                                   sweep.GetParamValues( 1 ).end(), c.begin(), c.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( sweep.GetParamValues( 2 ).begin(),
+                                   sweep.GetParamValues( 2 ).end(), v.begin(), v.end() );
+}
+
+
+/**
+ * Check the Monte-Carlo variants stay within the tolerances and are reproducible
+ */
+BOOST_AUTO_TEST_CASE( MonteCarloVariants )
+{
+    SIM_SWEEP       sweep( "", ST_TRANSIENT );
+    SIM_SWEEP_PARAM r1( "R1", 1e3 );
+    SIM_SWEEP_PARAM c1( "C1", 1e-9 );
+
+    r1.m_tolerance = 0.05;
+    c1.m_tolerance = 0.1;
+    c1.m_distribution = SSD_GAUSSIAN;
+
+    sweep.AddParam( r1 );
+    sweep.AddParam( c1 );
+    sweep.MakeMonteCarloVariants( 200, 42 );
+
+    BOOST_REQUIRE_EQUAL( sweep.GetVariantCount(), 200 );
+
+    // The first variant is the nominal one
+    BOOST_CHECK_EQUAL( sweep.GetParamValues( 0 )[0], 1e3 );
+    BOOST_CHECK_EQUAL( sweep.GetParamValues( 1 )[0], 1e-9 );
+
+    for( double r : sweep.GetParamValues( 0 ) )
+        BOOST_CHECK( r >= 950.0 && r <= 1050.0 );
+
+    for( double c : sweep.GetParamValues( 1 ) )
+        BOOST_CHECK( c >= 0.9e-9 && c <= 1.1e-9 );
+
+    std::vector<double> first = sweep.GetParamValues( 0 );
+
+    sweep.MakeMonteCarloVariants( 200, 42 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( first.begin(), first.end(), sweep.GetParamValues( 0 ).begin(),
+                                   sweep.GetParamValues( 0 ).end() );
+}
+
+
+/**
+ * Check the envelope of variants simulated at different time steps
+ */
+BOOST_AUTO_TEST_CASE( Envelope )
+{
+    SIM_SWEEP_RESULTS results( 3, 1 );
+
+    results.SetResult( 0, { 0.0, 1.0, 2.0 }, { { 0.0, 1.0, 2.0 } } );
+    results.SetResult( 2, { 0.0, 0.5, 2.0 }, { { 1.0, 0.0, 1.0 } } );
+
+    BOOST_CHECK( results.IsValid( 0 ) );
+    BOOST_CHECK( !results.IsValid( 1 ) );
+    BOOST_CHECK( results.IsValid( 2 ) );
+
+    std::vector<double> x, min, max;
+
+    BOOST_REQUIRE( results.GetEnvelope( 0, x, min, max ) );
+
+    const std::vector<double> expX = { 0.0, 1.0, 2.0 };
+    const std::vector<double> expMin = { 0.0, 1.0 / 3.0, 1.0 };
+    const std::vector<double> expMax = { 1.0, 1.0, 2.0 };
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( x.begin(), x.end(), expX.begin(), expX.end() );
+    BOOST_REQUIRE_EQUAL( min.size(), 3 );
+    BOOST_REQUIRE_EQUAL( max.size(), 3 );
+
+    for( size_t ii = 0; ii < 3; ++ii )
+    {
+        BOOST_CHECK_CLOSE( min[ii] + 1.0, expMin[ii] + 1.0, 1e-9 );
+        BOOST_CHECK_CLOSE( max[ii] + 1.0, expMax[ii] + 1.0, 1e-9 );
+    }
+
+    std::vector<double> values = results.GetValuesAt( 0, 1.5 );
+
+    BOOST_REQUIRE_EQUAL( values.size(), 2 );
+    BOOST_CHECK_CLOSE( values[0], 1.5, 1e-9 );
+    BOOST_CHECK_CLOSE( values[1], 2.0 / 3.0, 1e-9 );
+}
+
+
+/**
+ * Check the histogram of operating point results
+ */
+BOOST_AUTO_TEST_CASE( Histogram )
+{
+    SIM_SWEEP_RESULTS results( 5, 1 );
+    const double      op[] = { 1.0, 2.0, 2.5, 4.0, 5.0 };
+
+    for( size_t ii = 0; ii < 5; ++ii )
+        results.SetResult( ii, {}, { { op[ii] } } );
+
+    double              min = 0.0;
+    double              max = 0.0;
+    std::vector<size_t> bins = SIM_SWEEP_RESULTS::Histogram( results.GetValuesAt( 0, 0.0 ), 4,
+                                                             min, max );
+    const std::vector<size_t> expBins = { 1, 2, 0, 2 };
+
+    BOOST_CHECK_EQUAL( min, 1.0 );
+    BOOST_CHECK_EQUAL( max, 5.0 );
+    BOOST_CHECK_EQUAL_COLLECTIONS( bins.begin(), bins.end(), expBins.begin(), expBins.end() );
+}
+
+
+/**
+ * Check the variants simulated in parallel by ngspice, when its library is installed
+ */
+BOOST_AUTO_TEST_CASE( RunNgspice )
+{
+    try
+    {
+        SPICE_SIMULATOR::CreateWorkerInstance( "ngspice" );
+    }
+    catch( const std::exception& e )
+    {
+        BOOST_TEST_MESSAGE( "Skipped, ngspice is not available: " << e.what() );
+        return;
+    }
+
+    const std::string netlist = "Voltage divider\n"
+                                "V1 1 0 DC 10\n"
+                                "R1 1 2 1k\n"
+                                "R2 2 0 1k\n"
+                                ".op\n"
+                                ".end\n";
+
+    SIM_SWEEP       sweep( netlist, ST_OP );
+    SIM_SWEEP_PARAM r1( "r1", 1e3 );
+    SIM_SWEEP_PARAM r2( "r2", 1e3 );
+
+    r1.m_gridValues = { 1e3, 3e3 };
+    r2.m_gridValues = { 1e3, 3e3 };
+
+    sweep.AddParam( r1 );
+    sweep.AddParam( r2 );
+    sweep.AddSignal( "V(2)" );
+    sweep.MakeGridVariants();
+
+    SIM_SWEEP_RESULTS results = sweep.Run( 2 );
+
+    BOOST_REQUIRE_EQUAL( results.GetVariantCount(), 4 );
+    BOOST_CHECK_EQUAL( sweep.GetDoneCount(), 4 );
+
+    const double expected[] = { 5.0, 2.5, 7.5, 5.0 };
+
+    for( size_t ii = 0; ii < 4; ++ii )
+    {
+        BOOST_TEST_CONTEXT( "Variant " << ii )
+        {
+            BOOST_REQUIRE( results.IsValid( ii ) );
+            BOOST_CHECK( results.GetXAxis( ii ).empty() );
+            BOOST_REQUIRE_EQUAL( results.GetSignal( 0, ii ).size(), 1 );
+            BOOST_CHECK_CLOSE( results.GetSignal( 0, ii )[0], expected[ii], 1e-6 );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,334 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the incremental updates of CONNECTION_GRAPH, checked against full updates
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+#include "eeschema_test_utils.h"
+
+#include <map>
+#include <memory>
+#include <set>
+
+#include <sch_component.h>
+#include <sch_line.h>
+#include <sch_pin.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_text.h>
+
+// Code under test
+#include <connection_graph.h>
+
+
+class CONNECTION_GRAPH_FIXTURE : public KI_TEST::SCHEMATIC_TEST_FIXTURE
+{
+public:
+    ///> Returns the instances of the sheet used twice in the schematic
+    std::vector<SCH_SHEET_PATH> getSharedSheets();
+
+    ///> Returns the net of every item and pin of the schematic, on every sheet
+    std::map<wxString, wxString> getItemNets();
+
+    ///> Returns the subgraphs of every net, as their sheet and items
+    std::map<wxString, std::multiset<wxString>> getNetSubgraphs();
+
+    /**
+     * Updates the graph incrementally, then checks a full update gives the same nets and
+     * subgraphs.
+     *
+     * @param aKeptItem is an item away from the edits, its subgraph must not be rebuilt
+     */
+    void checkIncrementalUpdate( SCH_ITEM* aKeptItem );
+
+    ///> Returns the "12Vext" label of the root sheet
+    SCH_ITEM* getRootLabel();
+
+    ///> Items removed from the schematic, which the graph may still refer to
+    std::vector<std::unique_ptr<SCH_ITEM>> m_removed;
+};
+
+
+static wxString getItemKey( SCH_ITEM* aItem )
+{
+    if( aItem->Type() == SCH_PIN_T )
+    {
+        SCH_PIN* pin = static_cast<SCH_PIN*>( aItem );
+
+        return pin->GetParentComponent()->m_Uuid.AsString() + ":" + pin->GetNumber();
+    }
+
+    return aItem->m_Uuid.AsString();
+}
+
+
+std::vector<SCH_SHEET_PATH> CONNECTION_GRAPH_FIXTURE::getSharedSheets()
+{
+    std::vector<SCH_SHEET_PATH> sheets;
+
+    for( const SCH_SHEET_PATH& sheet : m_schematic.GetSheets() )
+    {
+        if( sheet.LastScreen() != m_schematic.RootScreen() )
+            sheets.push_back( sheet );
+    }
+
+    BOOST_REQUIRE_EQUAL( sheets.size(), 2u );
+    BOOST_REQUIRE_EQUAL( sheets[0].LastScreen(), sheets[1].LastScreen() );
+
+    return sheets;
+}
+
+
+std::map<wxString, wxString> CONNECTION_GRAPH_FIXTURE::getItemNets()
+{
+    std::map<wxString, wxString> nets;
+
+    for( const SCH_SHEET_PATH& sheet : m_schematic.GetSheets() )
+    {
+        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        {
+            if( !item->IsConnectable() )
+                continue;
+
+            std::vector<SCH_ITEM*> graphItems;
+
+            if( item->Type() == SCH_COMPONENT_T )
+            {
+                for( SCH_PIN* pin : static_cast<SCH_COMPONENT*>( item )->GetPins( &sheet ) )
+                    graphItems.push_back( pin );
+            }
+            else if( item->Type() == SCH_SHEET_T )
+            {
+                for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
+                    graphItems.push_back( pin );
+            }
+            else
+            {
+                graphItems.push_back( item );
+            }
+
+            for( SCH_ITEM* graphItem : graphItems )
+            {
+                SCH_CONNECTION* connection = graphItem->Connection( sheet );
+
+                nets[sheet.PathAsString() + getItemKey( graphItem )] =
+                        connection ? connection->Name() : wxString( "<none>" );
+            }
+        }
+    }
+
+    return nets;
+}
+
+
+std::map<wxString, std::multiset<wxString>> CONNECTION_GRAPH_FIXTURE::getNetSubgraphs()
+{
+    std::map<wxString, std::multiset<wxString>> subgraphs;
+
+    for( const auto& net : m_schematic.ConnectionGraph()->GetNetMap() )
+    {
+        for( const CONNECTION_SUBGRAPH* subgraph : net.second )
+        {
+            std::set<wxString> items;
+
+            for( SCH_ITEM* item : subgraph->m_items )
+                items.insert( getItemKey( item ) );
+
+            wxString desc = subgraph->m_sheet.PathAsString();
+
+            for( const wxString& item : items )
+                desc << " " << item;
+
+            subgraphs[net.first.first].insert( desc );
+        }
+    }
+
+    return subgraphs;
+}
+
+
+SCH_ITEM* CONNECTION_GRAPH_FIXTURE::getRootLabel()
+{
+    for( SCH_ITEM* item : m_schematic.RootScreen()->Items().OfType( SCH_LABEL_T ) )
+    {
+        if( static_cast<SCH_TEXT*>( item )->GetText() == "12Vext" )
+            return item;
+    }
+
+    BOOST_FAIL( "No 12Vext label in the root sheet" );
+    return nullptr;
+}
+
+
+template <typename MAP>
+static void checkSameMaps( const MAP& aIncremental, const MAP& aFull )
+{
+    BOOST_CHECK_EQUAL( aIncremental.size(), aFull.size() );
+
+    for( const auto& entry : aFull )
+    {
+        BOOST_TEST_CONTEXT( entry.first )
+        {
+            auto it = aIncremental.find( entry.first );
+
+            BOOST_CHECK( it != aIncremental.end() );
+
+            if( it != aIncremental.end() )
+                BOOST_CHECK( it->second == entry.second );
+        }
+    }
+}
+
+
+void CONNECTION_GRAPH_FIXTURE::checkIncrementalUpdate( SCH_ITEM* aKeptItem )
+{
+    SCH_SHEET_LIST    sheets = m_schematic.GetSheets();
+    CONNECTION_GRAPH* graph = m_schematic.ConnectionGraph();
+
+    CONNECTION_SUBGRAPH* kept = graph->GetSubgraphForItem( aKeptItem );
+    BOOST_REQUIRE( kept );
+
+    graph->Recalculate( sheets, false );
+
+    // The update was not a full one
+    BOOST_CHECK_EQUAL( graph->GetSubgraphForItem( aKeptItem ), kept );
+
+    std::map<wxString, wxString>                incrementalNets = getItemNets();
+    std::map<wxString, std::multiset<wxString>> incrementalSubgraphs = getNetSubgraphs();
+
+    graph->Recalculate( sheets, true );
+
+    checkSameMaps( incrementalNets, getItemNets() );
+    checkSameMaps( incrementalSubgraphs, getNetSubgraphs() );
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectionGraph, CONNECTION_GRAPH_FIXTURE )
+
+
+/**
+ * Check an update without any change keeps the graph
+ */
+BOOST_AUTO_TEST_CASE( NoChange )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    checkIncrementalUpdate( getRootLabel() );
+}
+
+
+/**
+ * Check renaming a label of a sheet used twice renames its net on both instances
+ */
+BOOST_AUTO_TEST_CASE( RenameSharedLabel )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    SCH_SCREEN* screen = getSharedSheets()[0].LastScreen();
+    SCH_TEXT*   label = nullptr;
+
+    for( SCH_ITEM* item : screen->Items().OfType( SCH_LABEL_T ) )
+    {
+        if( static_cast<SCH_TEXT*>( item )->GetText() == "PIEZO_OUT" )
+            label = static_cast<SCH_TEXT*>( item );
+    }
+
+    BOOST_REQUIRE( label );
+
+    label->SetText( "PIEZO_OUT_RENAMED" );
+    label->SetConnectivityDirty();
+
+    checkIncrementalUpdate( getRootLabel() );
+}
+
+
+/**
+ * Check deleting a wire of a sheet used twice splits its nets on both instances
+ */
+BOOST_AUTO_TEST_CASE( DeleteSharedWire )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    SCH_SHEET_PATH sheet = getSharedSheets()[0];
+    SCH_SCREEN*    screen = sheet.LastScreen();
+    SCH_LINE*      wire = nullptr;
+
+    // A wire of an unnamed net: the power nets reach most of the schematic
+    for( SCH_ITEM* item : screen->Items().OfType( SCH_LINE_T ) )
+    {
+        SCH_CONNECTION* connection = item->Connection( sheet );
+
+        if( static_cast<SCH_LINE*>( item )->IsWire() && connection
+                && connection->Name().Contains( "Net-(" ) )
+        {
+            wire = static_cast<SCH_LINE*>( item );
+            break;
+        }
+    }
+
+    BOOST_REQUIRE( wire );
+
+    screen->Remove( wire );
+    m_removed.emplace_back( wire );
+
+    checkIncrementalUpdate( getRootLabel() );
+}
+
+
+/**
+ * Check a symbol showing another unit on one instance of a shared sheet is updated on that
+ * instance, even if the symbol is not flagged as changed: the pins of each instance are
+ * compared with the graph
+ */
+BOOST_AUTO_TEST_CASE( InstanceUnitChange )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    std::vector<SCH_SHEET_PATH> sheets = getSharedSheets();
+    SCH_COMPONENT*              symbol = nullptr;
+
+    for( SCH_ITEM* item : sheets[0].LastScreen()->Items().OfType( SCH_COMPONENT_T ) )
+    {
+        SCH_COMPONENT* candidate = static_cast<SCH_COMPONENT*>( item );
+
+        if( candidate->GetUnitCount() > 1 && candidate->GetUnitSelection( &sheets[1] ) == 1 )
+        {
+            symbol = candidate;
+            break;
+        }
+    }
+
+    BOOST_REQUIRE( symbol );
+
+    symbol->SetUnitSelection( &sheets[1], 2 );
+
+    BOOST_CHECK( symbol->GetPins( &sheets[0] ) != symbol->GetPins( &sheets[1] ) );
+
+    checkIncrementalUpdate( getRootLabel() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
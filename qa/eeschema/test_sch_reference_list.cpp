@@ -0,0 +1,277 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the annotation of SCH_REFERENCE_LIST, on a hierarchy with a sheet used twice
+ * holding the two units of a package
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+#include "eeschema_test_utils.h"
+
+#include <map>
+#include <set>
+
+#include <sch_component.h>
+#include <sch_screen.h>
+#include <sch_sheet_path.h>
+
+// Code under test
+#include <sch_reference_list.h>
+
+
+class REFERENCE_LIST_FIXTURE : public KI_TEST::SCHEMATIC_TEST_FIXTURE
+{
+public:
+    ///> A symbol instance: sheet path and symbol uuid
+    typedef std::pair<wxString, wxString> INSTANCE;
+
+    ///> A reference and a unit
+    typedef std::pair<wxString, int> ANNOTATION;
+
+    ///> Returns the annotation of every symbol instance of the schematic
+    std::map<INSTANCE, ANNOTATION> getAnnotations();
+
+    /**
+     * Annotates the components not annotated yet, as SCH_EDIT_FRAME::AnnotateComponents()
+     * does, and returns the number of components whose annotation changed.
+     */
+    int annotate();
+
+    ///> Returns the instance of the shared sheet holding U4, the other one holds U3
+    SCH_SHEET_PATH getSecondSharedSheet();
+
+    ///> Returns the symbol of the shared sheet with the given uuid
+    SCH_COMPONENT* getSymbol( const SCH_SHEET_PATH& aSheet, const wxString& aUuid );
+};
+
+
+std::map<REFERENCE_LIST_FIXTURE::INSTANCE, REFERENCE_LIST_FIXTURE::ANNOTATION>
+REFERENCE_LIST_FIXTURE::getAnnotations()
+{
+    std::map<INSTANCE, ANNOTATION> annotations;
+
+    for( const SCH_SHEET_PATH& sheet : m_schematic.GetSheets() )
+    {
+        for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_COMPONENT_T ) )
+        {
+            SCH_COMPONENT* symbol = static_cast<SCH_COMPONENT*>( item );
+
+            annotations[ INSTANCE( sheet.PathAsString(), symbol->m_Uuid.AsString() ) ] =
+                    ANNOTATION( symbol->GetRef( &sheet ), symbol->GetUnitSelection( &sheet ) );
+        }
+    }
+
+    return annotations;
+}
+
+
+int REFERENCE_LIST_FIXTURE::annotate()
+{
+    SCH_REFERENCE_LIST           references;
+    SCH_MULTI_UNIT_REFERENCE_MAP lockedComponents;
+    int                          changed = 0;
+
+    m_schematic.GetSheets().GetComponents( references );
+    references.SplitReferences();
+    references.SortByXCoordinate();
+    references.Annotate( false, 0, 0, lockedComponents );
+
+    for( unsigned ii = 0; ii < references.GetCount(); ++ii )
+    {
+        if( references[ii].IsAnnotationChanged() )
+        {
+            references[ii].Annotate();
+            changed++;
+        }
+    }
+
+    return changed;
+}
+
+
+SCH_SHEET_PATH REFERENCE_LIST_FIXTURE::getSecondSharedSheet()
+{
+    for( const SCH_SHEET_PATH& sheet : m_schematic.GetSheets() )
+    {
+        if( sheet.LastScreen() == m_schematic.RootScreen() )
+            continue;
+
+        SCH_COMPONENT* symbol = getSymbol( sheet, "00000000-0000-0000-0000-00004b3a1368" );
+
+        if( symbol->GetRef( &sheet ) == "U4" )
+            return sheet;
+    }
+
+    BOOST_FAIL( "No instance of the shared sheet with U4" );
+    return SCH_SHEET_PATH();
+}
+
+
+SCH_COMPONENT* REFERENCE_LIST_FIXTURE::getSymbol( const SCH_SHEET_PATH& aSheet,
+                                                  const wxString& aUuid )
+{
+    for( SCH_ITEM* item : aSheet.LastScreen()->Items().OfType( SCH_COMPONENT_T ) )
+    {
+        if( item->m_Uuid.AsString() == aUuid )
+            return static_cast<SCH_COMPONENT*>( item );
+    }
+
+    BOOST_FAIL( "No symbol " << aUuid << " in the shared sheet" );
+    return nullptr;
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( SchReferenceList, REFERENCE_LIST_FIXTURE )
+
+
+/**
+ * An annotated schematic is left untouched
+ */
+BOOST_AUTO_TEST_CASE( AnnotatedUnchanged )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    std::map<INSTANCE, ANNOTATION> before = getAnnotations();
+
+    BOOST_CHECK_EQUAL( annotate(), 0 );
+    BOOST_CHECK( getAnnotations() == before );
+}
+
+
+/**
+ * A new unit completes the package of the other unit of its sheet instance, and only the
+ * new unit is changed
+ */
+BOOST_AUTO_TEST_CASE( NewUnitCompletesPackage )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    std::map<INSTANCE, ANNOTATION> before = getAnnotations();
+    SCH_SHEET_PATH                 sheet = getSecondSharedSheet();
+
+    // Unit 1 of U4, placed right of unit 2
+    getSymbol( sheet, "00000000-0000-0000-0000-00004b3a1368" )->ClearAnnotation( &sheet );
+
+    BOOST_CHECK_EQUAL( annotate(), 1 );
+    BOOST_CHECK( getAnnotations() == before );
+}
+
+
+/**
+ * A new package takes the first free number, and the other sheet instance keeps its package
+ */
+BOOST_AUTO_TEST_CASE( NewPackage )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    std::map<INSTANCE, ANNOTATION> before = getAnnotations();
+    SCH_SHEET_PATH                 sheet = getSecondSharedSheet();
+    std::set<INSTANCE>             cleared;
+
+    for( const wxString& uuid : { "00000000-0000-0000-0000-00004b3a1368",
+                                  "00000000-0000-0000-0000-00004b3a135c" } )
+    {
+        getSymbol( sheet, uuid )->ClearAnnotation( &sheet );
+        cleared.emplace( sheet.PathAsString(), uuid );
+    }
+
+    BOOST_CHECK_EQUAL( annotate(), 2 );
+
+    std::map<INSTANCE, ANNOTATION> after = getAnnotations();
+    std::set<int>                  units;
+
+    BOOST_REQUIRE_EQUAL( after.size(), before.size() );
+
+    for( const auto& annotation : after )
+    {
+        BOOST_TEST_CONTEXT( annotation.first.first << " " << annotation.first.second )
+        {
+            if( cleared.count( annotation.first ) )
+            {
+                BOOST_CHECK_EQUAL( annotation.second.first, "U4" );
+                units.insert( annotation.second.second );
+            }
+            else
+            {
+                BOOST_CHECK( annotation.second == before[annotation.first] );
+            }
+        }
+    }
+
+    BOOST_CHECK( units == std::set<int>( { 1, 2 } ) );
+}
+
+
+/**
+ * A schematic annotated again from scratch has no duplicate reference, and the four units
+ * of the shared sheet instances fill two packages
+ */
+BOOST_AUTO_TEST_CASE( AnnotateAll )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    for( const SCH_SHEET_PATH& sheet : m_schematic.GetSheets() )
+    {
+        for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_COMPONENT_T ) )
+            static_cast<SCH_COMPONENT*>( item )->ClearAnnotation( &sheet );
+    }
+
+    std::map<INSTANCE, ANNOTATION> before = getAnnotations();
+
+    BOOST_CHECK_EQUAL( annotate(), (int) before.size() );
+
+    std::set<ANNOTATION>              used;
+    std::map<wxString, std::set<int>> packages;     // LM358N references to their units
+
+    for( const auto& annotation : getAnnotations() )
+    {
+        BOOST_TEST_CONTEXT( annotation.second.first << " unit " << annotation.second.second )
+        {
+            BOOST_CHECK( !annotation.second.first.EndsWith( "?" ) );
+            BOOST_CHECK( used.insert( annotation.second ).second );
+        }
+
+        const wxString& uuid = annotation.first.second;
+
+        if( uuid == "00000000-0000-0000-0000-00004b3a1368"
+                || uuid == "00000000-0000-0000-0000-00004b3a135c" )
+        {
+            packages[annotation.second.first].insert( annotation.second.second );
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL( packages.size(), 2 );
+
+    for( const auto& package : packages )
+    {
+        BOOST_TEST_CONTEXT( package.first )
+        {
+            BOOST_CHECK( package.second == std::set<int>( { 1, 2 } ) );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,254 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for SCH_SCREEN::TestDanglingEnds(), checked against a test of every item with
+ * all the end points of its screen
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+#include "eeschema_test_utils.h"
+
+#include <functional>
+#include <memory>
+
+#include <sch_bus_entry.h>
+#include <sch_component.h>
+#include <sch_junction.h>
+#include <sch_line.h>
+#include <sch_pin.h>
+#include <sch_sheet.h>
+#include <sch_text.h>
+
+// Code under test
+#include <sch_screen.h>
+
+
+/**
+ * Checks the dangling states TestDanglingEnds() set are the ones found when testing each
+ * item with all the end points of the screen, as it used to be done.
+ */
+static void checkAgainstAllEndPoints( SCH_SCREEN* aScreen, const SCH_SHEET_PATH* aPath )
+{
+    std::vector<DANGLING_END_ITEM> endPoints;
+
+    for( SCH_ITEM* item : aScreen->Items() )
+        item->GetEndPoints( endPoints );
+
+    for( SCH_ITEM* item : aScreen->Items() )
+    {
+        BOOST_TEST_CONTEXT( item->GetClass() << " at " << item->GetPosition().x << ", "
+                                             << item->GetPosition().y )
+        {
+            // Nothing changes
+            BOOST_CHECK( !item->UpdateDanglingState( endPoints, aPath ) );
+        }
+    }
+}
+
+
+static SCH_LINE* addLine( SCH_SCREEN& aScreen, const wxPoint& aStart, const wxPoint& aEnd,
+                          int aLayer = LAYER_WIRE )
+{
+    SCH_LINE* line = new SCH_LINE( aStart, aLayer );
+
+    line->SetEndPoint( aEnd );
+    aScreen.Append( line );
+
+    return line;
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( SchScreen, KI_TEST::SCHEMATIC_TEST_FIXTURE )
+
+
+/**
+ * Wire ends, labels on wire ends and in the middle of wires, junctions and bus entries
+ */
+BOOST_AUTO_TEST_CASE( DanglingWiresLabelsBusEntries )
+{
+    SCH_SCREEN screen( &m_schematic );
+
+    // Two wires meeting at a junction, the other ends are free
+    SCH_LINE* first = addLine( screen, wxPoint( 0, 0 ), wxPoint( 10000, 0 ) );
+    SCH_LINE* second = addLine( screen, wxPoint( 10000, 0 ), wxPoint( 10000, 10000 ) );
+
+    screen.Append( new SCH_JUNCTION( wxPoint( 10000, 0 ) ) );
+
+    // A label in the middle of the first wire, one at the end of the second one, and one
+    // connected to nothing
+    SCH_LABEL*       middleLabel = new SCH_LABEL( wxPoint( 5000, 0 ), "MIDDLE" );
+    SCH_GLOBALLABEL* endLabel = new SCH_GLOBALLABEL( wxPoint( 10000, 10000 ), "END" );
+    SCH_LABEL*       freeLabel = new SCH_LABEL( wxPoint( 50000, 50000 ), "FREE" );
+
+    screen.Append( middleLabel );
+    screen.Append( endLabel );
+    screen.Append( freeLabel );
+
+    // A bus with an entry to a wire, and an entry to nothing
+    addLine( screen, wxPoint( 0, 20000 ), wxPoint( 20000, 20000 ), LAYER_BUS );
+
+    SCH_BUS_WIRE_ENTRY* entry = new SCH_BUS_WIRE_ENTRY( wxPoint( 5000, 20000 ) );
+    SCH_BUS_WIRE_ENTRY* freeEntry = new SCH_BUS_WIRE_ENTRY( wxPoint( 15000, 20000 ) );
+
+    screen.Append( entry );
+    screen.Append( freeEntry );
+
+    SCH_LINE* entryWire = addLine( screen, entry->GetEnd(),
+                                   entry->GetEnd() + wxPoint( 0, 5000 ) );
+
+    BOOST_CHECK( screen.TestDanglingEnds() );
+
+    BOOST_CHECK( first->IsStartDangling() );
+    BOOST_CHECK( !first->IsEndDangling() );
+    BOOST_CHECK( !second->IsStartDangling() );
+    BOOST_CHECK( !second->IsEndDangling() );
+
+    BOOST_CHECK( !middleLabel->IsDangling() );
+    BOOST_CHECK( !endLabel->IsDangling() );
+    BOOST_CHECK( freeLabel->IsDangling() );
+
+    BOOST_CHECK( !entry->IsDanglingStart() );
+    BOOST_CHECK( !entry->IsDanglingEnd() );
+    BOOST_CHECK( !freeEntry->IsDanglingStart() );
+    BOOST_CHECK( freeEntry->IsDanglingEnd() );
+    BOOST_CHECK( !entryWire->IsStartDangling() );
+    BOOST_CHECK( entryWire->IsEndDangling() );
+
+    checkAgainstAllEndPoints( &screen, nullptr );
+
+    // Only the items whose state changes are reported
+    BOOST_CHECK( !screen.TestDanglingEnds() );
+
+    screen.Remove( second );
+    delete second;
+
+    int changed = 0;
+    std::function<void( SCH_ITEM* )> handler =
+            [&]( SCH_ITEM* aItem )
+            {
+                changed++;
+            };
+
+    BOOST_CHECK( screen.TestDanglingEnds( nullptr, &handler ) );
+    BOOST_CHECK_EQUAL( changed, 1 );    // the end label
+
+    BOOST_CHECK( !first->IsEndDangling() );     // still on the junction
+    BOOST_CHECK( endLabel->IsDangling() );
+    BOOST_CHECK( !middleLabel->IsDangling() );
+
+    checkAgainstAllEndPoints( &screen, nullptr );
+}
+
+
+/**
+ * A symbol pin connected by a single wire dangles once the wire is removed
+ */
+BOOST_AUTO_TEST_CASE( DanglingPins )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    SCH_SHEET_PATH sheet = m_schematic.GetSheets()[0];
+    SCH_SCREEN*    screen = sheet.LastScreen();
+
+    BOOST_REQUIRE_EQUAL( screen, m_schematic.RootScreen() );
+
+    screen->TestDanglingEnds( &sheet );
+
+    std::vector<DANGLING_END_ITEM> endPoints;
+
+    for( SCH_ITEM* item : screen->Items() )
+        item->GetEndPoints( endPoints );
+
+    SCH_PIN*  pin = nullptr;
+    SCH_LINE* wire = nullptr;
+
+    for( SCH_ITEM* item : screen->Items().OfType( SCH_COMPONENT_T ) )
+    {
+        for( SCH_PIN* candidate : static_cast<SCH_COMPONENT*>( item )->GetPins( &sheet ) )
+        {
+            std::vector<const DANGLING_END_ITEM*> atPin;
+
+            for( const DANGLING_END_ITEM& endPoint : endPoints )
+            {
+                if( endPoint.GetPosition() == candidate->GetTransformedPosition() )
+                    atPin.push_back( &endPoint );
+            }
+
+            // The pin itself and a wire end
+            if( atPin.size() != 2 )
+                continue;
+
+            for( const DANGLING_END_ITEM* endPoint : atPin )
+            {
+                if( endPoint->GetType() == WIRE_START_END || endPoint->GetType() == WIRE_END_END )
+                    wire = static_cast<SCH_LINE*>( endPoint->GetItem() );
+            }
+
+            if( wire )
+            {
+                pin = candidate;
+                break;
+            }
+        }
+
+        if( pin )
+            break;
+    }
+
+    BOOST_REQUIRE( pin && wire );
+    BOOST_CHECK( !pin->IsDangling() );
+
+    screen->Remove( wire );
+    std::unique_ptr<SCH_LINE> removed( wire );
+
+    BOOST_CHECK( screen->TestDanglingEnds( &sheet ) );
+    BOOST_CHECK( pin->IsDangling() );
+
+    checkAgainstAllEndPoints( screen, &sheet );
+}
+
+
+/**
+ * The dangling states of whole schematics are the ones of a test with all the end points
+ */
+BOOST_AUTO_TEST_CASE( Schematics )
+{
+    for( const wxString& name : { "complex_hierarchy", "video", "test_global_promotion" } )
+    {
+        BOOST_TEST_CONTEXT( name )
+        {
+            loadSchematic( name );
+
+            for( const SCH_SHEET_PATH& sheet : m_schematic.GetSheets() )
+            {
+                sheet.LastScreen()->TestDanglingEnds( &sheet );
+                checkAgainstAllEndPoints( sheet.LastScreen(), &sheet );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
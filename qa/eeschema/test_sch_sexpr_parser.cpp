@@ -0,0 +1,176 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the number conversions of the s-expression parser, whose fast path must
+ * give the same results as strtod()
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <clocale>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include <common.h>
+#include <lib_text.h>
+#include <richio.h>
+
+// Code under test
+#include <sch_sexpr_parser.h>
+
+
+/**
+ * The values of a symbol text, the simplest draw item with both a length and a double
+ */
+struct PARSED_TEXT
+{
+    int    m_x;
+    double m_angle;
+};
+
+
+static PARSED_TEXT parseText( const std::string& aX, const std::string& aAngle, bool aFastPath )
+{
+    std::string text = "(text \"T\" (at " + aX + " 0 " + aAngle + ") "
+                       "(effects (font (size 1.27 1.27))))";
+
+    STRING_LINE_READER reader( text, "test" );
+    SCH_SEXPR_PARSER   parser( &reader );
+
+    parser.SetFastPath( aFastPath );
+
+    BOOST_REQUIRE_EQUAL( parser.NextTok(), TSCHEMATIC_T::T_LEFT );
+    BOOST_REQUIRE_EQUAL( parser.NextTok(), TSCHEMATIC_T::T_text );
+
+    std::unique_ptr<LIB_ITEM> item( parser.ParseDrawItem() );
+    LIB_TEXT*                 libText = dynamic_cast<LIB_TEXT*>( item.get() );
+
+    BOOST_REQUIRE( libText );
+
+    return { libText->GetPosition().x, libText->GetTextAngle() };
+}
+
+
+///> The length in internal units strtod() gives, clamped as the parser does
+static int strtodInternalUnits( const std::string& aText )
+{
+    double int_limit = std::numeric_limits<int>::max() * 0.7071;
+
+    return KiROUND( Clamp<double>( -int_limit, strtod( aText.c_str(), nullptr ) * IU_PER_MM,
+                                   int_limit ) );
+}
+
+
+///> Numbers the fast path converts, and numbers it leaves to strtod()
+static const char* const numbers[] = {
+    // Plain decimals
+    "0", "-0", "+0", "1", "-1", "+1.5", ".5", "-.5", "5.", "2.54", "-2.54", "0.0001", "-0.0001",
+    "1234.5678", "0.1", "0.3",
+    // More decimals than internal units, rounded
+    "0.00005", "-0.00005", "0.00015", "1.27000000001", "3.14159265358979",
+    // Long mantissas
+    "3.14159265358979323846", "0.30000000000000000000001", "12345678901234567",
+    "9007199254740993",
+    // Exponents
+    "1e2", "1E2", "1e-3", "-2.54e+1", "2.54E-0", ".5e1", "5.e-1", "1e308", "-1e308",
+    // Out of the schematic range, clamped
+    "1000000", "-1000000", "12345678901234567890"
+};
+
+
+BOOST_AUTO_TEST_SUITE( SchSexprParser )
+
+
+/**
+ * The fast conversions give the same lengths and doubles as strtod(), the reference path
+ */
+BOOST_AUTO_TEST_CASE( NumbersMatchStrtod )
+{
+    // The plugins parse with the "C" locale
+    LOCALE_IO toggle;
+
+    for( const char* number : numbers )
+    {
+        BOOST_TEST_CONTEXT( number )
+        {
+            PARSED_TEXT fast = parseText( number, number, true );
+            PARSED_TEXT reference = parseText( number, number, false );
+
+            BOOST_CHECK_EQUAL( fast.m_x, strtodInternalUnits( number ) );
+            BOOST_CHECK_EQUAL( fast.m_angle, strtod( number, nullptr ) );
+            BOOST_CHECK_EQUAL( fast.m_x, reference.m_x );
+            BOOST_CHECK_EQUAL( fast.m_angle, reference.m_angle );
+        }
+    }
+}
+
+
+/**
+ * The fast conversions don't depend on the locale: they give the "C" locale results even
+ * with a decimal comma
+ */
+BOOST_AUTO_TEST_CASE( NumbersIgnoreLocale )
+{
+    std::string previous = setlocale( LC_NUMERIC, nullptr );
+    const char* commaLocale = nullptr;
+
+    for( const char* name : { "de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR", "German" } )
+    {
+        if( setlocale( LC_NUMERIC, name ) )
+        {
+            commaLocale = name;
+            break;
+        }
+    }
+
+    if( !commaLocale || localeconv()->decimal_point[0] != ',' )
+    {
+        setlocale( LC_NUMERIC, previous.c_str() );
+        BOOST_TEST_MESSAGE( "No locale with a decimal comma, test skipped" );
+        return;
+    }
+
+    for( const char* number : { "2.54", "-0.0001", "1234.5678", ".5", "0.1" } )
+    {
+        BOOST_TEST_CONTEXT( number << " in " << commaLocale )
+        {
+            PARSED_TEXT fast = parseText( number, number, true );
+
+            setlocale( LC_NUMERIC, "C" );
+
+            BOOST_CHECK_EQUAL( fast.m_x, strtodInternalUnits( number ) );
+            BOOST_CHECK_EQUAL( fast.m_angle, strtod( number, nullptr ) );
+
+            setlocale( LC_NUMERIC, commaLocale );
+        }
+    }
+
+    setlocale( LC_NUMERIC, previous.c_str() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
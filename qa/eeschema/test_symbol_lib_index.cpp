@@ -0,0 +1,301 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for SYMBOL_LIB_INDEX, the saved index of the s-expression symbol libraries
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cache_file.h>
+#include <class_libentry.h>
+#include <sch_io_mgr.h>
+
+#include <string>
+
+#include <wx/datetime.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+// Code under test
+#include <symbol_lib_index.h>
+
+
+/**
+ * A library with a resistor described by \a aDescription, a symbol derived from it and a
+ * symbol with two units.  \a aFirstSymbol is written before them.
+ */
+static std::string makeLibraryText( const std::string& aDescription,
+                                    const std::string& aFirstSymbol = std::string() )
+{
+    auto properties =
+            []( const std::string& aValue, const std::string& aDescription )
+            {
+                return "    (property \"Reference\" \"R\" (id 0) (at 0 0 0))\n"
+                       "    (property \"Value\" \"" + aValue + "\" (id 1) (at 0 0 0))\n"
+                       "    (property \"Footprint\" \"\" (id 2) (at 0 0 0))\n"
+                       "    (property \"Datasheet\" \"\" (id 3) (at 0 0 0))\n"
+                       "    (property \"ki_keywords\" \"resistor\" (id 4) (at 0 0 0))\n"
+                       "    (property \"ki_description\" \"" + aDescription
+                               + "\" (id 5) (at 0 0 0))\n";
+            };
+
+    return "(kicad_symbol_lib (version 20200908) (generator kicad_symbol_editor)\n"
+           + aFirstSymbol
+           + "  (symbol \"R\"\n"
+           + properties( "R", aDescription )
+           + "    (symbol \"R_1_1\"\n"
+             "      (pin passive line (at 0 3.81 270) (length 1.27) (name \"~\") (number \"1\"))\n"
+             "      (pin passive line (at 0 -3.81 90) (length 1.27) (name \"~\") (number \"2\"))\n"
+             "    )\n"
+             "  )\n"
+             "  (symbol \"R_Small\" (extends \"R\")\n"
+           + properties( "R_Small", "small resistor" )
+           + "  )\n"
+             "  (symbol \"DUAL\"\n"
+           + properties( "DUAL", "two units" )
+           + "    (symbol \"DUAL_1_1\"\n"
+             "      (pin input line (at -5.08 0 0) (length 2.54) (name \"A\") (number \"1\"))\n"
+             "    )\n"
+             "    (symbol \"DUAL_2_1\"\n"
+             "      (pin input line (at -5.08 0 0) (length 2.54) (name \"B\") (number \"2\"))\n"
+             "    )\n"
+             "  )\n"
+             ")\n";
+}
+
+
+/**
+ * A symbol library in a temporary folder, indexed in another temporary folder rather than
+ * in the user settings
+ */
+struct SYMBOL_LIBRARY_FIXTURE
+{
+    SYMBOL_LIBRARY_FIXTURE()
+    {
+        wxFileName fn( wxFileName::CreateTempFileName( "qa_symbols" ) );
+
+        wxRemoveFile( fn.GetFullPath() );
+        m_indexRoot = fn.GetFullPath() + "-index";
+        fn.SetExt( "kicad_sym" );
+        m_libPath = fn.GetFullPath();
+
+        SetLibraryIndexRoot( m_indexRoot );
+
+        WriteLibrary( makeLibraryText( "first" ) );
+    }
+
+    ~SYMBOL_LIBRARY_FIXTURE()
+    {
+        SetLibraryIndexRoot( wxEmptyString );
+        wxFileName::Rmdir( m_indexRoot, wxPATH_RMDIR_RECURSIVE );
+        wxRemoveFile( m_libPath );
+    }
+
+    /**
+     * Writes the library file, always with the same modification time
+     */
+    void WriteLibrary( const std::string& aText )
+    {
+        WriteFile( m_libPath, aText );
+
+        BOOST_REQUIRE( wxFileName( m_libPath ).SetTimes( &m_time, &m_time, nullptr ) );
+    }
+
+    static void WriteFile( const wxString& aFileName, const std::string& aText )
+    {
+        wxFFile file( aFileName, "wb" );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aText.data(), aText.size() ) == aText.size() );
+    }
+
+    static std::string ReadFile( const wxString& aFileName )
+    {
+        wxFFile  file( aFileName, "rb" );
+        wxString text;
+
+        BOOST_REQUIRE( file.IsOpened() && file.ReadAll( &text, wxConvUTF8 ) );
+
+        return std::string( text.ToUTF8() );
+    }
+
+    wxString   m_libPath;
+    wxString   m_indexRoot;     ///< Replaces the user settings as the index folder
+    wxDateTime m_time = wxDateTime( 1, wxDateTime::Jan, 2020, 12, 0, 0 );
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SymbolLibIndex, SYMBOL_LIBRARY_FIXTURE )
+
+
+/**
+ * The index built from the library is saved, and read back as it was built
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    SYMBOL_LIB_INDEX built;
+
+    BOOST_REQUIRE( built.Load( m_libPath ) );
+
+    wxString indexFileName = SYMBOL_LIB_INDEX::GetIndexFileName( m_libPath );
+
+    BOOST_REQUIRE( wxFileName::FileExists( indexFileName ) );
+    BOOST_CHECK( indexFileName.StartsWith( m_indexRoot ) );
+
+    BOOST_REQUIRE_EQUAL( built.GetSymbols().size(), 3 );
+
+    const LIB_SYMBOL_INFO* resistor = built.Find( "R" );
+    const LIB_SYMBOL_INFO* small = built.Find( "R_Small" );
+    const LIB_SYMBOL_INFO* dual = built.Find( "DUAL" );
+
+    BOOST_REQUIRE( resistor && small && dual );
+
+    BOOST_CHECK_EQUAL( resistor->m_description, "first" );
+    BOOST_CHECK_EQUAL( resistor->m_keywords, "resistor" );
+    BOOST_CHECK_EQUAL( resistor->m_pinCount, 2 );
+    BOOST_CHECK_EQUAL( resistor->m_unitCount, 1 );
+    BOOST_CHECK( resistor->IsRoot() );
+    BOOST_CHECK_EQUAL( small->m_parent, "R" );
+    BOOST_CHECK_EQUAL( small->m_pinCount, 2 );
+    BOOST_CHECK_EQUAL( dual->m_unitCount, 2 );
+
+    std::string text = built.ReadSymbol( *resistor );
+
+    BOOST_CHECK_EQUAL( text, ReadFile( m_libPath ).substr( resistor->m_offset,
+                                                           resistor->m_length ) );
+    BOOST_CHECK_EQUAL( text.compare( 0, 12, "(symbol \"R\"\n" ), 0 );
+
+    // Mark the saved index, to tell it from an index built again
+    std::string saved = ReadFile( indexFileName );
+    size_t      pos = saved.find( "\nfirst\n" );
+
+    BOOST_REQUIRE( pos != std::string::npos );
+    WriteFile( indexFileName, saved.replace( pos, 7, "\nsaved\n" ) );
+
+    SYMBOL_LIB_INDEX read;
+
+    BOOST_REQUIRE( read.Load( m_libPath ) );
+    BOOST_REQUIRE_EQUAL( read.GetSymbols().size(), built.GetSymbols().size() );
+    BOOST_CHECK_EQUAL( read.Find( "R" )->m_description, "saved" );
+
+    for( const LIB_SYMBOL_INFO& info : built.GetSymbols() )
+    {
+        const LIB_SYMBOL_INFO* other = read.Find( info.m_name );
+
+        BOOST_TEST_CONTEXT( info.m_name )
+        {
+            BOOST_REQUIRE( other );
+            BOOST_CHECK_EQUAL( other->m_parent, info.m_parent );
+            BOOST_CHECK_EQUAL( other->m_keywords, info.m_keywords );
+            BOOST_CHECK_EQUAL( other->m_pinCount, info.m_pinCount );
+            BOOST_CHECK_EQUAL( other->m_unitCount, info.m_unitCount );
+            BOOST_CHECK_EQUAL( other->m_isPower, info.m_isPower );
+            BOOST_CHECK_EQUAL( other->m_offset, info.m_offset );
+            BOOST_CHECK_EQUAL( other->m_length, info.m_length );
+        }
+    }
+}
+
+
+/**
+ * A change of the content is found even when the size and the modification time are the same
+ */
+BOOST_AUTO_TEST_CASE( Invalidation )
+{
+    SYMBOL_LIB_INDEX index;
+
+    BOOST_REQUIRE( index.Load( m_libPath ) );
+    BOOST_CHECK( index.IsUpToDate() );
+
+    WriteLibrary( makeLibraryText( "third" ) );
+
+    BOOST_CHECK( !index.IsUpToDate() );
+
+    SYMBOL_LIB_INDEX reloaded;
+
+    BOOST_REQUIRE( reloaded.Load( m_libPath ) );
+    BOOST_REQUIRE( reloaded.Find( "R" ) );
+    BOOST_CHECK_EQUAL( reloaded.Find( "R" )->m_description, "third" );
+    BOOST_CHECK( reloaded.IsUpToDate() );
+}
+
+
+/**
+ * A symbol is only read from its indexed location if it is still there
+ */
+BOOST_AUTO_TEST_CASE( ReadSymbolMismatch )
+{
+    SYMBOL_LIB_INDEX index;
+
+    BOOST_REQUIRE( index.Load( m_libPath ) );
+
+    const LIB_SYMBOL_INFO resistor = *index.Find( "R" );
+
+    BOOST_CHECK( !index.ReadSymbol( resistor ).empty() );
+
+    // Another symbol of the same length at the same place
+    std::string text = makeLibraryText( "first" );
+    size_t      pos = text.find( "(symbol \"R\"" );
+
+    BOOST_REQUIRE( pos != std::string::npos );
+    WriteLibrary( text.replace( pos, 11, "(symbol \"Q\"" ) );
+
+    BOOST_CHECK( index.ReadSymbol( resistor ).empty() );
+
+    // The symbol moved
+    WriteLibrary( makeLibraryText( "first", "  (symbol \"C\" (extends \"R\"))\n" ) );
+
+    BOOST_CHECK( index.ReadSymbol( resistor ).empty() );
+}
+
+
+/**
+ * The plugin parses the whole library when a symbol is not found at its indexed location
+ */
+BOOST_AUTO_TEST_CASE( PluginFallback )
+{
+    SCH_PLUGIN::SCH_PLUGIN_RELEASER pi( SCH_IO_MGR::FindPlugin( SCH_IO_MGR::SCH_KICAD ) );
+    wxArrayString                   names;
+
+    pi->EnumerateSymbolLib( names, m_libPath );
+
+    BOOST_CHECK_EQUAL( names.size(), 3 );
+
+    // Same modification time, so the plugin keeps the index it loaded
+    WriteLibrary( makeLibraryText( "moved", "  (symbol \"C\" (extends \"R\"))\n" ) );
+
+    LIB_PART* symbol = pi->LoadSymbol( m_libPath, "R" );
+
+    BOOST_REQUIRE( symbol );
+    BOOST_CHECK_EQUAL( symbol->GetDescription(), "moved" );
+
+    symbol = pi->LoadSymbol( m_libPath, "DUAL" );
+
+    BOOST_REQUIRE( symbol );
+    BOOST_CHECK_EQUAL( symbol->GetUnitCount(), 2 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
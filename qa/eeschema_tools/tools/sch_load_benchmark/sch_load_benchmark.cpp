@@ -0,0 +1,498 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/utility_registry.h>
+
+#include <class_libentry.h>
+#include <lib_arc.h>
+#include <lib_bezier.h>
+#include <lib_circle.h>
+#include <lib_pin.h>
+#include <lib_polyline.h>
+#include <lib_rectangle.h>
+#include <profile.h>
+#include <project.h>
+#include <properties.h>
+#include <sch_bitmap.h>
+#include <sch_bus_entry.h>
+#include <sch_component.h>
+#include <sch_io_mgr.h>
+#include <sch_junction.h>
+#include <sch_line.h>
+#include <sch_screen.h>
+#include <sch_sexpr_plugin.h>
+#include <sch_sheet.h>
+#include <sch_text.h>
+#include <schematic.h>
+#include <settings/settings_manager.h>
+#include <wildcards_and_files_ext.h>
+
+#include <nlohmann/json.hpp>
+
+#include <wx/cmdline.h>
+
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "i", "iterations", _( "number of loads to average" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER, wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_SWITCH, "j", "json", _( "print the results as JSON" ).mb_str() },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input schematic file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum SCH_LOAD_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    RESULTS_DIFFER,
+};
+
+
+struct SCH_LOAD_BENCHMARK_RESULT
+{
+    std::string m_design;
+    size_t      m_items = 0;            ///< Items of all the screens
+    double      m_referenceMsecs = 0.0; ///< Average load time with the reference parser
+    double      m_fastMsecs = 0.0;      ///< Average load time with the parser fast path
+    bool        m_identical = false;    ///< Both parsers loaded the same content
+};
+
+
+static void hashCombine( size_t& aSeed, size_t aValue )
+{
+    aSeed ^= aValue + 0x9e3779b9 + ( aSeed << 6 ) + ( aSeed >> 2 );
+}
+
+
+static void hashText( size_t& aSeed, const wxString& aText )
+{
+    hashCombine( aSeed, std::hash<std::string>()( aText.ToStdString() ) );
+}
+
+
+static void hashPoint( size_t& aSeed, const wxPoint& aPoint )
+{
+    hashCombine( aSeed, aPoint.x );
+    hashCombine( aSeed, aPoint.y );
+}
+
+
+static void hashEdaText( size_t& aSeed, const EDA_TEXT& aText )
+{
+    hashText( aSeed, aText.GetText() );
+    hashPoint( aSeed, aText.GetTextPos() );
+    hashCombine( aSeed, aText.GetTextSize().x );
+    hashCombine( aSeed, aText.GetTextSize().y );
+    hashCombine( aSeed, std::hash<double>()( aText.GetTextAngle() ) );
+    hashCombine( aSeed, aText.GetHorizJustify() );
+    hashCombine( aSeed, aText.GetVertJustify() );
+    hashCombine( aSeed, aText.IsVisible() );
+}
+
+
+/**
+ * Hash the graphic items and pins of a library symbol
+ */
+static void hashLibSymbol( size_t& aSeed, LIB_PART& aSymbol )
+{
+    hashText( aSeed, aSymbol.GetName() );
+
+    for( LIB_ITEM& item : aSymbol.GetDrawItems() )
+    {
+        hashCombine( aSeed, item.Type() );
+        hashPoint( aSeed, item.GetPosition() );
+        hashCombine( aSeed, item.GetUnit() );
+        hashCombine( aSeed, item.GetConvert() );
+        hashCombine( aSeed, item.GetWidth() );
+        hashCombine( aSeed, item.GetFillMode() );
+
+        switch( item.Type() )
+        {
+        case LIB_PIN_T:
+        {
+            LIB_PIN& pin = static_cast<LIB_PIN&>( item );
+
+            hashText( aSeed, pin.GetNumber() );
+            hashText( aSeed, pin.GetName() );
+            hashCombine( aSeed, pin.GetLength() );
+            hashCombine( aSeed, pin.GetOrientation() );
+            hashCombine( aSeed, (int) pin.GetType() );
+            hashCombine( aSeed, (int) pin.GetShape() );
+            break;
+        }
+
+        case LIB_ARC_T:
+        {
+            LIB_ARC& arc = static_cast<LIB_ARC&>( item );
+
+            hashCombine( aSeed, arc.GetRadius() );
+            hashCombine( aSeed, arc.GetFirstRadiusAngle() );
+            hashCombine( aSeed, arc.GetSecondRadiusAngle() );
+            hashPoint( aSeed, arc.GetStart() );
+            hashPoint( aSeed, arc.GetEnd() );
+            break;
+        }
+
+        case LIB_CIRCLE_T:
+            hashPoint( aSeed, static_cast<LIB_CIRCLE&>( item ).GetEnd() );
+            break;
+
+        case LIB_RECTANGLE_T:
+            hashPoint( aSeed, static_cast<LIB_RECTANGLE&>( item ).GetEnd() );
+            break;
+
+        case LIB_POLYLINE_T:
+            for( const wxPoint& point : static_cast<LIB_POLYLINE&>( item ).GetPolyPoints() )
+                hashPoint( aSeed, point );
+
+            break;
+
+        case LIB_BEZIER_T:
+            for( const wxPoint& point : static_cast<LIB_BEZIER&>( item ).GetPoints() )
+                hashPoint( aSeed, point );
+
+            break;
+
+        case LIB_TEXT_T:
+        case LIB_FIELD_T:
+            hashEdaText( aSeed, dynamic_cast<EDA_TEXT&>( item ) );
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+
+/**
+ * Fingerprint of the content of the screens of a schematic, to check both parser paths
+ * give the same results: the geometry of every item, including the wire and bus entry ends,
+ * the sheet pins, the texts, the symbol fields and the library symbols with their pins.
+ */
+static size_t fingerprint( SCH_SHEET& aRoot, size_t& aItemCount )
+{
+    size_t      seed = 0;
+    SCH_SCREENS screens( aRoot );
+
+    aItemCount = 0;
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+    {
+        for( const std::pair<const wxString, LIB_PART*>& libSymbol : screen->GetLibSymbols() )
+        {
+            hashText( seed, libSymbol.first );
+            hashLibSymbol( seed, *libSymbol.second );
+        }
+
+        for( SCH_ITEM* item : screen->Items() )
+        {
+            aItemCount++;
+
+            hashCombine( seed, item->Type() );
+            hashCombine( seed, item->GetLayer() );
+            hashPoint( seed, item->GetPosition() );
+
+            // Wire, bus entry, junction, label and sheet pin ends
+            std::vector<DANGLING_END_ITEM> ends;
+            item->GetEndPoints( ends );
+
+            for( const DANGLING_END_ITEM& end : ends )
+            {
+                hashCombine( seed, end.GetType() );
+                hashPoint( seed, end.GetPosition() );
+            }
+
+            switch( item->Type() )
+            {
+            case SCH_LINE_T:
+            {
+                SCH_LINE* line = static_cast<SCH_LINE*>( item );
+
+                hashPoint( seed, line->GetStartPoint() );
+                hashPoint( seed, line->GetEndPoint() );
+                hashCombine( seed, line->GetLineSize() );
+                break;
+            }
+
+            case SCH_BUS_WIRE_ENTRY_T:
+            case SCH_BUS_BUS_ENTRY_T:
+            {
+                wxSize size = static_cast<SCH_BUS_ENTRY_BASE*>( item )->GetSize();
+
+                hashCombine( seed, size.x );
+                hashCombine( seed, size.y );
+                break;
+            }
+
+            case SCH_JUNCTION_T:
+                hashCombine( seed, static_cast<SCH_JUNCTION*>( item )->GetDiameter() );
+                break;
+
+            case SCH_BITMAP_T:
+                hashCombine( seed, std::hash<double>()(
+                                           static_cast<SCH_BITMAP*>( item )->GetImageScale() ) );
+                break;
+
+            case SCH_TEXT_T:
+            case SCH_LABEL_T:
+            case SCH_GLOBAL_LABEL_T:
+            case SCH_HIER_LABEL_T:
+            {
+                SCH_TEXT* text = static_cast<SCH_TEXT*>( item );
+
+                hashEdaText( seed, *text );
+                hashCombine( seed, (int) text->GetLabelSpinStyle() );
+                hashCombine( seed, (int) text->GetShape() );
+                break;
+            }
+
+            case SCH_SHEET_T:
+            {
+                SCH_SHEET* sheet = static_cast<SCH_SHEET*>( item );
+
+                hashCombine( seed, sheet->GetSize().x );
+                hashCombine( seed, sheet->GetSize().y );
+
+                for( SCH_FIELD& field : sheet->GetFields() )
+                    hashEdaText( seed, field );
+
+                for( SCH_SHEET_PIN* pin : sheet->GetPins() )
+                {
+                    hashEdaText( seed, *pin );
+                    hashCombine( seed, (int) pin->GetShape() );
+                    hashCombine( seed, (int) pin->GetEdge() );
+                }
+
+                break;
+            }
+
+            case SCH_COMPONENT_T:
+            {
+                SCH_COMPONENT* symbol = static_cast<SCH_COMPONENT*>( item );
+                TRANSFORM&     transform = symbol->GetTransform();
+
+                hashText( seed, symbol->GetLibId().Format() );
+                hashText( seed, symbol->GetSchSymbolLibraryName() );
+                hashCombine( seed, symbol->GetUnit() );
+                hashCombine( seed, symbol->GetConvert() );
+                hashCombine( seed, transform.x1 );
+                hashCombine( seed, transform.y1 );
+                hashCombine( seed, transform.x2 );
+                hashCombine( seed, transform.y2 );
+
+                for( SCH_FIELD& field : symbol->GetFields() )
+                {
+                    hashText( seed, field.GetName() );
+                    hashEdaText( seed, field );
+                }
+
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+    }
+
+    return seed;
+}
+
+
+/**
+ * Load a schematic and its hierarchy, without updating the symbol links nor the
+ * connectivity, so only the file parsing is measured.
+ *
+ * @return the load time in milliseconds, or a negative value on error.
+ */
+static double loadSchematic( const wxString& aFileName, SCHEMATIC& aSchematic,
+                             SETTINGS_MANAGER& aManager, const PROPERTIES* aProperties )
+{
+    SCH_PLUGIN::SCH_PLUGIN_RELEASER pi( SCH_IO_MGR::FindPlugin( SCH_IO_MGR::SCH_KICAD ) );
+
+    aSchematic.Reset();
+    aSchematic.SetProject( &aManager.Prj() );
+
+    try
+    {
+        PROF_COUNTER timer;
+        aSchematic.SetRoot( pi->Load( aFileName, &aSchematic, nullptr, aProperties ) );
+        timer.Stop();
+
+        return timer.msecs();
+    }
+    catch( const IO_ERROR& e )
+    {
+        std::cerr << e.What().ToStdString() << std::endl;
+        return -1.0;
+    }
+}
+
+
+static bool benchmarkSchematic( const wxString& aFileName, SETTINGS_MANAGER& aManager,
+                                int aIterations, SCH_LOAD_BENCHMARK_RESULT& aResult )
+{
+    wxFileName pro( aFileName );
+    pro.SetExt( ProjectFileExtension );
+
+    aManager.LoadProject( pro.GetFullPath() );
+    aManager.Prj().SetElem( PROJECT::ELEM_SCH_PART_LIBS, nullptr );
+
+    PROPERTIES reference;
+    reference[SCH_SEXPR_PLUGIN::PropReferenceParser] = "";
+
+    size_t referenceHash = 0;
+    size_t fastHash = 0;
+    size_t referenceItems = 0;
+
+    aResult.m_design = aFileName.ToStdString();
+
+    // Alternate both paths, so the file cache is as warm for one as for the other
+    for( int i = 0; i < aIterations; ++i )
+    {
+        SCHEMATIC referenceSchematic( nullptr );
+        double    msecs = loadSchematic( aFileName, referenceSchematic, aManager, &reference );
+
+        if( msecs < 0.0 )
+            return false;
+
+        aResult.m_referenceMsecs += msecs / aIterations;
+        referenceHash = fingerprint( referenceSchematic.Root(), referenceItems );
+
+        SCHEMATIC fastSchematic( nullptr );
+        msecs = loadSchematic( aFileName, fastSchematic, aManager, nullptr );
+
+        if( msecs < 0.0 )
+            return false;
+
+        aResult.m_fastMsecs += msecs / aIterations;
+        fastHash = fingerprint( fastSchematic.Root(), aResult.m_items );
+    }
+
+    aResult.m_identical = ( referenceHash == fastHash && referenceItems == aResult.m_items );
+
+    return true;
+}
+
+
+static void printResults( std::ostream& aStream,
+                          const std::vector<SCH_LOAD_BENCHMARK_RESULT>& aResults )
+{
+    for( const SCH_LOAD_BENCHMARK_RESULT& result : aResults )
+    {
+        aStream << result.m_design << ": " << result.m_items << " items, reference "
+                << std::fixed << std::setprecision( 2 ) << result.m_referenceMsecs
+                << " ms, fast " << result.m_fastMsecs << " ms, speedup x"
+                << result.m_referenceMsecs / result.m_fastMsecs
+                << ( result.m_identical ? "" : " (RESULTS DIFFER)" ) << std::endl;
+    }
+}
+
+
+static void printResultsJson( std::ostream& aStream,
+                              const std::vector<SCH_LOAD_BENCHMARK_RESULT>& aResults )
+{
+    nlohmann::json runs = nlohmann::json::array();
+
+    for( const SCH_LOAD_BENCHMARK_RESULT& result : aResults )
+    {
+        runs.push_back( { { "design", result.m_design },
+                          { "items", result.m_items },
+                          { "reference_ms", result.m_referenceMsecs },
+                          { "fast_ms", result.m_fastMsecs },
+                          { "speedup", result.m_referenceMsecs / result.m_fastMsecs },
+                          { "identical", result.m_identical } } );
+    }
+
+    aStream << std::setw( 2 ) << runs << std::endl;
+}
+
+
+int sch_load_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program measures the load time of the given schematics "
+                               "and their hierarchy with the reference number and text "
+                               "conversions of the s-expression parser and with its fast "
+                               "path, and checks both load the same content." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long iterations = 5;
+
+    cl_parser.Found( "iterations", &iterations );
+
+    if( iterations < 1 )
+    {
+        std::cerr << "The number of iterations must be at least 1" << std::endl;
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    const bool json = cl_parser.Found( "json" );
+
+    std::vector<SCH_LOAD_BENCHMARK_RESULT> results;
+    SETTINGS_MANAGER                       manager( true );
+    bool                                   identical = true;
+
+    for( unsigned i = 0; i < cl_parser.GetParamCount(); i++ )
+    {
+        SCH_LOAD_BENCHMARK_RESULT result;
+
+        if( !benchmarkSchematic( cl_parser.GetParam( i ), manager, iterations, result ) )
+            return SCH_LOAD_BENCHMARK_RET_CODES::LOAD_FAILED;
+
+        identical &= result.m_identical;
+        results.push_back( result );
+    }
+
+    if( json )
+        printResultsJson( std::cout, results );
+    else
+        printResults( std::cout, results );
+
+    return identical ? KI_TEST::RET_CODES::OK : SCH_LOAD_BENCHMARK_RET_CODES::RESULTS_DIFFER;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "sch_load_benchmark",
+        "Benchmark the s-expression schematic parser fast path against the reference one",
+        sch_load_benchmark_main_func,
+} );
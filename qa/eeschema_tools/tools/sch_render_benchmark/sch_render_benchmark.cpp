@@ -0,0 +1,229 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/render_benchmark.h>
+#include <qa_utils/utility_registry.h>
+
+#include <connection_graph.h>
+#include <project.h>
+#include <sch_io_mgr.h>
+#include <sch_painter.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_view.h>
+#include <schematic.h>
+#include <settings/settings_manager.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/cmdline.h>
+
+#include <iostream>
+#include <memory>
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "i", "iterations", _( "number of redraws of each layer" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER, wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_OPTION, "b", "backend", _( "backend to use: null, cairo or all (default)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_SWITCH, "j", "json", _( "print the results as JSON" ).mb_str() },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input schematic file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum SCH_RENDER_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+///> Size of the offscreen canvas, in pixels
+static const VECTOR2I CANVAS_SIZE( 1920, 1080 );
+
+
+/**
+ * Load a schematic and its hierarchy, the same way the netlist QA tests do.
+ */
+static bool loadSchematic( const wxString& aFileName, SETTINGS_MANAGER& aManager,
+                           SCHEMATIC& aSchematic )
+{
+    SCH_PLUGIN::SCH_PLUGIN_RELEASER pi( SCH_IO_MGR::FindPlugin( SCH_IO_MGR::SCH_KICAD ) );
+
+    wxFileName pro( aFileName );
+    pro.SetExt( ProjectFileExtension );
+
+    aManager.LoadProject( pro.GetFullPath() );
+    aManager.Prj().SetElem( PROJECT::ELEM_SCH_PART_LIBS, nullptr );
+
+    aSchematic.Reset();
+    aSchematic.SetProject( &aManager.Prj() );
+
+    try
+    {
+        aSchematic.SetRoot( pi->Load( aFileName, &aSchematic ) );
+    }
+    catch( const IO_ERROR& e )
+    {
+        std::cerr << e.What().ToStdString() << std::endl;
+        return false;
+    }
+
+    aSchematic.CurrentSheet().push_back( &aSchematic.Root() );
+
+    SCH_SCREENS screens( aSchematic.Root() );
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        screen->UpdateLocalLibSymbolLinks();
+
+    SCH_SHEET_LIST sheets = aSchematic.GetSheets();
+
+    sheets.UpdateSymbolInstances( aSchematic.RootScreen()->GetSymbolInstances() );
+
+    for( SCH_SHEET_PATH& sheet : sheets )
+        sheet.UpdateAllScreenReferences();
+
+    aSchematic.ConnectionGraph()->Recalculate( sheets, true );
+
+    return true;
+}
+
+
+static KI_TEST::RENDER_BENCHMARK_RESULT benchmarkScreen( SCH_SCREEN* aScreen,
+                                                         const std::string& aName,
+                                                         COLOR_SETTINGS* aColors,
+                                                         KIGFX::GAL* aGal,
+                                                         KI_TEST::COUNTING_GAL* aCounter,
+                                                         const std::string& aBackend,
+                                                         int aIterations )
+{
+    KIGFX::SCH_VIEW    view( false, nullptr );
+    KIGFX::SCH_PAINTER painter( aGal );
+
+    aGal->SetWorldUnitLength( SCH_WORLD_UNIT );
+
+    painter.GetSettings()->LoadColors( aColors );
+
+    view.SetGAL( aGal );
+    view.SetPainter( &painter );
+    view.DisplaySheet( aScreen );
+
+    KI_TEST::RENDER_BENCHMARK benchmark( view, aCounter );
+    const PAGE_INFO&          page = aScreen->GetPageSettings();
+
+    benchmark.ZoomToFit( BOX2I( VECTOR2I( 0, 0 ),
+                                VECTOR2I( page.GetWidthIU(), page.GetHeightIU() ) ) );
+
+    KI_TEST::RENDER_BENCHMARK_RESULT result = benchmark.Run( aName, aBackend, aIterations );
+
+    view.Cleanup();
+
+    return result;
+}
+
+
+int sch_render_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program measures the SCH_PAINTER throughput on every sheet "
+                               "of the given schematics, without a display. The view is redrawn "
+                               "layer by layer into a null GAL (counting primitives and "
+                               "vertices) and into an offscreen Cairo surface." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     iterations = 5;
+    wxString backend = "all";
+
+    cl_parser.Found( "iterations", &iterations );
+    cl_parser.Found( "backend", &backend );
+
+    const bool json = cl_parser.Found( "json" );
+
+    std::vector<KI_TEST::RENDER_BENCHMARK_RESULT> results;
+    KIGFX::GAL_DISPLAY_OPTIONS                    options;
+    SETTINGS_MANAGER                              manager( true );
+
+    for( unsigned i = 0; i < cl_parser.GetParamCount(); i++ )
+    {
+        const wxString filename = cl_parser.GetParam( i );
+        SCHEMATIC      schematic( nullptr );
+
+        if( !loadSchematic( filename, manager, schematic ) )
+            return SCH_RENDER_BENCHMARK_RET_CODES::LOAD_FAILED;
+
+        SCH_SCREENS screens( schematic.Root() );
+
+        // Each screen is drawn once, whatever its number of instances in the hierarchy
+        for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        {
+            const std::string name = screen->GetFileName().ToStdString();
+
+            if( backend == "all" || backend == "null" )
+            {
+                KI_TEST::COUNTING_GAL gal( options, CANVAS_SIZE );
+
+                results.push_back( benchmarkScreen( screen, name, manager.GetColorSettings(),
+                                                    &gal, &gal, "null", iterations ) );
+            }
+
+            if( backend == "all" || backend == "cairo" )
+            {
+                KI_TEST::CAIRO_IMAGE_GAL gal( options, CANVAS_SIZE );
+
+                results.push_back( benchmarkScreen( screen, name, manager.GetColorSettings(),
+                                                    &gal, nullptr, "cairo", iterations ) );
+            }
+        }
+    }
+
+    if( json )
+    {
+        KI_TEST::PrintRenderResultsJson( std::cout, results );
+    }
+    else
+    {
+        for( const KI_TEST::RENDER_BENCHMARK_RESULT& result : results )
+            KI_TEST::PrintRenderResults( std::cout, result );
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "sch_render_benchmark",
+        "Benchmark SCH_PAINTER throughput on schematics without a display",
+        sch_render_benchmark_main_func,
+} );
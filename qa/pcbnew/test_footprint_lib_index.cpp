@@ -0,0 +1,358 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cache_file.h>
+#include <class_module.h>
+#include <common.h>
+#include <footprint_lib_index.h>
+#include <kicad_plugin.h>
+#include <pcb_parser.h>
+#include <richio.h>
+#include <wildcards_and_files_ext.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wx/datetime.h>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+
+/**
+ * A footprint with \a aPadCount pads.  Its items have fixed time stamps, so it is formatted
+ * the same every time it is parsed.
+ */
+static std::string makeFootprintText( const std::string& aName, const std::string& aDescription,
+                                      int aPadCount )
+{
+    int  uuid = 0;
+    auto tstamp =
+            [&]()
+            {
+                char buf[64];
+                snprintf( buf, sizeof( buf ), " (tstamp 00000000-0000-0000-0000-%012d)", ++uuid );
+                return std::string( buf );
+            };
+
+    std::string text = "(module " + aName + " (layer F.Cu) (tedit 5F000000)" + tstamp() + "\n"
+                       "  (descr \"" + aDescription + "\") (tags resistor)\n"
+                       "  (fp_text reference REF** (at 0 -1.43) (layer F.SilkS)\n"
+                       "    (effects (font (size 1 1) (thickness 0.15)))" + tstamp() + ")\n"
+                       "  (fp_text value " + aName + " (at 0 1.43) (layer F.Fab)\n"
+                       "    (effects (font (size 1 1) (thickness 0.15)))" + tstamp() + ")\n";
+
+    for( int ii = 0; ii < aPadCount; ++ii )
+    {
+        text += "  (pad " + std::to_string( ii + 1 ) + " smd rect (at " + std::to_string( ii )
+                + ".27 0) (size 0.875 0.95) (layers F.Cu F.Paste F.Mask)" + tstamp() + ")\n";
+    }
+
+    return text + ")\n";
+}
+
+
+/**
+ * A footprint library in a temporary folder, indexed in another temporary folder rather than
+ * in the user settings
+ */
+struct FOOTPRINT_LIBRARY_FIXTURE
+{
+    FOOTPRINT_LIBRARY_FIXTURE()
+    {
+        wxFileName fn( wxFileName::CreateTempFileName( "qa_footprints" ) );
+
+        wxRemoveFile( fn.GetFullPath() );
+        m_indexRoot = fn.GetFullPath() + "-index";
+        fn.SetExt( "pretty" );
+        m_libPath = fn.GetFullPath();
+
+        BOOST_REQUIRE( wxFileName::Mkdir( m_libPath ) );
+        SetLibraryIndexRoot( m_indexRoot );
+
+        WriteFootprint( "R_0603", "first", m_time );
+        WriteFootprint( "C_0603", "capacitor", m_time );
+    }
+
+    ~FOOTPRINT_LIBRARY_FIXTURE()
+    {
+        SetLibraryIndexRoot( wxEmptyString );
+        wxFileName::Rmdir( m_indexRoot, wxPATH_RMDIR_RECURSIVE );
+        wxFileName::Rmdir( m_libPath, wxPATH_RMDIR_RECURSIVE );
+    }
+
+    /**
+     * Writes a footprint file with the given description and modification time
+     */
+    void WriteFootprint( const wxString& aName, const std::string& aDescription,
+                         const wxDateTime& aModTime )
+    {
+        WriteFile( aName, makeFootprintText( std::string( aName.mb_str() ), aDescription, 2 ),
+                   aModTime );
+    }
+
+    void WriteFile( const wxString& aName, const std::string& aText,
+                    const wxDateTime& aModTime )
+    {
+        wxFileName fn( m_libPath, aName, KiCadFootprintFileExtension );
+
+        {
+            wxFFile file( fn.GetFullPath(), "wb" );
+            BOOST_REQUIRE( file.Write( aText.data(), aText.size() ) == aText.size() );
+        }
+
+        BOOST_REQUIRE( fn.SetTimes( &aModTime, &aModTime, nullptr ) );
+    }
+
+    /**
+     * @return the footprints listed by a new plugin, which has to read the library again
+     */
+    std::vector<FOOTPRINT_INDEX_ENTRY> Enumerate()
+    {
+        PCB_IO                             io;
+        std::vector<FOOTPRINT_INDEX_ENTRY> footprints;
+
+        io.FootprintEnumerateInfo( footprints, m_libPath, false );
+
+        return footprints;
+    }
+
+    static wxString findDescription( const std::vector<FOOTPRINT_INDEX_ENTRY>& aFootprints,
+                                     const wxString& aName )
+    {
+        for( const FOOTPRINT_INDEX_ENTRY& entry : aFootprints )
+        {
+            if( entry.m_name == aName )
+                return entry.m_description;
+        }
+
+        return wxEmptyString;
+    }
+
+    wxString   m_libPath;
+    wxString   m_indexRoot;     ///< Replaces the user settings as the index folder
+    wxDateTime m_time = wxDateTime( 1, wxDateTime::Jan, 2020, 12, 0, 0 );
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FootprintLibIndex, FOOTPRINT_LIBRARY_FIXTURE )
+
+
+/**
+ * Listing a library saves its index, which the next listing uses instead of the footprint
+ * files, as long as they don't change
+ */
+BOOST_AUTO_TEST_CASE( IndexReuse )
+{
+    std::vector<FOOTPRINT_INDEX_ENTRY> footprints = Enumerate();
+
+    BOOST_CHECK_EQUAL( footprints.size(), 2 );
+    BOOST_CHECK_EQUAL( findDescription( footprints, "R_0603" ), "first" );
+
+    FOOTPRINT_LIB_INDEX index( m_libPath );
+
+    BOOST_REQUIRE( index.Read() );
+    BOOST_REQUIRE( index.Find( "R_0603" ) );
+    BOOST_CHECK_EQUAL( index.GetFootprints().size(), 2 );
+    BOOST_CHECK_EQUAL( index.Find( "R_0603" )->m_description, "first" );
+    BOOST_CHECK_EQUAL( index.Find( "R_0603" )->m_padCount, 2 );
+
+    // Not parsed again: the change of the content without a change of the modification
+    // time is not seen
+    WriteFootprint( "R_0603", "second", m_time );
+
+    footprints = Enumerate();
+
+    BOOST_CHECK_EQUAL( footprints.size(), 2 );
+    BOOST_CHECK_EQUAL( findDescription( footprints, "R_0603" ), "first" );
+    BOOST_CHECK_EQUAL( findDescription( footprints, "C_0603" ), "capacitor" );
+}
+
+
+/**
+ * A footprint file whose modification time changed is parsed again, and its index entry
+ * is replaced
+ */
+BOOST_AUTO_TEST_CASE( IndexInvalidation )
+{
+    Enumerate();
+
+    WriteFootprint( "R_0603", "second", m_time + wxTimeSpan::Minute() );
+
+    std::vector<FOOTPRINT_INDEX_ENTRY> footprints = Enumerate();
+
+    BOOST_CHECK_EQUAL( footprints.size(), 2 );
+    BOOST_CHECK_EQUAL( findDescription( footprints, "R_0603" ), "second" );
+
+    FOOTPRINT_LIB_INDEX index( m_libPath );
+
+    BOOST_REQUIRE( index.Read() );
+    BOOST_REQUIRE( index.Find( "R_0603" ) );
+    BOOST_CHECK_EQUAL( index.Find( "R_0603" )->m_description, "second" );
+    BOOST_CHECK_EQUAL( index.Find( "R_0603" )->m_fileModTime,
+                       ( m_time + wxTimeSpan::Minute() ).GetValue().GetValue() );
+
+    // A removed footprint leaves the index too
+    wxRemoveFile( wxFileName( m_libPath, "C_0603", KiCadFootprintFileExtension ).GetFullPath() );
+
+    BOOST_CHECK_EQUAL( Enumerate().size(), 1 );
+    BOOST_REQUIRE( index.Read() );
+    BOOST_CHECK( index.Find( "C_0603" ) == nullptr );
+}
+
+
+/**
+ * The footprints listed from the index are only parsed when they are asked for
+ */
+BOOST_AUTO_TEST_CASE( LazyGetModule )
+{
+    Enumerate();
+
+    // Same modification time, so listed from the index, but parsed from the new content
+    WriteFootprint( "R_0603", "second", m_time );
+
+    PCB_IO                             io;
+    std::vector<FOOTPRINT_INDEX_ENTRY> footprints;
+
+    io.FootprintEnumerateInfo( footprints, m_libPath, false );
+
+    BOOST_CHECK_EQUAL( findDescription( footprints, "R_0603" ), "first" );
+
+    const MODULE* module = io.GetEnumeratedFootprint( m_libPath, "R_0603" );
+
+    BOOST_REQUIRE( module );
+    BOOST_CHECK_EQUAL( module->GetDescription(), "second" );
+    BOOST_CHECK_EQUAL( module->GetPadCount(), 2 );
+
+    // Parsed once
+    BOOST_CHECK_EQUAL( io.GetEnumeratedFootprint( m_libPath, "R_0603" ), module );
+    BOOST_CHECK( io.GetEnumeratedFootprint( m_libPath, "missing" ) == nullptr );
+}
+
+
+/**
+ * The footprints parsed by several threads are the footprints a single parser gives, in the
+ * same order, with the same errors, every time
+ */
+BOOST_AUTO_TEST_CASE( ParallelLoad )
+{
+    for( int ii = 0; ii < 60; ++ii )
+    {
+        std::string name = "FP_" + std::to_string( ii );
+
+        WriteFile( name, makeFootprintText( name, "footprint " + name, ii % 7 + 1 ), m_time );
+    }
+
+    WriteFile( "Broken", "(module Broken (layer F.Cu) (pad 1 smd rect\n", m_time );
+
+    auto formatFootprint =
+            []( const MODULE& aModule )
+            {
+                STRING_FORMATTER formatter;
+                PCB_IO           io( CTL_FOR_LIBRARY );
+
+                io.SetOutputFormatter( &formatter );
+                io.Format( const_cast<MODULE*>( &aModule ) );
+
+                return formatter.GetString();
+            };
+
+    // Parsed one by one by a single parser
+    std::map<wxString, std::string> reference;
+    wxArrayString                   fileNames;
+
+    {
+        LOCALE_IO  toggle;
+        PCB_PARSER parser;
+
+        wxDir::GetAllFiles( m_libPath, &fileNames, "*." + KiCadFootprintFileExtension );
+
+        for( const wxString& fileName : fileNames )
+        {
+            FILE_LINE_READER reader( fileName );
+
+            parser.SetLineReader( &reader );
+
+            try
+            {
+                std::unique_ptr<BOARD_ITEM> item( parser.Parse() );
+                MODULE*                     module = dynamic_cast<MODULE*>( item.get() );
+
+                BOOST_REQUIRE( module );
+                reference[wxFileName( fileName ).GetName()] = formatFootprint( *module );
+            }
+            catch( const IO_ERROR& )
+            {
+            }
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL( fileNames.size(), 63 );
+    BOOST_REQUIRE_EQUAL( reference.size(), 62 );
+
+    wxString firstError;
+
+    for( int run = 0; run < 3; ++run )
+    {
+        // Without the index, so the footprints are all parsed by Load()
+        wxRemoveFile( FOOTPRINT_LIB_INDEX::GetIndexFileName( m_libPath ) );
+
+        PCB_IO                             io;
+        std::vector<FOOTPRINT_INDEX_ENTRY> footprints;
+        wxString                           error;
+
+        try
+        {
+            io.FootprintEnumerateInfo( footprints, m_libPath, false );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            error = ioe.What();
+        }
+
+        BOOST_CHECK( error.Contains( "Broken" ) );
+
+        if( run == 0 )
+            firstError = error;
+        else
+            BOOST_CHECK_EQUAL( error, firstError );
+
+        BOOST_REQUIRE_EQUAL( footprints.size(), reference.size() );
+
+        for( const FOOTPRINT_INDEX_ENTRY& entry : footprints )
+        {
+            const MODULE* module = io.GetEnumeratedFootprint( m_libPath, entry.m_name );
+
+            BOOST_REQUIRE( module );
+            BOOST_CHECK_EQUAL( formatFootprint( *module ), reference[entry.m_name] );
+            BOOST_CHECK_EQUAL( entry.m_padCount, module->GetPadCount( DO_NOT_INCLUDE_NPTH ) );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
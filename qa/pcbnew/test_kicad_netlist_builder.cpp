@@ -0,0 +1,217 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for KICAD_NETLIST_BUILDER, which must fill the same NETLIST from the elements
+ * Eeschema writes as KICAD_NETLIST_READER from the text of the same netlist
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <macros.h>
+#include <netlist_writer.h>
+#include <pcb_netlist.h>
+#include <richio.h>
+
+#include <map>
+#include <set>
+#include <string>
+
+#include <wx/filename.h>
+
+// Code under test
+#include <netlist_reader.h>
+
+
+///> A netlist exported by Eeschema, from the Eeschema test data
+static wxString getNetlistFileName( const wxString& aBaseName )
+{
+    wxFileName fn;
+
+    fn.AssignDir( QA_EESCHEMA_DATA_LOCATION );
+    fn.AppendDir( "netlists" );
+    fn.AppendDir( aBaseName );
+    fn.SetName( aBaseName );
+    fn.SetExt( "net" );
+
+    return fn.GetFullPath();
+}
+
+
+///> The attributes of each element, as NETLIST_EXPORTER_GENERIC writes them
+static const std::map<std::string, std::set<std::string>> attributes = {
+    { "export",      { "version" } },
+    { "sheet",       { "number", "name", "tstamps" } },
+    { "comment",     { "number", "value" } },
+    { "textvar",     { "name" } },
+    { "comp",        { "ref" } },
+    { "libsource",   { "lib", "part", "description" } },
+    { "property",    { "name", "value" } },
+    { "sheetpath",   { "names", "tstamps" } },
+    { "library",     { "logical" } },
+    { "libpart",     { "lib", "part" } },
+    { "field",       { "name" } },
+    { "pin",         { "num", "name", "type" } },
+    { "net",         { "code", "name" } },
+    { "node",        { "ref", "pin", "pinfunction" } }
+};
+
+
+/**
+ * Writes the element whose left parenthesis and name were just read to \a aWriter, with the
+ * calls that SEXPR_NETLIST_WRITER turns into this text.
+ */
+static void replayElement( NETLIST_LEXER& aLexer, NETLIST_WRITER& aWriter )
+{
+    const std::string name = aLexer.CurText();
+    auto              known = attributes.find( name );
+
+    aWriter.Open( name.c_str() );
+
+    for( NETLIST_T::T token = aLexer.NextTok(); token != NETLIST_T::T_RIGHT;
+         token = aLexer.NextTok() )
+    {
+        BOOST_REQUIRE( token != NETLIST_T::T_EOF );
+
+        if( token != NETLIST_T::T_LEFT )
+        {
+            aWriter.Text( FROM_UTF8( aLexer.CurText() ) );
+            continue;
+        }
+
+        aLexer.NextTok();
+        const std::string child = aLexer.CurText();
+
+        if( known != attributes.end() && known->second.count( child ) )
+        {
+            aLexer.NextTok();
+            aWriter.Attribute( child.c_str(), FROM_UTF8( aLexer.CurText() ) );
+            aLexer.NeedRIGHT();
+        }
+        else
+        {
+            replayElement( aLexer, aWriter );
+        }
+    }
+
+    aWriter.Close();
+}
+
+
+static void checkSameComponent( const COMPONENT& aBuilt, const COMPONENT& aRead )
+{
+    BOOST_CHECK_EQUAL( aBuilt.GetValue(), aRead.GetValue() );
+    BOOST_CHECK_EQUAL( aBuilt.GetFPID().Format().wx_str(), aRead.GetFPID().Format().wx_str() );
+    BOOST_CHECK_EQUAL( aBuilt.GetPath().AsString(), aRead.GetPath().AsString() );
+    BOOST_CHECK_EQUAL( aBuilt.GetName(), aRead.GetName() );
+    BOOST_CHECK_EQUAL( aBuilt.GetLibrary(), aRead.GetLibrary() );
+    BOOST_CHECK( aBuilt.GetProperties() == aRead.GetProperties() );
+    BOOST_CHECK( aBuilt.GetFootprintFilters() == aRead.GetFootprintFilters() );
+    BOOST_CHECK_EQUAL( aBuilt.GetPinCount(), aRead.GetPinCount() );
+    BOOST_REQUIRE_EQUAL( aBuilt.GetNetCount(), aRead.GetNetCount() );
+
+    for( unsigned ii = 0; ii < aBuilt.GetNetCount(); ++ii )
+    {
+        const COMPONENT_NET& built = aBuilt.GetNet( ii );
+        const COMPONENT_NET& read = aRead.GetNet( ii );
+
+        BOOST_TEST_CONTEXT( "pin " << read.GetPinName() )
+        {
+            BOOST_CHECK_EQUAL( built.GetPinName(), read.GetPinName() );
+            BOOST_CHECK_EQUAL( built.GetNetName(), read.GetNetName() );
+            BOOST_CHECK_EQUAL( built.GetPinFunction(), read.GetPinFunction() );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( KicadNetlistBuilder )
+
+
+/**
+ * The netlist built from the elements of an export is the one read from its text
+ */
+BOOST_AUTO_TEST_CASE( SameAsReader )
+{
+    wxString fileName = getNetlistFileName( "complex_hierarchy" );
+    NETLIST  read;
+
+    KICAD_NETLIST_READER reader( new FILE_LINE_READER( fileName ), &read );
+    reader.LoadNetlist();
+
+    NETLIST               built;
+    KICAD_NETLIST_BUILDER builder( &built );
+    FILE_LINE_READER      lineReader( fileName );
+    NETLIST_LEXER         lexer( &lineReader );
+
+    lexer.NeedLEFT();
+    lexer.NextTok();
+    replayElement( lexer, builder );
+
+    BOOST_CHECK( builder.GetError().IsEmpty() );
+    BOOST_CHECK( builder.IsExported() );
+
+    BOOST_REQUIRE( read.GetCount() > 0 );
+    BOOST_REQUIRE_EQUAL( built.GetCount(), read.GetCount() );
+
+    for( unsigned ii = 0; ii < read.GetCount(); ++ii )
+    {
+        BOOST_TEST_CONTEXT( read.GetComponent( ii )->GetReference() )
+        {
+            BOOST_CHECK_EQUAL( built.GetComponent( ii )->GetReference(),
+                               read.GetComponent( ii )->GetReference() );
+            checkSameComponent( *built.GetComponent( ii ), *read.GetComponent( ii ) );
+        }
+    }
+}
+
+
+/**
+ * A fetch which got no netlist, or only part of it, is told from an empty schematic
+ */
+BOOST_AUTO_TEST_CASE( NotExported )
+{
+    NETLIST               netlist;
+    KICAD_NETLIST_BUILDER nothing( &netlist );
+
+    BOOST_CHECK( !nothing.IsExported() );
+    BOOST_CHECK( nothing.GetError().IsEmpty() );
+
+    KICAD_NETLIST_BUILDER partial( &netlist );
+
+    partial.Open( "export" );
+    partial.Attribute( "version", "D" );
+    partial.Open( "components" );
+    partial.Close();
+
+    BOOST_CHECK( !partial.IsExported() );
+
+    partial.Close();
+
+    BOOST_CHECK( partial.IsExported() );
+    BOOST_CHECK_EQUAL( netlist.GetCount(), 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
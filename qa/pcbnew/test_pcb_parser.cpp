@@ -0,0 +1,381 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <board_snapshot.h>
+#include <class_board.h>
+#include <common.h>
+#include <kicad_plugin.h>
+#include <pcb_parser.h>
+#include <richio.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+
+/**
+ * A board with items of most kinds, a group and a net after them, a comment and texts
+ * holding parenthesis, to check the split of the file in sections.
+ */
+static std::string makeBoardText()
+{
+    std::string text =
+            "(kicad_pcb (version 20200829) (host pcbnew \"5.99\")\n"
+            "  (general (thickness 1.6))\n"
+            "  (net 0 \"\")\n"
+            "  (net 1 \"GND\")\n"
+            "  (net 2 \"/a(b)\")\n"
+            "  (gr_line (start 0 0) (end 10.5 0) (layer \"Edge.Cuts\") (width 0.1) "
+            "(tstamp 00000000-0000-0000-0000-000000000001))\n"
+            "  (gr_text \"x ) \\\" (\" (at 1 2) (layer \"F.SilkS\") "
+            "(tstamp 00000000-0000-0000-0000-000000000002)\n"
+            "    (effects (font (size 1 1) (thickness 0.15))))\n"
+            "# a comment (\n";
+
+    for( int ii = 0; ii < 200; ++ii )
+    {
+        text += "  (segment (start " + std::to_string( ii ) + " 1.25) (end "
+                + std::to_string( ii + 1 ) + ".123456 -3) (width 0.25) (layer \"F.Cu\") "
+                + "(net " + std::to_string( ii % 3 ) + ") (tstamp 00000000-0000-0000-0001-"
+                + std::to_string( 100000000000 + ii ) + "))\n";
+    }
+
+    text += "  (via (at 3 4) (size 0.8) (drill 0.4) (layers \"F.Cu\" \"B.Cu\") (net 1) "
+            "(tstamp 00000000-0000-0000-0000-000000000003))\n"
+            "  (zone (net 1) (net_name \"GND\") (layer \"F.Cu\") "
+            "(tstamp 00000000-0000-0000-0000-000000000004) (hatch edge 0.508)\n"
+            "    (connect_pads (clearance 0.5))\n"
+            "    (min_thickness 0.254)\n"
+            "    (fill yes (thermal_gap 0.5) (thermal_bridge_width 0.5))\n"
+            "    (polygon (pts (xy 0 0) (xy 10 0)\n"
+            "      (xy 10 10) (xy 0 1e1)))\n"
+            "    (filled_polygon (layer \"F.Cu\") (pts (xy 0.1 0.1) (xy 9.9 0.1) "
+            "(xy 9.9 9.9) (xy 0.1 9.9))))\n"
+            "  (group \"\" (id 00000000-0000-0000-0000-000000000005)\n"
+            "    (members 00000000-0000-0000-0000-000000000001 "
+            "00000000-0000-0000-0000-000000000003))\n"
+            "  (net 3 \"late\")\n"
+            "  (segment (start 0 0) (end 1 1) (width 0.25) (layer \"B.Cu\") (net 3) "
+            "(tstamp 00000000-0000-0000-0000-000000000006))\n"
+            ")\n";
+
+    return text;
+}
+
+
+static std::unique_ptr<BOARD> parseBoard( const std::string& aText, bool aParallel,
+                                          bool aFastPath )
+{
+    STRING_LINE_READER reader( aText, "test board" );
+    PCB_PARSER         parser( &reader );
+
+    parser.SetParallelLoad( aParallel );
+    parser.SetFastPath( aFastPath );
+
+    return std::unique_ptr<BOARD>( dynamic_cast<BOARD*>( parser.Parse() ) );
+}
+
+
+static std::string formatBoard( BOARD& aBoard )
+{
+    STRING_FORMATTER formatter;
+    PCB_IO           io;
+
+    io.SetOutputFormatter( &formatter );
+    io.Format( &aBoard );
+
+    return formatter.GetString();
+}
+
+
+BOOST_AUTO_TEST_SUITE( PcbParser )
+
+
+/**
+ * The board is the same whether its items are parsed by several threads or not, and with
+ * the fast number conversions or not
+ */
+BOOST_AUTO_TEST_CASE( ParallelLoadMatchesSequential )
+{
+    const std::string text = makeBoardText();
+
+    std::unique_ptr<BOARD> reference = parseBoard( text, false, false );
+    std::unique_ptr<BOARD> parallel = parseBoard( text, true, true );
+
+    BOOST_REQUIRE( reference );
+    BOOST_REQUIRE( parallel );
+
+    BOOST_CHECK_EQUAL( parallel->Tracks().size(), 202 );
+    BOOST_CHECK_EQUAL( parallel->Zones().size(), 1 );
+    BOOST_CHECK_EQUAL( parallel->Groups().size(), 1 );
+    BOOST_CHECK( parallel->FindNet( "late" ) != nullptr );
+
+    BOOST_CHECK_EQUAL( formatBoard( *parallel ), formatBoard( *reference ) );
+}
+
+
+/**
+ * Errors are reported at the same place either way
+ */
+BOOST_AUTO_TEST_CASE( ParallelLoadErrors )
+{
+    std::string text = makeBoardText();
+
+    // An unknown keyword in the middle of the items, then an unbalanced file
+    for( const std::string& broken : { std::string( "(segment (start 5 1.25) (foo 1)" ),
+                                       std::string( "(segment (start 5 1.25" ) } )
+    {
+        std::string brokenText = text;
+        brokenText.replace( brokenText.find( "(segment (start 5 1.25)" ),
+                            std::string( "(segment (start 5 1.25)" ).size(), broken );
+
+        wxString sequentialError;
+        wxString parallelError;
+
+        try
+        {
+            parseBoard( brokenText, false, true );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            sequentialError = ioe.What();
+        }
+
+        try
+        {
+            parseBoard( brokenText, true, true );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            parallelError = ioe.What();
+        }
+
+        BOOST_CHECK( !sequentialError.IsEmpty() );
+        BOOST_CHECK_EQUAL( parallelError, sequentialError );
+    }
+}
+
+
+/**
+ * A board loaded back from its snapshot is the board parsed from its file, and the
+ * snapshot is not used once the file changes
+ */
+BOOST_AUTO_TEST_CASE( BoardSnapshot )
+{
+    const std::string text = makeBoardText();
+    const wxString    fileName = wxFileName::CreateTempFileName( "kicad_pcb" );
+
+    {
+        wxFFile file( fileName, "wb" );
+        BOOST_REQUIRE( file.Write( text.data(), text.size() ) == text.size() );
+    }
+
+    std::unique_ptr<BOARD> reference = parseBoard( text, false, false );
+
+    BOOST_REQUIRE( reference );
+
+    BOARD_SNAPSHOT( fileName ).Save( reference.get() );
+
+    std::unique_ptr<BOARD> restored( BOARD_SNAPSHOT( fileName ).Load() );
+
+    BOOST_REQUIRE( restored );
+    BOOST_CHECK_EQUAL( restored->Tracks().size(), 202 );
+    BOOST_CHECK_EQUAL( formatBoard( *restored ), formatBoard( *reference ) );
+
+    {
+        wxFFile file( fileName, "ab" );
+        file.Write( wxString( "\n" ) );
+    }
+
+    BOOST_CHECK( BOARD_SNAPSHOT( fileName ).Load() == nullptr );
+
+    wxRemoveFile( BOARD_SNAPSHOT::GetFileName( fileName ) );
+    wxRemoveFile( fileName );
+}
+
+
+/**
+ * A snapshot with a damaged net or track count is not loaded, and nothing is allocated for
+ * the items it cannot hold
+ */
+BOOST_AUTO_TEST_CASE( BoardSnapshotDamagedCounts )
+{
+    const std::string text = makeBoardText();
+    const wxString    fileName = wxFileName::CreateTempFileName( "kicad_pcb" );
+
+    {
+        wxFFile file( fileName, "wb" );
+        BOOST_REQUIRE( file.Write( text.data(), text.size() ) == text.size() );
+    }
+
+    std::unique_ptr<BOARD> reference = parseBoard( text, false, false );
+
+    BOOST_REQUIRE( reference );
+
+    BOARD_SNAPSHOT( fileName ).Save( reference.get() );
+
+    const wxString snapshotName = BOARD_SNAPSHOT::GetFileName( fileName );
+    std::string    snapshot;
+
+    {
+        wxFFile file( snapshotName, "rb" );
+        BOOST_REQUIRE( file.IsOpened() );
+
+        snapshot.resize( file.Length() );
+        BOOST_REQUIRE( file.Read( &snapshot[0], snapshot.size() ) == snapshot.size() );
+    }
+
+    size_t pos = 0;
+
+    auto getCount =
+            [&]()
+            {
+                uint32_t count;
+
+                BOOST_REQUIRE( pos + sizeof( count ) <= snapshot.size() );
+                memcpy( &count, &snapshot[pos], sizeof( count ) );
+                pos += sizeof( count );
+                return count;
+            };
+
+    // Magic, byte order, format and file versions, board hash and board text
+    pos += getCount();
+    pos += 3 * sizeof( uint32_t );
+    pos += getCount();
+    pos += getCount();
+
+    const size_t netCountPos = pos;
+
+    for( uint32_t count = getCount(); count; --count )
+        pos += getCount();
+
+    const size_t trackCountPos = pos;
+
+    BOOST_REQUIRE( trackCountPos + sizeof( uint64_t ) <= snapshot.size() );
+
+    auto loadDamaged =
+            [&]( size_t aPos, const void* aCount, size_t aSize )
+            {
+                std::string damaged = snapshot;
+                memcpy( &damaged[aPos], aCount, aSize );
+
+                wxFFile file( snapshotName, "wb" );
+                BOOST_REQUIRE( file.Write( damaged.data(), damaged.size() ) == damaged.size() );
+                file.Close();
+
+                return std::unique_ptr<BOARD>( BOARD_SNAPSHOT( fileName ).Load() );
+            };
+
+    const uint32_t hugeNetCount = 0xFFFFFFFF;
+    const uint64_t hugeTrackCount = 0xFFFFFFFFFFFFull;
+
+    BOOST_CHECK( !loadDamaged( netCountPos, &hugeNetCount, sizeof( hugeNetCount ) ) );
+    BOOST_CHECK( !loadDamaged( trackCountPos, &hugeTrackCount, sizeof( hugeTrackCount ) ) );
+
+    // The undamaged snapshot still loads
+    uint64_t trackCount;
+    memcpy( &trackCount, &snapshot[trackCountPos], sizeof( trackCount ) );
+
+    BOOST_CHECK_EQUAL( trackCount, 202 );
+    BOOST_CHECK( loadDamaged( trackCountPos, &trackCount, sizeof( trackCount ) ) );
+
+    wxRemoveFile( snapshotName );
+    wxRemoveFile( fileName );
+}
+
+
+/**
+ * Parsers of several threads give the same footprint as a single parser
+ */
+BOOST_AUTO_TEST_CASE( ConcurrentFootprints )
+{
+    const std::string text =
+            "(module R_0603 (layer F.Cu) (tedit 5F000000) "
+            "(tstamp 00000000-0000-0000-0000-000000000001)\n"
+            "  (descr \"Resistor (0603)\") (tags resistor)\n"
+            "  (fp_text reference REF** (at 0 -1.43) (layer F.SilkS)\n"
+            "    (effects (font (size 1 1) (thickness 0.15)))\n"
+            "    (tstamp 00000000-0000-0000-0000-000000000002))\n"
+            "  (fp_text value R_0603 (at 0 1.43) (layer F.Fab)\n"
+            "    (effects (font (size 1 1) (thickness 0.15)))\n"
+            "    (tstamp 00000000-0000-0000-0000-000000000003))\n"
+            "  (fp_line (start -0.8 0.4) (end 0.8 0.4) (layer F.Fab) (width 0.1) "
+            "(tstamp 00000000-0000-0000-0000-000000000004))\n"
+            "  (pad 1 smd roundrect (at -0.7875 0) (size 0.875 0.95) (layers F.Cu F.Paste F.Mask)"
+            " (roundrect_rratio 0.25) (tstamp 00000000-0000-0000-0000-000000000005))\n"
+            "  (pad 2 smd roundrect (at 0.7875 0) (size 0.875 0.95) (layers F.Cu F.Paste F.Mask)"
+            " (roundrect_rratio 0.25) (tstamp 00000000-0000-0000-0000-000000000006)))\n";
+
+    auto parseFootprint =
+            [&]()
+            {
+                STRING_LINE_READER          reader( text, "test footprint" );
+                PCB_PARSER                  parser( &reader );
+                std::unique_ptr<BOARD_ITEM> item( parser.Parse() );
+                STRING_FORMATTER            formatter;
+                PCB_IO                      io;
+
+                io.SetOutputFormatter( &formatter );
+                io.Format( item.get() );
+
+                return formatter.GetString();
+            };
+
+    // Switched before the threads start, as the footprint library loader does
+    LOCALE_IO toggle;
+
+    const std::string        reference = parseFootprint();
+    std::vector<std::string> results( 8 );
+    std::vector<std::thread> threads;
+
+    for( std::string& result : results )
+    {
+        std::string* out = &result;
+
+        threads.emplace_back( [&parseFootprint, out]()
+                              {
+                                  for( int ii = 0; ii < 20; ++ii )
+                                      *out = parseFootprint();
+                              } );
+    }
+
+    for( std::thread& thread : threads )
+        thread.join();
+
+    BOOST_CHECK( reference.find( "smd roundrect" ) != std::string::npos );
+    BOOST_CHECK( reference.find( "00000000-0000-0000-0000-000000000005" ) != std::string::npos );
+
+    for( const std::string& result : results )
+        BOOST_CHECK_EQUAL( result, reference );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,324 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <qa_utils/utility_registry.h>
+
+#include <class_board.h>
+#include <profile.h>
+
+#include <3d_canvas/board_adapter.h>
+#include <3d_rendering/ctrack_ball.h>
+#include <3d_rendering/3d_render_raytracing/accelerators/cbvh_pbrt.h>
+#include <3d_rendering/3d_render_raytracing/shapes3D/clayeritem.h>
+
+#include <nlohmann/json.hpp>
+
+#include <wx/cmdline.h>
+
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "i", "iterations", _( "number of builds and ray casts to average" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER, wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_SWITCH, "j", "json", _( "print the results as JSON" ).mb_str() },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input board file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum BVH_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+///> Size of the "window" the rays are cast through, in pixels
+static const wxSize CANVAS_SIZE( 1024, 768 );
+
+
+struct BVH_BENCHMARK_CONFIG
+{
+    std::string m_name;
+    SPLITMETHOD m_splitMethod;
+    int         m_maxPrimsInNode;
+    bool        m_parallelBuild;
+};
+
+
+static const std::vector<BVH_BENCHMARK_CONFIG> g_configs = {
+    { "middle (raytracer)", SPLITMETHOD::MIDDLE, 8, false },
+    { "middle parallel",    SPLITMETHOD::MIDDLE, 8, true },
+    { "sah",                SPLITMETHOD::SAH,    4, false },
+    { "sah parallel",       SPLITMETHOD::SAH,    4, true },
+    { "hlbvh",              SPLITMETHOD::HLBVH,  4, false },
+};
+
+
+struct BVH_BENCHMARK_RESULT
+{
+    std::string m_design;
+    std::string m_config;
+    size_t      m_objects = 0;
+    double      m_buildMsecs = 0.0;         ///< Average build time
+    double      m_raysPerSecond = 0.0;      ///< Single ray traversal
+    double      m_packetRaysPerSecond = 0.0;///< Packet traversal
+    size_t      m_hits = 0;                 ///< Rays hitting the board, for cross-checking
+};
+
+
+/**
+ * Fill a container with the 3D layer objects of a board, as the raytracer does for the
+ * copper, silkscreen, paste, etc. layers.
+ */
+static void buildLayerObjects( const BOARD_ADAPTER& aAdapter, CCONTAINER& aContainer )
+{
+    for( const auto& layer : aAdapter.GetMapLayers() )
+    {
+        if( !layer.second )
+            continue;
+
+        const float zMin = aAdapter.GetLayerBottomZpos3DU( layer.first );
+        const float zMax = aAdapter.GetLayerTopZpos3DU( layer.first );
+
+        for( const COBJECT2D* object2d : layer.second->GetList() )
+            aContainer.Add( new CLAYERITEM( object2d, zMin, zMax ) );
+    }
+}
+
+
+static double castRays( const CBVH_PBRT& aAccelerator, const CCAMERA& aCamera, size_t& aHits )
+{
+    PROF_COUNTER timer;
+
+    aHits = 0;
+
+    for( int y = 0; y < CANVAS_SIZE.y; ++y )
+    {
+        for( int x = 0; x < CANVAS_SIZE.x; ++x )
+        {
+            SFVEC3F origin;
+            SFVEC3F direction;
+
+            aCamera.MakeRay( SFVEC2I( x, y ), origin, direction );
+
+            RAY ray;
+            ray.Init( origin, direction );
+
+            HITINFO hit;
+            hit.m_tHit = std::numeric_limits<float>::infinity();
+
+            if( aAccelerator.Intersect( ray, hit ) )
+                aHits++;
+        }
+    }
+
+    timer.Stop();
+
+    return (double) CANVAS_SIZE.x * CANVAS_SIZE.y / ( timer.msecs() / 1000.0 );
+}
+
+
+static double castPackets( const CBVH_PBRT& aAccelerator, const CCAMERA& aCamera )
+{
+    PROF_COUNTER timer;
+
+    for( int y = 0; y < CANVAS_SIZE.y; y += RAYPACKET_DIM )
+    {
+        for( int x = 0; x < CANVAS_SIZE.x; x += RAYPACKET_DIM )
+        {
+            RAYPACKET      packet( aCamera, SFVEC2I( x, y ) );
+            HITINFO_PACKET hits[RAYPACKET_RAYS_PER_PACKET];
+
+            for( HITINFO_PACKET& hit : hits )
+            {
+                hit.m_HitInfo.m_tHit = std::numeric_limits<float>::infinity();
+                hit.m_HitInfo.m_acc_node_info = 0;
+                hit.m_hitresult = false;
+            }
+
+            aAccelerator.Intersect( packet, hits );
+        }
+    }
+
+    timer.Stop();
+
+    return (double) CANVAS_SIZE.x * CANVAS_SIZE.y / ( timer.msecs() / 1000.0 );
+}
+
+
+static std::vector<BVH_BENCHMARK_RESULT> benchmarkBoard( BOARD& aBoard, const std::string& aName,
+                                                         int aIterations )
+{
+    std::vector<BVH_BENCHMARK_RESULT> results;
+
+    BOARD_ADAPTER adapter;
+
+    adapter.SetBoard( &aBoard );
+    adapter.RenderEngineSet( RENDER_ENGINE::RAYTRACING );
+
+    // Same layers as the default 3D viewer settings
+    for( DISPLAY3D_FLG flag : { FL_ZONE, FL_SILKSCREEN, FL_SOLDERMASK, FL_SHOW_BOARD_BODY,
+                                FL_USE_REALISTIC_MODE, FL_CLIP_SILK_ON_VIA_ANNULUS } )
+    {
+        adapter.SetFlag( flag, true );
+    }
+
+    adapter.InitSettings( nullptr, nullptr );
+
+    CCONTAINER container;
+    buildLayerObjects( adapter, container );
+
+    CTRACK_BALL camera( RANGE_SCALE_3D );
+    camera.SetBoardLookAtPos( adapter.GetBBox3DU().GetCenter() );
+    camera.SetCurWindowSize( CANVAS_SIZE );
+
+    for( const BVH_BENCHMARK_CONFIG& config : g_configs )
+    {
+        BVH_BENCHMARK_RESULT result;
+
+        result.m_design = aName;
+        result.m_config = config.m_name;
+        result.m_objects = container.GetList().size();
+
+        std::unique_ptr<CBVH_PBRT> accelerator;
+
+        for( int i = 0; i < aIterations; ++i )
+        {
+            accelerator.reset();
+
+            PROF_COUNTER timer;
+            accelerator.reset( new CBVH_PBRT( container, config.m_maxPrimsInNode,
+                                              config.m_splitMethod, config.m_parallelBuild ) );
+            timer.Stop();
+
+            result.m_buildMsecs += timer.msecs() / aIterations;
+        }
+
+        for( int i = 0; i < aIterations; ++i )
+        {
+            result.m_raysPerSecond += castRays( *accelerator, camera, result.m_hits ) / aIterations;
+            result.m_packetRaysPerSecond += castPackets( *accelerator, camera ) / aIterations;
+        }
+
+        results.push_back( result );
+    }
+
+    return results;
+}
+
+
+static void printResults( std::ostream& aStream, const std::vector<BVH_BENCHMARK_RESULT>& aResults )
+{
+    for( const BVH_BENCHMARK_RESULT& result : aResults )
+    {
+        aStream << result.m_design << " [" << result.m_config << "]: " << result.m_objects
+                << " objects, build " << std::fixed << std::setprecision( 2 )
+                << result.m_buildMsecs << " ms, " << std::setprecision( 0 )
+                << result.m_raysPerSecond << " rays/s, " << result.m_packetRaysPerSecond
+                << " packet rays/s, " << result.m_hits << " hits" << std::endl;
+    }
+}
+
+
+static void printResultsJson( std::ostream& aStream,
+                              const std::vector<BVH_BENCHMARK_RESULT>& aResults )
+{
+    nlohmann::json runs = nlohmann::json::array();
+
+    for( const BVH_BENCHMARK_RESULT& result : aResults )
+    {
+        runs.push_back( { { "design", result.m_design },
+                          { "config", result.m_config },
+                          { "objects", result.m_objects },
+                          { "build_ms", result.m_buildMsecs },
+                          { "rays_per_second", result.m_raysPerSecond },
+                          { "packet_rays_per_second", result.m_packetRaysPerSecond },
+                          { "hits", result.m_hits } } );
+    }
+
+    aStream << std::setw( 2 ) << runs << std::endl;
+}
+
+
+int bvh_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program measures the build time of the raytracer BVH on "
+                               "the layers of the given boards, and the number of rays per "
+                               "second it can trace, one by one and by packets, for each "
+                               "split method." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long iterations = 3;
+
+    cl_parser.Found( "iterations", &iterations );
+
+    const bool json = cl_parser.Found( "json" );
+
+    std::vector<BVH_BENCHMARK_RESULT> results;
+
+    for( unsigned i = 0; i < cl_parser.GetParamCount(); i++ )
+    {
+        const std::string filename = cl_parser.GetParam( i ).ToStdString();
+
+        std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( filename );
+
+        if( !board )
+            return BVH_BENCHMARK_RET_CODES::LOAD_FAILED;
+
+        for( const BVH_BENCHMARK_RESULT& result : benchmarkBoard( *board, filename, iterations ) )
+            results.push_back( result );
+    }
+
+    if( json )
+        printResultsJson( std::cout, results );
+    else
+        printResults( std::cout, results );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "bvh_benchmark",
+        "Benchmark the raytracer BVH build and traversal on boards",
+        bvh_benchmark_main_func,
+} );
@@ -45,14 +45,38 @@
 using PARSE_DURATION = std::chrono::microseconds;
 
 
+/**
+ * @return the size of the data left in a stream, or -1 if it can't be known (e.g. stdin)
+ */
+static std::streamoff streamSize( std::istream& aStream )
+{
+    const std::streampos pos = aStream.tellg();
+
+    if( pos < 0 || !aStream.seekg( 0, std::ios::end ) )
+    {
+        aStream.clear();
+        return -1;
+    }
+
+    const std::streamoff size = aStream.tellg() - pos;
+
+    aStream.seekg( pos );
+    return size;
+}
+
+
 /**
  * Parse a PCB or footprint file from the given input stream
  *
  * @param aStream the input stream to read from
+ * @param aFastPath use the fast number and point list conversions of the parser
+ * @param aParallel parse the board items with several threads
  * @return success, duration (in us)
  */
-bool parse( std::istream& aStream, bool aVerbose )
+bool parse( std::istream& aStream, bool aVerbose, bool aFastPath, bool aParallel )
 {
+    const std::streamoff size = streamSize( aStream );
+
     // Take input from stdin
     STDISTREAM_LINE_READER reader;
     reader.SetStream( aStream );
@@ -60,6 +84,8 @@ bool parse( std::istream& aStream, bool aVerbose )
     PCB_PARSER parser;
 
     parser.SetLineReader( &reader );
+    parser.SetFastPath( aFastPath );
+    parser.SetParallelLoad( aParallel );
 
     BOARD_ITEM* board = nullptr;
 
@@ -79,6 +105,13 @@ bool parse( std::istream& aStream, bool aVerbose )
     if( aVerbose )
     {
         std::cout << "Took: " << duration.count() << "us" << std::endl;
+
+        if( size > 0 && duration.count() > 0 )
+        {
+            // bytes per microsecond are MB/s
+            std::cout << "Throughput: " << (double) size / duration.count() << " MB/s"
+                      << std::endl;
+        }
     }
 
     return board != nullptr;
@@ -89,6 +122,11 @@ static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
     { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
             wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
     { wxCMD_LINE_SWITCH, "v", "verbose", _( "print parsing information" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "r", "reference",
+            _( "use the reference (slow) number conversions, to compare with the default ones" )
+                    .mb_str() },
+    { wxCMD_LINE_SWITCH, "s", "sequential", _( "parse the board items with a single thread" )
+            .mb_str() },
     { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input file" ).mb_str(), wxCMD_LINE_VAL_STRING,
             wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE },
     { wxCMD_LINE_NONE }
@@ -123,6 +161,8 @@ int pcb_parser_main_func( int argc, char** argv )
     }
 
     const bool verbose = cl_parser.Found( "verbose" );
+    const bool fastPath = !cl_parser.Found( "reference" );
+    const bool parallel = !cl_parser.Found( "sequential" );
 
     bool ok = true;
 
@@ -134,7 +174,7 @@ int pcb_parser_main_func( int argc, char** argv )
         // program
         // while (__AFL_LOOP(2))
         {
-            ok = parse( std::cin, verbose );
+            ok = parse( std::cin, verbose, fastPath, parallel );
         }
     }
     else
@@ -152,7 +192,7 @@ int pcb_parser_main_func( int argc, char** argv )
             std::ifstream fin;
             fin.open( filename );
 
-            ok = ok && parse( fin, verbose );
+            ok = ok && parse( fin, verbose, fastPath, parallel );
         }
     }
 
@@ -0,0 +1,191 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <qa_utils/render_benchmark.h>
+#include <qa_utils/utility_registry.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <class_marker_pcb.h>
+#include <pcb_painter.h>
+#include <pcb_view.h>
+
+#include <wx/cmdline.h>
+
+#include <iostream>
+#include <memory>
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "i", "iterations", _( "number of redraws of each layer" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER, wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_OPTION, "b", "backend", _( "backend to use: null, cairo or all (default)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_SWITCH, "j", "json", _( "print the results as JSON" ).mb_str() },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input board file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum RENDER_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+///> Size of the offscreen canvas, in pixels
+static const VECTOR2I CANVAS_SIZE( 1920, 1080 );
+
+
+/**
+ * Add the board items to the view, the same way PCB_DRAW_PANEL_GAL::DisplayBoard() does.
+ */
+static void addBoardToView( BOARD& aBoard, KIGFX::VIEW& aView )
+{
+    for( BOARD_ITEM* drawing : aBoard.Drawings() )
+        aView.Add( drawing );
+
+    for( TRACK* track : aBoard.Tracks() )
+        aView.Add( track );
+
+    for( MODULE* module : aBoard.Modules() )
+        aView.Add( module );
+
+    for( MARKER_PCB* marker : aBoard.Markers() )
+        aView.Add( marker );
+
+    for( ZONE_CONTAINER* zone : aBoard.Zones() )
+        aView.Add( zone );
+}
+
+
+static KI_TEST::RENDER_BENCHMARK_RESULT benchmarkBoard( BOARD& aBoard, const std::string& aName,
+                                                        KIGFX::GAL* aGal,
+                                                        KI_TEST::COUNTING_GAL* aCounter,
+                                                        const std::string& aBackend,
+                                                        int aIterations )
+{
+    KIGFX::PCB_VIEW    view( false );
+    KIGFX::PCB_PAINTER painter( aGal );
+
+    aGal->SetWorldUnitLength( 1e-9 /* 1 nm */ / 0.0254 /* 1 inch in meters */ );
+
+    view.SetGAL( aGal );
+    view.SetPainter( &painter );
+
+    addBoardToView( aBoard, view );
+
+    KI_TEST::RENDER_BENCHMARK benchmark( view, aCounter );
+    EDA_RECT                  bbox = aBoard.GetBoundingBox();
+
+    benchmark.ZoomToFit( BOX2I( bbox.GetOrigin(), bbox.GetSize() ) );
+
+    KI_TEST::RENDER_BENCHMARK_RESULT result = benchmark.Run( aName, aBackend, aIterations );
+
+    view.Clear();
+
+    return result;
+}
+
+
+int render_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program measures the PCB_PAINTER throughput on the given "
+                               "boards, without a display. The view is redrawn layer by layer "
+                               "into a null GAL (counting primitives and vertices) and into an "
+                               "offscreen Cairo surface." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     iterations = 5;
+    wxString backend = "all";
+
+    cl_parser.Found( "iterations", &iterations );
+    cl_parser.Found( "backend", &backend );
+
+    const bool json = cl_parser.Found( "json" );
+
+    std::vector<KI_TEST::RENDER_BENCHMARK_RESULT> results;
+    KIGFX::GAL_DISPLAY_OPTIONS                    options;
+
+    for( unsigned i = 0; i < cl_parser.GetParamCount(); i++ )
+    {
+        const std::string filename = cl_parser.GetParam( i ).ToStdString();
+
+        std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( filename );
+
+        if( !board )
+            return RENDER_BENCHMARK_RET_CODES::LOAD_FAILED;
+
+        if( backend == "all" || backend == "null" )
+        {
+            KI_TEST::COUNTING_GAL gal( options, CANVAS_SIZE );
+
+            results.push_back( benchmarkBoard( *board, filename, &gal, &gal, "null",
+                                               iterations ) );
+        }
+
+        if( backend == "all" || backend == "cairo" )
+        {
+            KI_TEST::CAIRO_IMAGE_GAL gal( options, CANVAS_SIZE );
+
+            results.push_back( benchmarkBoard( *board, filename, &gal, nullptr, "cairo",
+                                               iterations ) );
+        }
+    }
+
+    if( json )
+    {
+        KI_TEST::PrintRenderResultsJson( std::cout, results );
+    }
+    else
+    {
+        for( const KI_TEST::RENDER_BENCHMARK_RESULT& result : results )
+            KI_TEST::PrintRenderResults( std::cout, result );
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "render_benchmark",
+        "Benchmark PCB_PAINTER throughput on boards without a display",
+        render_benchmark_main_func,
+} );
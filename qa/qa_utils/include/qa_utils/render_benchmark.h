@@ -0,0 +1,199 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file render_benchmark.h
+ * Helpers to measure the throughput of the GAL painters without a display.
+ *
+ * The painters are driven through a KIGFX::VIEW, either into a COUNTING_GAL (a "null" GAL
+ * which only counts the primitives it receives) or into a CAIRO_IMAGE_GAL (a Cairo GAL
+ * rendering into an offscreen image surface).
+ */
+
+#ifndef QA_UTILS_RENDER_BENCHMARK_H
+#define QA_UTILS_RENDER_BENCHMARK_H
+
+#include <gal/cairo/cairo_gal.h>
+#include <gal/graphics_abstraction_layer.h>
+#include <painter.h>
+#include <view/view.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace KI_TEST
+{
+
+/**
+ * Number of primitives and points submitted to a GAL.
+ */
+struct GAL_PRIMITIVE_COUNTS
+{
+    size_t m_primitives = 0;    ///< Number of Draw*() calls
+    size_t m_vertices = 0;      ///< Number of points passed to the Draw*() calls
+};
+
+
+/**
+ * A GAL which does not draw anything, but counts the primitives it is asked to draw.
+ *
+ * It measures the painter cost alone, without any rasterization or GPU upload.
+ */
+class COUNTING_GAL : public KIGFX::GAL
+{
+public:
+    COUNTING_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aDisplayOptions, const VECTOR2I& aScreenSize );
+
+    const GAL_PRIMITIVE_COUNTS& GetCounts() const { return m_counts; }
+
+    void ResetCounts() { m_counts = GAL_PRIMITIVE_COUNTS(); }
+
+    void DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override;
+    void DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
+                      double aWidth ) override;
+    void DrawPolyline( const std::deque<VECTOR2D>& aPointList ) override;
+    void DrawPolyline( const VECTOR2D aPointList[], int aListSize ) override;
+    void DrawPolyline( const SHAPE_LINE_CHAIN& aLineChain ) override;
+    void DrawPolylines( const std::vector<std::vector<VECTOR2D>>& aPointLists ) override;
+    void DrawCircle( const VECTOR2D& aCenterPoint, double aRadius ) override;
+    void DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
+                  double aEndAngle ) override;
+    void DrawArcSegment( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
+                         double aEndAngle, double aWidth ) override;
+    void DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override;
+    void DrawPolygon( const std::deque<VECTOR2D>& aPointList ) override;
+    void DrawPolygon( const VECTOR2D aPointList[], int aListSize ) override;
+    void DrawPolygon( const SHAPE_POLY_SET& aPolySet ) override;
+    void DrawPolygon( const SHAPE_LINE_CHAIN& aPolySet ) override;
+    void DrawCurve( const VECTOR2D& startPoint, const VECTOR2D& controlPointA,
+                    const VECTOR2D& controlPointB, const VECTOR2D& endPoint,
+                    double aFilterValue = 0.0 ) override;
+    void DrawBitmap( const BITMAP_BASE& aBitmap ) override;
+
+private:
+    void count( size_t aVertices )
+    {
+        m_counts.m_primitives++;
+        m_counts.m_vertices += aVertices;
+    }
+
+    GAL_PRIMITIVE_COUNTS m_counts;
+};
+
+
+/**
+ * A Cairo GAL rendering into an offscreen image surface, so no window is required.
+ */
+class CAIRO_IMAGE_GAL : public KIGFX::CAIRO_GAL_BASE
+{
+public:
+    CAIRO_IMAGE_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aDisplayOptions, const VECTOR2I& aScreenSize );
+
+    /**
+     * Write the current content of the image surface to a PNG file.
+     * @return true if the file was written.
+     */
+    bool SavePNG( const std::string& aFileName );
+};
+
+
+/**
+ * Results of the benchmark of a single view layer.
+ */
+struct RENDER_LAYER_STATS
+{
+    int         m_layer = 0;
+    std::string m_name;
+    size_t      m_items = 0;        ///< Item draws (painter calls) per iteration
+    size_t      m_primitives = 0;   ///< GAL primitives per iteration (COUNTING_GAL only)
+    size_t      m_vertices = 0;     ///< Points emitted per iteration (COUNTING_GAL only)
+    double      m_msecs = 0.0;      ///< Average time per iteration
+};
+
+
+/**
+ * Results of a benchmark run of a design with a given backend.
+ */
+struct RENDER_BENCHMARK_RESULT
+{
+    std::string                     m_design;
+    std::string                     m_backend;
+    int                             m_iterations = 0;
+    std::vector<RENDER_LAYER_STATS> m_layers;
+
+    size_t TotalItems() const;
+    size_t TotalVertices() const;
+    double TotalMsecs() const;
+    double ItemsPerSecond() const;
+};
+
+
+/**
+ * Drives a VIEW (already populated with the items of a design) layer by layer, and
+ * measures the time spent by the painter in each of them.
+ *
+ * All the layers are switched to the non-cached target for the duration of the benchmark,
+ * so every redraw goes through the painter rather than replaying cached groups.
+ */
+class RENDER_BENCHMARK
+{
+public:
+    /**
+     * @param aView is the view holding the items to draw. Its GAL and painter must be set.
+     * @param aCounter is the GAL used by the view if it is a COUNTING_GAL (nullptr otherwise),
+     * to collect the primitive and vertex counts.
+     */
+    RENDER_BENCHMARK( KIGFX::VIEW& aView, COUNTING_GAL* aCounter );
+
+    /**
+     * Fit the whole given area in the view.
+     */
+    void ZoomToFit( const BOX2I& aArea );
+
+    /**
+     * Redraw every view layer containing items, aIterations times each.
+     */
+    RENDER_BENCHMARK_RESULT Run( const std::string& aDesign, const std::string& aBackend,
+                                 int aIterations );
+
+private:
+    KIGFX::VIEW&  m_view;
+    COUNTING_GAL* m_counter;
+};
+
+
+/**
+ * Print human-readable benchmark results.
+ */
+void PrintRenderResults( std::ostream& aStream, const RENDER_BENCHMARK_RESULT& aResult );
+
+/**
+ * Print a set of benchmark results as a JSON document, to track rendering regressions.
+ */
+void PrintRenderResultsJson( std::ostream& aStream,
+                             const std::vector<RENDER_BENCHMARK_RESULT>& aResults );
+
+} // namespace KI_TEST
+
+#endif // QA_UTILS_RENDER_BENCHMARK_H
@@ -0,0 +1,430 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/render_benchmark.h>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+#include <layers_id_colors_and_visibility.h>
+#include <profile.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <set>
+
+
+namespace KI_TEST
+{
+
+COUNTING_GAL::COUNTING_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aDisplayOptions,
+                            const VECTOR2I& aScreenSize ) :
+        GAL( aDisplayOptions )
+{
+    SetScreenSize( aScreenSize );
+}
+
+
+void COUNTING_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+{
+    count( 2 );
+}
+
+
+void COUNTING_GAL::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
+                                double aWidth )
+{
+    count( 2 );
+}
+
+
+void COUNTING_GAL::DrawPolyline( const std::deque<VECTOR2D>& aPointList )
+{
+    count( aPointList.size() );
+}
+
+
+void COUNTING_GAL::DrawPolyline( const VECTOR2D aPointList[], int aListSize )
+{
+    count( aListSize );
+}
+
+
+void COUNTING_GAL::DrawPolyline( const SHAPE_LINE_CHAIN& aLineChain )
+{
+    count( aLineChain.PointCount() );
+}
+
+
+void COUNTING_GAL::DrawPolylines( const std::vector<std::vector<VECTOR2D>>& aPointLists )
+{
+    size_t vertices = 0;
+
+    for( const std::vector<VECTOR2D>& pointList : aPointLists )
+        vertices += pointList.size();
+
+    count( vertices );
+}
+
+
+void COUNTING_GAL::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
+{
+    count( 1 );
+}
+
+
+void COUNTING_GAL::DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
+                            double aEndAngle )
+{
+    count( 1 );
+}
+
+
+void COUNTING_GAL::DrawArcSegment( const VECTOR2D& aCenterPoint, double aRadius,
+                                   double aStartAngle, double aEndAngle, double aWidth )
+{
+    count( 1 );
+}
+
+
+void COUNTING_GAL::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+{
+    count( 4 );
+}
+
+
+void COUNTING_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
+{
+    count( aPointList.size() );
+}
+
+
+void COUNTING_GAL::DrawPolygon( const VECTOR2D aPointList[], int aListSize )
+{
+    count( aListSize );
+}
+
+
+void COUNTING_GAL::DrawPolygon( const SHAPE_POLY_SET& aPolySet )
+{
+    count( aPolySet.TotalVertices() );
+}
+
+
+void COUNTING_GAL::DrawPolygon( const SHAPE_LINE_CHAIN& aPolySet )
+{
+    count( aPolySet.PointCount() );
+}
+
+
+void COUNTING_GAL::DrawCurve( const VECTOR2D& startPoint, const VECTOR2D& controlPointA,
+                              const VECTOR2D& controlPointB, const VECTOR2D& endPoint,
+                              double aFilterValue )
+{
+    count( 4 );
+}
+
+
+void COUNTING_GAL::DrawBitmap( const BITMAP_BASE& aBitmap )
+{
+    count( 4 );
+}
+
+
+CAIRO_IMAGE_GAL::CAIRO_IMAGE_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aDisplayOptions,
+                                  const VECTOR2I& aScreenSize ) :
+        CAIRO_GAL_BASE( aDisplayOptions )
+{
+    SetScreenSize( aScreenSize );
+
+    // Both are released by CAIRO_GAL_BASE
+    surface = cairo_image_surface_create( GAL_FORMAT, aScreenSize.x, aScreenSize.y );
+    context = currentContext = cairo_create( surface );
+
+    m_clearColor = KIGFX::COLOR4D( 0.0, 0.0, 0.0, 1.0 );
+    SetTarget( KIGFX::TARGET_NONCACHED );
+    resetContext();
+}
+
+
+bool CAIRO_IMAGE_GAL::SavePNG( const std::string& aFileName )
+{
+    cairo_surface_flush( surface );
+    return cairo_surface_write_to_png( surface, aFileName.c_str() ) == CAIRO_STATUS_SUCCESS;
+}
+
+
+size_t RENDER_BENCHMARK_RESULT::TotalItems() const
+{
+    size_t total = 0;
+
+    for( const RENDER_LAYER_STATS& layer : m_layers )
+        total += layer.m_items;
+
+    return total;
+}
+
+
+size_t RENDER_BENCHMARK_RESULT::TotalVertices() const
+{
+    size_t total = 0;
+
+    for( const RENDER_LAYER_STATS& layer : m_layers )
+        total += layer.m_vertices;
+
+    return total;
+}
+
+
+double RENDER_BENCHMARK_RESULT::TotalMsecs() const
+{
+    double total = 0.0;
+
+    for( const RENDER_LAYER_STATS& layer : m_layers )
+        total += layer.m_msecs;
+
+    return total;
+}
+
+
+double RENDER_BENCHMARK_RESULT::ItemsPerSecond() const
+{
+    double msecs = TotalMsecs();
+
+    return msecs > 0.0 ? TotalItems() * 1000.0 / msecs : 0.0;
+}
+
+
+/**
+ * Forwards everything to the real painter, counting the item draws.
+ */
+class COUNTING_PAINTER : public KIGFX::PAINTER
+{
+public:
+    COUNTING_PAINTER( KIGFX::GAL* aGal, KIGFX::PAINTER* aPainter ) :
+            PAINTER( aGal ),
+            m_draws( 0 ),
+            m_painter( aPainter )
+    {
+    }
+
+    void ApplySettings( const KIGFX::RENDER_SETTINGS* aSettings ) override
+    {
+        m_painter->ApplySettings( aSettings );
+    }
+
+    KIGFX::RENDER_SETTINGS* GetSettings() override
+    {
+        return m_painter->GetSettings();
+    }
+
+    bool Draw( const KIGFX::VIEW_ITEM* aItem, int aLayer ) override
+    {
+        m_draws++;
+        return m_painter->Draw( aItem, aLayer );
+    }
+
+    size_t m_draws;
+
+private:
+    KIGFX::PAINTER* m_painter;
+};
+
+
+RENDER_BENCHMARK::RENDER_BENCHMARK( KIGFX::VIEW& aView, COUNTING_GAL* aCounter ) :
+        m_view( aView ),
+        m_counter( aCounter )
+{
+}
+
+
+void RENDER_BENCHMARK::ZoomToFit( const BOX2I& aArea )
+{
+    m_view.SetViewport( BOX2D( aArea.GetOrigin(), aArea.GetSize() ) );
+}
+
+
+RENDER_BENCHMARK_RESULT RENDER_BENCHMARK::Run( const std::string& aDesign,
+                                               const std::string& aBackend, int aIterations )
+{
+    RENDER_BENCHMARK_RESULT result;
+    KIGFX::GAL*             gal = m_view.GetGAL();
+    KIGFX::PAINTER*         painter = m_view.GetPainter();
+    COUNTING_PAINTER        countingPainter( gal, painter );
+
+    result.m_design = aDesign;
+    result.m_backend = aBackend;
+    result.m_iterations = std::max( aIterations, 1 );
+
+    // Find out which layers hold items, and remember their visibility and target
+    std::vector<KIGFX::VIEW::LAYER_ITEM_PAIR> layerItems;
+    std::set<int>                             usedLayers;
+    BOX2I                                     everything;
+
+    everything.SetMaximum();
+    m_view.Query( everything, layerItems );
+
+    for( const KIGFX::VIEW::LAYER_ITEM_PAIR& pair : layerItems )
+        usedLayers.insert( pair.second );
+
+    std::vector<int> layers( usedLayers.begin(), usedLayers.end() );
+
+    // Same order as VIEW::Redraw()
+    std::sort( layers.begin(), layers.end(),
+               [&]( int a, int b )
+               {
+                   return m_view.GetLayerOrder( a ) > m_view.GetLayerOrder( b );
+               } );
+
+    std::vector<bool>                 visibility( KIGFX::VIEW::VIEW_MAX_LAYERS );
+    std::vector<KIGFX::RENDER_TARGET> targets( KIGFX::VIEW::VIEW_MAX_LAYERS );
+
+    for( int layer = 0; layer < KIGFX::VIEW::VIEW_MAX_LAYERS; ++layer )
+    {
+        visibility[layer] = m_view.IsLayerVisible( layer );
+        targets[layer] = m_view.GetLayerTarget( layer );
+        m_view.SetLayerVisible( layer, false );
+
+        // Force immediate mode, otherwise only the first redraw would reach the painter
+        m_view.SetLayerTarget( layer, KIGFX::TARGET_NONCACHED );
+    }
+
+    m_view.SetPainter( &countingPainter );
+
+    for( int layer : layers )
+    {
+        RENDER_LAYER_STATS stats;
+
+        stats.m_layer = layer;
+        stats.m_name = LayerName( layer ).ToStdString();
+
+        m_view.SetLayerVisible( layer, true );
+
+        countingPainter.m_draws = 0;
+
+        if( m_counter )
+            m_counter->ResetCounts();
+
+        PROF_COUNTER timer;
+
+        for( int i = 0; i < result.m_iterations; ++i )
+        {
+            KIGFX::GAL_DRAWING_CONTEXT ctx( gal );
+
+            m_view.MarkDirty();
+            m_view.Redraw();
+        }
+
+        timer.Stop();
+
+        stats.m_msecs = timer.msecs() / result.m_iterations;
+        stats.m_items = countingPainter.m_draws / result.m_iterations;
+
+        if( m_counter )
+        {
+            stats.m_primitives = m_counter->GetCounts().m_primitives / result.m_iterations;
+            stats.m_vertices = m_counter->GetCounts().m_vertices / result.m_iterations;
+        }
+
+        m_view.SetLayerVisible( layer, false );
+
+        result.m_layers.push_back( stats );
+    }
+
+    m_view.SetPainter( painter );
+
+    for( int layer = 0; layer < KIGFX::VIEW::VIEW_MAX_LAYERS; ++layer )
+    {
+        m_view.SetLayerVisible( layer, visibility[layer] );
+        m_view.SetLayerTarget( layer, targets[layer] );
+    }
+
+    // The cached layers were not updated while they were drawn in immediate mode
+    m_view.MarkDirty();
+
+    return result;
+}
+
+
+void PrintRenderResults( std::ostream& aStream, const RENDER_BENCHMARK_RESULT& aResult )
+{
+    aStream << aResult.m_design << " [" << aResult.m_backend << "], "
+            << aResult.m_iterations << " iteration(s)" << std::endl;
+
+    aStream << std::setw( 24 ) << std::left << "layer" << std::right
+            << std::setw( 10 ) << "items"
+            << std::setw( 12 ) << "primitives"
+            << std::setw( 12 ) << "vertices"
+            << std::setw( 12 ) << "ms" << std::endl;
+
+    for( const RENDER_LAYER_STATS& layer : aResult.m_layers )
+    {
+        aStream << std::setw( 24 ) << std::left << layer.m_name << std::right
+                << std::setw( 10 ) << layer.m_items
+                << std::setw( 12 ) << layer.m_primitives
+                << std::setw( 12 ) << layer.m_vertices
+                << std::setw( 12 ) << std::fixed << std::setprecision( 3 ) << layer.m_msecs
+                << std::endl;
+    }
+
+    aStream << "Total: " << aResult.TotalItems() << " items, " << aResult.TotalVertices()
+            << " vertices, " << std::fixed << std::setprecision( 3 ) << aResult.TotalMsecs()
+            << " ms (" << std::setprecision( 0 ) << aResult.ItemsPerSecond() << " items/s)"
+            << std::endl << std::endl;
+}
+
+
+void PrintRenderResultsJson( std::ostream& aStream,
+                             const std::vector<RENDER_BENCHMARK_RESULT>& aResults )
+{
+    nlohmann::json runs = nlohmann::json::array();
+
+    for( const RENDER_BENCHMARK_RESULT& result : aResults )
+    {
+        nlohmann::json layers = nlohmann::json::array();
+
+        for( const RENDER_LAYER_STATS& layer : result.m_layers )
+        {
+            layers.push_back( { { "id", layer.m_layer },
+                                { "name", layer.m_name },
+                                { "items", layer.m_items },
+                                { "primitives", layer.m_primitives },
+                                { "vertices", layer.m_vertices },
+                                { "ms", layer.m_msecs } } );
+        }
+
+        runs.push_back( { { "design", result.m_design },
+                          { "backend", result.m_backend },
+                          { "iterations", result.m_iterations },
+                          { "items", result.TotalItems() },
+                          { "vertices", result.TotalVertices() },
+                          { "ms", result.TotalMsecs() },
+                          { "items_per_second", result.ItemsPerSecond() },
+                          { "layers", layers } } );
+    }
+
+    aStream << std::setw( 2 ) << runs << std::endl;
+}
+
+} // namespace KI_TEST